@@ -14,6 +14,8 @@ typedef struct { // Circular Queue
 
 Queue*    queue_create(u64 n, u32 data_size, const container_ops* ops);
 Queue*    queue_create_val(u64 n, const u8* val, u32 data_size, const container_ops* ops);
+// struct and buffer from alloc (see wc_allocator.h, NULL = heap)
+Queue*    queue_create_alloc(u64 n, u32 data_size, const container_ops* ops, const wc_allocator* alloc);
 
 void      queue_destroy(Queue* q);
 void      queue_clear(Queue* q);
@@ -9,6 +9,8 @@ typedef genVec Stack;
 
 
 Stack* stack_create(u64 n, u32 data_size, const container_ops* ops);
+// Storage from alloc (see wc_allocator.h, NULL = heap), as genVec_init_alloc
+Stack* stack_create_alloc(u64 n, u32 data_size, const container_ops* ops, const wc_allocator* alloc);
 Stack* stack_create_val(u64 n, const u8* val, u32 data_size, const container_ops* ops);
 
 void stack_destroy(Stack* stk);
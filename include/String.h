@@ -2,6 +2,7 @@
 #define STRING_H
 
 #include "common.h"
+#include "wc_allocator.h"
 
 
 #ifndef STRING_GROWTH
@@ -19,9 +20,10 @@ typedef struct {
     // b8  sso;     // if cap is = STR_SSO_SIZE then we are in sso mode, if greater then heap mode
     u64 size;
     u64 capacity;
+    const wc_allocator* alloc; // for the heap buffer, NULL = heap (see wc_allocator.h)
 } String;
 
-// 24 8 8 = 40 bytes (same as genVec)
+// 24 8 8 8 = 48 bytes (same as genVec)
 
 
 //  Construction / Destruction 
@@ -38,6 +40,11 @@ String* string_from_string(const String* other);
 // Initialise a String whose struct lives on the stack (data may be on heap).
 void string_create_stk(String* str, const char* cstr);
 
+// Same as string_create_stk, with the buffer (once it outgrows SSO) taken
+// from alloc. alloc must outlive the string. Copies (string_from_string,
+// wc_str_ops) go to the heap; string_copy keeps dest's allocator.
+void string_create_stk_alloc(String* str, const char* cstr, const wc_allocator* alloc);
+
 // Destroy a heap-allocated String (frees struct + data).
 void string_destroy(String* str);
 
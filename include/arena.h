@@ -2,6 +2,7 @@
 #define ARENA_H
 
 #include "common.h"
+#include "wc_allocator.h"
 
 
 
@@ -112,6 +113,40 @@ Return:
 u8* arena_alloc_aligned(Arena* arena, u64 size, u32 alignment);
 
 
+/*
+Resize an allocation previously returned by this arena.
+If ptr is the arena's last allocation it is extended (or shrunk)
+in place, nothing is copied. Otherwise a shrink returns ptr as is
+and a grow takes a new block and copies old_size bytes into it;
+the old block stays used until the arena is cleared.
+A NULL ptr is the same as arena_alloc(arena, new_size).
+
+Parameters:
+  Arena* arena    |    The arena ptr was allocated from.
+  u8*    ptr      |    The allocation to resize (or NULL).
+  u64    old_size |    Its current size in bytes.
+  u64    new_size |    The size wanted, in bytes (not 0).
+Return:
+  Pointer to the resized allocation, NULL (wc_errno = WC_ERR_FULL)
+  if the arena has no room; ptr is left untouched then.
+*/
+u8* arena_realloc(Arena* arena, u8* ptr, u64 old_size, u64 new_size);
+
+/*
+A wc_allocator backed by arena, for containers whose storage
+should come from it (genVec_init_alloc, string_create_stk_alloc, ...).
+Growing the last allocation is done in place, and freeing the last
+allocation gives it back to the arena (so a vector destroyed right
+after it was built costs nothing). Other frees are no-ops.
+The returned struct holds arena as ctx, keep it alive as long as
+the containers using it.
+
+Parameters:
+  Arena* arena    |    The arena to allocate from.
+*/
+wc_allocator arena_allocator(Arena* arena);
+
+
 /*
 Get the value of index at the current state of arena
 This can be used to later clear upto that point using arena_clear_mark
@@ -0,0 +1,81 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include "map_setup.h"
+
+
+/* Blocked Bloom Filter
+  - probabilistic membership: "definitely not present" or "maybe present"
+  - sits in front of a hashmap/hashset whose lookups mostly miss: a definite
+    miss skips the probe, a maybe falls through to the real lookup
+  - blocked: each key's k bits all land in one 64-byte block (8 u64 words),
+    so a lookup costs one cache line however large k is
+  - hash_fn(key) is computed once; the block and the k bit positions come
+    from wymix remixes of that hash, so k costs multiplies, not hash_fn calls
+  - sized from the expected key count and target false-positive rate, padded
+    for the uneven fill of blocks: the real rate stays at or below the target
+    while the key count stays within what was asked for
+  - keys can't be removed (clear resets the whole filter)
+*/
+
+
+#define BLOOM_BLOCK_WORDS 8                         // u64 words per block
+#define BLOOM_BLOCK_BITS  (BLOOM_BLOCK_WORDS * 64)  // 512 bits = one cache line
+#define BLOOM_MAX_K       16
+
+
+typedef struct {
+    u64*           words;    // n_blocks * BLOOM_BLOCK_WORDS, 64-byte aligned
+    u64            n_blocks;
+    u64            count;    // keys added (duplicates counted again)
+    u32            k;        // bits set per key
+    u32            key_size;
+    custom_hash_fn hash_fn;
+} bloom;
+
+
+// Create a filter for about expected_n keys at fp_rate false positives
+// (0 < fp_rate < 1). hash_fn defaults to wyhash if NULL; pass the same
+// hash_fn as the map it guards (e.g. wyhash_str for String keys).
+bloom* bloom_create(u64 expected_n, double fp_rate, u32 key_size, custom_hash_fn hash_fn);
+
+void bloom_destroy(bloom* bf);
+
+void bloom_add(bloom* bf, const u8* key);
+
+// 0 = key was never added, 1 = maybe added (false positive at ~fp_rate)
+b8 bloom_maybe_has(const bloom* bf, const u8* key);
+
+// Add n keys from a packed array. Hashes and prefetches a chunk of keys
+// before setting any bits, so the cache misses overlap.
+void bloom_add_many(bloom* bf, const u8* keys, u64 n);
+
+// Batch bloom_maybe_has. maybe (optional) gets 1/0 per key.
+// Returns the number of maybe-present keys.
+u64 bloom_maybe_has_many(const bloom* bf, const u8* keys, u64 n, b8* maybe);
+
+// dest |= src: dest then answers maybe for every key added to either.
+// Both must come from bloom_create with the same arguments.
+void bloom_merge(bloom* dest, const bloom* src);
+
+// Forget every key, keep the size.
+void bloom_clear(bloom* bf);
+
+// Expected false-positive rate at the current fill: mean over blocks of
+// (bits set / bits)^k
+double bloom_fp_estimate(const bloom* bf);
+
+
+static inline u64 bloom_count(const bloom* bf)
+{
+    CHECK_FATAL(!bf, "bloom is null");
+    return bf->count;
+}
+static inline u64 bloom_size_bits(const bloom* bf)
+{
+    CHECK_FATAL(!bf, "bloom is null");
+    return bf->n_blocks * BLOOM_BLOCK_BITS;
+}
+
+
+#endif // BLOOM_H
@@ -2,6 +2,7 @@
 #define GEN_VECTOR_H
 
 #include "common.h"
+#include "wc_allocator.h"
 
 
 /*          TLDR
@@ -39,12 +40,15 @@ typedef struct {
     // Pointer to shared type-ops vtable (or NULL for POD types)
     const container_ops* ops;
 
+    // Where data (and the struct, for genVec_init_alloc) comes from, NULL = heap
+    const wc_allocator* alloc;
+
     u64 size;       // Number of elements currently in vector
     u64 capacity;   // Total allocated capacity (in elements)
     u32 data_size;  // Size of each element in bytes
 } genVec;
 
-// 8 8 8 8 4 '4'  = 40 bytes
+// 8 8 8 8 8 4 '4'  = 48 bytes
 
 
 // Convenience: access ops callbacks safely
@@ -64,6 +68,16 @@ genVec* genVec_init(u64 n, u32 data_size, const container_ops* ops);
 // Initialize vector on stack (struct on stack, data on heap).
 void genVec_init_stk(u64 n, u32 data_size, const container_ops* ops, genVec* vec);
 
+// Same as genVec_init / genVec_init_stk, with storage from alloc
+// (see wc_allocator.h, NULL = heap). genVec_init_alloc takes the
+// struct from alloc too. alloc must outlive the vector.
+// A copy never shares the source's allocator (it may outlive it):
+// genVec_copy keeps dest's, wc_vec_ops copies go to the heap.
+// Moves take the allocator along with the data.
+genVec* genVec_init_alloc(u64 n, u32 data_size, const container_ops* ops, const wc_allocator* alloc);
+void    genVec_init_stk_alloc(u64 n, u32 data_size, const container_ops* ops,
+                              const wc_allocator* alloc, genVec* vec);
+
 // Initialize vector of size n with all elements set to val.
 genVec* genVec_init_val(u64 n, const u8* val, u32 data_size, const container_ops* ops);
 
@@ -109,6 +123,34 @@ void genVec_push(genVec* vec, const u8* data);
 // Append element to end, transfer ownership (nulls original pointer).
 void genVec_push_move(genVec* vec, u8** data);
 
+// Append one uninitialised element and return its slot, to build the
+// element in place (e.g. string_create_stk((String*)slot, "...")): no
+// source buffer, no copy, no heap shell as push_move needs.
+// The element counts in size at once — construct it before any other call
+// on vec. The pointer is invalidated by the next push / emplace that grows.
+u8* genVec_emplace_back(genVec* vec);
+
+// Same for n elements at once (one reserve): returns the first of n
+// contiguous slots, or NULL for n = 0.
+u8* genVec_emplace_n(genVec* vec, u64 n);
+
+// Append n elements from a packed array (makes deep copies if copy_fn provided).
+// Reserves once, then one memcpy for POD. arr must not point into vec.
+void genVec_extend(genVec* vec, const u8* arr, u64 n);
+
+// Append n elements, MOVE semantics: the vec takes over the element bytes
+// (no copy_fn) — the caller must not destroy the elements afterwards, but
+// still owns and frees arr itself.
+void genVec_extend_move(genVec* vec, u8* arr, u64 n);
+
+// Append copies of every element of src (same data_size). dest == src doubles it.
+void genVec_append_vec(genVec* dest, const genVec* src);
+
+// Set size to n. Shrinking calls del_fn on the dropped elements (capacity is
+// kept). Growing fills the new slots with copies of fill, or zero bytes if
+// fill is NULL.
+void genVec_resize(genVec* vec, u64 n, const u8* fill);
+
 // Remove element from end. If popped is provided, copies element before deletion.
 // Note: del_fn is called regardless to clean up owned resources.
 void genVec_pop(genVec* vec, u8* popped);
@@ -169,13 +211,29 @@ u64 genVec_find(const genVec* vec, u8* elm, compare_fn cmp_fn);
 genVec* genVec_subarr(const genVec* vec, u64 start, u64 len);
 
 
+// Sorting and sorted merges
+// ===========================
+
+// Sort ascending by cmp_fn (NULL = memcmp). Elements move as raw bytes.
+void genVec_sort(genVec* vec, compare_fn cmp_fn);
+
+// Set operations on vectors sorted ascending by cmp_fn (NULL = memcmp)
+// with no duplicates. out gets copies, in order; its old elements are
+// destroyed and it must be a different vector from a and b. One linear
+// merge — intersect switches to galloping search when one side is more
+// than 16x the other.
+void genVec_sorted_union(genVec* out, const genVec* a, const genVec* b, compare_fn cmp_fn);
+void genVec_sorted_intersect(genVec* out, const genVec* a, const genVec* b, compare_fn cmp_fn);
+void genVec_sorted_difference(genVec* out, const genVec* a, const genVec* b, compare_fn cmp_fn);
+
+
 // Utility
 // ===========================
 
 // Print all elements using provided print function.
 void genVec_print(const genVec* vec, print_fn fn);
 
-// Deep copy src vector into dest.
+// Deep copy src vector into dest, with dest's allocator.
 // Note: cleans up dest (if already inited).
 void genVec_copy(genVec* dest, const genVec* src);
 
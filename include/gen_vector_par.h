@@ -0,0 +1,58 @@
+#ifndef GEN_VECTOR_PAR_H
+#define GEN_VECTOR_PAR_H
+
+#include "gen_vector.h"
+#include "thread_pool.h"
+
+
+/* Parallel genVec algorithms
+  - the vector is cut into contiguous chunks, one task per chunk, and the
+    tasks run on a thread_pool (several chunks per thread, so a slow chunk
+    doesn't hold the rest up); pool = NULL runs on the calling thread
+  - a chunk is at least GENVEC_PAR_MIN_CHUNK elements, smaller vectors
+    are not split at all
+  - callbacks run on several threads at once: each call may write its own
+    element / output slot and read shared state through ctx, anything else
+    needs its own synchronization
+  - the vectors must not be resized by anyone while an algorithm runs
+*/
+
+
+#ifndef GENVEC_PAR_MIN_CHUNK
+    #define GENVEC_PAR_MIN_CHUNK 4096
+#endif
+
+typedef void (*vec_elm_fn)(u8* elm, void* ctx);
+typedef void (*vec_map_fn)(u8* out, const u8* in, void* ctx);
+typedef void (*vec_fold_fn)(u8* acc, const u8* elm, void* ctx);
+
+
+// fn(elm, ctx) on every element, in place.
+void genVec_par_for_each(thread_pool* pool, genVec* vec, vec_elm_fn fn, void* ctx);
+
+// dest[i] = fn(src[i]) for every element of src. dest is cleared first
+// (del_fn on its elements) and ends with src->size elements; its data_size
+// and ops may differ from src's. The out slots are raw memory, fn builds
+// each one in place (as with genVec_emplace_back). dest != src.
+void genVec_par_map(thread_pool* pool, genVec* dest, const genVec* src, vec_map_fn fn, void* ctx);
+
+// Fold the vector into acc, acc_size bytes of plain data. On entry acc holds
+// the identity (0 for a sum): every chunk starts from a copy of it and folds
+// its elements in with fold(acc, elm); the chunk results are then merged in
+// order with combine(acc, other). combine = NULL uses fold, which then needs
+// acc_size == data_size. fold and combine must be associative. The chunks
+// depend on the vector's size alone (at most 64 of them), so a result that
+// rounds, like a float sum, is the same for every pool and for pool = NULL.
+void genVec_par_reduce(thread_pool* pool, const genVec* vec, u8* acc, u32 acc_size,
+                       vec_fold_fn fold, vec_fold_fn combine, void* ctx);
+
+// Sort with cmp_fn (NULL = memcmp), like genVec_sort: each thread sorts a
+// chunk, then pairs of sorted runs are merged with every thread on every
+// round (a merge is split at output positions found by binary search).
+// Elements are relocated by their bytes like genVec_sort does, so owned
+// types keep their resources and no copy_fn / del_fn runs. Needs a temporary
+// buffer the size of the data. Not stable.
+void genVec_par_sort(thread_pool* pool, genVec* vec, compare_fn cmp_fn);
+
+
+#endif // GEN_VECTOR_PAR_H
@@ -2,6 +2,8 @@
 #define HASHMAP_H
 
 #include "map_setup.h"
+#include "gen_vector.h"
+#include "arena.h"
 
 
 /* Generic Hashmap with Ownership Semantics
@@ -11,10 +13,44 @@
   - we actuall store psl + 1 as psl = 0 means empty bucket
   - Robin Hood Invarient: all keys that hash to i come before keys that hash to i + 1
   - vals store [val] inline
+  - insert shifts the displaced run right by one slot and builds the new
+    entry in place, so there is no staging/swap buffer
+  - optional hash cache: a 4th array holding the low 32 hash bits of each
+    entry, parallel to psls (see hashmap_set_hash_cache)
+  - optional incremental resize: growth allocates the bigger table and
+    later puts/dels move a few old buckets each, so no single call pays
+    for rehashing the whole map (see hashmap_set_incremental)
+  - optional arena storage: struct and tables come from an Arena and are
+    reclaimed by arena_clear, not by destroy (see hashmap_create_arena)
+  - seeded: every map mixes its own random seed into hash_fn results, and a
+    psl that reaches RH_PSL_LIMIT makes the next put rehash the map under a
+    fresh seed (see hashmap_set_seed); a run of keys whose hash_fn outputs
+    are equal is kept instead, up to 254 such keys
+  - per-map load factor: grows at 0.75 by default, up to 0.95 for maps that
+    trade probe length for memory (see hashmap_set_max_load)
+  - shrinks only when asked: hashmap_shrink_to_fit, or automatically once
+    dels drop it below a min load (see hashmap_set_min_load)
+  - POD maps can be saved to a file and mapped back without a rebuild
+    (see hashmap_save / hashmap_load_mmap)
 */
 
 
-typedef struct {
+// Default for new maps: 1 = every map starts with the hash cache on.
+// Can be overridden per build (-DHASHMAP_HASH_CACHE=1) or per map at runtime.
+#ifndef HASHMAP_HASH_CACHE
+    #define HASHMAP_HASH_CACHE 0
+#endif
+
+// Default for new maps: 1 = every map resizes incrementally.
+// Can be overridden per build (-DHASHMAP_INCREMENTAL=1) or per map at runtime.
+#ifndef HASHMAP_INCREMENTAL
+    #define HASHMAP_INCREMENTAL 0
+#endif
+
+
+typedef struct hashmap hashmap;
+
+struct hashmap {
     u8*            keys; 
     u8*            psls;
     u8*            vals;
@@ -22,16 +58,50 @@ typedef struct {
     u64            capacity;
     u32            key_size;
     u32            val_size;
-    u8*            scratch;  // key_size + val_size bytes + alignment - temp buffer for robin hood swaps
+    u32*           hashes;   // low 32 hash bits per bucket, NULL when the cache is off
     custom_hash_fn hash_fn;
     compare_fn     cmp_fn;
+    u64            seed;     // mixed into every hash_fn result, 0 = unseeded
+    u8             max_load; // grow once size reaches max_load % of capacity
+    u8             min_load; // shrink once a del drops below min_load %, 0 = never
+
+    b8 psl_overflow; // a psl reached psl_limit, the map needs a new seed
+    b8 defer_reseed; // leave psl_overflow to the owner (hashmap_concurrent)
+    u8 psl_limit;    // RH_PSL_LIMIT, or RH_PSL_MAX once equal hashes flood a run
 
     // Shared ops vtables for keys and values.
     // Pass NULL for POD types (int, float, flat structs).
     // For types with heap resources define one static ops per type:
     const container_ops* key_ops;
     const container_ops* val_ops;
-} hashmap;
+
+    Arena* arena; // table storage comes from here when set (never freed by the map)
+
+    // hashmap_load_mmap: the tables live in a private mapping of the file
+    u8* snapshot;     // base of the mapping, NULL for every other map
+    u64 snapshot_len;
+    b8  read_only;    // mapping still PROT_READ, see hashmap_promote
+
+    // Incremental resize: the previous table while it is being drained.
+    // size counts the entries of both tables; capacity is the new table's.
+    hashmap* old;           // NULL when no resize is in flight
+    u64      migrate_start; // first old bucket moved (an empty one)
+    u64      migrated;      // old buckets moved so far, from migrate_start on
+    b8       incremental;
+
+    map_counters counters; // lookup/resize counts, only updated with WC_MAP_STATS
+};
+
+
+// Cursor over the entries of a hashmap (see hashmap_iter_begin).
+// Plain value: copy it to save a position, resume from it later.
+typedef struct {
+    const hashmap* map;
+    const hashmap* table; // table being walked: map, then map->old; NULL when done
+    u64            idx;   // next bucket to test in table
+    u8*            key;   // current entry, set by hashmap_iter_next
+    u8*            val;
+} hashmap_iter;
 
 
 // Safely extract callbacks — always NULL-safe on ops itself.
@@ -39,20 +109,21 @@ typedef struct {
 #define MAP_MOVE(ops) ((ops) ? (ops)->move_fn : NULL)
 #define MAP_DEL(ops)  ((ops) ? (ops)->del_fn  : NULL)
 
-/* TODO: 
-    reserve one extra slot at the end of the key/val arrays that never holds a real entry.
-    During insert, you keep the “current” key/value in registers or local variables
-    and only write them into the array when the final empty slot is found.
-    This requires a small rewrite of map_insert, but it saves two memcpy calls per eviction
-    and eliminates scratch
-*/
-
 // Create a new hashmap.
 // hash_fn and cmp_fn default to fnv1a_hash / default_compare if NULL.
 // key_ops / val_ops: pass NULL for POD types.
 hashmap* hashmap_create(u32 key_size, u32 val_size, custom_hash_fn hash_fn, compare_fn cmp_fn,
                         const container_ops* key_ops, const container_ops* val_ops);
 
+// Create a hashmap whose struct and table storage come from arena.
+// Resizes take fresh arena memory and abandon the old arrays, so reserve
+// up front when the size is known. destroy frees nothing — it only runs
+// del_fn on owned keys/vals (a no-op for POD maps); arena_clear or
+// arena_release reclaims everything. The map must not outlive the arena.
+hashmap* hashmap_create_arena(Arena* arena, u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                              compare_fn cmp_fn, const container_ops* key_ops,
+                              const container_ops* val_ops);
+
 void hashmap_destroy(hashmap* map);
 
 // Insert or update — COPY semantics.
@@ -82,6 +153,83 @@ b8 hashmap_del(hashmap* map, const u8* key, u8* out);
 // Check if key exists.
 b8 hashmap_has(const hashmap* map, const u8* key);
 
+// Entry API: value slot of key, inserting the key first if it is absent.
+// One probe either way — for "find or default, then mutate" patterns:
+//   (*(int*)hashmap_entry(counts, (u8*)&word, NULL))++;
+// On insert the key is copied (copy_fn or memcpy), the value bytes are
+// zeroed and *inserted is set to 1; construct owned values in place then.
+// inserted may be NULL. The pointer is valid until the next put/del.
+u8* hashmap_entry(hashmap* map, const u8* key, b8* inserted);
+
+// Same as hashmap_entry, but the key is MOVED in on insert (*key nulled).
+// If the key already exists the incoming one is destroyed and freed
+// (*key nulled too), as with hashmap_put_move. Requires key move_fn.
+u8* hashmap_entry_move(hashmap* map, u8** key, b8* inserted);
+
+// Precomputed hash: one hash serves a has-then-put or get-then-del sequence.
+// hash must be hashmap_hash(map, key) for this map; any other value makes
+// the key unfindable or duplicates it. A reseed (hashmap_set_seed, or the
+// automatic one after a psl overflow) changes every hash — don't keep
+// precomputed hashes across puts.
+u64 hashmap_hash(const hashmap* map, const u8* key);
+
+b8  hashmap_put_with_hash(hashmap* map, const u8* key, const u8* val, u64 hash);
+b8  hashmap_get_with_hash(const hashmap* map, const u8* key, u8* val, u64 hash);
+u8* hashmap_get_ptr_with_hash(hashmap* map, const u8* key, u64 hash);
+b8  hashmap_del_with_hash(hashmap* map, const u8* key, u8* out, u64 hash);
+b8  hashmap_has_with_hash(const hashmap* map, const u8* key, u64 hash);
+
+// Batch lookups/inserts over packed arrays of n keys (and n values).
+// Hashes and prefetches a chunk of keys before probing, so the cache misses
+// of independent lookups overlap. Same ownership rules as the single-key calls.
+
+// Copies each found value into vals[i]; found (optional) gets 1/0 per key.
+// Returns the number of keys found.
+u64 hashmap_get_many(const hashmap* map, const u8* keys, u64 n, u8* vals, b8* found);
+
+// found (optional) gets 1/0 per key. Returns the number of keys present.
+u64 hashmap_has_many(const hashmap* map, const u8* keys, u64 n, b8* found);
+
+// Insert or update, COPY semantics. Returns the number of new keys.
+u64 hashmap_put_many(hashmap* map, const u8* keys, const u8* vals, u64 n);
+
+// Insert or update, MOVE semantics: the map takes over the element bytes.
+// Don't destroy the elements afterwards; the arrays themselves stay yours.
+// Returns the number of new keys.
+u64 hashmap_put_many_move(hashmap* map, u8* keys, u8* vals, u64 n);
+
+// Build a map from two genVecs of equal size: keys[i] -> vals[i].
+// The table is sized once and entries go in by MOVE: the map takes the
+// element bytes and both vecs are left empty (capacity kept). Key and value
+// ops come from the vecs. A repeated key keeps its last value.
+// sort: insert in home-bucket order so the table is written front to back
+// (pays off for large builds).
+hashmap* hashmap_from_vecs(genVec* keys, genVec* vals, custom_hash_fn hash_fn, compare_fn cmp_fn,
+                           b8 sort);
+
+// Grow once so that n entries in total fit without another resize.
+// Never shrinks (see hashmap_shrink_to_fit). Finishes an incremental resize in flight.
+void hashmap_reserve(hashmap* map, u64 n);
+
+// Iterate over all entries in bucket order (no particular key order):
+//   hashmap_iter it = hashmap_iter_begin(map);
+//   while (hashmap_iter_next(&it)) { use(it.key, it.val); }
+// Empty buckets are skipped 8 at a time. The cursor is just a bucket index:
+// it can be stopped, copied and resumed, and stays valid across gets and
+// writes through it.val. put/del may move entries, so don't resume across them.
+// Keys are read-only; values may be modified in place.
+hashmap_iter hashmap_iter_begin(const hashmap* map);
+
+// Advance to the next entry. Returns 1 and sets it->key / it->val, or
+// returns 0 once every entry has been visited.
+b8 hashmap_iter_next(hashmap_iter* it);
+
+// All keys / all values as a new genVec sized to hashmap_size, filled in one
+// pass. Elements are deep copies (the vec gets the map's key_ops / val_ops);
+// the caller owns the vec. keys[i] and values[i] belong to the same entry.
+genVec* hashmap_keys(const hashmap* map);
+genVec* hashmap_values(const hashmap* map);
+
 // Print all key-value pairs.
 void hashmap_print(const hashmap* map, print_fn key_print, print_fn val_print);
 
@@ -92,6 +240,75 @@ void hashmap_clear(hashmap* map);
 // dest should be pre-inited, it will be freed
 void hashmap_copy(hashmap* dest, const hashmap* src);
 
+// Cache the low 32 hash bits of every entry next to its psl.
+// Probes skip cmp_fn on fingerprint mismatch and resize never rehashes keys.
+// Worth it for expensive hash/compare (String keys); costs 4 bytes per bucket.
+void hashmap_set_hash_cache(hashmap* map, b8 enable);
+
+// Spread each resize over the following operations instead of rehashing
+// everything inside one put. Both tables coexist until the old one drains;
+// every put/del moves a bounded number of old buckets. Gets never mutate,
+// they just also probe the old table. Disabling finishes any pending resize.
+void hashmap_set_incremental(hashmap* map, b8 enable);
+
+// Rehash the map under seed. New maps get a random one (WC_MAP_SEEDED);
+// 0 turns seeding off: buckets come straight from hash_fn, which makes
+// layouts reproducible but lets crafted keys pile into one run. An overflow
+// reseed (see above) gives even an unseeded map a random seed.
+void hashmap_set_seed(hashmap* map, u64 seed);
+
+// Rehash the map under a fresh random seed.
+void hashmap_reseed(hashmap* map);
+
+// Load factor at which the map grows, in [LOAD_FACTOR_MIN, LOAD_FACTOR_MAX]
+// (default LOAD_FACTOR_GROW, 0.75). 0.9 keeps a big map in half the buckets
+// more often, at the price of longer probes, misses especially. Grows at
+// once if the map is already past the new limit; never shrinks.
+void hashmap_set_max_load(hashmap* map, double load);
+
+// Shrink automatically: a del that leaves the map below load shrinks it
+// until it is at most half of max_load full, so it has to double its size
+// again before it grows back. load is at most max_load / 4 (hysteresis);
+// 0 turns it off (the default). Checked on del only, and not while an
+// incremental resize is in flight.
+// Arena maps leave every old table behind in the arena — leave it off there.
+void hashmap_set_min_load(hashmap* map, double load);
+
+// Shrink to the smallest capacity that holds the current entries below
+// max_load. Finishes an incremental resize in flight. Keeps the seed.
+void hashmap_shrink_to_fit(hashmap* map);
+
+// Snapshot of the table: load factor, max/mean psl and a psl histogram
+// (both tables while an incremental resize is in flight), bytes held, and
+// the counters since create / hashmap_stats_reset. A healthy map keeps
+// mean_psl around 1 or less; a high max_psl or a fat histogram tail at
+// normal load points to a weak hash_fn. The scan is O(capacity).
+// Counters are compiled in with -DWC_MAP_STATS=1 and read 0 otherwise.
+void hashmap_stats(const hashmap* map, map_stats* out);
+
+// Zero the counters (the table shape is not affected).
+void hashmap_stats_reset(hashmap* map);
+
+// Snapshots (POD keys and values only, see map_snapshot.h for the format).
+// Save writes the tables as they are, so a load is an mmap: no rehash, and
+// pages are read in as lookups touch them. Returns 1, or 0 with
+// wc_errno = WC_ERR_IO. Finishes an incremental resize in flight.
+b8 hashmap_save(hashmap* map, const char* path);
+
+// Map a snapshot back. hash_fn must be the one it was saved with (checked),
+// cmp_fn as for hashmap_create; NULL picks the same defaults. The map starts
+// read-only: gets, iteration and copies work, puts and dels are fatal (and
+// writes through hashmap_get_ptr fault) until hashmap_promote. Returns NULL
+// with wc_errno = WC_ERR_IO if the file is missing, not a valid hashmap
+// snapshot, or was saved with another hash_fn. hashmap_destroy unmaps the
+// file. Snapshot maps don't resize incrementally.
+hashmap* hashmap_load_mmap(const char* path, custom_hash_fn hash_fn, compare_fn cmp_fn);
+
+// Make a loaded map writable. Copy-on-write per page: only the pages a
+// put/del touches are copied, the file never changes. A no-op on maps
+// that are already writable.
+void hashmap_promote(hashmap* map);
+
 
 static inline u64 hashmap_size(const hashmap* map)
 {
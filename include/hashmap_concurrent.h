@@ -0,0 +1,118 @@
+#ifndef HASHMAP_CONCURRENT_H
+#define HASHMAP_CONCURRENT_H
+
+#include "hashmap.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+
+/* Thread-safe Hashmap (sharded)
+  - N independent shards, each a regular Robin Hood hashmap
+  - a key's shard comes from the high hash bits; the shard's hashmap uses
+    the low bits, so the two never correlate
+  - every shard has a reader-writer lock plus a sequence counter (seqlock)
+    that writers bump to odd before mutating and back to even after
+  - POD keys and values (key_ops == val_ops == NULL, keys up to
+    CMAP_OPTIMISTIC_KEY_MAX bytes) get lock-free reads: probe without the
+    lock through relaxed atomic loads, copy the value out, retry if the
+    sequence moved. Writers still store plain bytes under the write lock,
+    so ThreadSanitizer flags the pair; build with
+    -DHASHMAP_CONCURRENT_OPTIMISTIC=0 for TSan runs
+  - for lock-free reads a shard never resizes in place: growth builds a
+    bigger hashmap and swaps the pointer; the old one is retired and kept
+    until hashmap_concurrent_reclaim or destroy. Growth alone retires under
+    1x the live tables; a psl overflow reseeds the same way, by copy, and
+    retires a full same-size table each time
+  - hashes are seeded like hashmap's: shard choice uses the map's seed,
+    each shard's hashmap its own
+  - same container_ops ownership rules as hashmap; there is no get_ptr —
+    a pointer into a shard would not outlive the lock
+*/
+
+
+// Default shard count when 0 is passed to create (power of 2)
+#ifndef HASHMAP_CONCURRENT_SHARDS
+    #define HASHMAP_CONCURRENT_SHARDS 64
+#endif
+
+// Set to 0 to always take the read lock, even for POD maps
+#ifndef HASHMAP_CONCURRENT_OPTIMISTIC
+    #define HASHMAP_CONCURRENT_OPTIMISTIC 1
+#endif
+
+// Longest key a lock-free probe copies onto its stack; longer keys lock
+#define CMAP_OPTIMISTIC_KEY_MAX 64
+
+
+typedef struct cmap_retired cmap_retired;
+
+typedef struct {
+    _Alignas(64) pthread_rwlock_t lock;
+    _Atomic u32         seq;     // odd while a writer is inside the shard
+    _Atomic(hashmap*)   map;
+    cmap_retired*       retired; // maps swapped out by growth (lock-free mode)
+} cmap_shard;
+
+typedef struct {
+    cmap_shard*    shards;
+    u32            shard_count; // power of 2, <= 65536
+    u32            key_size;
+    u32            val_size;
+    b8             optimistic;  // lock-free reads on (POD keys and vals)
+    custom_hash_fn hash_fn;
+    compare_fn     cmp_fn;
+    u64            seed;        // picks the shard; each shard's hashmap has its own
+
+    const container_ops* key_ops;
+    const container_ops* val_ops;
+} hashmap_concurrent;
+
+
+// Create a new concurrent hashmap.
+// shard_count: power of 2 (0 = HASHMAP_CONCURRENT_SHARDS). More shards, less contention.
+// Remaining args as hashmap_create.
+hashmap_concurrent* hashmap_concurrent_create(u32 shard_count, u32 key_size, u32 val_size,
+                                              custom_hash_fn hash_fn, compare_fn cmp_fn,
+                                              const container_ops* key_ops,
+                                              const container_ops* val_ops);
+
+// Not thread-safe: no other thread may use the map during or after destroy.
+void hashmap_concurrent_destroy(hashmap_concurrent* map);
+
+// Insert or update — COPY semantics. Returns 1 if key existed, 0 if new.
+b8 hashmap_concurrent_put(hashmap_concurrent* map, const u8* key, const u8* val);
+
+// Insert or update — MOVE semantics (see hashmap_put_move).
+b8 hashmap_concurrent_put_move(hashmap_concurrent* map, u8** key, u8** val);
+
+// Mixed: key copied, val moved.
+b8 hashmap_concurrent_put_val_move(hashmap_concurrent* map, const u8* key, u8** val);
+
+// Copy the value into val. Returns 1 if found, 0 if not.
+// Lock-free for POD maps.
+b8 hashmap_concurrent_get(const hashmap_concurrent* map, const u8* key, u8* val);
+
+// Check if key exists. Lock-free for POD maps.
+b8 hashmap_concurrent_has(const hashmap_concurrent* map, const u8* key);
+
+// Delete key. If out is provided, the value is moved into it.
+// Returns 1 if found and deleted, 0 if not found.
+b8 hashmap_concurrent_del(hashmap_concurrent* map, const u8* key, u8* out);
+
+// Remove all elements, shard by shard (not one atomic snapshot).
+void hashmap_concurrent_clear(hashmap_concurrent* map);
+
+// Growth load of every shard (see hashmap_set_max_load), set shard by shard.
+void hashmap_concurrent_set_max_load(hashmap_concurrent* map, double load);
+
+// Sum of shard sizes, read shard by shard — exact only when no writer runs.
+u64 hashmap_concurrent_size(const hashmap_concurrent* map);
+
+// Free the maps retired by lock-free growth and reseeds.
+// Not thread-safe: lock-free readers may still be inside a retired map, so
+// no other thread may use the map during the call.
+void hashmap_concurrent_reclaim(hashmap_concurrent* map);
+
+
+#endif // HASHMAP_CONCURRENT_H
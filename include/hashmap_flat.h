@@ -0,0 +1,119 @@
+#ifndef HASHMAP_FLAT_H
+#define HASHMAP_FLAT_H
+
+#include "map_setup.h"
+
+
+/* Generic Flat Hashmap with Ownership Semantics
+  - Swiss-table style open addressing, sibling of hashmap (same callbacks)
+  - 3 arrays: ctrl, keys and vals
+  - ctrl: one byte per bucket
+      0x80           empty
+      0xFE           deleted (tombstone)
+      0x00 .. 0x7F   full, holds the low 7 hash bits (h2)
+  - the upper hash bits (h1) pick the start of the probe
+  - probing scans 16 ctrl bytes at once (SSE2, scalar fallback) and only
+    calls cmp_fn on buckets whose h2 matches
+  - the first 16 ctrl bytes are mirrored past the end, so a group load
+    never has to wrap
+  - max load is 7/8; deletes leave tombstones only when a probe could
+    have passed through the bucket
+  - prefer it for read-heavy lookup tables; hashmap (Robin Hood) stays
+    the general default
+*/
+
+
+// Define to force the portable scalar group scan (no SSE2 intrinsics)
+// #define HASHMAP_FLAT_NO_SIMD
+
+
+typedef struct {
+    u8*            ctrl;        // capacity + HASHMAP_FLAT_GROUP bytes
+    u8*            keys;
+    u8*            vals;
+    u64            size;
+    u64            capacity;
+    u64            growth_left; // inserts left before rehash (tombstones count as used)
+    u32            key_size;
+    u32            val_size;
+    custom_hash_fn hash_fn;
+    compare_fn     cmp_fn;
+
+    // Pass NULL for POD types (same as hashmap)
+    const container_ops* key_ops;
+    const container_ops* val_ops;
+} hashmap_flat;
+
+
+#define HASHMAP_FLAT_GROUP 16
+
+// Safely extract callbacks — always NULL-safe on ops itself.
+#define FLAT_COPY(ops) ((ops) ? (ops)->copy_fn : NULL)
+#define FLAT_MOVE(ops) ((ops) ? (ops)->move_fn : NULL)
+#define FLAT_DEL(ops)  ((ops) ? (ops)->del_fn  : NULL)
+
+
+// Create a new flat hashmap.
+// hash_fn and cmp_fn default to wyhash / default_compare if NULL.
+// key_ops / val_ops: pass NULL for POD types.
+hashmap_flat* hashmap_flat_create(u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                                  compare_fn cmp_fn, const container_ops* key_ops,
+                                  const container_ops* val_ops);
+
+void hashmap_flat_destroy(hashmap_flat* map);
+
+// Insert or update — COPY semantics.
+// Returns 1 if key existed (updated), 0 if new key inserted.
+b8 hashmap_flat_put(hashmap_flat* map, const u8* key, const u8* val);
+
+// Insert or update — MOVE semantics (key and val are u8**, both nulled).
+b8 hashmap_flat_put_move(hashmap_flat* map, u8** key, u8** val);
+
+// Mixed: key copied, val moved.
+b8 hashmap_flat_put_val_move(hashmap_flat* map, const u8* key, u8** val);
+
+// Mixed: key moved, val copied.
+b8 hashmap_flat_put_key_move(hashmap_flat* map, u8** key, const u8* val);
+
+// Get value for key — copies into val. Returns 1 if found, 0 if not.
+b8 hashmap_flat_get(const hashmap_flat* map, const u8* key, u8* val);
+
+// Get pointer to value. Valid until the next put/del.
+u8* hashmap_flat_get_ptr(hashmap_flat* map, const u8* key);
+
+// Delete key. If out is provided, value is moved into it before deletion.
+// Returns 1 if found and deleted, 0 if not found.
+b8 hashmap_flat_del(hashmap_flat* map, const u8* key, u8* out);
+
+// Check if key exists.
+b8 hashmap_flat_has(const hashmap_flat* map, const u8* key);
+
+// Print all key-value pairs.
+void hashmap_flat_print(const hashmap_flat* map, print_fn key_print, print_fn val_print);
+
+// Remove all elements, keep capacity.
+void hashmap_flat_clear(hashmap_flat* map);
+
+// Deep copy src into dest
+// dest should be pre-inited, it will be freed
+void hashmap_flat_copy(hashmap_flat* dest, const hashmap_flat* src);
+
+
+static inline u64 hashmap_flat_size(const hashmap_flat* map)
+{
+    CHECK_FATAL(!map, "map is null");
+    return map->size;
+}
+static inline u64 hashmap_flat_capacity(const hashmap_flat* map)
+{
+    CHECK_FATAL(!map, "map is null");
+    return map->capacity;
+}
+static inline b8 hashmap_flat_empty(const hashmap_flat* map)
+{
+    CHECK_FATAL(!map, "map is null");
+    return map->size == 0;
+}
+
+
+#endif // HASHMAP_FLAT_H
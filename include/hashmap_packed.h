@@ -0,0 +1,113 @@
+#ifndef HASHMAP_PACKED_H
+#define HASHMAP_PACKED_H
+
+#include "map_setup.h"
+
+
+/* Generic Packed Hashmap with Ownership Semantics
+  - Robin Hood hashing, sibling of hashmap (same callbacks, same rules)
+  - 1 array of buckets instead of 3: each bucket is [psl | key | val]
+  - key and val are aligned inside the bucket (up to 8 bytes), the bucket
+    size is rounded up so every bucket keeps that alignment
+  - psl works as in hashmap: 0 = empty, stored as real psl + 1; unseeded,
+    so a psl that would pass 255 (a weak hash_fn) saturates there instead
+    of wrapping to empty
+  - a probe reads psl, key and val from the same bucket, so a hit costs one
+    cache line where hashmap touches three (psls, keys, vals)
+  - the price is density: padding in every bucket, and a probe that walks
+    past full buckets drags their keys and vals through the cache too, so
+    misses are slower than hashmap's (its psl array alone ends most misses)
+  - prefer it for hit-heavy lookups on small entries; hashmap stays the
+    default, and the only one with the optional features (hash cache,
+    incremental resize, arena, batch APIs)
+*/
+
+
+typedef struct {
+    u8*            buckets;  // capacity * stride bytes
+    u64            size;
+    u64            capacity;
+    u32            key_size;
+    u32            val_size;
+    u32            stride;   // bytes per bucket
+    u32            key_off;  // offset of the key inside a bucket
+    u32            val_off;  // offset of the val inside a bucket
+    custom_hash_fn hash_fn;
+    compare_fn     cmp_fn;
+
+    // Pass NULL for POD types (same as hashmap)
+    const container_ops* key_ops;
+    const container_ops* val_ops;
+} hashmap_packed;
+
+
+// Safely extract callbacks — always NULL-safe on ops itself.
+#define PACKED_COPY(ops) ((ops) ? (ops)->copy_fn : NULL)
+#define PACKED_MOVE(ops) ((ops) ? (ops)->move_fn : NULL)
+#define PACKED_DEL(ops)  ((ops) ? (ops)->del_fn  : NULL)
+
+
+// Create a new packed hashmap.
+// hash_fn and cmp_fn default to wyhash / default_compare if NULL.
+// key_ops / val_ops: pass NULL for POD types.
+hashmap_packed* hashmap_packed_create(u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                                      compare_fn cmp_fn, const container_ops* key_ops,
+                                      const container_ops* val_ops);
+
+void hashmap_packed_destroy(hashmap_packed* map);
+
+// Insert or update — COPY semantics.
+// Returns 1 if key existed (updated), 0 if new key inserted.
+b8 hashmap_packed_put(hashmap_packed* map, const u8* key, const u8* val);
+
+// Insert or update — MOVE semantics (key and val are u8**, both nulled).
+b8 hashmap_packed_put_move(hashmap_packed* map, u8** key, u8** val);
+
+// Mixed: key copied, val moved.
+b8 hashmap_packed_put_val_move(hashmap_packed* map, const u8* key, u8** val);
+
+// Mixed: key moved, val copied.
+b8 hashmap_packed_put_key_move(hashmap_packed* map, u8** key, const u8* val);
+
+// Get value for key — copies into val. Returns 1 if found, 0 if not.
+b8 hashmap_packed_get(const hashmap_packed* map, const u8* key, u8* val);
+
+// Get pointer to value. Valid until the next put/del.
+u8* hashmap_packed_get_ptr(hashmap_packed* map, const u8* key);
+
+// Delete key. If out is provided, value is moved into it before deletion.
+// Returns 1 if found and deleted, 0 if not found.
+b8 hashmap_packed_del(hashmap_packed* map, const u8* key, u8* out);
+
+// Check if key exists.
+b8 hashmap_packed_has(const hashmap_packed* map, const u8* key);
+
+// Print all key-value pairs.
+void hashmap_packed_print(const hashmap_packed* map, print_fn key_print, print_fn val_print);
+
+// Remove all elements, keep capacity.
+void hashmap_packed_clear(hashmap_packed* map);
+
+// Deep copy src into dest
+// dest should be pre-inited, it will be freed
+void hashmap_packed_copy(hashmap_packed* dest, const hashmap_packed* src);
+
+
+static inline u64 hashmap_packed_size(const hashmap_packed* map)
+{
+    CHECK_FATAL(!map, "map is null");
+    return map->size;
+}
+static inline u64 hashmap_packed_capacity(const hashmap_packed* map)
+{
+    CHECK_FATAL(!map, "map is null");
+    return map->capacity;
+}
+static inline b8 hashmap_packed_empty(const hashmap_packed* map)
+{
+    CHECK_FATAL(!map, "map is null");
+    return map->size == 0;
+}
+
+
+#endif // HASHMAP_PACKED_H
@@ -2,6 +2,8 @@
 #define HASHSET_H
 
 #include "map_setup.h"
+#include "gen_vector.h"
+#include "arena.h"
 
 
 /* Generic Hashset with Ownership Semantics
@@ -11,6 +13,13 @@
   - we actually store psl + 1 as psl = 0 means empty bucket
   - Robin Hood Invariant: all elms that hash to i come before elms that hash to i + 1
   - elms stored inline
+  - insert shifts the displaced run right and builds the elm in place
+  - optional arena storage (see hashset_create_arena)
+  - seeded like hashmap: a per-set random seed is mixed into hash_fn
+    results, and a psl overflow rehashes under a new one
+  - set algebra walks the smaller set and probes the other in batches:
+    a chunk of elms is hashed and prefetched before any of them is probed
+  - POD sets can be saved and mapped back, as hashmap (hashset_save)
 */
 
 
@@ -20,13 +29,26 @@ typedef struct {
     u64            size;
     u64            capacity;
     u32            elm_size;
-    u8*            scratch;  // 2 * elm_size bytes — stage (first half) + RH swap (second half)
     custom_hash_fn hash_fn;
     compare_fn     cmp_fn;
+    u64            seed;         // mixed into every hash_fn result, 0 = unseeded
+    u8             max_load;     // grow once size reaches max_load % of capacity
+    u8             min_load;     // shrink once a remove drops below min_load %, 0 = never
+    b8             psl_overflow; // a psl reached psl_limit, rehash on the next insert
+    u8             psl_limit;    // RH_PSL_LIMIT, or RH_PSL_MAX once equal hashes flood a run
 
     // Shared ops vtable for elements.
     // Pass NULL for POD types (int, float, flat structs).
     const container_ops* ops;
+
+    Arena* arena; // table storage comes from here when set (never freed by the set)
+
+    // hashset_load_mmap: the tables live in a private mapping of the file
+    u8* snapshot;     // base of the mapping, NULL for every other set
+    u64 snapshot_len;
+    b8  read_only;    // mapping still PROT_READ, see hashset_promote
+
+    map_counters counters; // lookup/resize counts, only updated with WC_MAP_STATS
 } hashset;
 
 
@@ -42,6 +64,12 @@ typedef struct {
 hashset* hashset_create(u32 elm_size, custom_hash_fn hash_fn, compare_fn cmp_fn,
                         const container_ops* ops);
 
+// Create a hashset whose struct and tables come from arena.
+// Resizes abandon the old arrays in the arena. destroy frees nothing — it
+// only runs del_fn on owned elements; arena_clear reclaims everything.
+hashset* hashset_create_arena(Arena* arena, u32 elm_size, custom_hash_fn hash_fn,
+                              compare_fn cmp_fn, const container_ops* ops);
+
 void hashset_destroy(hashset* set);
 
 // Insert element — COPY semantics.
@@ -58,6 +86,14 @@ b8 hashset_has(const hashset* set, const u8* elm);
 // Returns 1 if found and removed, 0 if not found.
 b8 hashset_remove(hashset* set, const u8* elm);
 
+// Precomputed hash: hash must be hashset_hash(set, elm) for this set; any
+// other value breaks lookups. A reseed changes every hash (see hashmap_hash).
+u64 hashset_hash(const hashset* set, const u8* elm);
+
+b8 hashset_insert_with_hash(hashset* set, const u8* elm, u64 hash);
+b8 hashset_has_with_hash(const hashset* set, const u8* elm, u64 hash);
+b8 hashset_remove_with_hash(hashset* set, const u8* elm, u64 hash);
+
 // Print all elements.
 void hashset_print(const hashset* set, print_fn print);
 
@@ -68,6 +104,60 @@ void hashset_clear(hashset* set);
 // dest should be pre-inited
 void hashset_copy(hashset* dest, const hashset* src);
 
+// Rehash under seed (0 = unseeded), as hashmap_set_seed.
+void hashset_set_seed(hashset* set, u64 seed);
+
+// Rehash under a fresh random seed.
+void hashset_reseed(hashset* set);
+
+// Growth load factor, as hashmap_set_max_load.
+void hashset_set_max_load(hashset* set, double load);
+
+// Automatic shrink on remove, as hashmap_set_min_load (0 = off, the default).
+void hashset_set_min_load(hashset* set, double load);
+
+// Shrink to the smallest capacity that holds the elements below max_load.
+void hashset_shrink_to_fit(hashset* set);
+
+// Set algebra. All sets involved must hold the same elm type with the same
+// hash_fn / cmp_fn / ops. Elements go in by COPY.
+// Each pass walks the smaller input and probes the larger one in batches.
+
+// out = a | b, a & b, a - b. out must be a different set from a and b;
+// its old contents are destroyed. union and difference may start from a
+// copy of one input (out then takes that input's seed and load settings).
+void hashset_union(hashset* out, const hashset* a, const hashset* b);
+void hashset_intersect(hashset* out, const hashset* a, const hashset* b);
+void hashset_difference(hashset* out, const hashset* a, const hashset* b);
+
+// In place: set |= other, set &= other, set -= other.
+// Removals compact the table in one pass over it, without rehashing.
+void hashset_union_with(hashset* set, const hashset* other);
+void hashset_intersect_with(hashset* set, const hashset* other);
+void hashset_difference_with(hashset* set, const hashset* other);
+
+// |a & b| without building it.
+u64 hashset_intersect_count(const hashset* a, const hashset* b);
+
+// The elements as a new genVec, deep copies sorted ascending by cmp_fn
+// (NULL = byte order). Feeds genVec_sorted_union and friends, the merge
+// fallback for POD sets that are built once and intersected many times.
+genVec* hashset_sorted(const hashset* set, compare_fn cmp_fn);
+
+// Table shape and counters, as hashmap_stats (map_stats is shared).
+// Counters need -DWC_MAP_STATS=1 and read 0 otherwise.
+void hashset_stats(const hashset* set, map_stats* out);
+
+// Zero the counters.
+void hashset_stats_reset(hashset* set);
+
+// Snapshots, as hashmap_save / hashmap_load_mmap / hashmap_promote.
+// POD elms only. A loaded set answers lookups straight away; inserts and
+// removes are fatal until hashset_promote.
+b8       hashset_save(const hashset* set, const char* path);
+hashset* hashset_load_mmap(const char* path, custom_hash_fn hash_fn, compare_fn cmp_fn);
+void     hashset_promote(hashset* set);
+
 
 static inline u64 hashset_size(const hashset* set)
 {
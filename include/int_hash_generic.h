@@ -0,0 +1,514 @@
+#ifndef INT_HASH_GENERIC_H
+#define INT_HASH_GENERIC_H
+
+#include "map_setup.h"
+
+
+/* Integer Hashset / Hashmap Specializations
+  - macro-generated per key type, same idea as INSTANTIATE_MATRIX
+  - for integer keys (u32, u64, int, ...) where hashset/hashmap pay an
+    indirect hash_fn call, an indirect cmp_fn call and a memcmp per probe:
+    here the hash is an inline multiply-mix and the compare is ==
+  - Robin Hood hashing with backward-shift deletion, like hashset, but no
+    psl array: a key's probe distance is recomputed from its hash
+  - key 0 is the empty-slot sentinel, so a zeroed table is an empty table;
+    the key 0 itself is kept out of the table (has_zero / zero_val)
+  - seeded per set like hashset (see WC_MAP_SEEDED)
+  - values are plain types (no container_ops): copied in and out by =
+  - functions are static inline, so expand the macros in every .c file that
+    uses them; a type expanded in two files is two private copies
+*/
+
+
+// ============================================================================
+// SHARED HELPERS (type-agnostic)
+// ============================================================================
+
+#define INT_HASH_EMPTY 0
+
+// Bucket hash of an integer key. Always mixed, even unseeded: identity
+// hashing puts strided keys (multiples of the capacity) in one bucket.
+static inline u64 int_hash_mix(u64 key, u64 seed)
+{
+    return wymix(key ^ seed, 0x9e3779b97f4a7c15ULL);
+}
+
+// Probe distance of a key sitting at idx
+#define INT_HASH_DIST(idx, key, seed, mask) \
+    (((idx) - (int_hash_mix((u64)(key), (seed)) & (mask))) & (mask))
+
+#define INT_HASH_GROW_PCT MAP_LOAD_PCT(LOAD_FACTOR_GROW)
+
+
+// ============================================================================
+// INTEGER SET
+// ============================================================================
+
+#define INTSET_TYPE(T)                                               \
+    typedef struct {                                                 \
+        T*  keys;     /* capacity slots, INT_HASH_EMPTY = free */    \
+        u64 size;     /* includes the zero key */                    \
+        u64 capacity; /* power of 2 */                               \
+        u64 seed;                                                    \
+        b8  has_zero; /* key 0 can't live in the table */            \
+    } IntSet_##T
+
+
+// Robin Hood placement of a key known not to be in keys
+#define INTSET_PLACE(T)                                                             \
+    static inline void intset_place_##T(T* keys, u64 mask, u64 seed, T key)         \
+    {                                                                               \
+        u64 idx  = int_hash_mix((u64)key, seed) & mask;                             \
+        u64 dist = 0;                                                               \
+                                                                                    \
+        while (keys[idx] != INT_HASH_EMPTY) {                                       \
+            u64 cur_dist = INT_HASH_DIST(idx, keys[idx], seed, mask);               \
+            if (cur_dist < dist) { /* rich key gives up its slot */                 \
+                T tmp     = keys[idx];                                              \
+                keys[idx] = key;                                                    \
+                key       = tmp;                                                    \
+                dist      = cur_dist;                                               \
+            }                                                                       \
+            idx = (idx + 1) & mask;                                                 \
+            dist++;                                                                 \
+        }                                                                           \
+        keys[idx] = key;                                                            \
+    }
+
+// Slot holding key, or capacity if absent
+#define INTSET_FIND(T)                                                              \
+    static inline u64 intset_find_##T(const IntSet_##T* set, T key)                 \
+    {                                                                               \
+        u64 mask = set->capacity - 1;                                               \
+        u64 idx  = int_hash_mix((u64)key, set->seed) & mask;                        \
+        u64 dist = 0;                                                               \
+                                                                                    \
+        for (;;) {                                                                  \
+            T cur = set->keys[idx];                                                 \
+            if (cur == key) {                                                       \
+                return idx;                                                         \
+            }                                                                       \
+            if (cur == INT_HASH_EMPTY ||                                            \
+                INT_HASH_DIST(idx, cur, set->seed, mask) < dist) {                  \
+                return set->capacity; /* Robin Hood exit */                         \
+            }                                                                       \
+            idx = (idx + 1) & mask;                                                 \
+            dist++;                                                                 \
+        }                                                                           \
+    }
+
+#define INTSET_RESIZE(T)                                                            \
+    static inline void intset_resize_##T(IntSet_##T* set, u64 new_cap)              \
+    {                                                                               \
+        T* keys = (T*)calloc(new_cap, sizeof(T));                                   \
+        CHECK_FATAL(!keys, "intset keys calloc failed");                            \
+                                                                                    \
+        for (u64 i = 0; i < set->capacity; i++) {                                   \
+            if (set->keys[i] != INT_HASH_EMPTY) {                                   \
+                intset_place_##T(keys, new_cap - 1, set->seed, set->keys[i]);       \
+            }                                                                       \
+        }                                                                           \
+        free(set->keys);                                                            \
+        set->keys     = keys;                                                       \
+        set->capacity = new_cap;                                                    \
+    }
+
+#define INTSET_CREATE(T)                                                            \
+    static inline IntSet_##T* intset_create_##T(void)                               \
+    {                                                                               \
+        IntSet_##T* set = (IntSet_##T*)malloc(sizeof(IntSet_##T));                  \
+        CHECK_FATAL(!set, "intset malloc failed");                                  \
+        set->keys = (T*)calloc(HASHMAP_INIT_CAPACITY, sizeof(T));                   \
+        CHECK_FATAL(!set->keys, "intset keys calloc failed");                       \
+        set->size     = 0;                                                          \
+        set->capacity = HASHMAP_INIT_CAPACITY;                                      \
+        set->seed     = WC_MAP_SEEDED ? map_seed_random() : 0;                      \
+        set->has_zero = 0;                                                          \
+        return set;                                                                 \
+    }
+
+#define INTSET_DESTROY(T)                                                           \
+    static inline void intset_destroy_##T(IntSet_##T* set)                          \
+    {                                                                               \
+        CHECK_FATAL(!set, "set is null");                                           \
+        free(set->keys);                                                            \
+        free(set);                                                                  \
+    }
+
+// Ensure room for n keys without growing
+#define INTSET_RESERVE(T)                                                           \
+    static inline void intset_reserve_##T(IntSet_##T* set, u64 n)                   \
+    {                                                                               \
+        CHECK_FATAL(!set, "set is null");                                           \
+        u64 cap = map_capacity_for(n, set->capacity, INT_HASH_GROW_PCT);            \
+        if (cap != set->capacity) {                                                 \
+            intset_resize_##T(set, cap);                                            \
+        }                                                                           \
+    }
+
+// Returns 1 if key already existed, 0 if newly inserted
+#define INTSET_INSERT(T)                                                            \
+    static inline b8 intset_insert_##T(IntSet_##T* set, T key)                      \
+    {                                                                               \
+        CHECK_FATAL(!set, "set is null");                                           \
+        if (key == INT_HASH_EMPTY) {                                                \
+            b8 had = set->has_zero;                                                 \
+            set->has_zero = 1;                                                      \
+            set->size += !had;                                                      \
+            return had;                                                             \
+        }                                                                           \
+        if (intset_find_##T(set, key) != set->capacity) {                           \
+            return 1;                                                               \
+        }                                                                           \
+        if (map_load_reached(set->size + 1, set->capacity, INT_HASH_GROW_PCT)) {    \
+            intset_resize_##T(set, set->capacity * 2);                              \
+        }                                                                           \
+        intset_place_##T(set->keys, set->capacity - 1, set->seed, key);             \
+        set->size++;                                                                \
+        return 0;                                                                   \
+    }
+
+#define INTSET_HAS(T)                                                               \
+    static inline b8 intset_has_##T(const IntSet_##T* set, T key)                   \
+    {                                                                               \
+        CHECK_FATAL(!set, "set is null");                                           \
+        if (key == INT_HASH_EMPTY) {                                                \
+            return set->has_zero;                                                   \
+        }                                                                           \
+        return intset_find_##T(set, key) != set->capacity;                          \
+    }
+
+// Returns 1 if found and removed, 0 if not found
+#define INTSET_REMOVE(T)                                                            \
+    static inline b8 intset_remove_##T(IntSet_##T* set, T key)                      \
+    {                                                                               \
+        CHECK_FATAL(!set, "set is null");                                           \
+        if (key == INT_HASH_EMPTY) {                                                \
+            b8 had = set->has_zero;                                                 \
+            set->has_zero = 0;                                                      \
+            set->size -= had;                                                       \
+            return had;                                                             \
+        }                                                                           \
+        u64 idx = intset_find_##T(set, key);                                        \
+        if (idx == set->capacity) {                                                 \
+            return 0;                                                               \
+        }                                                                           \
+        /* backward shift: pull the run left until an empty or home slot */         \
+        u64 mask = set->capacity - 1;                                               \
+        for (;;) {                                                                  \
+            u64 next = (idx + 1) & mask;                                            \
+            T   cur  = set->keys[next];                                             \
+            if (cur == INT_HASH_EMPTY ||                                            \
+                INT_HASH_DIST(next, cur, set->seed, mask) == 0) {                   \
+                break;                                                              \
+            }                                                                       \
+            set->keys[idx] = cur;                                                   \
+            idx            = next;                                                  \
+        }                                                                           \
+        set->keys[idx] = INT_HASH_EMPTY;                                            \
+        set->size--;                                                                \
+        return 1;                                                                   \
+    }
+
+// Remove all keys, keep capacity
+#define INTSET_CLEAR(T)                                                             \
+    static inline void intset_clear_##T(IntSet_##T* set)                            \
+    {                                                                               \
+        CHECK_FATAL(!set, "set is null");                                           \
+        memset(set->keys, 0, set->capacity * sizeof(T));                            \
+        set->size     = 0;                                                          \
+        set->has_zero = 0;                                                          \
+    }
+
+#define INTSET_PRINT(T, fmt)                                                        \
+    static inline void intset_print_##T(const IntSet_##T* set)                      \
+    {                                                                               \
+        CHECK_FATAL(!set, "set is null");                                           \
+        printf("\t=========\n");                                                    \
+        printf("\tSize: %lu / Capacity: %lu\n", set->size, set->capacity);          \
+        printf("\t=========\n");                                                    \
+        if (set->has_zero) {                                                        \
+            printf("\t" fmt "\n", (T)0);                                            \
+        }                                                                           \
+        for (u64 i = 0; i < set->capacity; i++) {                                   \
+            if (set->keys[i] != INT_HASH_EMPTY) {                                   \
+                printf("\t" fmt "\n", set->keys[i]);                                \
+            }                                                                       \
+        }                                                                           \
+        printf("\t=========\n");                                                    \
+    }
+
+
+// ============================================================================
+// INTEGER MAP
+// ============================================================================
+
+#define INTMAP_TYPE(K, V)                                            \
+    typedef struct {                                                 \
+        K*  keys;     /* capacity slots, INT_HASH_EMPTY = free */    \
+        V*  vals;     /* parallel to keys */                         \
+        u64 size;     /* includes the zero key */                    \
+        u64 capacity; /* power of 2 */                               \
+        u64 seed;                                                    \
+        b8  has_zero; /* key 0 can't live in the table */            \
+        V   zero_val;                                                \
+    } IntMap_##K##_##V
+
+
+// Robin Hood placement of a key known not to be in keys
+#define INTMAP_PLACE(K, V)                                                          \
+    static inline void intmap_place_##K##_##V(K* keys, V* vals, u64 mask, u64 seed, \
+                                              K key, V val)                         \
+    {                                                                               \
+        u64 idx  = int_hash_mix((u64)key, seed) & mask;                             \
+        u64 dist = 0;                                                               \
+                                                                                    \
+        while (keys[idx] != INT_HASH_EMPTY) {                                       \
+            u64 cur_dist = INT_HASH_DIST(idx, keys[idx], seed, mask);               \
+            if (cur_dist < dist) { /* rich entry gives up its slot */               \
+                K tk      = keys[idx];                                              \
+                V tv      = vals[idx];                                              \
+                keys[idx] = key;                                                    \
+                vals[idx] = val;                                                    \
+                key       = tk;                                                     \
+                val       = tv;                                                     \
+                dist      = cur_dist;                                               \
+            }                                                                       \
+            idx = (idx + 1) & mask;                                                 \
+            dist++;                                                                 \
+        }                                                                           \
+        keys[idx] = key;                                                            \
+        vals[idx] = val;                                                            \
+    }
+
+// Slot holding key, or capacity if absent
+#define INTMAP_FIND(K, V)                                                           \
+    static inline u64 intmap_find_##K##_##V(const IntMap_##K##_##V* map, K key)     \
+    {                                                                               \
+        u64 mask = map->capacity - 1;                                               \
+        u64 idx  = int_hash_mix((u64)key, map->seed) & mask;                        \
+        u64 dist = 0;                                                               \
+                                                                                    \
+        for (;;) {                                                                  \
+            K cur = map->keys[idx];                                                 \
+            if (cur == key) {                                                       \
+                return idx;                                                         \
+            }                                                                       \
+            if (cur == INT_HASH_EMPTY ||                                            \
+                INT_HASH_DIST(idx, cur, map->seed, mask) < dist) {                  \
+                return map->capacity; /* Robin Hood exit */                         \
+            }                                                                       \
+            idx = (idx + 1) & mask;                                                 \
+            dist++;                                                                 \
+        }                                                                           \
+    }
+
+#define INTMAP_RESIZE(K, V)                                                         \
+    static inline void intmap_resize_##K##_##V(IntMap_##K##_##V* map, u64 new_cap)  \
+    {                                                                               \
+        K* keys = (K*)calloc(new_cap, sizeof(K));                                   \
+        CHECK_FATAL(!keys, "intmap keys calloc failed");                            \
+        V* vals = (V*)malloc(new_cap * sizeof(V));                                  \
+        CHECK_FATAL(!vals, "intmap vals malloc failed");                            \
+                                                                                    \
+        for (u64 i = 0; i < map->capacity; i++) {                                   \
+            if (map->keys[i] != INT_HASH_EMPTY) {                                   \
+                intmap_place_##K##_##V(keys, vals, new_cap - 1, map->seed,          \
+                                       map->keys[i], map->vals[i]);                 \
+            }                                                                       \
+        }                                                                           \
+        free(map->keys);                                                            \
+        free(map->vals);                                                            \
+        map->keys     = keys;                                                       \
+        map->vals     = vals;                                                       \
+        map->capacity = new_cap;                                                    \
+    }
+
+#define INTMAP_CREATE(K, V)                                                         \
+    static inline IntMap_##K##_##V* intmap_create_##K##_##V(void)                   \
+    {                                                                               \
+        IntMap_##K##_##V* map = (IntMap_##K##_##V*)malloc(sizeof(IntMap_##K##_##V)); \
+        CHECK_FATAL(!map, "intmap malloc failed");                                  \
+        map->keys = (K*)calloc(HASHMAP_INIT_CAPACITY, sizeof(K));                   \
+        CHECK_FATAL(!map->keys, "intmap keys calloc failed");                       \
+        map->vals = (V*)malloc(HASHMAP_INIT_CAPACITY * sizeof(V));                  \
+        CHECK_FATAL(!map->vals, "intmap vals malloc failed");                       \
+        map->size     = 0;                                                          \
+        map->capacity = HASHMAP_INIT_CAPACITY;                                      \
+        map->seed     = WC_MAP_SEEDED ? map_seed_random() : 0;                      \
+        map->has_zero = 0;                                                          \
+        return map;                                                                 \
+    }
+
+#define INTMAP_DESTROY(K, V)                                                        \
+    static inline void intmap_destroy_##K##_##V(IntMap_##K##_##V* map)              \
+    {                                                                               \
+        CHECK_FATAL(!map, "map is null");                                           \
+        free(map->keys);                                                            \
+        free(map->vals);                                                            \
+        free(map);                                                                  \
+    }
+
+// Ensure room for n keys without growing
+#define INTMAP_RESERVE(K, V)                                                        \
+    static inline void intmap_reserve_##K##_##V(IntMap_##K##_##V* map, u64 n)       \
+    {                                                                               \
+        CHECK_FATAL(!map, "map is null");                                           \
+        u64 cap = map_capacity_for(n, map->capacity, INT_HASH_GROW_PCT);            \
+        if (cap != map->capacity) {                                                 \
+            intmap_resize_##K##_##V(map, cap);                                      \
+        }                                                                           \
+    }
+
+// Insert or update. Returns 1 if key existed (updated), 0 if new key inserted
+#define INTMAP_PUT(K, V)                                                            \
+    static inline b8 intmap_put_##K##_##V(IntMap_##K##_##V* map, K key, V val)      \
+    {                                                                               \
+        CHECK_FATAL(!map, "map is null");                                           \
+        if (key == INT_HASH_EMPTY) {                                                \
+            b8 had = map->has_zero;                                                 \
+            map->has_zero = 1;                                                      \
+            map->zero_val = val;                                                    \
+            map->size += !had;                                                      \
+            return had;                                                             \
+        }                                                                           \
+        u64 idx = intmap_find_##K##_##V(map, key);                                  \
+        if (idx != map->capacity) {                                                 \
+            map->vals[idx] = val;                                                   \
+            return 1;                                                               \
+        }                                                                           \
+        if (map_load_reached(map->size + 1, map->capacity, INT_HASH_GROW_PCT)) {    \
+            intmap_resize_##K##_##V(map, map->capacity * 2);                        \
+        }                                                                           \
+        intmap_place_##K##_##V(map->keys, map->vals, map->capacity - 1, map->seed,  \
+                               key, val);                                           \
+        map->size++;                                                                \
+        return 0;                                                                   \
+    }
+
+// Pointer to the value for key, NULL if absent. Valid until the next put/del
+#define INTMAP_GET_PTR(K, V)                                                        \
+    static inline V* intmap_get_ptr_##K##_##V(IntMap_##K##_##V* map, K key)         \
+    {                                                                               \
+        CHECK_FATAL(!map, "map is null");                                           \
+        if (key == INT_HASH_EMPTY) {                                                \
+            return map->has_zero ? &map->zero_val : NULL;                           \
+        }                                                                           \
+        u64 idx = intmap_find_##K##_##V(map, key);                                  \
+        return idx == map->capacity ? NULL : &map->vals[idx];                       \
+    }
+
+// Copy the value for key into out. Returns 1 if found, 0 if not
+#define INTMAP_GET(K, V)                                                            \
+    static inline b8 intmap_get_##K##_##V(IntMap_##K##_##V* map, K key, V* out)     \
+    {                                                                               \
+        CHECK_FATAL(!out, "out is null");                                           \
+        V* val = intmap_get_ptr_##K##_##V(map, key);                                \
+        if (!val) {                                                                 \
+            return 0;                                                               \
+        }                                                                           \
+        *out = *val;                                                                \
+        return 1;                                                                   \
+    }
+
+#define INTMAP_HAS(K, V)                                                            \
+    static inline b8 intmap_has_##K##_##V(const IntMap_##K##_##V* map, K key)       \
+    {                                                                               \
+        CHECK_FATAL(!map, "map is null");                                           \
+        if (key == INT_HASH_EMPTY) {                                                \
+            return map->has_zero;                                                   \
+        }                                                                           \
+        return intmap_find_##K##_##V(map, key) != map->capacity;                    \
+    }
+
+// Delete key. If out is provided, the value is copied into it first.
+// Returns 1 if found and deleted, 0 if not found
+#define INTMAP_DEL(K, V)                                                            \
+    static inline b8 intmap_del_##K##_##V(IntMap_##K##_##V* map, K key, V* out)     \
+    {                                                                               \
+        CHECK_FATAL(!map, "map is null");                                           \
+        if (key == INT_HASH_EMPTY) {                                                \
+            if (!map->has_zero) {                                                   \
+                return 0;                                                           \
+            }                                                                       \
+            if (out) {                                                              \
+                *out = map->zero_val;                                               \
+            }                                                                       \
+            map->has_zero = 0;                                                      \
+            map->size--;                                                            \
+            return 1;                                                               \
+        }                                                                           \
+        u64 idx = intmap_find_##K##_##V(map, key);                                  \
+        if (idx == map->capacity) {                                                 \
+            return 0;                                                               \
+        }                                                                           \
+        if (out) {                                                                  \
+            *out = map->vals[idx];                                                  \
+        }                                                                           \
+        /* backward shift: pull the run left until an empty or home slot */         \
+        u64 mask = map->capacity - 1;                                               \
+        for (;;) {                                                                  \
+            u64 next = (idx + 1) & mask;                                            \
+            K   cur  = map->keys[next];                                             \
+            if (cur == INT_HASH_EMPTY ||                                            \
+                INT_HASH_DIST(next, cur, map->seed, mask) == 0) {                   \
+                break;                                                              \
+            }                                                                       \
+            map->keys[idx] = cur;                                                   \
+            map->vals[idx] = map->vals[next];                                       \
+            idx            = next;                                                  \
+        }                                                                           \
+        map->keys[idx] = INT_HASH_EMPTY;                                            \
+        map->size--;                                                                \
+        return 1;                                                                   \
+    }
+
+// Remove all keys, keep capacity
+#define INTMAP_CLEAR(K, V)                                                          \
+    static inline void intmap_clear_##K##_##V(IntMap_##K##_##V* map)                \
+    {                                                                               \
+        CHECK_FATAL(!map, "map is null");                                           \
+        memset(map->keys, 0, map->capacity * sizeof(K));                            \
+        map->size     = 0;                                                          \
+        map->has_zero = 0;                                                          \
+    }
+
+
+// ============================================================================
+// MACROS TO INSTANTIATE ALL FUNCTIONS FOR A TYPE
+// ============================================================================
+
+// Order matters: functions must be defined before they're called
+// fmt: printf format for T, used by intset_print_T
+#define INSTANTIATE_INT_SET(T, fmt) \
+    INTSET_TYPE(T);                 \
+    INTSET_PLACE(T)                 \
+    INTSET_FIND(T)                  \
+    INTSET_RESIZE(T)                \
+    INTSET_CREATE(T)                \
+    INTSET_DESTROY(T)               \
+    INTSET_RESERVE(T)               \
+    INTSET_INSERT(T)                \
+    INTSET_HAS(T)                   \
+    INTSET_REMOVE(T)                \
+    INTSET_CLEAR(T)                 \
+    INTSET_PRINT(T, fmt)
+
+// K and V must be single identifiers (typedef structs before using them as V)
+#define INSTANTIATE_INT_MAP(K, V) \
+    INTMAP_TYPE(K, V);            \
+    INTMAP_PLACE(K, V)            \
+    INTMAP_FIND(K, V)             \
+    INTMAP_RESIZE(K, V)           \
+    INTMAP_CREATE(K, V)           \
+    INTMAP_DESTROY(K, V)          \
+    INTMAP_RESERVE(K, V)          \
+    INTMAP_PUT(K, V)              \
+    INTMAP_GET_PTR(K, V)          \
+    INTMAP_GET(K, V)              \
+    INTMAP_HAS(K, V)              \
+    INTMAP_DEL(K, V)              \
+    INTMAP_CLEAR(K, V)
+
+
+#endif // INT_HASH_GENERIC_H
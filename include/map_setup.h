@@ -4,13 +4,63 @@
 
 #include "common.h"
 #include <string.h>
+#include <stdatomic.h>
+#include <sys/random.h>
 
 
 typedef u64 (*custom_hash_fn)(const u8* key, u64 size);
 
-#define LOAD_FACTOR_GROW      0.75 // Robin Hood sweet spot
+#define LOAD_FACTOR_GROW      0.75 // Robin Hood sweet spot, default for new maps/sets
 #define HASHMAP_INIT_CAPACITY 16   // power-of-2 to avoid modulo
 
+// Range accepted by hashmap_set_max_load / hashset_set_max_load. Past 0.95
+// Robin Hood runs get long enough to hit the psl limit on their own.
+#define LOAD_FACTOR_MIN 0.25
+#define LOAD_FACTOR_MAX 0.95
+
+// Load factors are kept per map in whole percent, so the growth check
+// stays an integer multiply
+#define MAP_LOAD_PCT(lf) ((u8)((lf) * 100.0 + 0.5))
+
+// 1 once size entries in cap buckets reach load_pct percent
+static inline b8 map_load_reached(u64 size, u64 cap, u8 load_pct)
+{
+    return size * 100 >= cap * load_pct;
+}
+
+// Smallest power-of-2 capacity, at least cap, that holds n entries below load_pct
+static inline u64 map_capacity_for(u64 n, u64 cap, u8 load_pct)
+{
+    while (map_load_reached(n, cap, load_pct)) {
+        cap *= 2;
+    }
+    return cap;
+}
+
+// Capacity an automatic shrink lands on: halve while the entries still fit
+// in half of load_pct, so the load ends up in (load_pct / 4, load_pct / 2]
+// and the table needs to double its entries again before it grows back
+static inline u64 map_shrink_capacity(u64 size, u64 cap, u8 load_pct)
+{
+    while (cap > HASHMAP_INIT_CAPACITY && size * 200 <= (cap / 2) * load_pct) {
+        cap /= 2;
+    }
+    return cap;
+}
+
+// What settles a psl overflow (see RH_PSL_LIMIT): 1 = grow, 0 = reseed
+static inline b8 map_overflow_grows(u64 size, u64 cap)
+{
+    return map_load_reached(size, cap, MAP_LOAD_PCT(LOAD_FACTOR_GROW));
+}
+
+// Default for new maps and sets: 1 = every one gets its own random seed.
+// 0 = unseeded, buckets come straight from hash_fn (reproducible layouts).
+// Per map at runtime: hashmap_set_seed / hashset_set_seed.
+#ifndef WC_MAP_SEEDED
+    #define WC_MAP_SEEDED 1
+#endif
+
 typedef enum {
     NOT_FOUND = 0,
     FOUND,
@@ -99,6 +149,153 @@ static inline int default_compare(const u8* a, const u8* b, u64 size)
 }
 
 
+/*
+====================ROBIN HOOD SHIFT INSERT====================
+*/
+// Robin Hood keeps every cluster sorted by home bucket. Inserting at the
+// position where the probe stopped and pushing the rest of the run one slot
+// to the right gives the same invariant as the classic swap-and-carry loop,
+// but each displaced entry is moved exactly once (one memmove per array)
+// and the incoming entry never needs a staging buffer.
+
+// First empty slot at or after idx (psl 0 == empty)
+static inline u64 rh_run_end(const u8* psls, u64 idx, u64 mask)
+{
+    while (psls[idx] != 0) {
+        idx = (idx + 1) & mask;
+    }
+    return idx;
+}
+
+// Move the run [idx, end) one slot right. end is the first empty slot and
+// may have wrapped around past cap - 1.
+static inline void rh_shift_right(u8* arr, u64 elm_size, u64 idx, u64 end, u64 cap)
+{
+    if (end > idx) {
+        memmove(arr + ((idx + 1) * elm_size), arr + (idx * elm_size), (end - idx) * elm_size);
+        return;
+    }
+
+    // wrapped run: [idx, cap) ++ [0, end)
+    if (end > 0) {
+        memmove(arr + elm_size, arr, end * elm_size);
+    }
+    memcpy(arr, arr + ((cap - 1) * elm_size), elm_size);
+    if (cap - 1 > idx) {
+        memmove(arr + ((idx + 1) * elm_size), arr + (idx * elm_size), (cap - 1 - idx) * elm_size);
+    }
+}
+
+// Stored psls are u8. A table whose psls reach this limit is flagged; the
+// gap up to 255 absorbs the few inserts that can still happen before the
+// owner rehashes (the rest of one put, a migration step). Below the default
+// load the run is the seed's fault and the owner reseeds; above it (a raised
+// max load) the table is simply too full and the owner grows it.
+#define RH_PSL_LIMIT 128
+
+// Limit of a table whose long run is keys with equal hash_fn outputs (see
+// rh_overflow_twins): no seed or capacity splits those, so the run is kept
+// and only a psl about to wrap is flagged.
+#define RH_PSL_MAX 255
+
+// After a shift every entry in (idx, end] sits one slot further from home.
+// Returns 1 if any of them reached limit.
+static inline b8 rh_bump_psls(u8* psls, u64 idx, u64 end, u64 mask, u8 limit)
+{
+    b8 over = 0;
+    for (u64 i = (idx + 1) & mask;; i = (i + 1) & mask) {
+        over |= ++psls[i] >= limit;
+        if (i == end) {
+            break;
+        }
+    }
+    return over;
+}
+
+// A rebuild just flagged a psl that reached limit. Of the run from that
+// entry's home up to it, how many keys share its hash_fn output: those
+// collide under every seed and capacity, so a rehash can't shorten the run
+// below this count.
+static inline u64 rh_overflow_twins(const u8* psls, const u8* keys, u32 key_size, u64 cap,
+                                    u8 limit, custom_hash_fn hash_fn)
+{
+    u64 mask = cap - 1;
+    for (u64 i = 0; i < cap; i++) {
+        if (psls[i] < limit) {
+            continue;
+        }
+
+        u64 hash  = hash_fn(keys + (i * key_size), key_size);
+        u64 twins = 0;
+        for (u64 j = (i - psls[i] + 1) & mask;; j = (j + 1) & mask) {
+            twins += hash_fn(keys + (j * key_size), key_size) == hash;
+            if (j == i) {
+                break;
+            }
+        }
+        return twins;
+    }
+    return 0;
+}
+
+// First full bucket at or after idx, or cap if there is none (iterators,
+// set algebra). Tests 8 psls per load: a zero word is 8 empty buckets
+// (little-endian, so the lowest set byte is the first full bucket).
+static inline u64 map_next_full(const u8* psls, u64 idx, u64 cap)
+{
+    for (; idx + 8 <= cap; idx += 8) {
+        u64 w;
+        memcpy(&w, psls + idx, sizeof(w));
+        if (w) {
+            return idx + ((u64)__builtin_ctzll(w) >> 3);
+        }
+    }
+    for (; idx < cap; idx++) {
+        if (psls[idx] != 0) {
+            return idx;
+        }
+    }
+    return cap;
+}
+
+
+/*
+====================SEEDING====================
+*/
+// hash_fn has no seed parameter, so the per-map seed is mixed into its
+// result instead. Keys crafted to share buckets under one seed scatter under
+// another; only keys whose hash_fn outputs are fully equal still collide,
+// and a table flooded by those keeps the run (see RH_PSL_MAX).
+
+// Seeds are a process secret (getrandom, drawn once) run through a counter,
+// so creating a map costs no syscall. Never returns 0 (0 = unseeded).
+static inline u64 map_seed_random(void)
+{
+    static _Atomic u64 secret  = 0;
+    static _Atomic u64 counter = 0;
+
+    u64 s = atomic_load_explicit(&secret, memory_order_relaxed);
+    if (s == 0) {
+        if (getrandom(&s, sizeof(s), 0) != (ssize_t)sizeof(s)) {
+            s = (u64)(uintptr_t)&s ^ 0x2545f4914f6cdd1dULL; // ASLR as a last resort
+        }
+        s |= 1;
+        // racing threads may each store their own draw — any one of them works
+        atomic_store_explicit(&secret, s, memory_order_relaxed);
+    }
+
+    u64 n    = atomic_fetch_add_explicit(&counter, 1, memory_order_relaxed);
+    u64 seed = wymix(s ^ n, 0x9e3779b97f4a7c15ULL);
+    return seed ? seed : 1;
+}
+
+// Bucket hash for a hash_fn result under seed (0 = the result as is)
+static inline u64 map_seed_mix(u64 hash, u64 seed)
+{
+    return seed ? wymix(hash ^ seed, 0xe7037ed1a0b428dbULL) : hash;
+}
+
+
 /*
 ====================STRING HASHING====================
 */
@@ -124,4 +321,87 @@ static u64 wyhash_str_ptr(const u8* key, u64 size)
 #define ALIGN8(size) (((u64)(size) + 7u) & ~7u)
 
 
+/*
+====================STATS====================
+*/
+// Shape of a table (load, probe distances, memory) plus optional counters,
+// shared by hashmap_stats and hashset_stats. The shape is scanned from the
+// psls array on demand and costs nothing until asked for. The counters are
+// bumped on every lookup, so they only exist in builds with -DWC_MAP_STATS=1;
+// otherwise they read 0. The adds are relaxed atomics: const lookups bump
+// them too, and hashmap_concurrent runs those on shared shards at once.
+
+#ifndef WC_MAP_STATS
+    #define WC_MAP_STATS 0
+#endif
+
+#if WC_MAP_STATS
+    #define MAP_STAT_ADD(counters, field, n) \
+        ((void)__atomic_fetch_add(&(counters)->field, (n), __ATOMIC_RELAXED))
+#else
+    #define MAP_STAT_ADD(counters, field, n) ((void)0)
+#endif
+
+// psl_hist[d] counts entries d buckets away from home; the last slot
+// collects everything at MAP_STATS_PSL_SLOTS - 1 and beyond
+#define MAP_STATS_PSL_SLOTS 16
+
+typedef struct {
+    u64 lookups;  // probes started by get/has/put/del and friends
+    u64 probes;   // buckets visited by those lookups
+    u64 compares; // cmp_fn calls made by those lookups
+    u64 resizes;  // table rebuilds (growth, reserve, shrink)
+} map_counters;
+
+typedef struct {
+    u64          size;
+    u64          capacity;
+    double       load_factor;
+    u64          max_psl;  // longest probe distance (0 = in its home bucket)
+    double       mean_psl;
+    u64          psl_hist[MAP_STATS_PSL_SLOTS];
+    u64          bytes;    // struct + table arrays currently held
+    map_counters counters; // since create or the last *_stats_reset
+} map_stats;
+
+// Add the entries of one table to the psl fields of out.
+// mean_psl holds the psl sum until map_stats_finish.
+static inline void map_stats_scan(map_stats* out, const u8* psls, u64 cap)
+{
+    for (u64 i = 0; i < cap; i++) {
+        if (psls[i] == 0) {
+            continue;
+        }
+        u64 d = (u64)psls[i] - 1;
+        out->psl_hist[d < MAP_STATS_PSL_SLOTS ? d : MAP_STATS_PSL_SLOTS - 1]++;
+        out->mean_psl += (double)d;
+        if (d > out->max_psl) {
+            out->max_psl = d;
+        }
+    }
+}
+
+static inline void map_stats_finish(map_stats* out)
+{
+    out->load_factor = out->capacity ? (double)out->size / (double)out->capacity : 0.0;
+    out->mean_psl    = out->size ? out->mean_psl / (double)out->size : 0.0;
+}
+
+static inline void map_stats_print(const map_stats* s)
+{
+    printf("size %llu / cap %llu (load %.2f), %llu bytes\n", (unsigned long long)s->size,
+           (unsigned long long)s->capacity, s->load_factor, (unsigned long long)s->bytes);
+    printf("psl: max %llu, mean %.2f\n", (unsigned long long)s->max_psl, s->mean_psl);
+    for (u32 d = 0; d < MAP_STATS_PSL_SLOTS; d++) {
+        if (s->psl_hist[d]) {
+            printf("  %2u%s %llu\n", d, d == MAP_STATS_PSL_SLOTS - 1 ? "+" : " ",
+                   (unsigned long long)s->psl_hist[d]);
+        }
+    }
+    printf("lookups %llu, probes %llu, compares %llu, resizes %llu\n",
+           (unsigned long long)s->counters.lookups, (unsigned long long)s->counters.probes,
+           (unsigned long long)s->counters.compares, (unsigned long long)s->counters.resizes);
+}
+
+
 #endif // MAP_SETUP_H
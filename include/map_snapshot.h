@@ -0,0 +1,84 @@
+#ifndef MAP_SNAPSHOT_H
+#define MAP_SNAPSHOT_H
+
+#include "map_setup.h"
+#include "wc_errno.h"
+
+
+/* On-disk snapshots of POD hash tables (hashmap_save / hashset_save)
+  - one file: a header page, then the table arrays exactly as they sit in
+    memory (psls, keys, vals), each 64-byte aligned
+  - loading maps the file MAP_PRIVATE and points the table at it: no parse,
+    no rehash, pages come in from the page cache as probes touch them
+  - the mapping starts PROT_READ; promoting it makes it writable, and the
+    kernel copies a page the first time it is written (the file never is)
+  - native byte order and struct layout: a snapshot is read back by the
+    same build on the same kind of machine, it is not an exchange format
+  - hash_fn can't be stored, so the header keeps hash_fn applied to a fixed
+    probe key; loading with a different hash_fn is caught there
+*/
+
+
+#define MAP_SNAPSHOT_VERSION 1
+#define MAP_SNAPSHOT_ARRAYS  3 // psls, keys, vals (sets leave vals empty)
+
+typedef enum {
+    MAP_SNAPSHOT_HASHMAP = 1,
+    MAP_SNAPSHOT_HASHSET = 2,
+} map_snapshot_kind;
+
+typedef struct {
+    u64 magic;
+    u32 version;
+    u32 kind;       // map_snapshot_kind
+    u32 key_size;   // elm_size for sets
+    u32 val_size;   // 0 for sets
+    u64 size;
+    u64 capacity;
+    u64 seed;
+    u64 hash_check; // hash_fn(probe key), see map_snapshot_hash_check
+    u64 file_len;
+    u64 offs[MAP_SNAPSHOT_ARRAYS]; // byte offset of each array, 0 = absent
+    u64 lens[MAP_SNAPSHOT_ARRAYS]; // byte length of each array
+    u8  max_load;
+    u8  min_load;
+} map_snapshot_header;
+
+
+// hash_fn applied to key_size bytes of a fixed pattern
+u64 map_snapshot_hash_check(custom_hash_fn hash_fn, u32 key_size);
+
+// Write hdr (magic, version, offsets and file_len are filled in here) and
+// the arrays to path. Goes through "<path>.tmp" and a rename, so a crash
+// mid-write leaves any previous snapshot intact.
+// Returns 1 on success, 0 with wc_errno = WC_ERR_IO otherwise.
+b8 map_snapshot_save(const char* path, map_snapshot_header* hdr,
+                     const u8* const arrays[MAP_SNAPSHOT_ARRAYS]);
+
+// Map path read-only and check its header against kind. On success returns
+// the base of the mapping and fills hdr. Returns NULL with
+// wc_errno = WC_ERR_IO if the file can't be mapped, is not a snapshot of
+// this kind and version, is shorter than its header says, or holds loads
+// outside what hashmap_set_max_load / hashmap_set_min_load accept.
+u8* map_snapshot_map(const char* path, map_snapshot_kind kind, map_snapshot_header* hdr);
+
+// Make a mapping from map_snapshot_map writable, copy-on-write per page.
+void map_snapshot_promote(u8* base, u64 len);
+
+void map_snapshot_unmap(u8* base, u64 len);
+
+// 1 if ptr points into the mapping [base, base + len)
+// 1 if an array of len bytes holds exactly capacity items of elm_size
+// (divides instead of multiplying, so a forged capacity can't overflow)
+static inline b8 map_snapshot_len_is(u64 len, u64 capacity, u32 elm_size)
+{
+    return elm_size != 0 && len % elm_size == 0 && len / elm_size == capacity;
+}
+
+static inline b8 map_snapshot_owns(const u8* base, u64 len, const void* ptr)
+{
+    return base && (const u8*)ptr >= base && (const u8*)ptr < base + len;
+}
+
+
+#endif // MAP_SNAPSHOT_H
@@ -0,0 +1,38 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "common.h"
+
+
+/* Fork-join thread pool (pthreads)
+  - n threads work on a job: n - 1 workers parked on a condition variable
+    plus the thread that calls thread_pool_run
+  - a job is n_tasks calls of fn(ctx, task), task in [0, n_tasks); threads
+    claim the next task index from an atomic counter, so uneven tasks
+    balance out on their own
+  - thread_pool_run returns once every task has finished; one job at a
+    time, and fn must not run another job on the same pool
+  - nothing runs in the background between jobs
+*/
+
+
+typedef struct thread_pool thread_pool;
+
+typedef void (*thread_pool_fn)(void* ctx, u64 task);
+
+
+// Pool of n_threads threads, the caller of thread_pool_run included.
+// n_threads = 0 uses one per online CPU.
+thread_pool* thread_pool_create(u32 n_threads);
+
+// Joins the workers. Must not be called while a job runs.
+void thread_pool_destroy(thread_pool* pool);
+
+// Threads taking part in a job (workers + the caller)
+u32 thread_pool_threads(const thread_pool* pool);
+
+// Run fn(ctx, task) for every task in [0, n_tasks) and wait for all of them.
+void thread_pool_run(thread_pool* pool, u64 n_tasks, thread_pool_fn fn, void* ctx);
+
+
+#endif // THREAD_POOL_H
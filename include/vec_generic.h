@@ -0,0 +1,310 @@
+#ifndef VEC_GENERIC_H
+#define VEC_GENERIC_H
+
+#include "gen_vector.h"
+#include "wc_errno.h"
+
+#include <stddef.h>
+#include <string.h>
+
+
+/* Typed Vector Specializations
+  - macro-generated per element type, same idea as INSTANTIATE_MATRIX:
+    VEC_INSTANTIATE(int) gives Vec_int and vec_int_push, vec_int_at, ...
+  - genVec copies every element with a runtime data_size memcpy and checks
+    ops on each call; here the element size is sizeof(T), so a POD push is
+    one store and loops over the data can be vectorized
+  - same layout as genVec (checked at compile time): vec_T_as_genVec hands
+    the same vector to every genVec_* function (sort, find, print, ...) and
+    genVec_destroy frees it
+  - ops work as in genVec: NULL for POD, container_ops for owned types
+    (copy on push / set, del on pop / clear / destroy)
+  - vec_T_create / init_stk use the heap; a genVec_init_alloc vector
+    viewed through vec_T_from_genVec keeps growing and freeing through
+    its allocator
+  - moves are plain struct copies: an element is its bytes, there is no
+    heap shell to hand over (unlike genVec_push_move), so move_fn is unused
+  - T must be a single identifier (int, float, String, a typedef);
+    functions are static inline, expand the macro in every .c file that
+    uses the type
+*/
+
+
+// ============================================================================
+// SHARED HELPERS (type-agnostic)
+// ============================================================================
+
+#define TVEC_MIN_CAPACITY 4 // as genVec
+
+// Field for field the same as genVec, with data typed
+#define TVEC_TYPE(T)                                                                 \
+    typedef struct {                                                                 \
+        T*                   data;                                                   \
+        const container_ops* ops;                                                    \
+        const wc_allocator*  alloc;                                                  \
+        u64                  size;                                                   \
+        u64                  capacity;                                               \
+        u32                  data_size; /* sizeof(T), kept for genVec */             \
+    } Vec_##T;                                                                       \
+                                                                                     \
+    _Static_assert(sizeof(Vec_##T) == sizeof(genVec), "Vec_" #T " size != genVec");  \
+    _Static_assert(offsetof(Vec_##T, ops) == offsetof(genVec, ops) &&                \
+                       offsetof(Vec_##T, alloc) == offsetof(genVec, alloc) &&        \
+                       offsetof(Vec_##T, size) == offsetof(genVec, size) &&          \
+                       offsetof(Vec_##T, capacity) == offsetof(genVec, capacity) &&  \
+                       offsetof(Vec_##T, data_size) == offsetof(genVec, data_size),  \
+                   "Vec_" #T " layout != genVec")
+
+
+// ============================================================================
+// CREATION / DESTRUCTION
+// ============================================================================
+
+#define TVEC_INIT_STK(T)                                                             \
+    static inline void vec_##T##_init_stk(Vec_##T* vec, u64 n, const container_ops* ops) \
+    {                                                                                \
+        CHECK_FATAL(!vec, "vec is null");                                            \
+        vec->data = (n > 0) ? (T*)malloc(sizeof(T) * n) : NULL;                      \
+        CHECK_FATAL(n > 0 && !vec->data, "data malloc failed");                      \
+        vec->ops       = ops;                                                        \
+        vec->alloc     = NULL;                                                       \
+        vec->size      = 0;                                                          \
+        vec->capacity  = n;                                                          \
+        vec->data_size = sizeof(T);                                                  \
+    }
+
+#define TVEC_CREATE(T)                                                               \
+    static inline Vec_##T* vec_##T##_create(u64 n, const container_ops* ops)         \
+    {                                                                                \
+        Vec_##T* vec = (Vec_##T*)malloc(sizeof(Vec_##T));                            \
+        CHECK_FATAL(!vec, "vec malloc failed");                                      \
+        vec_##T##_init_stk(vec, n, ops);                                             \
+        return vec;                                                                  \
+    }
+
+// del_fn on every element (if any); the vector stays usable, size 0
+#define TVEC_CLEAR(T)                                                                \
+    static inline void vec_##T##_clear(Vec_##T* vec)                                 \
+    {                                                                                \
+        CHECK_FATAL(!vec, "vec is null");                                            \
+        delete_fn del = VEC_DEL_FN(vec);                                             \
+        if (del) {                                                                   \
+            for (u64 i = 0; i < vec->size; i++) {                                    \
+                del((u8*)&vec->data[i]);                                             \
+            }                                                                        \
+        }                                                                            \
+        vec->size = 0;                                                               \
+    }
+
+#define TVEC_DESTROY(T)                                                              \
+    static inline void vec_##T##_destroy_stk(Vec_##T* vec)                           \
+    {                                                                                \
+        vec_##T##_clear(vec);                                                        \
+        wc_free(vec->alloc, vec->data, sizeof(T) * vec->capacity);                   \
+        vec->data     = NULL;                                                        \
+        vec->capacity = 0;                                                           \
+    }                                                                                \
+                                                                                     \
+    static inline void vec_##T##_destroy(Vec_##T* vec)                               \
+    {                                                                                \
+        vec_##T##_destroy_stk(vec);                                                  \
+        wc_free(vec->alloc, vec, sizeof(Vec_##T));                                   \
+    }
+
+// Never shrinks
+#define TVEC_RESERVE(T)                                                              \
+    static inline void vec_##T##_reserve(Vec_##T* vec, u64 new_capacity)             \
+    {                                                                                \
+        CHECK_FATAL(!vec, "vec is null");                                            \
+        if (new_capacity <= vec->capacity) {                                         \
+            return;                                                                  \
+        }                                                                            \
+        T* data = (T*)wc_realloc(vec->alloc, vec->data, sizeof(T) * vec->capacity,   \
+                                 sizeof(T) * new_capacity);                          \
+        CHECK_FATAL(!data, "data realloc failed");                                   \
+        vec->data     = data;                                                        \
+        vec->capacity = new_capacity;                                                \
+    }
+
+// Out of line from push so the hot path stays small
+#define TVEC_GROW(T)                                                                 \
+    static void vec_##T##_grow(Vec_##T* vec)                                         \
+    {                                                                                \
+        u64 new_cap = (u64)((float)vec->capacity * GENVEC_GROWTH);                   \
+        if (new_cap < TVEC_MIN_CAPACITY) {                                           \
+            new_cap = TVEC_MIN_CAPACITY;                                             \
+        }                                                                            \
+        if (new_cap <= vec->capacity) {                                              \
+            new_cap = vec->capacity + 1;                                             \
+        }                                                                            \
+        vec_##T##_reserve(vec, new_cap);                                             \
+    }
+
+
+// ============================================================================
+// OPERATIONS
+// ============================================================================
+
+// COPY semantics: copy_fn builds the element in place, else a plain store
+#define TVEC_PUSH(T)                                                                 \
+    static inline void vec_##T##_push(Vec_##T* vec, T val)                           \
+    {                                                                                \
+        CHECK_FATAL(!vec, "vec is null");                                            \
+        if (vec->size == vec->capacity) {                                            \
+            vec_##T##_grow(vec);                                                     \
+        }                                                                            \
+        copy_fn cp = VEC_COPY_FN(vec);                                               \
+        if (cp) {                                                                    \
+            cp((u8*)&vec->data[vec->size], (const u8*)&val);                         \
+        } else {                                                                     \
+            vec->data[vec->size] = val;                                              \
+        }                                                                            \
+        vec->size++;                                                                 \
+    }
+
+// MOVE semantics: the vec takes *val's bytes, *val is zeroed
+#define TVEC_PUSH_MOVE(T)                                                            \
+    static inline void vec_##T##_push_move(Vec_##T* vec, T* val)                     \
+    {                                                                                \
+        CHECK_FATAL(!vec || !val, "null arg");                                       \
+        if (vec->size == vec->capacity) {                                            \
+            vec_##T##_grow(vec);                                                     \
+        }                                                                            \
+        vec->data[vec->size++] = *val;                                               \
+        memset(val, 0, sizeof(T));                                                   \
+    }
+
+// Uninitialised slot at the back, as genVec_emplace_back
+#define TVEC_EMPLACE_BACK(T)                                                         \
+    static inline T* vec_##T##_emplace_back(Vec_##T* vec)                           \
+    {                                                                                \
+        CHECK_FATAL(!vec, "vec is null");                                            \
+        if (vec->size == vec->capacity) {                                            \
+            vec_##T##_grow(vec);                                                     \
+        }                                                                            \
+        return &vec->data[vec->size++];                                              \
+    }
+
+// Append n elements of arr, COPY semantics. Reserves once; POD elements
+// go across in one loop the compiler can vectorize.
+#define TVEC_PUSH_ARR(T)                                                             \
+    static inline void vec_##T##_push_arr(Vec_##T* vec, const T* restrict arr, u64 n) \
+    {                                                                                \
+        CHECK_FATAL(!vec || (!arr && n > 0), "null arg");                            \
+        if (vec->size + n > vec->capacity) {                                         \
+            vec_##T##_reserve(vec, vec->size + n);                                   \
+        }                                                                            \
+        T* restrict dst = vec->data + vec->size;                                     \
+        copy_fn     cp  = VEC_COPY_FN(vec);                                          \
+        if (cp) {                                                                    \
+            for (u64 i = 0; i < n; i++) {                                            \
+                cp((u8*)&dst[i], (const u8*)&arr[i]);                                \
+            }                                                                        \
+        } else {                                                                     \
+            for (u64 i = 0; i < n; i++) {                                            \
+                dst[i] = arr[i];                                                     \
+            }                                                                        \
+        }                                                                            \
+        vec->size += n;                                                              \
+    }
+
+// Remove the last element. out (optional) takes it over as is, without a
+// copy; with out NULL it goes to del_fn. Returns 0 with
+// wc_errno = WC_ERR_EMPTY on an empty vec.
+#define TVEC_POP(T)                                                                  \
+    static inline b8 vec_##T##_pop(Vec_##T* vec, T* out)                             \
+    {                                                                                \
+        CHECK_FATAL(!vec, "vec is null");                                            \
+        WC_SET_RET(WC_ERR_EMPTY, vec->size == 0, 0);                                 \
+        vec->size--;                                                                 \
+        if (out) {                                                                   \
+            *out = vec->data[vec->size];                                             \
+        } else {                                                                     \
+            delete_fn del = VEC_DEL_FN(vec);                                         \
+            if (del) {                                                               \
+                del((u8*)&vec->data[vec->size]);                                     \
+            }                                                                        \
+        }                                                                            \
+        return 1;                                                                    \
+    }
+
+// Pointer to element i (bounds checked). Invalidated by a push that grows.
+#define TVEC_AT(T)                                                                   \
+    static inline T* vec_##T##_at(const Vec_##T* vec, u64 i)                         \
+    {                                                                                \
+        CHECK_FATAL(!vec, "vec is null");                                            \
+        CHECK_FATAL(i >= vec->size, "index out of bounds");                          \
+        return &vec->data[i];                                                        \
+    }
+
+// Element i by value. For owned types this is a shallow view: the vec
+// still owns whatever the element points to.
+#define TVEC_GET(T)                                                                  \
+    static inline T vec_##T##_get(const Vec_##T* vec, u64 i)                         \
+    {                                                                                \
+        return *vec_##T##_at(vec, i);                                                \
+    }
+
+// Replace element i, COPY semantics (the old element goes to del_fn)
+#define TVEC_SET(T)                                                                  \
+    static inline void vec_##T##_set(Vec_##T* vec, u64 i, T val)                     \
+    {                                                                                \
+        T*        slot = vec_##T##_at(vec, i);                                       \
+        delete_fn del  = VEC_DEL_FN(vec);                                            \
+        copy_fn   cp   = VEC_COPY_FN(vec);                                           \
+        if (del) {                                                                   \
+            del((u8*)slot);                                                          \
+        }                                                                            \
+        if (cp) {                                                                    \
+            cp((u8*)slot, (const u8*)&val);                                          \
+        } else {                                                                     \
+            *slot = val;                                                             \
+        }                                                                            \
+    }
+
+
+// ============================================================================
+// GENVEC INTEROP
+// ============================================================================
+
+// The same vector seen as a genVec: every genVec_* call works on it
+#define TVEC_AS_GENVEC(T)                                                            \
+    static inline genVec* vec_##T##_as_genVec(Vec_##T* vec)                          \
+    {                                                                                \
+        CHECK_FATAL(!vec, "vec is null");                                            \
+        return (genVec*)vec;                                                         \
+    }                                                                                \
+                                                                                     \
+    static inline Vec_##T* vec_##T##_from_genVec(genVec* vec)                        \
+    {                                                                                \
+        CHECK_FATAL(!vec, "vec is null");                                            \
+        CHECK_FATAL(vec->data_size != sizeof(T), "genVec data_size != sizeof(" #T ")"); \
+        return (Vec_##T*)vec;                                                        \
+    }
+
+
+// ============================================================================
+// MACRO TO INSTANTIATE ALL FUNCTIONS FOR A TYPE
+// ============================================================================
+
+// Order matters: functions must be defined before they're called
+#define VEC_INSTANTIATE(T) \
+    TVEC_TYPE(T);          \
+    TVEC_INIT_STK(T)       \
+    TVEC_CREATE(T)         \
+    TVEC_CLEAR(T)          \
+    TVEC_DESTROY(T)        \
+    TVEC_RESERVE(T)        \
+    TVEC_GROW(T)           \
+    TVEC_PUSH(T)           \
+    TVEC_PUSH_MOVE(T)      \
+    TVEC_EMPLACE_BACK(T)   \
+    TVEC_PUSH_ARR(T)       \
+    TVEC_POP(T)            \
+    TVEC_AT(T)             \
+    TVEC_GET(T)            \
+    TVEC_SET(T)            \
+    TVEC_AS_GENVEC(T)
+
+
+#endif // VEC_GENERIC_H
@@ -0,0 +1,58 @@
+#ifndef WC_ALLOCATOR_H
+#define WC_ALLOCATOR_H
+
+#include "common.h"
+
+
+/* Pluggable allocator for container storage (genVec, Stack, Queue, String)
+  - a vtable of alloc / realloc / free plus a ctx pointer handed back to
+    each call; the container keeps a pointer to it, so the allocator must
+    outlive every container built on it
+  - NULL means the C heap (malloc / realloc / free), which is what every
+    plain _init / _create uses
+  - realloc and free are told the old size: allocators without a size
+    header (arenas, pools) need it to copy or to give memory back
+  - alloc / realloc return NULL when out of memory, the container treats
+    that as fatal like a failed malloc
+  - arena_allocator (arena.h) is the stock adapter: grow reallocs in place
+    while the block is the arena's last allocation, free gives the last
+    allocation back, anything else is left for arena_clear
+*/
+
+
+typedef struct {
+    void* (*alloc_fn)(void* ctx, u64 size);
+    void* (*realloc_fn)(void* ctx, void* ptr, u64 old_size, u64 new_size);
+    void  (*free_fn)(void* ctx, void* ptr, u64 size);
+    void* ctx;
+} wc_allocator;
+
+
+// Dispatch, with the NULL allocator going straight to the C heap
+
+static inline void* wc_alloc(const wc_allocator* a, u64 size)
+{
+    return a ? a->alloc_fn(a->ctx, size) : malloc(size);
+}
+
+// ptr may be NULL (then it is an alloc)
+static inline void* wc_realloc(const wc_allocator* a, void* ptr, u64 old_size, u64 new_size)
+{
+    return a ? a->realloc_fn(a->ctx, ptr, old_size, new_size) : realloc(ptr, new_size);
+}
+
+// ptr may be NULL (then it is a no-op)
+static inline void wc_free(const wc_allocator* a, void* ptr, u64 size)
+{
+    if (!ptr) {
+        return;
+    }
+    if (a) {
+        a->free_fn(a->ctx, ptr, size);
+    } else {
+        free(ptr);
+    }
+}
+
+
+#endif // WC_ALLOCATOR_H
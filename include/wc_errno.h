@@ -44,6 +44,8 @@
  *   genVec_pop, genVec_front, genVec_back WC_ERR_EMPTY   vec is empty
  *   dequeue, queue_peek, queue_peek_ptr   WC_ERR_EMPTY   queue is empty
  *   stack_pop, stack_peek                 WC_ERR_EMPTY   stack is empty
+ *   hashmap_save, hashmap_load_mmap,      WC_ERR_IO      file can't be written / read,
+ *   hashset_save, hashset_load_mmap                      or is not a matching snapshot
  */
 
 
@@ -52,6 +54,7 @@ typedef enum {
     WC_ERR_FULL,       // arena exhausted / container at capacity
     WC_ERR_EMPTY,      // pop or peek on empty container
     WC_ERR_INVALID_OP, // call to a function with preconditions not met
+    WC_ERR_IO,         // file missing, unreadable, or not what was expected
 } wc_err;
 
 static inline const char* wc_strerror(wc_err e)
@@ -61,6 +64,7 @@ static inline const char* wc_strerror(wc_err e)
         case WC_ERR_FULL:       return "full";
         case WC_ERR_EMPTY:      return "empty";
         case WC_ERR_INVALID_OP: return "invalid op";
+        case WC_ERR_IO:         return "io error";
         default:                return "unknown";
     }
 }
@@ -77,6 +77,7 @@ static inline void str_copy(u8* dest, const u8* src)
 
     String* s = (String*)src;
     memcpy(d, s, sizeof(String));
+    d->alloc = NULL; // the copy lives on the heap, whatever src came from
 
     if (s->capacity == STR_SSO_SIZE) {
         return; // str stored inline, we have everything 
@@ -159,7 +160,8 @@ static inline void vec_copy(u8* dest, const u8* src)
     genVec*       d = (genVec*)dest;
 
     memcpy(d, s, sizeof(genVec));                           // copy all fields (including ops ptr)
-    d->data = malloc(s->capacity * (u64)s->data_size);      // new data buffer
+    d->alloc = NULL;                                        // copies live on the heap
+    d->data  = malloc(s->capacity * (u64)s->data_size);     // new data buffer
 
     copy_fn copy = VEC_COPY_FN(s);                          // safe: handles NULL ops
     if (copy) {
@@ -174,7 +176,7 @@ static inline void vec_copy(u8* dest, const u8* src)
 static inline void vec_move(u8* dest, u8** src)
 {
     memcpy(dest, *src, sizeof(genVec));  // transfer all fields (incl. data ptr and ops ptr)
-    free(*src);                          // free container struct only
+    wc_free(((genVec*)dest)->alloc, *src, sizeof(genVec)); // free container struct only
     *src = NULL;
 }
 
@@ -205,6 +207,7 @@ static inline void vec_copy_ptr(u8* dest, const u8* src)
 
     genVec* d = malloc(sizeof(genVec));
     memcpy(d, s, sizeof(genVec));                           // copies ops ptr too
+    d->alloc  = NULL;
     d->data   = malloc(s->capacity * (u64)s->data_size);
 
     copy_fn copy = VEC_COPY_FN(s);
@@ -215,19 +215,28 @@ Usage:
         _out;                                            \
     })
 
+// Pointer to key's value, inserted zeroed if absent: (*MAP_ENTRY(m, int, k))++;
+#define MAP_ENTRY(map, V, key)                           \
+    ({                                                   \
+        typeof(key) _mk = (key);                         \
+        (V*)hashmap_entry((map), (const u8*)&_mk, NULL); \
+    })
+
 
 
 // Iterate
 
 
+// Both walk the old table too while an incremental resize is in flight.
+
 // WARN: don't modify the key !!!
-#define MAP_FOREACH_KEY(map, T, name)            \
-    for (u64 _i = 0; _i < (map)->capacity; _i++) \
-        for (const T* name = (const T*)((map)->keys + (_i * (map)->key_size)); name && (map)->psls[_i]; name = NULL)
+#define MAP_FOREACH_KEY(map, T, name)                                        \
+    for (hashmap_iter _it = hashmap_iter_begin(map); hashmap_iter_next(&_it);) \
+        for (const T* name = (const T*)_it.key; name; name = NULL)
 
-#define MAP_FOREACH_VAL(map, T, name)            \
-    for (u64 _i = 0; _i < (map)->capacity; _i++) \
-        for (T* name = (T*)((map)->vals + (_i * (map)->val_size)); name && (map)->psls[_i]; name = NULL)
+#define MAP_FOREACH_VAL(map, T, name)                                        \
+    for (hashmap_iter _it = hashmap_iter_begin(map); hashmap_iter_next(&_it);) \
+        for (T* name = (T*)_it.val; name; name = NULL)
 
 
 // Hashset shorthands
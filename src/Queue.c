@@ -46,14 +46,19 @@ static void queue_compact(Queue* q, u64 new_capacity);
 
 
 Queue* queue_create(u64 n, u32 data_size, const container_ops* ops)
+{
+    return queue_create_alloc(n, data_size, ops, NULL);
+}
+
+Queue* queue_create_alloc(u64 n, u32 data_size, const container_ops* ops, const wc_allocator* alloc)
 {
     CHECK_FATAL(n == 0, "n can't be 0");
     CHECK_FATAL(data_size == 0, "data_size can't be 0");
 
-    Queue* q = malloc(sizeof(Queue));
+    Queue* q = wc_alloc(alloc, sizeof(Queue));
     CHECK_FATAL(!q, "queue malloc failed");
 
-    q->arr = genVec_init(n, data_size, ops);
+    q->arr = genVec_init_alloc(n, data_size, ops, alloc);
 
     q->head = 0;
     q->tail = 0;
@@ -84,8 +89,9 @@ void queue_destroy(Queue* q)
 {
     CHECK_FATAL(!q, "queue is null");
 
+    const wc_allocator* alloc = q->arr->alloc;
     genVec_destroy(q->arr);
-    free(q);
+    wc_free(alloc, q, sizeof(Queue));
 }
 
 void queue_clear(Queue* q)
@@ -254,7 +260,7 @@ static void queue_compact(Queue* q, u64 new_capacity)
     CHECK_FATAL(new_capacity < q->size, "new_capacity must be >= current size");
 
     // Share the same ops pointer — no callbacks to copy
-    genVec* new_arr = genVec_init(new_capacity, q->arr->data_size, q->arr->ops);
+    genVec* new_arr = genVec_init_alloc(new_capacity, q->arr->data_size, q->arr->ops, q->arr->alloc);
 
     u64 h       = q->head;
     u64 old_cap = genVec_capacity(q->arr);
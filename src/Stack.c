@@ -7,6 +7,11 @@ Stack* stack_create(u64 n, u32 data_size, const container_ops* ops)
     return genVec_init(n, data_size, ops);
 }
 
+Stack* stack_create_alloc(u64 n, u32 data_size, const container_ops* ops, const wc_allocator* alloc)
+{
+    return genVec_init_alloc(n, data_size, ops, alloc);
+}
+
 Stack* stack_create_val(u64 n, const u8* val, u32 data_size, const container_ops* ops)
 {
     return genVec_init_val(n, val, data_size, ops);
@@ -12,6 +12,11 @@
 #define GET_STR_CHAR(s, i) (GET_STR(s)[i])
 #define STR_REMAINING(s)   ((s)->capacity - (s)->size)
 
+// heap buffer through the string's allocator (NULL = heap)
+#define STR_ALLOC(s, n)             ((char*)wc_alloc((s)->alloc, (n)))
+#define STR_REALLOC(s, new_cap)     ((char*)wc_realloc((s)->alloc, (s)->heap, (s)->capacity, (new_cap)))
+#define STR_FREE(s)                 wc_free((s)->alloc, (s)->heap, (s)->capacity)
+
 // Grow if full.
 #define MAYBE_GROW_STR(s)                     \
     do {                                  \
@@ -46,6 +51,7 @@ String* string_create(void)
 
     s->size     = 0;
     s->capacity = STR_SSO_SIZE;
+    s->alloc    = NULL;
 
     return s;
 }
@@ -68,6 +74,7 @@ String* string_from_string(const String* other)
 
     s->size     = 0;
     s->capacity = STR_SSO_SIZE;
+    s->alloc    = NULL;
 
     if (other->size > 0) {
         ensure_capacity(s, other->size);
@@ -79,11 +86,17 @@ String* string_from_string(const String* other)
 }
 
 void string_create_stk(String* s, const char* cstr)
+{
+    string_create_stk_alloc(s, cstr, NULL);
+}
+
+void string_create_stk_alloc(String* s, const char* cstr, const wc_allocator* alloc)
 {
     CHECK_FATAL(!s, "str is null");
 
     s->size     = 0;
     s->capacity = STR_SSO_SIZE;
+    s->alloc    = alloc;
 
     if (!cstr) {
         return;
@@ -111,7 +124,7 @@ void string_destroy_stk(String* s)
     CHECK_FATAL(!s, "str is null");
 
     if (!IS_SSO(s)) {
-        free(s->heap);
+        STR_FREE(s);
         s->heap = NULL;
     }
 
@@ -206,7 +219,7 @@ void string_shrink_to_fit(String* s)
     } // already optimal
 
     if (s->size == 0) {
-        free(s->heap);
+        STR_FREE(s);
         s->heap     = NULL;
         s->capacity = STR_SSO_SIZE;
         return;
@@ -218,7 +231,7 @@ void string_shrink_to_fit(String* s)
         return;
     }
 
-    char* new_data = realloc(s->heap, s->size);
+    char* new_data = STR_REALLOC(s, s->size);
     if (!new_data) {
         WARN("shrink_to_fit realloc failed");
         return;
@@ -586,7 +599,7 @@ static void stk_to_heap(String* s)
 {
     u64 new_cap = (u64)((float)s->capacity * STRING_GROWTH);
 
-    char* new_data = malloc(new_cap);
+    char* new_data = STR_ALLOC(s, new_cap);
     CHECK_FATAL(!new_data, "malloc failed");
 
     str_copy_n(new_data, s->stk, s->size);
@@ -599,7 +612,7 @@ static void heap_to_stk(String* s)
 {
     char tmp[STR_SSO_SIZE];
     str_copy_n(tmp, s->heap, s->size);
-    free(s->heap);
+    STR_FREE(s);
     str_copy_n(s->stk, tmp, s->size);
     s->capacity = STR_SSO_SIZE;
 }
@@ -608,7 +621,7 @@ static void string_grow(String* s)
 {
     u64 new_cap = (u64)((float)s->capacity * STRING_GROWTH);
 
-    char* new_data = realloc(s->heap, new_cap);
+    char* new_data = STR_REALLOC(s, new_cap);
     CHECK_FATAL(!new_data, "realloc failed");
 
     s->heap     = new_data;
@@ -629,13 +642,13 @@ static void ensure_capacity(String* s, u64 needed)
 
     // currently in sso but sso_cap is not enough
     if (IS_SSO(s)) {
-        char* new_data = malloc(new_cap);
+        char* new_data = STR_ALLOC(s, new_cap);
         CHECK_FATAL(!new_data, "malloc failed");
         str_copy_n(new_data, s->stk, s->size);
         s->heap     = new_data;
         s->capacity = new_cap;
     } else {
-        char* new_data = realloc(s->heap, new_cap);
+        char* new_data = STR_REALLOC(s, new_cap);
         CHECK_FATAL(!new_data, "realloc failed");
         s->heap     = new_data;
         s->capacity = new_cap;
@@ -1,6 +1,8 @@
 #include "arena.h"
 #include "wc_errno.h"
 
+#include <string.h>
+
 /* python
 align to 8 bytes
 >>> 4 + 7 & ~(7)
@@ -116,6 +118,37 @@ u8* arena_alloc_aligned(Arena* arena, u64 size, u32 alignment)
     return ptr;
 }
 
+u8* arena_realloc(Arena* arena, u8* ptr, u64 old_size, u64 new_size)
+{
+    CHECK_FATAL(!arena, "arena is null");
+    CHECK_FATAL(new_size == 0, "can't have allocation of size = 0");
+
+    if (!ptr) {
+        return arena_alloc(arena, new_size);
+    }
+
+    // last allocation: move the top instead of copying
+    if (ptr + old_size == ARENA_CURR_IDX_PTR(arena)) {
+        u64 off = (u64)(ptr - arena->base);
+        WC_SET_RET(WC_ERR_FULL, arena->size - off < new_size, NULL);
+
+        arena->idx = off + new_size;
+        return ptr;
+    }
+
+    if (new_size <= old_size) {
+        return ptr;
+    }
+
+    u8* new_ptr = arena_alloc(arena, new_size);
+    if (!new_ptr) {
+        return NULL;
+    }
+    memcpy(new_ptr, ptr, old_size);
+
+    return new_ptr;
+}
+
 u64 arena_get_mark(Arena* arena)
 {
     CHECK_FATAL(!arena, "arena is null");
@@ -134,3 +167,36 @@ void arena_clear_mark(Arena* arena, u64 mark)
 }
 
 
+// WC_ALLOCATOR ADAPTER
+
+static void* arena_alloc_fn(void* ctx, u64 size)
+{
+    return arena_alloc((Arena*)ctx, size);
+}
+
+static void* arena_realloc_fn(void* ctx, void* ptr, u64 old_size, u64 new_size)
+{
+    return arena_realloc((Arena*)ctx, (u8*)ptr, old_size, new_size);
+}
+
+// Only the last allocation can be given back
+static void arena_free_fn(void* ctx, void* ptr, u64 size)
+{
+    Arena* arena = (Arena*)ctx;
+
+    if ((u8*)ptr + size == ARENA_CURR_IDX_PTR(arena)) {
+        arena->idx = (u64)((u8*)ptr - arena->base);
+    }
+}
+
+wc_allocator arena_allocator(Arena* arena)
+{
+    CHECK_FATAL(!arena, "arena is null");
+
+    return (wc_allocator){
+        .alloc_fn   = arena_alloc_fn,
+        .realloc_fn = arena_realloc_fn,
+        .free_fn    = arena_free_fn,
+        .ctx        = arena,
+    };
+}
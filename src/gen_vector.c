@@ -1,11 +1,15 @@
 #include "gen_vector.h"
 #include "wc_errno.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 
 #define GENVEC_MIN_CAPACITY 4
 
+// sorted intersect gallops through the larger side past this size ratio
+#define GENVEC_GALLOP_RATIO 16
+
 
 // MACROS
 
@@ -29,50 +33,79 @@
 
 #define IS_POD(vec) (vec->ops == NULL)
 
+// storage through the vector's allocator (NULL = heap)
+#define VEC_ALLOC(vec, bytes)                  wc_alloc((vec)->alloc, (bytes))
+#define VEC_REALLOC(vec, ptr, old_cap, new_cap) \
+    wc_realloc((vec)->alloc, (ptr), GET_SCALED(vec, old_cap), GET_SCALED(vec, new_cap))
+#define VEC_FREE(vec, ptr, cap)                wc_free((vec)->alloc, (ptr), GET_SCALED(vec, cap))
+
 
 // private functions
 
-static void genVec_grow(genVec* vec);
+static void       genVec_grow(genVec* vec);
+static void       genVec_reserve_extra(genVec* vec, u64 n);
+static void       genVec_copy_range(const genVec* vec, u8* dest, const u8* src, u64 n);
+static inline int genVec_cmp(compare_fn cmp_fn, const u8* x, const u8* y, u32 size);
+static int        genVec_sort_cmp(const void* a, const void* b);
+static u64        genVec_gallop(const genVec* vec, u64 lo, const u8* elm, compare_fn cmp_fn);
+static void       genVec_merge_check(const genVec* out, const genVec* a, const genVec* b);
 
 
 // API Implementation
 
 genVec* genVec_init(u64 n, u32 data_size, const container_ops* ops)
+{
+    return genVec_init_alloc(n, data_size, ops, NULL);
+}
+
+
+void genVec_init_stk(u64 n, u32 data_size, const container_ops* ops, genVec* vec)
+{
+    genVec_init_stk_alloc(n, data_size, ops, NULL, vec);
+}
+
+
+genVec* genVec_init_alloc(u64 n, u32 data_size, const container_ops* ops, const wc_allocator* alloc)
 {
     CHECK_FATAL(data_size == 0, "data_size can't be 0");
 
-    genVec* vec = malloc(sizeof(genVec));
+    genVec* vec = wc_alloc(alloc, sizeof(genVec));
     CHECK_FATAL(!vec, "vec init failed");
 
+    vec->alloc     = alloc;
+    vec->data_size = data_size;
+
     // Only allocate memory if n > 0, otherwise data can be NULL
-    vec->data = (n > 0) ? malloc(data_size * n) : NULL;
+    vec->data = (n > 0) ? VEC_ALLOC(vec, GET_SCALED(vec, n)) : NULL;
 
     if (n > 0 && !vec->data) {
-        free(vec);
+        wc_free(alloc, vec, sizeof(genVec));
         FATAL("data init failed");
     }
 
-    vec->size      = 0;
-    vec->capacity  = n;
-    vec->data_size = data_size;
-    vec->ops       = ops;
+    vec->size     = 0;
+    vec->capacity = n;
+    vec->ops      = ops;
 
     return vec;
 }
 
 
-void genVec_init_stk(u64 n, u32 data_size, const container_ops* ops, genVec* vec)
+void genVec_init_stk_alloc(u64 n, u32 data_size, const container_ops* ops,
+                           const wc_allocator* alloc, genVec* vec)
 {
     CHECK_FATAL(!vec, "vec is null");
     CHECK_FATAL(data_size == 0, "data_size can't be 0");
 
-    vec->data = (n > 0) ? malloc(data_size * n) : NULL;
+    vec->alloc     = alloc;
+    vec->data_size = data_size;
+
+    vec->data = (n > 0) ? VEC_ALLOC(vec, GET_SCALED(vec, n)) : NULL;
     CHECK_FATAL(n > 0 && !vec->data, "data init failed");
 
-    vec->size      = 0;
-    vec->capacity  = n;
-    vec->data_size = data_size;
-    vec->ops       = ops;
+    vec->size     = 0;
+    vec->capacity = n;
+    vec->ops      = ops;
 }
 
 
@@ -157,13 +190,14 @@ void genVec_init_stk_arr(u64 n, u8* arr, u32 data_size, const container_ops* ops
     vec->capacity  = n;
     vec->data_size = data_size;
     vec->ops       = ops;
+    vec->alloc     = NULL;
 }
 
 
 void genVec_destroy(genVec* vec)
 {
     genVec_destroy_stk(vec);
-    free(vec);
+    wc_free(vec->alloc, vec, sizeof(genVec));
 }
 
 
@@ -184,7 +218,7 @@ void genVec_destroy_stk(genVec* vec)
         }
     }
 
-    free(vec->data);
+    VEC_FREE(vec, vec->data, vec->capacity);
     vec->data = NULL;
 }
 
@@ -219,7 +253,7 @@ void genVec_reset(genVec* vec)
         }
     }
 
-    free(vec->data);
+    VEC_FREE(vec, vec->data, vec->capacity);
     vec->data     = NULL;
     vec->size     = 0;
     vec->capacity = 0;
@@ -234,7 +268,7 @@ void genVec_reserve(genVec* vec, u64 new_capacity)
         return;
     }
 
-    u8* new_data = realloc(vec->data, GET_SCALED(vec, new_capacity));
+    u8* new_data = VEC_REALLOC(vec, vec->data, vec->capacity, new_capacity);
     CHECK_FATAL(!new_data, "realloc failed");
 
     vec->data     = new_data;
@@ -281,7 +315,7 @@ void genVec_shrink_to_fit(genVec* vec)
         return;
     }
 
-    u8* new_data = realloc(vec->data, GET_SCALED(vec, min_cap));
+    u8* new_data = VEC_REALLOC(vec, vec->data, curr_cap, min_cap);
     CHECK_FATAL(!new_data, "data realloc failed");
 
     vec->data     = new_data;
@@ -336,6 +370,125 @@ void genVec_push_move(genVec* vec, u8** data)
 }
 
 
+// The slot is raw memory, counted in size straight away: the caller builds
+// the element in it before anything else reads or destroys the vec.
+u8* genVec_emplace_back(genVec* vec)
+{
+    CHECK_FATAL(!vec, "vec is null");
+
+    MAYBE_GROW(vec);
+
+    return GET_PTR(vec, vec->size++);
+}
+
+
+u8* genVec_emplace_n(genVec* vec, u64 n)
+{
+    CHECK_FATAL(!vec, "vec is null");
+
+    if (n == 0) {
+        return NULL;
+    }
+
+    genVec_reserve_extra(vec, n);
+
+    u8* first = GET_PTR(vec, vec->size);
+    vec->size += n;
+    return first;
+}
+
+
+// Bulk appends: one capacity check and reserve for all n, then a single
+// memcpy (POD / no copy_fn) or one copy_fn loop
+
+void genVec_extend(genVec* vec, const u8* arr, u64 n)
+{
+    CHECK_FATAL(!vec, "vec is null");
+    CHECK_FATAL(!arr && n > 0, "arr is null");
+
+    if (n == 0) {
+        return;
+    }
+
+    genVec_reserve_extra(vec, n);
+    genVec_copy_range(vec, GET_PTR(vec, vec->size), arr, n);
+    vec->size += n;
+}
+
+
+void genVec_extend_move(genVec* vec, u8* arr, u64 n)
+{
+    CHECK_FATAL(!vec, "vec is null");
+    CHECK_FATAL(!arr && n > 0, "arr is null");
+
+    if (n == 0) {
+        return;
+    }
+
+    genVec_reserve_extra(vec, n);
+    memcpy(GET_PTR(vec, vec->size), arr, GET_SCALED(vec, n));
+    vec->size += n;
+}
+
+
+void genVec_append_vec(genVec* dest, const genVec* src)
+{
+    CHECK_FATAL(!dest || !src, "null arg");
+    CHECK_FATAL(dest->data_size != src->data_size, "data_size mismatch");
+
+    u64 n = src->size;
+    if (n == 0) {
+        return;
+    }
+
+    // reserve first: when dest == src the realloc moves what is read below
+    genVec_reserve_extra(dest, n);
+    genVec_copy_range(dest, GET_PTR(dest, dest->size), src->data, n);
+    dest->size += n;
+}
+
+
+void genVec_resize(genVec* vec, u64 n, const u8* fill)
+{
+    CHECK_FATAL(!vec, "vec is null");
+
+    if (n <= vec->size) {
+        delete_fn del = VEC_DEL_FN(vec);
+        if (del) {
+            for (u64 i = n; i < vec->size; i++) {
+                del(GET_PTR(vec, i));
+            }
+        }
+        vec->size = n;
+        return;
+    }
+
+    genVec_reserve(vec, n);
+
+    u8*     first = GET_PTR(vec, vec->size);
+    u64     added = n - vec->size;
+    copy_fn copy  = VEC_COPY_FN(vec);
+
+    if (!fill) {
+        memset(first, 0, GET_SCALED(vec, added));
+    } else if (copy) {
+        for (u64 i = 0; i < added; i++) {
+            copy(first + GET_SCALED(vec, i), fill);
+        }
+    } else {
+        // one element, then double the filled prefix: log2(added) memcpys
+        memcpy(first, fill, vec->data_size);
+        u64 done = 1;
+        while (done < added) {
+            u64 chunk = done < added - done ? done : added - done;
+            memcpy(first + GET_SCALED(vec, done), first, GET_SCALED(vec, chunk));
+            done += chunk;
+        }
+    }
+    vec->size = n;
+}
+
+
 void genVec_pop(genVec* vec, u8* popped)
 {
     CHECK_FATAL(!vec, "vec is null");
@@ -736,6 +889,125 @@ u64 genVec_find(const genVec* vec, u8* elm, compare_fn cmp_fn)
 }
 
 
+// qsort has no context argument: the comparator and element size ride
+// along in thread-locals, so concurrent sorts in other threads are fine
+static _Thread_local compare_fn sort_cmp_fn;
+static _Thread_local u64        sort_size;
+
+void genVec_sort(genVec* vec, compare_fn cmp_fn)
+{
+    CHECK_FATAL(!vec, "vec is null");
+
+    if (vec->size < 2) {
+        return;
+    }
+
+    sort_cmp_fn = cmp_fn;
+    sort_size   = vec->data_size;
+    qsort(vec->data, vec->size, vec->data_size, genVec_sort_cmp);
+}
+
+
+void genVec_sorted_union(genVec* out, const genVec* a, const genVec* b, compare_fn cmp_fn)
+{
+    genVec_merge_check(out, a, b);
+    genVec_clear(out);
+    genVec_reserve(out, a->size + b->size);
+
+    u64 i = 0, j = 0;
+    while (i < a->size && j < b->size) {
+        const u8* x = GET_PTR(a, i);
+        const u8* y = GET_PTR(b, j);
+        int       c = genVec_cmp(cmp_fn, x, y, a->data_size);
+
+        if (c <= 0) {
+            genVec_push(out, x);
+            i++;
+            j += (c == 0);
+        } else {
+            genVec_push(out, y);
+            j++;
+        }
+    }
+    for (; i < a->size; i++) {
+        genVec_push(out, GET_PTR(a, i));
+    }
+    for (; j < b->size; j++) {
+        genVec_push(out, GET_PTR(b, j));
+    }
+}
+
+
+void genVec_sorted_intersect(genVec* out, const genVec* a, const genVec* b, compare_fn cmp_fn)
+{
+    genVec_merge_check(out, a, b);
+    genVec_clear(out);
+
+    const genVec* small = a->size <= b->size ? a : b;
+    const genVec* large = small == a ? b : a;
+
+    // lopsided: look each small elm up in the large side instead of
+    // walking all of it
+    if (small->size * GENVEC_GALLOP_RATIO < large->size) {
+        u64 lo = 0;
+        for (u64 i = 0; i < small->size && lo < large->size; i++) {
+            const u8* x = GET_PTR(small, i);
+            lo          = genVec_gallop(large, lo, x, cmp_fn);
+            if (lo < large->size) {
+                const u8* y = GET_PTR(large, lo);
+                if (genVec_cmp(cmp_fn, x, y, a->data_size) == 0) {
+                    genVec_push(out, x);
+                    lo++;
+                }
+            }
+        }
+        return;
+    }
+
+    u64 i = 0, j = 0;
+    while (i < a->size && j < b->size) {
+        const u8* x = GET_PTR(a, i);
+        const u8* y = GET_PTR(b, j);
+        int       c = genVec_cmp(cmp_fn, x, y, a->data_size);
+
+        if (c == 0) {
+            genVec_push(out, x);
+            i++;
+            j++;
+        } else if (c < 0) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+}
+
+
+void genVec_sorted_difference(genVec* out, const genVec* a, const genVec* b, compare_fn cmp_fn)
+{
+    genVec_merge_check(out, a, b);
+    genVec_clear(out);
+
+    u64 i = 0, j = 0;
+    while (i < a->size && j < b->size) {
+        const u8* x = GET_PTR(a, i);
+        const u8* y = GET_PTR(b, j);
+        int       c = genVec_cmp(cmp_fn, x, y, a->data_size);
+
+        if (c < 0) {
+            genVec_push(out, x);
+            i++;
+        } else {
+            i += (c == 0);
+            j++;
+        }
+    }
+    for (; i < a->size; i++) {
+        genVec_push(out, GET_PTR(a, i));
+    }
+}
+
+
 genVec* genVec_subarr(const genVec* vec, u64 start, u64 len)
 {
     CHECK_FATAL(!vec, "vec is null");
@@ -793,12 +1065,18 @@ void genVec_copy(genVec* dest, const genVec* src)
 
     genVec_destroy_stk(dest);
 
-    // Copy all fields (including ops pointer)
+    // Copy all fields (including ops pointer), dest keeps its allocator
+    const wc_allocator* alloc = dest->alloc;
     memcpy(dest, src, sizeof(genVec));
+    dest->alloc = alloc;
 
     // TODO: fix for copying into uninited memory ?
     // dest->data = calloc(src->capacity, src->data_size);
-    dest->data = malloc(GET_SCALED(src, src->capacity));
+    if (src->capacity == 0) {
+        dest->data = NULL;
+        return;
+    }
+    dest->data = VEC_ALLOC(dest, GET_SCALED(src, src->capacity));
     CHECK_FATAL(!dest->data, "dest data calloc failed");
 
     if (IS_POD(src)) {
@@ -830,11 +1108,86 @@ void genVec_move(genVec* dest, genVec** src)
     memcpy(dest, *src, sizeof(genVec));
 
     (*src)->data = NULL;
-    free(*src);
+    wc_free(dest->alloc, *src, sizeof(genVec));
     *src = NULL;
 }
 
 
+// cmp_fn, or memcmp when it is NULL
+static inline int genVec_cmp(compare_fn cmp_fn, const u8* x, const u8* y, u32 size)
+{
+    return cmp_fn ? cmp_fn(x, y, size) : memcmp(x, y, size);
+}
+
+static int genVec_sort_cmp(const void* a, const void* b)
+{
+    return genVec_cmp(sort_cmp_fn, a, b, (u32)sort_size);
+}
+
+// First index >= lo whose element is not less than elm: steps of 1, 2, 4...
+// to bracket it, then a binary search inside the bracket.
+static u64 genVec_gallop(const genVec* vec, u64 lo, const u8* elm, compare_fn cmp_fn)
+{
+    u64 step = 1;
+    u64 hi   = lo;
+    while (hi < vec->size && genVec_cmp(cmp_fn, GET_PTR(vec, hi), elm, vec->data_size) < 0) {
+        lo = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    if (hi > vec->size) {
+        hi = vec->size;
+    }
+
+    // answer in [lo, hi]
+    while (lo < hi) {
+        u64 mid = lo + ((hi - lo) / 2);
+        if (genVec_cmp(cmp_fn, GET_PTR(vec, mid), elm, vec->data_size) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void genVec_merge_check(const genVec* out, const genVec* a, const genVec* b)
+{
+    CHECK_FATAL(!out || !a || !b, "null arg");
+    CHECK_FATAL(out == a || out == b, "out must be a separate vec");
+    CHECK_FATAL(a->data_size != b->data_size || out->data_size != a->data_size,
+                "vecs differ in data size");
+}
+
+
+// Room for n more elements. Grows geometrically like genVec_grow, so a
+// run of small extends stays amortized O(1) per element.
+static void genVec_reserve_extra(genVec* vec, u64 n)
+{
+    u64 need = vec->size + n;
+    if (need <= vec->capacity) {
+        return;
+    }
+
+    u64 grown = (u64)((float)vec->capacity * GENVEC_GROWTH);
+    genVec_reserve(vec, grown > need ? grown : need);
+}
+
+// n elements from src into raw slots at dest, COPY semantics
+static void genVec_copy_range(const genVec* vec, u8* dest, const u8* src, u64 n)
+{
+    copy_fn copy = VEC_COPY_FN(vec);
+
+    if (!copy) {
+        memcpy(dest, src, GET_SCALED(vec, n));
+        return;
+    }
+    for (u64 i = 0; i < n; i++) {
+        copy(dest + GET_SCALED(vec, i), src + GET_SCALED(vec, i));
+    }
+}
+
+
 static void genVec_grow(genVec* vec)
 {
     u64 new_cap;
@@ -847,7 +1200,7 @@ static void genVec_grow(genVec* vec)
         }
     }
 
-    u8* new_data = realloc(vec->data, GET_SCALED(vec, new_cap));
+    u8* new_data = VEC_REALLOC(vec, vec->data, vec->capacity, new_cap);
     CHECK_FATAL(!new_data, "data realloc failed");
 
     vec->data     = new_data;
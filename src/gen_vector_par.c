@@ -0,0 +1,374 @@
+#include "gen_vector_par.h"
+
+#include <string.h>
+
+
+// chunks per thread for the element-wise algorithms
+#define PAR_CHUNKS_PER_THREAD 4
+
+// most chunks a reduce splits into: a fixed count, so the chunk bounds (and
+// any rounding in fold) depend on the size alone, not on the pool
+#define PAR_REDUCE_CHUNKS 64
+
+// first element of chunk t out of k
+#define CHUNK_BEGIN(n, t, k) ((n) * (t) / (k))
+
+#define ELM_PTR(base, i, size) ((base) + ((u64)(i) * (size)))
+
+
+typedef struct {
+    genVec*    vec;
+    u64        chunks;
+    vec_elm_fn fn;
+    void*      ctx;
+} par_each_job;
+
+typedef struct {
+    const genVec* src;
+    u8*           out;
+    u32           out_size;
+    u64           chunks;
+    vec_map_fn    fn;
+    void*         ctx;
+} par_map_job;
+
+typedef struct {
+    const genVec* vec;
+    u8*           partials; // one acc per chunk
+    u32           acc_size;
+    u64           chunks;
+    vec_fold_fn   fold;
+    void*         ctx;
+} par_reduce_job;
+
+typedef struct {
+    const genVec* vec;
+    u8*           src;    // runs are read from here...
+    u8*           dst;    // ...and merged into here
+    compare_fn    cmp_fn;
+    u64*          bounds; // run r is [bounds[r], bounds[r + 1])
+    u64           runs;
+    u64           pieces; // tasks per pair of runs
+} par_sort_job;
+
+
+/*
+====================PRIVATE====================
+*/
+
+// Chunks for n elements: per_thread per thread, none under GENVEC_PAR_MIN_CHUNK
+static u64 par_chunks(const thread_pool* pool, u64 n, u64 per_thread)
+{
+    if (!pool) {
+        return 1;
+    }
+
+    u64 chunks = thread_pool_threads(pool) * per_thread;
+    u64 most   = n / GENVEC_PAR_MIN_CHUNK;
+    if (chunks > most) {
+        chunks = most;
+    }
+    return chunks ? chunks : 1;
+}
+
+// Reduce chunks for n elements, the same for every pool (and for none)
+static u64 par_reduce_chunks(u64 n)
+{
+    u64 chunks = n / GENVEC_PAR_MIN_CHUNK;
+    if (chunks > PAR_REDUCE_CHUNKS) {
+        chunks = PAR_REDUCE_CHUNKS;
+    }
+    return chunks ? chunks : 1;
+}
+
+static void par_run(thread_pool* pool, u64 n_tasks, thread_pool_fn fn, void* job)
+{
+    if (pool) {
+        thread_pool_run(pool, n_tasks, fn, job);
+        return;
+    }
+    for (u64 t = 0; t < n_tasks; t++) {
+        fn(job, t);
+    }
+}
+
+static inline int par_cmp(compare_fn cmp_fn, const u8* a, const u8* b, u32 size)
+{
+    return cmp_fn ? cmp_fn(a, b, size) : memcmp(a, b, size);
+}
+
+// fixed sizes turn into a single load / store
+static inline void par_copy_elm(u8* dest, const u8* src, u32 size)
+{
+    switch (size) {
+        case 4:  memcpy(dest, src, 4); break;
+        case 8:  memcpy(dest, src, 8); break;
+        default: memcpy(dest, src, size); break;
+    }
+}
+
+
+static void par_each_task(void* arg, u64 t)
+{
+    par_each_job* job = arg;
+    genVec*       vec = job->vec;
+
+    u64 end = CHUNK_BEGIN(vec->size, t + 1, job->chunks);
+    for (u64 i = CHUNK_BEGIN(vec->size, t, job->chunks); i < end; i++) {
+        job->fn(ELM_PTR(vec->data, i, vec->data_size), job->ctx);
+    }
+}
+
+static void par_map_task(void* arg, u64 t)
+{
+    par_map_job*  job = arg;
+    const genVec* src = job->src;
+
+    u64 end = CHUNK_BEGIN(src->size, t + 1, job->chunks);
+    for (u64 i = CHUNK_BEGIN(src->size, t, job->chunks); i < end; i++) {
+        job->fn(ELM_PTR(job->out, i, job->out_size), ELM_PTR(src->data, i, src->data_size),
+                job->ctx);
+    }
+}
+
+static void par_reduce_task(void* arg, u64 t)
+{
+    par_reduce_job* job = arg;
+    const genVec*   vec = job->vec;
+    u8*             acc = ELM_PTR(job->partials, t, job->acc_size);
+
+    u64 end = CHUNK_BEGIN(vec->size, t + 1, job->chunks);
+    for (u64 i = CHUNK_BEGIN(vec->size, t, job->chunks); i < end; i++) {
+        job->fold(acc, ELM_PTR(vec->data, i, vec->data_size), job->ctx);
+    }
+}
+
+
+// Sort run t in place, through genVec_sort on a vec that borrows its slice
+static void par_sort_run_task(void* arg, u64 t)
+{
+    par_sort_job* job = arg;
+    const genVec* vec = job->vec;
+    u64           n   = job->bounds[t + 1] - job->bounds[t];
+
+    genVec view = {
+        .data      = ELM_PTR(vec->data, job->bounds[t], vec->data_size),
+        .ops       = vec->ops,
+        .alloc     = NULL,
+        .size      = n,
+        .capacity  = n,
+        .data_size = vec->data_size,
+    };
+    genVec_sort(&view, job->cmp_fn);
+}
+
+// How many of a's elements come first in the merged output's first d
+// (a before b on ties, which keeps the merge stable)
+static u64 par_corank(u64 d, const u8* a, u64 na, const u8* b, u64 nb, u32 size, compare_fn cmp_fn)
+{
+    u64 lo = d > nb ? d - nb : 0;
+    u64 hi = d < na ? d : na;
+
+    while (lo < hi) {
+        u64 i = lo + ((hi - lo) / 2);
+        u64 j = d - i;
+        // b[j - 1] not below a[i]: a[i] belongs in the first d as well
+        if (par_cmp(cmp_fn, ELM_PTR(b, j - 1, size), ELM_PTR(a, i, size), size) >= 0) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+// Piece t % pieces of the merge of run pair t / pieces. A run without a
+// partner (odd run count) is "merged" with an empty one, i.e. copied.
+static void par_merge_task(void* arg, u64 t)
+{
+    par_sort_job* job  = arg;
+    u32           size = job->vec->data_size;
+    u64           pair = t / job->pieces;
+    u64           part = t % job->pieces;
+
+    u64 r   = pair * 2;
+    u64 lo  = job->bounds[r];
+    u64 mid = job->bounds[(r + 1 < job->runs) ? r + 1 : job->runs];
+    u64 hi  = job->bounds[(r + 2 < job->runs) ? r + 2 : job->runs];
+
+    const u8* a  = ELM_PTR(job->src, lo, size);
+    const u8* b  = ELM_PTR(job->src, mid, size);
+    u64       na = mid - lo;
+    u64       nb = hi - mid;
+
+    u64 d0 = CHUNK_BEGIN(hi - lo, part, job->pieces);
+    u64 d1 = CHUNK_BEGIN(hi - lo, part + 1, job->pieces);
+    u64 i  = par_corank(d0, a, na, b, nb, size, job->cmp_fn);
+    u64 i1 = par_corank(d1, a, na, b, nb, size, job->cmp_fn);
+    u64 j  = d0 - i;
+    u64 j1 = d1 - i1;
+
+    u8* out = ELM_PTR(job->dst, lo + d0, size);
+    while (i < i1 && j < j1) {
+        if (par_cmp(job->cmp_fn, ELM_PTR(b, j, size), ELM_PTR(a, i, size), size) < 0) {
+            par_copy_elm(out, ELM_PTR(b, j++, size), size);
+        } else {
+            par_copy_elm(out, ELM_PTR(a, i++, size), size);
+        }
+        out += size;
+    }
+    memcpy(out, ELM_PTR(a, i, size), (i1 - i) * size);
+    out += (i1 - i) * size;
+    memcpy(out, ELM_PTR(b, j, size), (j1 - j) * size);
+}
+
+// One merge round: runs pairs from src into dst with every thread busy,
+// then halve the run list
+static void par_merge_round(thread_pool* pool, par_sort_job* job, u64 threads)
+{
+    u64 pairs   = (job->runs + 1) / 2;
+    job->pieces = (threads + pairs - 1) / pairs;
+
+    par_run(pool, pairs * job->pieces, par_merge_task, job);
+
+    u64 n = job->bounds[job->runs];
+    for (u64 p = 0; p < pairs; p++) {
+        job->bounds[p] = job->bounds[p * 2];
+    }
+    job->bounds[pairs] = n;
+    job->runs          = pairs;
+
+    u8* tmp  = job->src;
+    job->src = job->dst;
+    job->dst = tmp;
+}
+
+
+/*
+====================PUBLIC====================
+*/
+
+void genVec_par_for_each(thread_pool* pool, genVec* vec, vec_elm_fn fn, void* ctx)
+{
+    CHECK_FATAL(!vec, "vec is null");
+    CHECK_FATAL(!fn, "fn is null");
+
+    par_each_job job = {
+        .vec    = vec,
+        .chunks = par_chunks(pool, vec->size, PAR_CHUNKS_PER_THREAD),
+        .fn     = fn,
+        .ctx    = ctx,
+    };
+    par_run(pool, job.chunks, par_each_task, &job);
+}
+
+
+void genVec_par_map(thread_pool* pool, genVec* dest, const genVec* src, vec_map_fn fn, void* ctx)
+{
+    CHECK_FATAL(!dest || !src, "null arg");
+    CHECK_FATAL(!fn, "fn is null");
+    CHECK_FATAL(dest == src, "dest must be a separate vec");
+
+    genVec_clear(dest);
+    if (src->size == 0) {
+        return;
+    }
+
+    par_map_job job = {
+        .src      = src,
+        .out      = genVec_emplace_n(dest, src->size),
+        .out_size = dest->data_size,
+        .chunks   = par_chunks(pool, src->size, PAR_CHUNKS_PER_THREAD),
+        .fn       = fn,
+        .ctx      = ctx,
+    };
+    par_run(pool, job.chunks, par_map_task, &job);
+}
+
+
+void genVec_par_reduce(thread_pool* pool, const genVec* vec, u8* acc, u32 acc_size,
+                       vec_fold_fn fold, vec_fold_fn combine, void* ctx)
+{
+    CHECK_FATAL(!vec || !acc, "null arg");
+    CHECK_FATAL(!fold, "fold is null");
+    CHECK_FATAL(acc_size == 0, "acc_size can't be 0");
+    CHECK_FATAL(!combine && acc_size != vec->data_size,
+                "combine can only default to fold when acc_size == data_size");
+
+    if (!combine) {
+        combine = fold;
+    }
+
+    par_reduce_job job = {
+        .vec      = vec,
+        .acc_size = acc_size,
+        .chunks   = par_reduce_chunks(vec->size),
+        .fold     = fold,
+        .ctx      = ctx,
+    };
+
+    // one chunk: fold straight into acc
+    if (job.chunks == 1) {
+        for (u64 i = 0; i < vec->size; i++) {
+            fold(acc, ELM_PTR(vec->data, i, vec->data_size), ctx);
+        }
+        return;
+    }
+
+    job.partials = malloc(job.chunks * acc_size);
+    CHECK_FATAL(!job.partials, "partials malloc failed");
+    for (u64 t = 0; t < job.chunks; t++) {
+        memcpy(ELM_PTR(job.partials, t, acc_size), acc, acc_size);
+    }
+
+    par_run(pool, job.chunks, par_reduce_task, &job);
+
+    memcpy(acc, job.partials, acc_size);
+    for (u64 t = 1; t < job.chunks; t++) {
+        combine(acc, ELM_PTR(job.partials, t, acc_size), ctx);
+    }
+    free(job.partials);
+}
+
+
+void genVec_par_sort(thread_pool* pool, genVec* vec, compare_fn cmp_fn)
+{
+    CHECK_FATAL(!vec, "vec is null");
+
+    u64 threads = pool ? thread_pool_threads(pool) : 1;
+    u64 runs    = par_chunks(pool, vec->size, 1);
+    if (runs <= 1) {
+        genVec_sort(vec, cmp_fn);
+        return;
+    }
+
+    u64* bounds  = malloc((runs + 1) * sizeof(u64));
+    u8*  scratch = malloc(vec->size * vec->data_size);
+    CHECK_FATAL(!bounds || !scratch, "sort buffers malloc failed");
+
+    for (u64 r = 0; r <= runs; r++) {
+        bounds[r] = CHUNK_BEGIN(vec->size, r, runs);
+    }
+
+    par_sort_job job = {
+        .vec    = vec,
+        .src    = vec->data,
+        .dst    = scratch,
+        .cmp_fn = cmp_fn,
+        .bounds = bounds,
+        .runs   = runs,
+    };
+    par_run(pool, runs, par_sort_run_task, &job);
+
+    while (job.runs > 1) {
+        par_merge_round(pool, &job, threads);
+    }
+    // an odd number of rounds leaves the result in scratch: one more
+    // "round" over the single run copies it back with every thread
+    if (job.src != vec->data) {
+        par_merge_round(pool, &job, threads);
+    }
+
+    free(scratch);
+    free(bounds);
+}
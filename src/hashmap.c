@@ -1,4 +1,5 @@
 #include "hashmap.h"
+#include "map_snapshot.h"
 
 #include <string.h>
 
@@ -6,43 +7,84 @@
 #define GET_KEY(map, i) ((map)->keys + ((u64)(map)->key_size * (i)))
 #define GET_PSL(map, i) ((map)->psls + (i))
 #define GET_VAL(map, i) ((map)->vals + ((u64)(map)->val_size * (i)))
+#define GET_HSH(map, i) ((map)->hashes + (i))
 
 // capacity is always power-of-2 — use bitmask instead of %
 #define MAP_MASK(map)     ((map)->capacity - 1)
-#define MAP_IDX(map, key) ((map)->hash_fn((key), (map)->key_size) & MAP_MASK(map))
+#define MAP_HASH(map, key)  map_seed_mix((map)->hash_fn((key), (map)->key_size), (map)->seed)
+#define MAP_HOME(map, hash) ((hash) & MAP_MASK(map))
 #define MAP_NEXT(map, i)  (((i) + 1) & MAP_MASK(map))
 
 // PSL 0 == empty bucket; stored PSL is (real_psl + 1), starting at 1
 #define BUCKET_EMPTY 0
 
-// scratch layout:
-//   STAGE region (first half)  — used by hashmap_put to copy incoming key/val
-//     [0                         ..  ALIGN8(key_size))             = STAGE_KEY
-//     [ALIGN8(key_size)          ..  ALIGN8(key_size) + val_size)  = STAGE_VAL
-//   SWAP region (second half)  — used by map_insert for Robin Hood evictions
-//     [ALIGN8(key_size)+val_size ..  +ALIGN8(key_size))            = SWAP_KEY
-//     [+ALIGN8(key_size)         ..  +val_size)                    = SWAP_VAL
-//
-// The two regions must NOT overlap: map_insert is called with pointers INTO
-// the STAGE region, and it writes displaced residents into the SWAP region.
-// Total: 2 * (ALIGN8(key_size) + val_size) bytes.
-#define STAGE_KEY(map) ((map)->scratch)
-#define STAGE_VAL(map) ((map)->scratch + ALIGN8((map)->key_size))
-#define SWAP_KEY(map)  ((map)->scratch + ALIGN8((map)->key_size) + (map)->val_size)
-#define SWAP_VAL(map)  ((map)->scratch + ALIGN8((map)->key_size) + (map)->val_size + ALIGN8((map)->key_size))
+// batch APIs hash and prefetch this many keys before resolving any probe
+#define MAP_BATCH 16
+
+// hash cache keeps the low 32 bits — enough to place entries up to 2^32 buckets
+#define MAP_HASH_CACHE_MAX_CAP (1ULL << 32)
+
+// hashmap_from_vecs(sort = 1) orders keys by the top bits of their home
+// bucket — enough for sequential writes without a full sort of the hashes
+#define MAP_SORT_BINS (1ULL << 16)
+
+// old buckets moved per put/del during an incremental resize. Anything >= 2
+// drains the old table before the new one can fill up to its own grow point;
+// every moved entry is a cache miss in the new table, so keep it small.
+#define MAP_MIGRATE_STEP 8
+
+// fresh seeds tried by a rehash that keeps overflowing psls before it
+// doubles the table on every further try as well
+#define MAP_RESEED_TRIES 4
 
 #define IS_POD_K(map) (map->key_ops == NULL)
 #define IS_POD_V(map) (map->val_ops == NULL)
 
+// puts and dels write the tables in place, which a snapshot mapping only
+// allows once promoted
+#define MAP_CHECK_WRITABLE(map) \
+    CHECK_FATAL((map)->read_only, "map is a read-only snapshot, call hashmap_promote first")
+
+// counters are bookkeeping, not map state: const lookups bump them too
+#define MAP_COUNT(map, field, n) MAP_STAT_ADD(&((hashmap*)(map))->counters, field, n)
+
 
 /*
 ====================PRIVATE DECLARATIONS====================
 */
 
-static u64         map_lookup(const hashmap* map, const u8* key, LOOKUP_RES* res, u8* out_psl);
-static void        map_insert(hashmap* map, u8* key, u8* val, u8 psl, u64 idx);
+static hashmap*    map_create(Arena* arena, u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                              compare_fn cmp_fn, const container_ops* key_ops,
+                              const container_ops* val_ops);
+static inline u8*  map_alloc(const hashmap* map, u64 size);
+static inline u8*  map_calloc(const hashmap* map, u64 size);
+static inline void map_free(const hashmap* map, void* ptr);
+static inline void map_drop_snapshot(hashmap* map);
+static u64         map_lookup(const hashmap* map, const u8* key, u64 hash, LOOKUP_RES* res, u8* out_psl);
+static u8*         map_find_val(const hashmap* map, const u8* key, u64 hash);
+static b8          map_put_hashed(hashmap* map, const u8* key, const u8* val, u64 hash);
+static b8          map_get_hashed(const hashmap* map, const u8* key, u8* val, u64 hash);
+static b8          map_put_moved(hashmap* map, u8* key, u8* val, u64 hash);
+static inline void map_prefetch(const hashmap* map, u64 hash, b8 with_val);
+static u64         map_insert_pos(const hashmap* map, u64 idx, u8* out_psl);
+static void        map_insert(hashmap* map, u8 psl, u64 idx, u64 hash);
+static void        map_erase(hashmap* map, u64 slot);
+static inline b8   map_entry_slot(hashmap* map, const u8* key, u64 hash, u64* slot);
+static inline void map_grow(hashmap* map);
 static inline void map_maybe_resize(hashmap* map);
+static inline void map_maybe_shrink(hashmap* map);
 static void        map_resize(hashmap* map, u64 new_capacity);
+static void        map_rehash(hashmap* map, u64 new_capacity, u64 seed);
+static b8          map_rehash_from(hashmap* map, const hashmap* src, b8 cached);
+static inline void map_check_overflow(hashmap* map);
+static void        map_grow_incremental(hashmap* map);
+static inline void map_migrate_step(hashmap* map, const u8* key, u64 hash);
+static void        map_migrate(hashmap* map, u64 buckets);
+static inline void map_migrate_all(hashmap* map);
+static b8          map_lookup_old(const hashmap* map, const u8* key, u64 hash, u64* slot);
+static void        map_move_in(hashmap* map, u64 old_slot);
+static inline u64  map_old_hash(const hashmap* map, u64 old_slot);
+static genVec*     map_export(const hashmap* map, b8 vals);
 
 
 /*
@@ -51,24 +93,43 @@ static void        map_resize(hashmap* map, u64 new_capacity);
 
 hashmap* hashmap_create(u32 key_size, u32 val_size, custom_hash_fn hash_fn, compare_fn cmp_fn,
                         const container_ops* key_ops, const container_ops* val_ops)
+{
+    return map_create(NULL, key_size, val_size, hash_fn, cmp_fn, key_ops, val_ops);
+}
+
+
+// Same as hashmap_create, but the map struct and every table array come from
+// arena. Nothing is freed individually: destroy only runs del_fn on owned
+// keys/vals, and the memory goes back with arena_clear / arena_release.
+hashmap* hashmap_create_arena(Arena* arena, u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                              compare_fn cmp_fn, const container_ops* key_ops,
+                              const container_ops* val_ops)
+{
+    CHECK_FATAL(!arena, "arena is null");
+
+    return map_create(arena, key_size, val_size, hash_fn, cmp_fn, key_ops, val_ops);
+}
+
+
+static hashmap* map_create(Arena* arena, u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                           compare_fn cmp_fn, const container_ops* key_ops,
+                           const container_ops* val_ops)
 {
     CHECK_FATAL(key_size == 0 || val_size == 0, "key/val size can't be 0");
 
-    hashmap* map = malloc(sizeof(hashmap));
+    hashmap* map = arena ? ARENA_ALLOC(arena, hashmap) : malloc(sizeof(hashmap));
     CHECK_FATAL(!map, "map malloc failed");
+    map->arena = arena;
 
     // map->keys = calloc(HASHMAP_INIT_CAPACITY, key_size);
-    map->keys = malloc((u64)HASHMAP_INIT_CAPACITY * key_size);
+    map->keys = map_alloc(map, (u64)HASHMAP_INIT_CAPACITY * key_size);
     CHECK_FATAL(!map->keys, "keys calloc failed");
-    map->psls = calloc(HASHMAP_INIT_CAPACITY, sizeof(u8));
+    map->psls = map_calloc(map, HASHMAP_INIT_CAPACITY * sizeof(u8));
     CHECK_FATAL(!map->psls, "psls calloc failed");
     // map->vals = calloc(HASHMAP_INIT_CAPACITY, val_size);
-    map->vals = malloc((u64)HASHMAP_INIT_CAPACITY * val_size);
+    map->vals = map_alloc(map, (u64)HASHMAP_INIT_CAPACITY * val_size);
     CHECK_FATAL(!map->vals, "vals calloc failed");
 
-    map->scratch = malloc(2 * (ALIGN8(key_size) + val_size));
-    CHECK_FATAL(!map->scratch, "scratch malloc failed");
-
     map->size     = 0;
     map->capacity = HASHMAP_INIT_CAPACITY;
     map->key_size = key_size;
@@ -76,10 +137,33 @@ hashmap* hashmap_create(u32 key_size, u32 val_size, custom_hash_fn hash_fn, comp
 
     map->hash_fn = hash_fn ? hash_fn : wyhash;
     map->cmp_fn  = cmp_fn ? cmp_fn : default_compare;
+    map->seed    = WC_MAP_SEEDED ? map_seed_random() : 0;
+
+    map->max_load     = MAP_LOAD_PCT(LOAD_FACTOR_GROW);
+    map->min_load     = 0;
+    map->psl_overflow = 0;
+    map->defer_reseed = 0;
+    map->psl_limit    = RH_PSL_LIMIT;
 
     map->key_ops = key_ops;
     map->val_ops = val_ops;
 
+    map->hashes = NULL;
+    if (HASHMAP_HASH_CACHE) {
+        hashmap_set_hash_cache(map, 1);
+    }
+
+    map->old           = NULL;
+    map->migrate_start = 0;
+    map->migrated      = 0;
+    map->incremental   = HASHMAP_INCREMENTAL;
+
+    map->snapshot     = NULL;
+    map->snapshot_len = 0;
+    map->read_only    = 0;
+
+    memset(&map->counters, 0, sizeof(map->counters));
+
     return map;
 }
 
@@ -106,11 +190,17 @@ void hashmap_destroy(hashmap* map)
         }
     }
 
-    free(map->keys);
-    free(map->psls);
-    free(map->vals);
-    free(map->scratch);
-    free(map);
+    // entries not yet moved out of the old table are still owned there
+    if (map->old) {
+        hashmap_destroy(map->old);
+    }
+
+    map_free(map, map->keys);
+    map_free(map, map->psls);
+    map_free(map, map->vals);
+    map_free(map, map->hashes);
+    map_drop_snapshot(map);
+    map_free(map, map);
 }
 
 static void hashmap_destroy_stk(hashmap* map)
@@ -135,10 +225,16 @@ static void hashmap_destroy_stk(hashmap* map)
         }
     }
 
-    free(map->keys);
-    free(map->psls);
-    free(map->vals);
-    free(map->scratch);
+    if (map->old) {
+        hashmap_destroy(map->old);
+        map->old = NULL;
+    }
+
+    map_free(map, map->keys);
+    map_free(map, map->psls);
+    map_free(map, map->vals);
+    map_free(map, map->hashes);
+    map_drop_snapshot(map);
 }
 
 
@@ -150,9 +246,28 @@ b8 hashmap_put(hashmap* map, const u8* key, const u8* val)
 {
     CHECK_FATAL(!map || !key || !val, "args null");
 
+    return map_put_hashed(map, key, val, MAP_HASH(map, key));
+}
+
+
+b8 hashmap_put_with_hash(hashmap* map, const u8* key, const u8* val, u64 hash)
+{
+    CHECK_FATAL(!map || !key || !val, "args null");
+
+    return map_put_hashed(map, key, val, hash);
+}
+
+
+// hashmap_put with the hash already computed
+static b8 map_put_hashed(hashmap* map, const u8* key, const u8* val, u64 hash)
+{
+    MAP_CHECK_WRITABLE(map);
+
+    map_migrate_step(map, key, hash);
+
     LOOKUP_RES res;
     u8         out_psl;
-    u64        slot = map_lookup(map, key, &res, &out_psl);
+    u64        slot = map_lookup(map, key, hash, &res, &out_psl);
 
     if (res == FOUND) {
         if (IS_POD_V(map)) {
@@ -172,28 +287,30 @@ b8 hashmap_put(hashmap* map, const u8* key, const u8* val)
         return 1;
     }
 
+    // Open the slot first, then construct key/val directly inside it
+    map_insert(map, out_psl, slot, hash);
+
     if (IS_POD_K(map)) {
-        memcpy(STAGE_KEY(map), key, map->key_size);
+        memcpy(GET_KEY(map, slot), key, map->key_size);
     } else {
         copy_fn k_cp = map->key_ops->copy_fn;
         if (k_cp) {
-            k_cp(STAGE_KEY(map), key);
+            k_cp(GET_KEY(map, slot), key);
         } else {
-            memcpy(STAGE_KEY(map), key, map->key_size);
+            memcpy(GET_KEY(map, slot), key, map->key_size);
         }
     }
     if (IS_POD_V(map)) {
-        memcpy(STAGE_VAL(map), val, map->val_size);
+        memcpy(GET_VAL(map, slot), val, map->val_size);
     } else {
         copy_fn v_cp = map->val_ops->copy_fn;
         if (v_cp) {
-            v_cp(STAGE_VAL(map), val);
+            v_cp(GET_VAL(map, slot), val);
         } else {
-            memcpy(STAGE_VAL(map), val, map->val_size);
+            memcpy(GET_VAL(map, slot), val, map->val_size);
         }
     }
 
-    map_insert(map, STAGE_KEY(map), STAGE_VAL(map), out_psl, slot);
     map_maybe_resize(map);
     return 0;
 }
@@ -206,6 +323,7 @@ b8 hashmap_put(hashmap* map, const u8* key, const u8* val)
 b8 hashmap_put_move(hashmap* map, u8** key, u8** val)
 {
     CHECK_FATAL(!map || !key || !val || !*key || !*val, "args null");
+    MAP_CHECK_WRITABLE(map);
 
     move_fn k_mv = MAP_MOVE(map->key_ops);
     move_fn v_mv = MAP_MOVE(map->val_ops);
@@ -214,9 +332,12 @@ b8 hashmap_put_move(hashmap* map, u8** key, u8** val)
     // For by-value types with no heap resources, use hashmap_put (copy semantics) instead.
     CHECK_FATAL(!k_mv || !v_mv, "key/val move funcs required");
 
+    u64 hash = MAP_HASH(map, *key);
+    map_migrate_step(map, *key, hash);
+
     LOOKUP_RES res;
     u8         out_psl;
-    u64        slot = map_lookup(map, *key, &res, &out_psl);
+    u64        slot = map_lookup(map, *key, hash, &res, &out_psl);
 
     if (res == FOUND) {
         if (!IS_POD_V(map)) {
@@ -237,12 +358,11 @@ b8 hashmap_put_move(hashmap* map, u8** key, u8** val)
         return 1;
     }
 
-    // Stage: move key into STAGE_KEY, move val into STAGE_VAL.
     // move_fn transfers the heap resource pointer into the dest slot and nulls src.
-    k_mv(STAGE_KEY(map), key); // nulls *key
-    v_mv(STAGE_VAL(map), val); // nulls *val
+    map_insert(map, out_psl, slot, hash);
+    k_mv(GET_KEY(map, slot), key); // nulls *key
+    v_mv(GET_VAL(map, slot), val); // nulls *val
 
-    map_insert(map, STAGE_KEY(map), STAGE_VAL(map), out_psl, slot);
     map_maybe_resize(map);
     return 0;
 }
@@ -254,14 +374,18 @@ b8 hashmap_put_move(hashmap* map, u8** key, u8** val)
 b8 hashmap_put_val_move(hashmap* map, const u8* key, u8** val)
 {
     CHECK_FATAL(!map || !key || !val || !*val, "args null");
+    MAP_CHECK_WRITABLE(map);
 
     move_fn v_mv = MAP_MOVE(map->val_ops);
 
     CHECK_FATAL(!v_mv, "val move func required");
 
+    u64 hash = MAP_HASH(map, key);
+    map_migrate_step(map, key, hash);
+
     LOOKUP_RES res;
     u8         out_psl;
-    u64        slot = map_lookup(map, key, &res, &out_psl);
+    u64        slot = map_lookup(map, key, hash, &res, &out_psl);
 
     if (res == FOUND) {
         if (!IS_POD_V(map)) {
@@ -274,19 +398,20 @@ b8 hashmap_put_val_move(hashmap* map, const u8* key, u8** val)
         return 1;
     }
 
+    map_insert(map, out_psl, slot, hash);
+
     if (IS_POD_K(map)) {
-        memcpy(STAGE_KEY(map), key, map->key_size);
+        memcpy(GET_KEY(map, slot), key, map->key_size);
     } else {
         copy_fn k_cp = map->key_ops->copy_fn;
         if (k_cp) {
-            k_cp(STAGE_KEY(map), key);
+            k_cp(GET_KEY(map, slot), key);
         } else {
-            memcpy(STAGE_KEY(map), key, map->key_size);
+            memcpy(GET_KEY(map, slot), key, map->key_size);
         }
     }
-    v_mv(STAGE_VAL(map), val);
+    v_mv(GET_VAL(map, slot), val);
 
-    map_insert(map, STAGE_KEY(map), STAGE_VAL(map), out_psl, slot);
     map_maybe_resize(map);
     return 0;
 }
@@ -298,14 +423,18 @@ b8 hashmap_put_val_move(hashmap* map, const u8* key, u8** val)
 b8 hashmap_put_key_move(hashmap* map, u8** key, const u8* val)
 {
     CHECK_FATAL(!map || !key || !*key || !val, "args null");
+    MAP_CHECK_WRITABLE(map);
 
     move_fn k_mv = MAP_MOVE(map->key_ops);
 
     CHECK_FATAL(!k_mv, "key move func required for hashmap_put_key_move");
 
+    u64 hash = MAP_HASH(map, *key);
+    map_migrate_step(map, *key, hash);
+
     LOOKUP_RES res;
     u8         out_psl;
-    u64        slot = map_lookup(map, *key, &res, &out_psl);
+    u64        slot = map_lookup(map, *key, hash, &res, &out_psl);
 
     if (res == FOUND) {
         if (!IS_POD_V(map)) {
@@ -334,20 +463,21 @@ b8 hashmap_put_key_move(hashmap* map, u8** key, const u8* val)
         return 1;
     }
 
-    // Stage key (move) and val (copy).
-    k_mv(STAGE_KEY(map), key);
+    // key (move) and val (copy) go straight into the opened slot
+    map_insert(map, out_psl, slot, hash);
+
+    k_mv(GET_KEY(map, slot), key);
     if (IS_POD_V(map)) {
-        memcpy(STAGE_VAL(map), val, map->val_size);
+        memcpy(GET_VAL(map, slot), val, map->val_size);
     } else {
         copy_fn v_cp = map->val_ops->copy_fn;
         if (v_cp) {
-            v_cp(STAGE_VAL(map), val);
+            v_cp(GET_VAL(map, slot), val);
         } else {
-            memcpy(STAGE_VAL(map), val, map->val_size);
+            memcpy(GET_VAL(map, slot), val, map->val_size);
         }
     }
 
-    map_insert(map, STAGE_KEY(map), STAGE_VAL(map), out_psl, slot);
     map_maybe_resize(map);
     return 0;
 }
@@ -359,22 +489,35 @@ b8 hashmap_get(const hashmap* map, const u8* key, u8* val)
 {
     CHECK_FATAL(!map || !key || !val, "null arg");
 
-    LOOKUP_RES res;
-    u8         out_psl;
-    u64        slot = map_lookup(map, key, &res, &out_psl);
+    return map_get_hashed(map, key, val, MAP_HASH(map, key));
+}
 
-    if (res != FOUND) {
+
+b8 hashmap_get_with_hash(const hashmap* map, const u8* key, u8* val, u64 hash)
+{
+    CHECK_FATAL(!map || !key || !val, "null arg");
+
+    return map_get_hashed(map, key, val, hash);
+}
+
+
+// hashmap_get with the hash already computed
+static b8 map_get_hashed(const hashmap* map, const u8* key, u8* val, u64 hash)
+{
+    const u8* src = map_find_val(map, key, hash);
+
+    if (!src) {
         return 0;
     }
 
     if (IS_POD_V(map)) {
-        memcpy(val, GET_VAL(map, slot), map->val_size);
+        memcpy(val, src, map->val_size);
     } else {
         copy_fn v_copy = map->val_ops->copy_fn;
         if (v_copy) {
-            v_copy(val, GET_VAL(map, slot));
+            v_copy(val, src);
         } else {
-            memcpy(val, GET_VAL(map, slot), map->val_size);
+            memcpy(val, src, map->val_size);
         }
     }
     return 1;
@@ -388,11 +531,15 @@ u8* hashmap_get_ptr(hashmap* map, const u8* key)
 {
     CHECK_FATAL(!map || !key, "null arg");
 
-    LOOKUP_RES res;
-    u8         out_psl;
-    u64        slot = map_lookup(map, key, &res, &out_psl);
+    return hashmap_get_ptr_with_hash(map, key, MAP_HASH(map, key));
+}
 
-    return (res == FOUND) ? GET_VAL(map, slot) : NULL;
+
+u8* hashmap_get_ptr_with_hash(hashmap* map, const u8* key, u64 hash)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    return map_find_val(map, key, hash);
 }
 
 
@@ -408,9 +555,20 @@ b8 hashmap_del(hashmap* map, const u8* key, u8* out)
 {
     CHECK_FATAL(!map || !key, "null arg");
 
+    return hashmap_del_with_hash(map, key, out, MAP_HASH(map, key));
+}
+
+
+b8 hashmap_del_with_hash(hashmap* map, const u8* key, u8* out, u64 hash)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+    MAP_CHECK_WRITABLE(map);
+
+    map_migrate_step(map, key, hash);
+
     LOOKUP_RES res;
     u8         out_psl;
-    u64        slot = map_lookup(map, key, &res, &out_psl);
+    u64        slot = map_lookup(map, key, hash, &res, &out_psl);
 
     if (res != FOUND) {
         return 0;
@@ -434,30 +592,67 @@ b8 hashmap_del(hashmap* map, const u8* key, u8* out)
         }
     }
 
-    // Backward-shift deletion: pull subsequent entries one slot back as long as
-    // they have PSL > 1.  Entries at their home slot (PSL == 1) must not move.
-    // This restores the Robin Hood invariant without tombstones.
-    u64 cur = slot;
-    for (;;) {
-        u64 next     = MAP_NEXT(map, cur);
-        u8  next_psl = *GET_PSL(map, next);
+    map_erase(map, slot);
+    map_maybe_shrink(map);
+    return 1;
+}
 
-        // Stop if next slot is empty or the next entry is already at its home slot.
-        if (next_psl <= 1) {
-            *GET_PSL(map, cur) = BUCKET_EMPTY;
-            break;
+
+// Value slot for key, inserting (key COPIED, value zeroed) if absent.
+// Ownership: on insert the map holds a deep copy of key; the value slot is
+// the map's, the caller fills it in place.
+u8* hashmap_entry(hashmap* map, const u8* key, b8* inserted)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    u64 slot;
+    b8  found = map_entry_slot(map, key, MAP_HASH(map, key), &slot);
+
+    if (!found) {
+        copy_fn k_cp = MAP_COPY(map->key_ops);
+        if (k_cp) {
+            k_cp(GET_KEY(map, slot), key);
+        } else {
+            memcpy(GET_KEY(map, slot), key, map->key_size);
         }
+    }
 
-        // Shift next entry one slot back; its PSL decreases by 1.
-        *GET_PSL(map, cur) = next_psl - 1;
-        memcpy(GET_KEY(map, cur), GET_KEY(map, next), map->key_size);
-        memcpy(GET_VAL(map, cur), GET_VAL(map, next), map->val_size);
+    if (inserted) {
+        *inserted = !found;
+    }
+    return GET_VAL(map, slot);
+}
 
-        cur = next;
+
+// Value slot for *key, inserting (key MOVED, value zeroed) if absent.
+// Ownership: *key is consumed either way and nulled.
+u8* hashmap_entry_move(hashmap* map, u8** key, b8* inserted)
+{
+    CHECK_FATAL(!map || !key || !*key, "null arg");
+
+    move_fn k_mv = MAP_MOVE(map->key_ops);
+
+    CHECK_FATAL(!k_mv, "key move func required for hashmap_entry_move");
+
+    u64 slot;
+    b8  found = map_entry_slot(map, *key, MAP_HASH(map, *key), &slot);
+
+    if (found) {
+        // key already in map — consume the incoming duplicate
+        delete_fn k_del = MAP_DEL(map->key_ops);
+        if (k_del) {
+            k_del(*key);
+        }
+        free(*key);
+        *key = NULL;
+    } else {
+        k_mv(GET_KEY(map, slot), key);
     }
 
-    map->size--;
-    return 1;
+    if (inserted) {
+        *inserted = !found;
+    }
+    return GET_VAL(map, slot);
 }
 
 
@@ -466,10 +661,283 @@ b8 hashmap_has(const hashmap* map, const u8* key)
 {
     CHECK_FATAL(!map || !key, "null arg");
 
-    LOOKUP_RES res;
-    u8         out_psl;
-    map_lookup(map, key, &res, &out_psl);
-    return res == FOUND;
+    return hashmap_has_with_hash(map, key, MAP_HASH(map, key));
+}
+
+
+b8 hashmap_has_with_hash(const hashmap* map, const u8* key, u64 hash)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    return map_find_val(map, key, hash) != NULL;
+}
+
+
+// Hash of key as this map computes it — feed it to the *_with_hash calls.
+u64 hashmap_hash(const hashmap* map, const u8* key)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    return MAP_HASH(map, key);
+}
+
+
+/*
+====================BATCH API====================
+*/
+// Each call works through the keys in chunks of MAP_BATCH: hash the whole
+// chunk and prefetch every home bucket first, then run the probes. The
+// lookups are independent, so their cache misses overlap instead of being
+// paid one after another.
+
+// Batch get — COPIES each found value into vals[i] (same rules as hashmap_get).
+// keys / vals are packed arrays of n keys / n values. found (optional) gets
+// 1 or 0 per key; vals[i] is untouched for missing keys.
+// Returns the number of keys found.
+u64 hashmap_get_many(const hashmap* map, const u8* keys, u64 n, u8* vals, b8* found)
+{
+    CHECK_FATAL(!map || !keys || !vals, "null arg");
+
+    u64 hashes[MAP_BATCH];
+    u64 hits = 0;
+
+    for (u64 base = 0; base < n; base += MAP_BATCH) {
+        u64 cnt = (n - base < MAP_BATCH) ? n - base : MAP_BATCH;
+
+        for (u64 j = 0; j < cnt; j++) {
+            hashes[j] = MAP_HASH(map, keys + ((base + j) * map->key_size));
+            map_prefetch(map, hashes[j], 1);
+        }
+
+        for (u64 j = 0; j < cnt; j++) {
+            u64 i = base + j;
+            b8  f = map_get_hashed(map, keys + (i * map->key_size), vals + (i * map->val_size),
+                                   hashes[j]);
+            hits += f;
+            if (found) {
+                found[i] = f;
+            }
+        }
+    }
+
+    return hits;
+}
+
+
+// Batch has — found (optional) gets 1 or 0 per key.
+// Returns the number of keys present.
+u64 hashmap_has_many(const hashmap* map, const u8* keys, u64 n, b8* found)
+{
+    CHECK_FATAL(!map || !keys, "null arg");
+
+    u64 hashes[MAP_BATCH];
+    u64 hits = 0;
+
+    for (u64 base = 0; base < n; base += MAP_BATCH) {
+        u64 cnt = (n - base < MAP_BATCH) ? n - base : MAP_BATCH;
+
+        for (u64 j = 0; j < cnt; j++) {
+            hashes[j] = MAP_HASH(map, keys + ((base + j) * map->key_size));
+            map_prefetch(map, hashes[j], 0);
+        }
+
+        for (u64 j = 0; j < cnt; j++) {
+            b8 f = map_find_val(map, keys + ((base + j) * map->key_size), hashes[j]) != NULL;
+            hits += f;
+            if (found) {
+                found[base + j] = f;
+            }
+        }
+    }
+
+    return hits;
+}
+
+
+// Batch insert or update — COPY semantics (same rules as hashmap_put).
+// Keys are applied in order, so a key repeated in the batch keeps its last value.
+// Returns the number of new keys inserted.
+u64 hashmap_put_many(hashmap* map, const u8* keys, const u8* vals, u64 n)
+{
+    CHECK_FATAL(!map || !keys || !vals, "null arg");
+
+    u64 hashes[MAP_BATCH];
+    u64 inserted = 0;
+
+    for (u64 base = 0; base < n; base += MAP_BATCH) {
+        u64 cnt = (n - base < MAP_BATCH) ? n - base : MAP_BATCH;
+
+        for (u64 j = 0; j < cnt; j++) {
+            hashes[j] = MAP_HASH(map, keys + ((base + j) * map->key_size));
+            map_prefetch(map, hashes[j], 1);
+        }
+
+        // a resize mid-chunk only wastes the remaining prefetches; a reseed
+        // makes the remaining hashes stale
+        u64 seed = map->seed;
+        for (u64 j = 0; j < cnt; j++) {
+            u64 i = base + j;
+            u64 h = map->seed == seed ? hashes[j] : MAP_HASH(map, keys + (i * map->key_size));
+            inserted += !map_put_hashed(map, keys + (i * map->key_size),
+                                        vals + (i * map->val_size), h);
+        }
+    }
+
+    return inserted;
+}
+
+
+// Batch insert or update — MOVE semantics for packed arrays of by-value elements.
+// Ownership: the map takes over the element bytes (no copy_fn) — the caller must not
+// destroy the elements afterwards, but still owns and frees the arrays themselves.
+// For a key already in the map the old value is destroyed and the incoming
+// duplicate key is destroyed via del_fn.
+// Returns the number of new keys inserted.
+u64 hashmap_put_many_move(hashmap* map, u8* keys, u8* vals, u64 n)
+{
+    CHECK_FATAL(!map || !keys || !vals, "null arg");
+
+    u64 hashes[MAP_BATCH];
+    u64 inserted = 0;
+
+    for (u64 base = 0; base < n; base += MAP_BATCH) {
+        u64 cnt = (n - base < MAP_BATCH) ? n - base : MAP_BATCH;
+
+        for (u64 j = 0; j < cnt; j++) {
+            hashes[j] = MAP_HASH(map, keys + ((base + j) * map->key_size));
+            map_prefetch(map, hashes[j], 1);
+        }
+
+        u64 seed = map->seed; // see hashmap_put_many
+        for (u64 j = 0; j < cnt; j++) {
+            u64 i = base + j;
+            u64 h = map->seed == seed ? hashes[j] : MAP_HASH(map, keys + (i * map->key_size));
+            inserted += map_put_moved(map, keys + (i * map->key_size), vals + (i * map->val_size),
+                                      h);
+        }
+    }
+
+    return inserted;
+}
+
+
+// Build a map from two equal-size genVecs — MOVE semantics.
+// Ownership: the map takes over every element's bytes; both vecs end up
+// empty but keep their buffers, the caller still destroys them.
+// The table is reserved for all n entries up front, so nothing is rehashed.
+// With sort, entries are inserted in order of home bucket (stable, so a
+// repeated key still keeps its last value) and the table fills front to back.
+hashmap* hashmap_from_vecs(genVec* keys, genVec* vals, custom_hash_fn hash_fn, compare_fn cmp_fn,
+                           b8 sort)
+{
+    CHECK_FATAL(!keys || !vals, "null arg");
+    CHECK_FATAL(keys->size != vals->size, "keys and vals differ in size");
+
+    hashmap* map = hashmap_create(keys->data_size, vals->data_size, hash_fn, cmp_fn, keys->ops,
+                                  vals->ops);
+
+    u64 n = keys->size;
+    hashmap_reserve(map, n);
+
+    if (!sort || n < 2) {
+        if (n > 0) { // an empty vec may have no buffer at all
+            hashmap_put_many_move(map, keys->data, vals->data, n);
+        }
+        keys->size = 0;
+        vals->size = 0;
+        return map;
+    }
+
+    u64* hashes = malloc(n * sizeof(u64));
+    CHECK_FATAL(!hashes, "hashes malloc failed");
+    u64* order = malloc(n * sizeof(u64));
+    CHECK_FATAL(!order, "order malloc failed");
+
+    // counting sort on the top bits of the home bucket
+    u64 bins  = map->capacity < MAP_SORT_BINS ? map->capacity : MAP_SORT_BINS;
+    u32 shift = (u32)(__builtin_ctzll(map->capacity) - __builtin_ctzll(bins));
+    u64* count = calloc(bins + 1, sizeof(u64));
+    CHECK_FATAL(!count, "count calloc failed");
+
+    for (u64 i = 0; i < n; i++) {
+        hashes[i] = MAP_HASH(map, keys->data + (i * map->key_size));
+        count[(MAP_HOME(map, hashes[i]) >> shift) + 1]++;
+    }
+    for (u64 b = 1; b <= bins; b++) {
+        count[b] += count[b - 1];
+    }
+    for (u64 i = 0; i < n; i++) {
+        order[count[MAP_HOME(map, hashes[i]) >> shift]++] = i;
+    }
+
+    // an overflow reseed mid-build leaves the rest of hashes[] stale
+    u64 seed = map->seed;
+    for (u64 j = 0; j < n; j++) {
+        u64 i   = order[j];
+        u8* key = keys->data + (i * map->key_size);
+        u64 h   = map->seed == seed ? hashes[i] : MAP_HASH(map, key);
+        map_put_moved(map, key, vals->data + (i * map->val_size), h);
+    }
+
+    free(count);
+    free(order);
+    free(hashes);
+    keys->size = 0;
+    vals->size = 0;
+    return map;
+}
+
+
+// Start a walk over all entries: the live table first, then the old table
+// of an incremental resize (its migrated arc is empty, so it is skipped).
+hashmap_iter hashmap_iter_begin(const hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    return (hashmap_iter){.map = map, .table = map, .idx = 0, .key = NULL, .val = NULL};
+}
+
+
+b8 hashmap_iter_next(hashmap_iter* it)
+{
+    CHECK_FATAL(!it, "iter is null");
+
+    while (it->table) {
+        const hashmap* t = it->table;
+        u64            i = map_next_full(t->psls, it->idx, t->capacity);
+
+        if (i < t->capacity) {
+            it->key = GET_KEY(t, i);
+            it->val = GET_VAL(t, i);
+            it->idx = i + 1;
+            return 1;
+        }
+
+        it->table = (t == it->map) ? it->map->old : NULL;
+        it->idx   = 0;
+    }
+
+    it->key = NULL;
+    it->val = NULL;
+    return 0;
+}
+
+
+// All keys, deep copied into a new vec (caller owns it).
+genVec* hashmap_keys(const hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    return map_export(map, 0);
+}
+
+
+// All values, deep copied into a new vec (caller owns it).
+genVec* hashmap_values(const hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    return map_export(map, 1);
 }
 
 
@@ -493,6 +961,19 @@ void hashmap_print(const hashmap* map, print_fn key_print, print_fn val_print)
         putchar('\n');
     }
 
+    // entries still waiting in the old table of an incremental resize
+    const hashmap* old = map->old;
+    for (u64 i = 0; old && i < old->capacity; i++) {
+        if (*GET_PSL(old, i) == BUCKET_EMPTY) {
+            continue;
+        }
+        putchar('\t');
+        key_print(GET_KEY(old, i));
+        printf(" => ");
+        val_print(GET_VAL(old, i));
+        putchar('\n');
+    }
+
     printf("\t=========\n");
 }
 
@@ -502,6 +983,7 @@ void hashmap_print(const hashmap* map, print_fn key_print, print_fn val_print)
 void hashmap_clear(hashmap* map)
 {
     CHECK_FATAL(!map, "map is null");
+    MAP_CHECK_WRITABLE(map);
 
     if (!IS_POD_K(map) || !IS_POD_V(map)) {
         delete_fn k_del = IS_POD_K(map) ? NULL : map->key_ops->del_fn;
@@ -519,8 +1001,32 @@ void hashmap_clear(hashmap* map)
         }
     }
 
+    // drop the old table of a pending resize along with its entries
+    if (map->old) {
+        hashmap_destroy(map->old);
+        map->old = NULL;
+    }
+
     memset(map->psls, 0, map->capacity * sizeof(u8));
-    map->size = 0;
+    map->size         = 0;
+    map->psl_overflow = 0;
+}
+
+
+// Grow to the smallest power-of-2 capacity that holds n entries below the
+// load factor. One rehash instead of one per doubling; never shrinks.
+void hashmap_reserve(hashmap* map, u64 n)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    // map_maybe_resize grows once size reaches max_load
+    u64 cap = map_capacity_for(n, map->capacity, map->max_load);
+
+    if (cap != map->capacity) {
+        map_resize(map, cap); // takes in the old table too, if there is one
+    } else {
+        map_migrate_all(map);
+    }
 }
 
 
@@ -533,24 +1039,43 @@ void hashmap_copy(hashmap* dest, const hashmap* src)
 
     hashmap_destroy_stk(dest);
 
-    dest->keys = malloc(src->capacity * src->key_size);
+    // dest keeps its own storage: its arena if it has one, else the heap
+    dest->keys = map_alloc(dest, src->capacity * src->key_size);
     CHECK_FATAL(!dest->keys, "copy keys calloc failed");
-    dest->psls = calloc(src->capacity, sizeof(u8));
+    dest->psls = map_calloc(dest, src->capacity * sizeof(u8));
     CHECK_FATAL(!dest->psls, "copy psls calloc failed");
-    dest->vals = malloc(src->capacity * src->val_size);
+    dest->vals = map_alloc(dest, src->capacity * src->val_size);
     CHECK_FATAL(!dest->vals, "copy vals calloc failed");
-    dest->scratch = malloc(2 * (ALIGN8(src->key_size) + src->val_size));
-    CHECK_FATAL(!dest->scratch, "copy scratch malloc failed");
 
-    dest->size     = src->size;
+    dest->hashes = NULL;
+    if (src->hashes) {
+        dest->hashes = (u32*)map_alloc(dest, src->capacity * sizeof(u32));
+        CHECK_FATAL(!dest->hashes, "copy hashes malloc failed");
+        memcpy(dest->hashes, src->hashes, src->capacity * sizeof(u32));
+    }
+
+    // old-table entries are re-inserted below, and map_insert counts them
+    dest->size     = src->old ? src->size - src->old->size : src->size;
     dest->capacity = src->capacity;
     dest->key_size = src->key_size;
     dest->val_size = src->val_size;
     dest->hash_fn  = src->hash_fn;
     dest->cmp_fn   = src->cmp_fn;
+    dest->seed     = src->seed; // entries keep their slots, so they keep their hashes
+    dest->max_load = src->max_load;
+    dest->min_load = src->min_load;
     dest->key_ops  = src->key_ops;
     dest->val_ops  = src->val_ops;
 
+    dest->psl_overflow = src->psl_overflow;
+    dest->defer_reseed = src->defer_reseed;
+    dest->psl_limit    = src->psl_limit;
+
+    dest->old           = NULL;
+    dest->migrate_start = 0;
+    dest->migrated      = 0;
+    dest->incremental   = src->incremental;
+
     copy_fn k_cp = IS_POD_K(src) ? NULL : src->key_ops->copy_fn;
     copy_fn v_cp = IS_POD_V(src) ? NULL : src->val_ops->copy_fn;
 
@@ -574,26 +1099,514 @@ void hashmap_copy(hashmap* dest, const hashmap* src)
             memcpy(GET_VAL(dest, i), GET_VAL(src, i), src->val_size);
         }
     }
-}
 
+    // src is mid-resize: dest gets everything in one table (it fits — the
+    // new capacity was sized for all of src's entries)
+    const hashmap* old = src->old;
+    for (u64 i = 0; old && i < old->capacity; i++) {
+        if (*GET_PSL(old, i) == BUCKET_EMPTY) {
+            continue;
+        }
 
-/*
-====================PRIVATE FUNCTIONS====================
+        u64 hash = map_old_hash(src, i);
+        u8  out_psl;
+        u64 slot = map_insert_pos(dest, MAP_HOME(dest, hash), &out_psl);
+        map_insert(dest, out_psl, slot, hash);
+
+        if (k_cp) {
+            k_cp(GET_KEY(dest, slot), GET_KEY(old, i));
+        } else {
+            memcpy(GET_KEY(dest, slot), GET_KEY(old, i), src->key_size);
+        }
+
+        if (v_cp) {
+            v_cp(GET_VAL(dest, slot), GET_VAL(old, i));
+        } else {
+            memcpy(GET_VAL(dest, slot), GET_VAL(old, i), src->val_size);
+        }
+    }
+}
+
+
+// Turn the per-bucket hash cache on or off.
+// Enabling hashes every live key once; disabling just frees the array.
+void hashmap_set_hash_cache(hashmap* map, b8 enable)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    if (!enable) {
+        map_free(map, map->hashes);
+        map->hashes = NULL;
+        if (map->old) {
+            map_free(map, map->old->hashes);
+            map->old->hashes = NULL;
+        }
+        return;
+    }
+
+    if (map->hashes) {
+        return;
+    }
+
+    // one table to fill, not two
+    map_migrate_all(map);
+
+    // low 32 bits are enough to place entries in tables of up to 2^32 buckets
+    CHECK_FATAL(map->capacity > MAP_HASH_CACHE_MAX_CAP, "capacity too large for hash cache");
+
+    map->hashes = (u32*)map_alloc(map, map->capacity * sizeof(u32));
+    CHECK_FATAL(!map->hashes, "hashes malloc failed");
+
+    for (u64 i = 0; i < map->capacity; i++) {
+        if (*GET_PSL(map, i) != BUCKET_EMPTY) {
+            *GET_HSH(map, i) = (u32)MAP_HASH(map, GET_KEY(map, i));
+        }
+    }
+}
+
+
+// Turn incremental resizing on or off.
+// Turning it off finishes a resize in flight, so the map is one table again.
+void hashmap_set_incremental(hashmap* map, b8 enable)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(enable && map->snapshot, "snapshot maps resize in one step");
+
+    map->incremental = enable;
+    if (!enable) {
+        map_migrate_all(map);
+    }
+}
+
+
+// Rehash under the given seed (0 = unseeded). Same capacity.
+void hashmap_set_seed(hashmap* map, u64 seed)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    if (seed != map->seed) {
+        map_rehash(map, map->capacity, seed);
+    }
+}
+
+
+void hashmap_reseed(hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    map_rehash(map, map->capacity, map_seed_random());
+}
+
+
+void hashmap_set_max_load(hashmap* map, double load)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(load < LOAD_FACTOR_MIN || load > LOAD_FACTOR_MAX, "max load out of range");
+    CHECK_FATAL(map->min_load * 4 > MAP_LOAD_PCT(load), "max load below 4x min load");
+
+    map->max_load = MAP_LOAD_PCT(load);
+    hashmap_reserve(map, map->size);
+}
+
+
+void hashmap_set_min_load(hashmap* map, double load)
+{
+    CHECK_FATAL(!map, "map is null");
+    // range-check the double first: MAP_LOAD_PCT of anything past 2.55 doesn't fit a u8
+    CHECK_FATAL(!(load >= 0 && load <= LOAD_FACTOR_MAX / 4), "min load out of range");
+    CHECK_FATAL(MAP_LOAD_PCT(load) * 4 > map->max_load, "min load above max load / 4");
+
+    // takes effect on the next del, so a map reserved ahead of time keeps its table
+    map->min_load = MAP_LOAD_PCT(load);
+}
+
+
+void hashmap_shrink_to_fit(hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    u64 cap = map_capacity_for(map->size, HASHMAP_INIT_CAPACITY, map->max_load);
+    if (cap < map->capacity) {
+        map_resize(map, cap); // takes in the old table too, if there is one
+    } else {
+        map_migrate_all(map);
+    }
+}
+
+
+void hashmap_stats(const hashmap* map, map_stats* out)
+{
+    CHECK_FATAL(!map || !out, "null arg");
+
+    memset(out, 0, sizeof(*out));
+    out->size     = map->size;
+    out->capacity = map->capacity;
+    out->counters = map->counters;
+
+    // per bucket: key, val, psl, and the cached hash bits when on
+    u64 bucket = (u64)map->key_size + map->val_size + 1;
+    out->bytes = sizeof(hashmap) + (map->capacity * (bucket + (map->hashes ? sizeof(u32) : 0)));
+    map_stats_scan(out, map->psls, map->capacity);
+
+    const hashmap* old = map->old;
+    if (old) {
+        out->bytes += sizeof(hashmap) + (old->capacity * (bucket + (old->hashes ? sizeof(u32) : 0)));
+        map_stats_scan(out, old->psls, old->capacity);
+    }
+
+    map_stats_finish(out);
+}
+
+
+void hashmap_stats_reset(hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+    memset(&map->counters, 0, sizeof(map->counters));
+}
+
+
+/*
+====================SNAPSHOTS====================
 */
 
-static inline void map_maybe_resize(hashmap* map)
+// Write the tables as they are: psls, keys and vals go to disk byte for
+// byte, so loading needs no rehash. Finishes an incremental resize first.
+b8 hashmap_save(hashmap* map, const char* path)
 {
-    // integer multiply avoids float — equivalent to load > 0.75
-    if (map->size * 4 >= map->capacity * 3) {
+    CHECK_FATAL(!map || !path, "null arg");
+    CHECK_FATAL(!IS_POD_K(map) || !IS_POD_V(map), "snapshots need POD keys and values");
+
+    map_migrate_all(map);
+
+    map_snapshot_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.kind       = MAP_SNAPSHOT_HASHMAP;
+    hdr.key_size   = map->key_size;
+    hdr.val_size   = map->val_size;
+    hdr.size       = map->size;
+    hdr.capacity   = map->capacity;
+    hdr.seed       = map->seed;
+    hdr.hash_check = map_snapshot_hash_check(map->hash_fn, map->key_size);
+    hdr.max_load   = map->max_load;
+    hdr.min_load   = map->min_load;
+    hdr.lens[0]    = map->capacity;
+    hdr.lens[1]    = map->capacity * map->key_size;
+    hdr.lens[2]    = map->capacity * map->val_size;
+
+    const u8* const arrays[MAP_SNAPSHOT_ARRAYS] = {map->psls, map->keys, map->vals};
+    return map_snapshot_save(path, &hdr, arrays);
+}
+
+
+// The struct is fresh heap memory; the tables stay in the file mapping
+// until a resize or rehash moves them to the heap.
+hashmap* hashmap_load_mmap(const char* path, custom_hash_fn hash_fn, compare_fn cmp_fn)
+{
+    CHECK_FATAL(!path, "path is null");
+
+    map_snapshot_header hdr;
+    u8*                 base = map_snapshot_map(path, MAP_SNAPSHOT_HASHMAP, &hdr);
+    if (!base) {
+        return NULL;
+    }
+
+    // a different hash_fn would find nothing where the entries sit
+    hash_fn = hash_fn ? hash_fn : wyhash;
+    if (hdr.lens[0] != hdr.capacity ||
+        !map_snapshot_len_is(hdr.lens[1], hdr.capacity, hdr.key_size) ||
+        !map_snapshot_len_is(hdr.lens[2], hdr.capacity, hdr.val_size) ||
+        map_snapshot_hash_check(hash_fn, hdr.key_size) != hdr.hash_check) {
+        map_snapshot_unmap(base, hdr.file_len);
+        WC_SET_RET(WC_ERR_IO, 1, NULL);
+    }
+
+    hashmap* map = malloc(sizeof(hashmap));
+    CHECK_FATAL(!map, "map malloc failed");
+    map->arena = NULL;
+
+    map->psls     = base + hdr.offs[0];
+    map->keys     = base + hdr.offs[1];
+    map->vals     = base + hdr.offs[2];
+    map->size     = hdr.size;
+    map->capacity = hdr.capacity;
+    map->key_size = hdr.key_size;
+    map->val_size = hdr.val_size;
+    map->hashes   = NULL;
+
+    map->hash_fn = hash_fn;
+    map->cmp_fn  = cmp_fn ? cmp_fn : default_compare;
+    map->seed    = hdr.seed; // entries sit where this seed put them
+
+    map->max_load     = hdr.max_load;
+    map->min_load     = hdr.min_load;
+    map->psl_overflow = 0;
+    map->defer_reseed = 0;
+    map->psl_limit    = RH_PSL_LIMIT;
+
+    map->key_ops = NULL;
+    map->val_ops = NULL;
+
+    map->old           = NULL;
+    map->migrate_start = 0;
+    map->migrated      = 0;
+    map->incremental   = 0;
+
+    map->snapshot     = base;
+    map->snapshot_len = hdr.file_len;
+    map->read_only    = 1;
+
+    memset(&map->counters, 0, sizeof(map->counters));
+
+    return map;
+}
+
+
+// mprotect the mapping writable. Still MAP_PRIVATE: the kernel copies a
+// page on its first write, the file is never touched, untouched pages
+// stay shared with the page cache.
+void hashmap_promote(hashmap* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    if (!map->read_only) {
+        return;
+    }
+    map_snapshot_promote(map->snapshot, map->snapshot_len);
+    map->read_only = 0;
+}
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+// Table storage comes from the map's arena when it has one, else the heap.
+// Arena memory is never handed back piecemeal — map_free skips it.
+static inline u8* map_alloc(const hashmap* map, u64 size)
+{
+    return map->arena ? arena_alloc(map->arena, size) : malloc(size);
+}
+
+static inline u8* map_calloc(const hashmap* map, u64 size)
+{
+    if (!map->arena) {
+        return calloc(size, 1);
+    }
+    u8* ptr = arena_alloc(map->arena, size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+// Tables that still live in a snapshot mapping go back with it instead
+// (map_drop_snapshot)
+static inline void map_free(const hashmap* map, void* ptr)
+{
+    if (!map->arena && !map_snapshot_owns(map->snapshot, map->snapshot_len, ptr)) {
+        free(ptr);
+    }
+}
+
+// Unmap the snapshot once nothing points into it any more
+static inline void map_drop_snapshot(hashmap* map)
+{
+    map_snapshot_unmap(map->snapshot, map->snapshot_len);
+    map->snapshot     = NULL;
+    map->snapshot_len = 0;
+    map->read_only    = 0;
+}
+
+// Keys (vals = 0) or values (vals = 1) of every entry, in iteration order,
+// copied straight into a vec allocated at exactly hashmap_size.
+static genVec* map_export(const hashmap* map, b8 vals)
+{
+    u32                  elm_size = vals ? map->val_size : map->key_size;
+    const container_ops* ops      = vals ? map->val_ops : map->key_ops;
+    copy_fn              cp       = MAP_COPY(ops);
+
+    genVec* vec = genVec_init(map->size, elm_size, ops);
+
+    u8*          dst = vec->data;
+    hashmap_iter it  = hashmap_iter_begin(map);
+    while (hashmap_iter_next(&it)) {
+        const u8* src = vals ? it.val : it.key;
+        if (cp) {
+            cp(dst, src);
+        } else {
+            memcpy(dst, src, elm_size);
+        }
+        dst += elm_size;
+    }
+
+    vec->size = map->size;
+    return vec;
+}
+
+
+static inline void map_grow(hashmap* map)
+{
+    if (map->incremental) {
+        map_grow_incremental(map);
+    } else {
         map_resize(map, map->capacity * 2);
     }
 }
 
-static u64 map_lookup(const hashmap* map, const u8* key, LOOKUP_RES* res, u8* out_psl)
+static inline void map_maybe_resize(hashmap* map)
 {
-    u64        idx = MAP_IDX(map, key);
+    map_check_overflow(map);
+
+    if (map_load_reached(map->size, map->capacity, map->max_load)) {
+        map_grow(map);
+    }
+}
+
+// Dels call this after erasing. Skipped while an incremental resize is in
+// flight: the map just grew, and shrinking would undo it.
+static inline void map_maybe_shrink(hashmap* map)
+{
+    if (map->min_load && !map->old && map->capacity > HASHMAP_INIT_CAPACITY &&
+        !map_load_reached(map->size, map->capacity, map->min_load)) {
+        map_resize(map, map_shrink_capacity(map->size, map->capacity, map->max_load));
+    }
+}
+
+// A psl reached RH_PSL_LIMIT. Past the default load the table is just too
+// full for Robin Hood runs to stay short: double it, keeping the seed (and
+// so every precomputed hash). Below it, under this seed too many keys share
+// a run (crafted keys or a weak hash_fn): rehash under a new seed.
+// Dels don't call this: with the flag up migration stops, so they never
+// lengthen a run, and the next put settles it.
+static inline void map_check_overflow(hashmap* map)
+{
+    if (!map->psl_overflow || map->defer_reseed) {
+        return;
+    }
+
+    if (map_overflow_grows(map->size, map->capacity)) {
+        map_rehash(map, map->capacity * 2, map->seed);
+    } else {
+        map_rehash(map, map->capacity, map_seed_random());
+    }
+}
+
+// Find key's slot, or open one for it (key unset, value zeroed).
+// A put grows right after the insert that reaches max_load; here the same
+// growth happens just before it, so the returned slot never moves and the
+// only extra work on that path is a psl-only walk for the insert position.
+// Returns 1 if the key was already present.
+static inline b8 map_entry_slot(hashmap* map, const u8* key, u64 hash, u64* slot)
+{
+    MAP_CHECK_WRITABLE(map);
+
+    map_migrate_step(map, key, hash);
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    *slot = map_lookup(map, key, hash, &res, &out_psl);
+
+    if (res == FOUND) {
+        return 1;
+    }
+
+    if (map_load_reached(map->size + 1, map->capacity, map->max_load)) {
+        map_grow(map);
+        *slot = map_insert_pos(map, MAP_HOME(map, hash), &out_psl);
+    }
+
+    map_insert(map, out_psl, *slot, hash);
+
+    // settle an overflow now, while the new entry is still empty: take it
+    // out again, reseed, and reopen it, so the slot handed back stays put
+    if (map->psl_overflow && !map->defer_reseed) {
+        map_erase(map, *slot);
+        map_check_overflow(map);
+        hash  = MAP_HASH(map, key);
+        *slot = map_insert_pos(map, MAP_HOME(map, hash), &out_psl);
+        map_insert(map, out_psl, *slot, hash);
+    }
+
+    memset(GET_VAL(map, *slot), 0, map->val_size);
+    return 0;
+}
+
+// Insert or update with the element bytes taken over (no copy_fn).
+// On update the old value and the incoming duplicate key are destroyed.
+// Returns 1 if the key was new.
+static b8 map_put_moved(hashmap* map, u8* key, u8* val, u64 hash)
+{
+    MAP_CHECK_WRITABLE(map);
+
+    map_migrate_step(map, key, hash);
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    u64        slot = map_lookup(map, key, hash, &res, &out_psl);
+
+    if (res == FOUND) {
+        delete_fn v_del = MAP_DEL(map->val_ops);
+        delete_fn k_del = MAP_DEL(map->key_ops);
+        if (v_del) {
+            v_del(GET_VAL(map, slot));
+        }
+        memcpy(GET_VAL(map, slot), val, map->val_size);
+        if (k_del) {
+            k_del(key);
+        }
+        return 0;
+    }
+
+    map_insert(map, out_psl, slot, hash);
+    memcpy(GET_KEY(map, slot), key, map->key_size);
+    memcpy(GET_VAL(map, slot), val, map->val_size);
+
+    map_maybe_resize(map);
+    return 1;
+}
+
+// Pull the home bucket of hash into cache ahead of its probe.
+// Puts read the bucket first too, so a read prefetch serves both.
+static inline void map_prefetch(const hashmap* map, u64 hash, b8 with_val)
+{
+    u64 home = MAP_HOME(map, hash);
+
+    __builtin_prefetch(GET_PSL(map, home));
+    __builtin_prefetch(GET_KEY(map, home));
+    if (with_val) {
+        __builtin_prefetch(GET_VAL(map, home));
+    }
+    if (map->hashes) {
+        __builtin_prefetch(GET_HSH(map, home));
+    }
+}
+
+// Value of key, in the live table or the old one of a pending resize.
+// NULL if absent. Never mutates, so gets stay safe on a const map.
+static u8* map_find_val(const hashmap* map, const u8* key, u64 hash)
+{
+    LOOKUP_RES res;
+    u8         out_psl;
+    u64        slot = map_lookup(map, key, hash, &res, &out_psl);
+
+    if (res == FOUND) {
+        return GET_VAL(map, slot);
+    }
+    if (map->old && map_lookup_old(map, key, hash, &slot)) {
+        return GET_VAL(map->old, slot);
+    }
+    return NULL;
+}
+
+
+static u64 map_lookup(const hashmap* map, const u8* key, u64 hash, LOOKUP_RES* res, u8* out_psl)
+{
+    u64        idx = MAP_HOME(map, hash);
     u8         psl = 1; // stored PSL=1 means real probe distance 0 (home slot)
     compare_fn cmp = map->cmp_fn;
+    const u32* hsh = map->hashes;
+
+    MAP_COUNT(map, lookups, 1);
 
     for (u64 i = idx;; i = MAP_NEXT(map, i)) {
         u8 slot_psl = *GET_PSL(map, i);
@@ -601,6 +1614,7 @@ static u64 map_lookup(const hashmap* map, const u8* key, LOOKUP_RES* res, u8* ou
         if (slot_psl == BUCKET_EMPTY) {
             *res     = NOT_FOUND;
             *out_psl = psl;
+            MAP_COUNT(map, probes, psl);
             return i;
         }
 
@@ -610,12 +1624,16 @@ static u64 map_lookup(const hashmap* map, const u8* key, LOOKUP_RES* res, u8* ou
             // so our key cannot exist at or beyond this slot.
             *res     = ROBINHOOD_EXIT;
             *out_psl = psl;
+            MAP_COUNT(map, probes, psl);
             return i;
         }
 
-        if (cmp(GET_KEY(map, i), key, map->key_size) == 0) {
+        // cached hash bits reject most mismatches without touching the key array
+        if ((!hsh || hsh[i] == (u32)hash) &&
+            (MAP_COUNT(map, compares, 1), cmp(GET_KEY(map, i), key, map->key_size) == 0)) {
             *res     = FOUND;
             *out_psl = psl;
+            MAP_COUNT(map, probes, psl);
             return i;
         }
 
@@ -625,65 +1643,81 @@ static u64 map_lookup(const hashmap* map, const u8* key, LOOKUP_RES* res, u8* ou
 
 
 
-// Insert key/val with the given starting psl at slot idx.
-// key and val are already OWNED by the caller (staged copy or moved pointer).
-// This function never calls copy/del — it only shuffles raw bytes between slots.
-// Displaced residents are temporarily buffered in SWAP_KEY/SWAP_VAL (second half
-// of scratch), which is disjoint from the STAGE region where key/val came from.
-static void map_insert(hashmap* map, u8* key, u8* val, u8 psl, u64 idx)
+// Insertion point for a key that is known to be absent (resize / rehash).
+// Keys are unique there, so the probe only compares PSLs — never keys.
+static u64 map_insert_pos(const hashmap* map, u64 idx, u8* out_psl)
 {
-    // Use two alternating scratch halves to avoid aliasing
-    u8* cur_key = STAGE_KEY(map);
-    u8* cur_val = STAGE_VAL(map);
-    u8* swp_key = SWAP_KEY(map);
-    u8* swp_val = SWAP_VAL(map);
+    u8 psl = 1;
 
-    // key/val may already be STAGE — only copy if not already there
-    if (key != cur_key) {
-        memcpy(cur_key, key, map->key_size);
+    // empty buckets (psl 0) always stop the probe
+    while (*GET_PSL(map, idx) >= psl) {
+        idx = MAP_NEXT(map, idx);
+        psl++;
     }
-    if (val != cur_val) {
-        memcpy(cur_val, val, map->val_size);
+
+    *out_psl = psl;
+    return idx;
+}
+
+
+// Open slot idx for a new entry with the given psl.
+// idx must be the Robin Hood insertion point returned by map_lookup / map_insert_pos.
+// If the slot is taken, the run [idx, next empty) is shifted one slot right
+// (raw bytes, no copy/del callbacks). The caller constructs key/val in place.
+// Raises psl_overflow when a psl reaches psl_limit; put paths settle it
+// in map_maybe_resize once the entry is complete.
+static void map_insert(hashmap* map, u8 psl, u64 idx, u64 hash)
+{
+    if (*GET_PSL(map, idx) != BUCKET_EMPTY) {
+        u64 end = rh_run_end(map->psls, idx, MAP_MASK(map));
+
+        rh_shift_right(map->keys, map->key_size, idx, end, map->capacity);
+        rh_shift_right(map->vals, map->val_size, idx, end, map->capacity);
+        rh_shift_right(map->psls, sizeof(u8), idx, end, map->capacity);
+        if (map->hashes) {
+            rh_shift_right((u8*)map->hashes, sizeof(u32), idx, end, map->capacity);
+        }
+        map->psl_overflow |= rh_bump_psls(map->psls, idx, end, MAP_MASK(map), map->psl_limit);
     }
-    key = cur_key;
-    val = cur_val;
 
-    for (u64 i = idx;; i = MAP_NEXT(map, i)) {
-        u8 slot_psl = *GET_PSL(map, i);
+    map->psl_overflow |= psl >= map->psl_limit;
+    *GET_PSL(map, idx) = psl;
+    if (map->hashes) {
+        *GET_HSH(map, idx) = (u32)hash;
+    }
+    map->size++;
+}
 
-        if (slot_psl == BUCKET_EMPTY) {
-            *GET_PSL(map, i) = psl;
-            memcpy(GET_KEY(map, i), key, map->key_size);
-            memcpy(GET_VAL(map, i), val, map->val_size);
-            map->size++;
-            return;
+
+// Remove the entry at slot (raw bytes — callbacks are the caller's job).
+// Backward-shift deletion: pull subsequent entries one slot back as long as
+// they have PSL > 1.  Entries at their home slot (PSL == 1) must not move.
+// This restores the Robin Hood invariant without tombstones.
+static void map_erase(hashmap* map, u64 slot)
+{
+    u64 cur = slot;
+    for (;;) {
+        u64 next     = MAP_NEXT(map, cur);
+        u8  next_psl = *GET_PSL(map, next);
+
+        // Stop if next slot is empty or the next entry is already at its home slot.
+        if (next_psl <= 1) {
+            *GET_PSL(map, cur) = BUCKET_EMPTY;
+            break;
         }
 
-        if (slot_psl < psl) {
-            u8 tmp_psl = slot_psl;
-            // Evict into swp (disjoint from key which is in cur)
-            memcpy(swp_key, GET_KEY(map, i), map->key_size);
-            memcpy(swp_val, GET_VAL(map, i), map->val_size);
-
-            *GET_PSL(map, i) = psl;
-            memcpy(GET_KEY(map, i), key, map->key_size);
-            memcpy(GET_VAL(map, i), val, map->val_size);
-
-            // Swap roles: evicted becomes current, current becomes swap buffer
-            u8* tmp = cur_key;
-            cur_key = swp_key;
-            swp_key = tmp;
-            tmp     = cur_val;
-            cur_val = swp_val;
-            swp_val = tmp;
-            key     = cur_key;
-            val     = cur_val;
-            psl     = tmp_psl + 1;
-            continue;
+        // Shift next entry one slot back; its PSL decreases by 1.
+        *GET_PSL(map, cur) = next_psl - 1;
+        memcpy(GET_KEY(map, cur), GET_KEY(map, next), map->key_size);
+        memcpy(GET_VAL(map, cur), GET_VAL(map, next), map->val_size);
+        if (map->hashes) {
+            *GET_HSH(map, cur) = *GET_HSH(map, next);
         }
 
-        psl++;
+        cur = next;
     }
+
+    map->size--;
 }
 
 
@@ -691,53 +1725,292 @@ static void map_insert(hashmap* map, u8* key, u8* val, u8 psl, u64 idx)
 // Ownership transfers as raw bytes — no copy/del callbacks are invoked.
 // This is safe because the data itself doesn't move, only the slot positions.
 static void map_resize(hashmap* map, u64 new_capacity)
+{
+    map_rehash(map, new_capacity, map->seed);
+}
+
+
+// Rebuild the table at new_capacity under seed, taking in the entries of
+// both tables when an incremental resize is in flight. If a psl overflows
+// the new table is thrown away and built again under a fresh seed, twice
+// the size if it is past the default load (see map_check_overflow) or the
+// seeds keep failing. A run of keys with equal hash_fn outputs is rebuilt
+// as it is under RH_PSL_MAX instead: no seed would split it.
+static void map_rehash(hashmap* map, u64 new_capacity, u64 seed)
 {
     if (new_capacity < HASHMAP_INIT_CAPACITY) {
         new_capacity = HASHMAP_INIT_CAPACITY;
     }
 
-    u8* old_keys = map->keys;
-    u8* old_psls = map->psls;
-    u8* old_vals = map->vals;
-    u64 old_cap  = map->capacity;
+    MAP_COUNT(map, resizes, 1);
+
+    hashmap  cur = *map; // the current arrays, by value
+    hashmap* old = map->old;
+
+    map->old           = NULL;
+    map->migrate_start = 0;
+    map->migrated      = 0;
+
+    for (u32 tries = 0;; tries++) {
+        // past 2^32 buckets the cached low bits can't place entries — drop the cache
+        b8 keep_cache = cur.hashes && new_capacity <= MAP_HASH_CACHE_MAX_CAP;
+
+        // cached bits were computed under the old seed
+        b8 cached     = keep_cache && seed == cur.seed;
+        map->seed     = seed;
+        map->capacity = new_capacity;
+
+        map->keys = map_alloc(map, new_capacity * map->key_size);
+        CHECK_FATAL(!map->keys, "resize keys calloc failed");
+        map->psls = map_calloc(map, new_capacity * sizeof(u8));
+        CHECK_FATAL(!map->psls, "resize psls calloc failed");
+        map->vals = map_alloc(map, new_capacity * map->val_size);
+        CHECK_FATAL(!map->vals, "resize vals calloc failed");
+
+        map->hashes = NULL;
+        if (keep_cache) {
+            map->hashes = (u32*)map_alloc(map, new_capacity * sizeof(u32));
+            CHECK_FATAL(!map->hashes, "resize hashes malloc failed");
+        }
+
+        map->size         = 0;
+        map->psl_overflow = 0;
+
+        if (map_rehash_from(map, &cur, cached) && (!old || map_rehash_from(map, old, cached))) {
+            break;
+        }
+
+        u64 twins = rh_overflow_twins(map->psls, map->keys, map->key_size, map->capacity,
+                                      map->psl_limit, map->hash_fn);
+        CHECK_FATAL(twins >= RH_PSL_MAX, "psl overflow: hash_fn maps over 254 keys to one hash");
+
+        map_free(map, map->keys);
+        map_free(map, map->psls);
+        map_free(map, map->vals);
+        map_free(map, map->hashes);
+
+        if (map->psl_limit < RH_PSL_MAX && twins * 2 >= RH_PSL_LIMIT) {
+            map->psl_limit = RH_PSL_MAX; // same seed and size, keep the run
+        } else {
+            seed = map_seed_random();
+            if (tries >= MAP_RESEED_TRIES || map_overflow_grows(cur.size, new_capacity)) {
+                new_capacity *= 2;
+            }
+        }
+    }
+
+    // arena maps just leave the old arrays behind until the arena is cleared
+    map_free(map, cur.keys);
+    map_free(map, cur.psls);
+    map_free(map, cur.vals);
+    map_free(map, cur.hashes);
+    if (old) {
+        map_free(map, old->keys);
+        map_free(map, old->psls);
+        map_free(map, old->vals);
+        map_free(map, old->hashes);
+        map_free(map, old);
+    }
 
-    // map->keys = calloc(new_capacity, map->key_size);
-    map->keys = malloc(new_capacity * map->key_size);
+    map_drop_snapshot(map); // the new tables are on the heap
+}
+
+
+// Insert every entry of src (raw bytes) into the fresh table of map.
+// cached: src->hashes hold this seed's bits, no need to rehash the keys.
+// Returns 0 as soon as a psl overflows.
+static b8 map_rehash_from(hashmap* map, const hashmap* src, b8 cached)
+{
+    for (u64 i = 0; i < src->capacity; i++) {
+        if (*GET_PSL(src, i) == BUCKET_EMPTY) {
+            continue;
+        }
+
+        u8* src_key = GET_KEY(src, i);
+        u64 hash    = cached && src->hashes ? *GET_HSH(src, i) : MAP_HASH(map, src_key);
+
+        // src arrays are disjoint from the new ones — copy straight across
+        u8  out_psl;
+        u64 slot = map_insert_pos(map, MAP_HOME(map, hash), &out_psl);
+
+        map_insert(map, out_psl, slot, hash);
+        memcpy(GET_KEY(map, slot), src_key, map->key_size);
+        memcpy(GET_VAL(map, slot), GET_VAL(src, i), map->val_size);
+
+        if (map->psl_overflow) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+====================INCREMENTAL RESIZE====================
+*/
+// Growth moves the current arrays into map->old and gives the map empty
+// arrays of twice the size. New keys always go to the new table; every
+// put/del then drains MAP_MIGRATE_STEP old buckets, walking forward from
+// migrate_start. That start is an empty bucket, and the old table only ever
+// loses entries, so no Robin Hood run crosses it: the moved buckets form
+// one arc [migrate_start, migrate_start + migrated) and a probe whose home
+// falls inside the arc can resume right after it.
+
+static void map_grow_incremental(hashmap* map)
+{
+    // the previous resize must be done before the table is swapped again
+    map_migrate_all(map);
+    MAP_COUNT(map, resizes, 1);
+
+    hashmap* old = (hashmap*)map_alloc(map, sizeof(hashmap));
+    CHECK_FATAL(!old, "resize old table malloc failed");
+    *old     = *map;
+    old->old = NULL;
+
+    u64 new_capacity = map->capacity * 2;
+
+    map->keys = map_alloc(map, new_capacity * map->key_size);
     CHECK_FATAL(!map->keys, "resize keys calloc failed");
-    map->psls = calloc(new_capacity, sizeof(u8));
+    map->psls = map_calloc(map, new_capacity * sizeof(u8));
     CHECK_FATAL(!map->psls, "resize psls calloc failed");
-    // map->vals = calloc(new_capacity, map->val_size);
-    map->vals = malloc(new_capacity * map->val_size);
+    map->vals = map_alloc(map, new_capacity * map->val_size);
     CHECK_FATAL(!map->vals, "resize vals calloc failed");
 
-    map->capacity = new_capacity;
-    map->size     = 0;
+    // same rule as map_resize: past 2^32 buckets the cache can't place entries
+    map->hashes = NULL;
+    if (old->hashes && new_capacity <= MAP_HASH_CACHE_MAX_CAP) {
+        map->hashes = (u32*)map_alloc(map, new_capacity * sizeof(u32));
+        CHECK_FATAL(!map->hashes, "resize hashes malloc failed");
+    }
 
+    // size stays the total of both tables
+    map->capacity      = new_capacity;
+    map->old           = old;
+    map->migrate_start = rh_run_end(old->psls, 0, old->capacity - 1);
+    map->migrated      = 0;
+}
 
-    for (u64 i = 0; i < old_cap; i++) {
 
-        if (old_psls[i] == BUCKET_EMPTY) {
-            continue;
+// One slice of an incremental resize, run by every put/del before it probes.
+// The key's own entry is pulled across first, so the rest of the call only
+// has to look at the new table.
+static inline void map_migrate_step(hashmap* map, const u8* key, u64 hash)
+{
+    if (!map->old) {
+        return;
+    }
+
+    u64 slot;
+    if (map_lookup_old(map, key, hash, &slot)) {
+        map_move_in(map, slot);
+        map_erase(map->old, slot);
+    }
+
+    map_migrate(map, MAP_MIGRATE_STEP);
+}
+
+
+// Move up to `buckets` old buckets into the new table. Frees the old table
+// once its last entry is gone.
+static void map_migrate(hashmap* map, u64 buckets)
+{
+    hashmap* old  = map->old;
+    u64      mask = old->capacity - 1;
+
+    // stop on a psl overflow: moving more entries only lengthens the runs
+    for (; buckets > 0 && old->size > 0 && !map->psl_overflow; buckets--) {
+        u64 i = (map->migrate_start + map->migrated) & mask;
+        if (*GET_PSL(old, i) != BUCKET_EMPTY) {
+            map_move_in(map, i);
+            *GET_PSL(old, i) = BUCKET_EMPTY;
+            old->size--;
         }
+        map->migrated++;
+    }
+
+    if (old->size == 0) {
+        // every entry moved out as raw bytes — nothing left to delete
+        map_free(map, old->keys);
+        map_free(map, old->psls);
+        map_free(map, old->vals);
+        map_free(map, old->hashes);
+        map_free(map, old);
+        map->old = NULL;
+    }
+}
 
-        u8* old_key = old_keys + ((u64)map->key_size * i);
-        u8* old_val = old_vals + ((u64)map->val_size * i);
 
-        // Stage into scratch first — map_insert uses SWAP region of scratch
-        // and would clobber old_key/old_val if they happened to alias it
-        memcpy(STAGE_KEY(map), old_key, map->key_size);
-        memcpy(STAGE_VAL(map), old_val, map->val_size);
+static inline void map_migrate_all(hashmap* map)
+{
+    if (map->old) {
+        map_migrate(map, map->old->capacity);
+    }
+    // stopped by a psl overflow: the reseed drains what is left
+    if (map->old) {
+        map_rehash(map, map->capacity, map_seed_random());
+    }
+}
+
 
-        LOOKUP_RES res;
-        u8         out_psl;
-        u64        slot = map_lookup(map, STAGE_KEY(map), &res, &out_psl);
+// Find key in the old table. Buckets of the moved arc are empty, so a probe
+// whose home lies inside it starts at the first unmoved bucket instead,
+// carrying the distance it skipped.
+static b8 map_lookup_old(const hashmap* map, const u8* key, u64 hash, u64* slot)
+{
+    const hashmap* old  = map->old;
+    u64            mask = old->capacity - 1;
+    u64            idx  = hash & mask;
+    u64            psl  = 1; // wide: the skip can exceed any stored psl
+    u64            dist = (idx - map->migrate_start) & mask;
+
+    if (dist < map->migrated) {
+        psl += map->migrated - dist;
+        idx  = (map->migrate_start + map->migrated) & mask;
+    }
+
+    // second table of the same lookup: buckets count, the lookup doesn't
+    for (;; idx = (idx + 1) & mask, psl++) {
+        u8 slot_psl = *GET_PSL(old, idx);
+        MAP_COUNT(map, probes, 1);
 
-        map_insert(map, STAGE_KEY(map), STAGE_VAL(map), out_psl, slot);
+        // empty (0) or Robin Hood exit — same rules as map_lookup
+        if (slot_psl < psl) {
+            return 0;
+        }
+        if ((!old->hashes || *GET_HSH(old, idx) == (u32)hash) &&
+            (MAP_COUNT(map, compares, 1),
+             map->cmp_fn(GET_KEY(old, idx), key, map->key_size) == 0)) {
+            *slot = idx;
+            return 1;
+        }
     }
+}
+
+
+// Copy old bucket old_slot into the new table (raw bytes, the entry moves).
+// The caller empties the old bucket.
+static void map_move_in(hashmap* map, u64 old_slot)
+{
+    const hashmap* old  = map->old;
+    u64            hash = map_old_hash(map, old_slot);
 
-    free(old_keys);
-    free(old_psls);
-    free(old_vals);
+    u8  out_psl;
+    u64 slot = map_insert_pos(map, MAP_HOME(map, hash), &out_psl);
+
+    map_insert(map, out_psl, slot, hash);
+    memcpy(GET_KEY(map, slot), GET_KEY(old, old_slot), map->key_size);
+    memcpy(GET_VAL(map, slot), GET_VAL(old, old_slot), map->val_size);
+
+    map->size--; // moved, not added
 }
 
 
+// Hash of an old-table entry: the cached bits when both tables cache them.
+static inline u64 map_old_hash(const hashmap* map, u64 old_slot)
+{
+    const hashmap* old = map->old;
+    if (map->hashes && old->hashes) {
+        return *GET_HSH(old, old_slot);
+    }
+    return MAP_HASH(map, GET_KEY(old, old_slot));
+}
@@ -0,0 +1,473 @@
+#include "hashmap_concurrent.h"
+
+#include <string.h>
+
+
+// hash_fn runs once per call. The high 16 bits of that result under the
+// map's seed pick the shard; the shard's hashmap mixes it with its own seed
+// (read under the shard lock, or from the probed map when lock-free)
+#define CMAP_RAW(map, key)   ((map)->hash_fn((key), (map)->key_size))
+#define CMAP_SHARD(map, raw) \
+    (&(map)->shards[(map_seed_mix((raw), (map)->seed) >> 48) & ((map)->shard_count - 1)])
+#define CMAP_HASH(m, raw) map_seed_mix((raw), (m)->seed)
+
+// lock-free reads give up and take the read lock after this many retries
+#define CMAP_READ_RETRIES 8
+
+// hashmap grows once size reaches its max_load (see map_maybe_resize)
+#define CMAP_WOULD_GROW(m) map_load_reached((m)->size + 1, (m)->capacity, (m)->max_load)
+
+
+struct cmap_retired {
+    hashmap*      map;
+    cmap_retired* next;
+};
+
+
+/*
+====================PRIVATE DECLARATIONS====================
+*/
+
+static inline hashmap* shard_map(const cmap_shard* sh);
+static inline void     shard_write_begin(cmap_shard* sh);
+static inline void     shard_write_end(cmap_shard* sh);
+static b8              shard_read_optimistic(const cmap_shard* sh, const u8* key, u64 raw,
+                                             u8* val, b8* found);
+static b8              shard_probe(const hashmap* m, const u8* key, u64 hash, u8* val);
+static void            shard_free_retired(cmap_shard* sh);
+static void            shard_rebuild(hashmap_concurrent* map, cmap_shard* sh, const u8* key,
+                                     const u8* val);
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+hashmap_concurrent* hashmap_concurrent_create(u32 shard_count, u32 key_size, u32 val_size,
+                                              custom_hash_fn hash_fn, compare_fn cmp_fn,
+                                              const container_ops* key_ops,
+                                              const container_ops* val_ops)
+{
+    if (shard_count == 0) {
+        shard_count = HASHMAP_CONCURRENT_SHARDS;
+    }
+    CHECK_FATAL((shard_count & (shard_count - 1)) != 0, "shard_count must be a power of 2");
+    CHECK_FATAL(shard_count > (1u << 16), "shard_count too large");
+
+    hashmap_concurrent* map = malloc(sizeof(hashmap_concurrent));
+    CHECK_FATAL(!map, "map malloc failed");
+
+    map->shards = aligned_alloc(_Alignof(cmap_shard), sizeof(cmap_shard) * shard_count);
+    CHECK_FATAL(!map->shards, "shards alloc failed");
+
+    map->shard_count = shard_count;
+    map->key_size    = key_size;
+    map->val_size    = val_size;
+    map->hash_fn     = hash_fn ? hash_fn : wyhash;
+    map->cmp_fn      = cmp_fn ? cmp_fn : default_compare;
+    map->seed        = WC_MAP_SEEDED ? map_seed_random() : 0;
+    map->key_ops     = key_ops;
+    map->val_ops     = val_ops;
+    map->optimistic  = HASHMAP_CONCURRENT_OPTIMISTIC && !key_ops && !val_ops &&
+                       key_size <= CMAP_OPTIMISTIC_KEY_MAX;
+
+    for (u32 i = 0; i < shard_count; i++) {
+        cmap_shard* sh = &map->shards[i];
+        CHECK_FATAL(pthread_rwlock_init(&sh->lock, NULL) != 0, "rwlock init failed");
+        atomic_init(&sh->seq, 0);
+
+        hashmap* m = hashmap_create(key_size, val_size, map->hash_fn, map->cmp_fn, key_ops,
+                                    val_ops);
+        // shard_probe walks a single table — no incremental resize under it,
+        // and no reseed in place either (shard_rebuild does that)
+        if (map->optimistic) {
+            hashmap_set_incremental(m, 0);
+            m->defer_reseed = 1;
+        }
+        atomic_init(&sh->map, m);
+        sh->retired = NULL;
+    }
+
+    return map;
+}
+
+
+void hashmap_concurrent_destroy(hashmap_concurrent* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    for (u32 i = 0; i < map->shard_count; i++) {
+        cmap_shard* sh = &map->shards[i];
+
+        hashmap_destroy(shard_map(sh));
+        shard_free_retired(sh);
+        pthread_rwlock_destroy(&sh->lock);
+    }
+
+    free(map->shards);
+    free(map);
+}
+
+
+// Insert or update — COPY semantics (see hashmap_put).
+b8 hashmap_concurrent_put(hashmap_concurrent* map, const u8* key, const u8* val)
+{
+    CHECK_FATAL(!map || !key || !val, "args null");
+
+    u64         raw = CMAP_RAW(map, key);
+    cmap_shard* sh  = CMAP_SHARD(map, raw);
+    b8          existed;
+
+    pthread_rwlock_wrlock(&sh->lock);
+    shard_write_begin(sh);
+
+    hashmap* m    = shard_map(sh);
+    u64      hash = CMAP_HASH(m, raw);
+    // lock-free readers may be inside m — it must never resize in place
+    if (map->optimistic && CMAP_WOULD_GROW(m) && !hashmap_has_with_hash(m, key, hash)) {
+        shard_rebuild(map, sh, key, val);
+        existed = 0;
+    } else {
+        existed = hashmap_put_with_hash(m, key, val, hash);
+        if (m->psl_overflow) {
+            shard_rebuild(map, sh, NULL, NULL); // same reason: reseed by copy
+        }
+    }
+
+    shard_write_end(sh);
+    pthread_rwlock_unlock(&sh->lock);
+    return existed;
+}
+
+
+// Insert or update — MOVE semantics (see hashmap_put_move).
+// Needs move_fn, so the map is never in lock-free read mode here.
+b8 hashmap_concurrent_put_move(hashmap_concurrent* map, u8** key, u8** val)
+{
+    CHECK_FATAL(!map || !key || !val || !*key || !*val, "args null");
+
+    cmap_shard* sh = CMAP_SHARD(map, CMAP_RAW(map, *key));
+
+    pthread_rwlock_wrlock(&sh->lock);
+    shard_write_begin(sh);
+    b8 existed = hashmap_put_move(shard_map(sh), key, val);
+    shard_write_end(sh);
+    pthread_rwlock_unlock(&sh->lock);
+
+    return existed;
+}
+
+
+// Insert or update — key COPIED, val MOVED (see hashmap_put_val_move).
+b8 hashmap_concurrent_put_val_move(hashmap_concurrent* map, const u8* key, u8** val)
+{
+    CHECK_FATAL(!map || !key || !val || !*val, "args null");
+
+    cmap_shard* sh = CMAP_SHARD(map, CMAP_RAW(map, key));
+
+    pthread_rwlock_wrlock(&sh->lock);
+    shard_write_begin(sh);
+    b8 existed = hashmap_put_val_move(shard_map(sh), key, val);
+    shard_write_end(sh);
+    pthread_rwlock_unlock(&sh->lock);
+
+    return existed;
+}
+
+
+// Get value for key — COPIES into val. Returns 1 if found, 0 if not.
+// POD maps try a lock-free seqlock read first.
+b8 hashmap_concurrent_get(const hashmap_concurrent* map, const u8* key, u8* val)
+{
+    CHECK_FATAL(!map || !key || !val, "null arg");
+
+    u64         raw = CMAP_RAW(map, key);
+    cmap_shard* sh  = CMAP_SHARD(map, raw);
+    b8          found;
+
+    if (map->optimistic && shard_read_optimistic(sh, key, raw, val, &found)) {
+        return found;
+    }
+
+    pthread_rwlock_rdlock(&sh->lock);
+    hashmap* m = shard_map(sh);
+    found      = hashmap_get_with_hash(m, key, val, CMAP_HASH(m, raw));
+    pthread_rwlock_unlock(&sh->lock);
+
+    return found;
+}
+
+
+// Check if key exists. POD maps try a lock-free seqlock read first.
+b8 hashmap_concurrent_has(const hashmap_concurrent* map, const u8* key)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    u64         raw = CMAP_RAW(map, key);
+    cmap_shard* sh  = CMAP_SHARD(map, raw);
+    b8          found;
+
+    if (map->optimistic && shard_read_optimistic(sh, key, raw, NULL, &found)) {
+        return found;
+    }
+
+    pthread_rwlock_rdlock(&sh->lock);
+    hashmap* m = shard_map(sh);
+    found      = hashmap_has_with_hash(m, key, CMAP_HASH(m, raw));
+    pthread_rwlock_unlock(&sh->lock);
+
+    return found;
+}
+
+
+// Delete key. If out != NULL the value is MOVED into it (see hashmap_del).
+b8 hashmap_concurrent_del(hashmap_concurrent* map, const u8* key, u8* out)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    u64         raw = CMAP_RAW(map, key);
+    cmap_shard* sh  = CMAP_SHARD(map, raw);
+
+    pthread_rwlock_wrlock(&sh->lock);
+    shard_write_begin(sh);
+    hashmap* m     = shard_map(sh);
+    b8       found = hashmap_del_with_hash(m, key, out, CMAP_HASH(m, raw));
+    shard_write_end(sh);
+    pthread_rwlock_unlock(&sh->lock);
+
+    return found;
+}
+
+
+// Remove all elements, one shard at a time. Capacity is kept.
+void hashmap_concurrent_clear(hashmap_concurrent* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    for (u32 i = 0; i < map->shard_count; i++) {
+        cmap_shard* sh = &map->shards[i];
+
+        pthread_rwlock_wrlock(&sh->lock);
+        shard_write_begin(sh);
+        hashmap_clear(shard_map(sh));
+        shard_write_end(sh);
+        pthread_rwlock_unlock(&sh->lock);
+    }
+}
+
+
+// Set every shard's growth load. A shard already past it is rebuilt
+// bigger right away (by copy in lock-free mode, like any growth).
+void hashmap_concurrent_set_max_load(hashmap_concurrent* map, double load)
+{
+    CHECK_FATAL(!map, "map is null");
+    CHECK_FATAL(load < LOAD_FACTOR_MIN || load > LOAD_FACTOR_MAX, "max load out of range");
+
+    for (u32 i = 0; i < map->shard_count; i++) {
+        cmap_shard* sh = &map->shards[i];
+
+        pthread_rwlock_wrlock(&sh->lock);
+        shard_write_begin(sh);
+
+        hashmap* m = shard_map(sh);
+        if (map->optimistic) {
+            m->max_load = MAP_LOAD_PCT(load);
+            if (map_load_reached(m->size, m->capacity, m->max_load)) {
+                shard_rebuild(map, sh, NULL, NULL);
+            }
+        } else {
+            hashmap_set_max_load(m, load);
+        }
+
+        shard_write_end(sh);
+        pthread_rwlock_unlock(&sh->lock);
+    }
+}
+
+
+// Sum of shard sizes. Each shard is read under its lock, but writers may
+// run between shards — exact only when the map is quiescent.
+u64 hashmap_concurrent_size(const hashmap_concurrent* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    u64 total = 0;
+    for (u32 i = 0; i < map->shard_count; i++) {
+        cmap_shard* sh = &map->shards[i];
+
+        pthread_rwlock_rdlock(&sh->lock);
+        total += shard_map(sh)->size;
+        pthread_rwlock_unlock(&sh->lock);
+    }
+    return total;
+}
+
+
+void hashmap_concurrent_reclaim(hashmap_concurrent* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    for (u32 i = 0; i < map->shard_count; i++) {
+        shard_free_retired(&map->shards[i]);
+    }
+}
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+static inline hashmap* shard_map(const cmap_shard* sh)
+{
+    return atomic_load_explicit(&((cmap_shard*)sh)->map, memory_order_acquire);
+}
+
+
+// Seqlock write side. Called with the write lock held, so only one
+// writer per shard ever touches seq.
+static inline void shard_write_begin(cmap_shard* sh)
+{
+    u32 s = atomic_load_explicit(&sh->seq, memory_order_relaxed);
+    atomic_store_explicit(&sh->seq, s + 1, memory_order_relaxed);
+    // the odd value must be visible before any of the shard's bytes change
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void shard_write_end(cmap_shard* sh)
+{
+    u32 s = atomic_load_explicit(&sh->seq, memory_order_relaxed);
+    atomic_store_explicit(&sh->seq, s + 1, memory_order_release);
+}
+
+
+// Seqlock read side. Returns 1 with *found set when a consistent read
+// went through, 0 when writers kept interfering (caller takes the lock).
+static b8 shard_read_optimistic(const cmap_shard* sh, const u8* key, u64 raw, u8* val,
+                                b8* found)
+{
+    for (u32 attempt = 0; attempt < CMAP_READ_RETRIES; attempt++) {
+        u32 s1 = atomic_load_explicit(&sh->seq, memory_order_acquire);
+        if (s1 & 1) {
+            continue; // writer inside
+        }
+
+        // the map (and its arrays) stays allocated until reclaim / destroy,
+        // which no reader overlaps, even if a writer swaps it out meanwhile —
+        // the bytes may be torn, never freed
+        // a published map keeps its seed: rebuilds swap in a new map
+        const hashmap* m = shard_map(sh);
+        b8             f = shard_probe(m, key, CMAP_HASH(m, raw), val);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&sh->seq, memory_order_relaxed) == s1) {
+            *found = f;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+// Copy n bytes a writer may be changing, every one through a relaxed atomic
+// load (whole words where src is aligned). The copy may be torn; the
+// sequence check throws such reads away.
+static inline void shard_load_bytes(u8* dest, const u8* src, u64 n)
+{
+    u64 i = 0;
+    if (((uintptr_t)src & 7) == 0) {
+        for (; i + 8 <= n; i += 8) {
+            u64 w = __atomic_load_n((const u64*)(src + i), __ATOMIC_RELAXED);
+            memcpy(dest + i, &w, sizeof(w));
+        }
+    }
+    for (; i < n; i++) {
+        dest[i] = __atomic_load_n(src + i, __ATOMIC_RELAXED);
+    }
+}
+
+// Robin Hood probe over a map that may be changing underneath. The table
+// bytes are read with relaxed atomic loads (cmp_fn sees a stack copy of the
+// key), every bucket index is masked and the walk is bounded, so torn
+// psls can only produce a wrong answer — which the sequence check then
+// throws away. val may be NULL.
+static b8 shard_probe(const hashmap* m, const u8* key, u64 hash, u8* val)
+{
+    u64 mask = m->capacity - 1;
+    u64 i    = hash & mask;
+    u8  slot_key[CMAP_OPTIMISTIC_KEY_MAX];
+
+    // stored psls are u8, so no real probe is longer than 255
+    for (u32 psl = 1; psl <= 255 && psl <= m->capacity; psl++, i = (i + 1) & mask) {
+        u8 slot_psl = __atomic_load_n(m->psls + i, __ATOMIC_RELAXED);
+
+        if (slot_psl < psl) {
+            return 0; // empty (0) or Robin Hood exit
+        }
+        if (m->hashes && __atomic_load_n(m->hashes + i, __ATOMIC_RELAXED) != (u32)hash) {
+            continue;
+        }
+        shard_load_bytes(slot_key, m->keys + (i * m->key_size), m->key_size);
+        if (m->cmp_fn(slot_key, key, m->key_size) == 0) {
+            if (val) {
+                shard_load_bytes(val, m->vals + (i * m->val_size), m->val_size);
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+// Replace a shard's hashmap without touching it in place: build a copy
+// holding the old entries (plus key/val when key is not NULL), publish it,
+// retire the old map. Used when a put would grow the map, and to reseed it
+// after a psl overflow — the copy draws a fresh seed of its own.
+// POD-only (lock-free mode), so entries copy as raw bytes.
+static void shard_rebuild(hashmap_concurrent* map, cmap_shard* sh, const u8* key, const u8* val)
+{
+    hashmap* old = shard_map(sh);
+    hashmap* big = hashmap_create(map->key_size, map->val_size, map->hash_fn, map->cmp_fn,
+                                  NULL, NULL);
+    hashmap_set_incremental(big, 0);
+    big->max_load  = old->max_load;
+    big->psl_limit = old->psl_limit;
+    if (old->hashes) {
+        hashmap_set_hash_cache(big, 1);
+    }
+    // one allocation at the final size instead of doubling up from 16
+    hashmap_reserve(big, old->size + 1);
+
+    // not published yet, so big may still reseed itself in place
+    for (u64 i = 0; i < old->capacity; i++) {
+        if (old->psls[i] != 0) {
+            hashmap_put(big, old->keys + (i * old->key_size), old->vals + (i * old->val_size));
+        }
+    }
+    if (key) {
+        hashmap_put(big, key, val);
+    }
+    big->defer_reseed = 1;
+
+    cmap_retired* r = malloc(sizeof(cmap_retired));
+    CHECK_FATAL(!r, "retired node malloc failed");
+    r->map      = old;
+    r->next     = sh->retired;
+    sh->retired = r;
+
+    atomic_store_explicit(&sh->map, big, memory_order_release);
+}
+
+
+// Free the shard's retired maps. They only ever hold POD bytes already
+// copied forward.
+static void shard_free_retired(cmap_shard* sh)
+{
+    cmap_retired* r = sh->retired;
+    while (r) {
+        cmap_retired* next = r->next;
+        hashmap_destroy(r->map);
+        free(r);
+        r = next;
+    }
+    sh->retired = NULL;
+}
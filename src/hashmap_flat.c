@@ -0,0 +1,686 @@
+#include "hashmap_flat.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) && !defined(HASHMAP_FLAT_NO_SIMD)
+    #include <emmintrin.h>
+    #define FLAT_SSE2 1
+#else
+    #define FLAT_SSE2 0
+#endif
+
+
+#define GET_KEY(map, i) ((map)->keys + ((u64)(map)->key_size * (i)))
+#define GET_VAL(map, i) ((map)->vals + ((u64)(map)->val_size * (i)))
+
+// capacity is always power-of-2 (and >= HASHMAP_FLAT_GROUP)
+#define FLAT_MASK(map)      ((map)->capacity - 1)
+#define FLAT_HASH(map, key) ((map)->hash_fn((key), (map)->key_size))
+
+#define CTRL_EMPTY   ((u8)0x80)
+#define CTRL_DELETED ((u8)0xFE)
+#define CTRL_FULL(c) (((c) & 0x80) == 0)
+
+// h1 picks the probe start, h2 (low 7 bits) is stored in ctrl
+#define FLAT_H1(hash) ((hash) >> 7)
+#define FLAT_H2(hash) ((u8)((hash) & 0x7F))
+
+// max load 7/8 — group probing stays short far past Robin Hood's 0.75
+#define FLAT_MAX_LOAD(cap) ((cap) - ((cap) / 8))
+
+#define IS_POD_K(map) (map->key_ops == NULL)
+#define IS_POD_V(map) (map->val_ops == NULL)
+
+
+/*
+====================GROUP SCAN====================
+*/
+// Each function looks at 16 ctrl bytes starting at g and returns a bitmask,
+// bit i set when ctrl[g + i] matches.
+
+#if FLAT_SSE2
+
+static inline u32 group_match(const u8* g, u8 h2)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)g);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)h2)));
+}
+
+static inline u32 group_match_empty(const u8* g)
+{
+    return group_match(g, CTRL_EMPTY);
+}
+
+// empty or deleted — both have the high bit set
+static inline u32 group_match_free(const u8* g)
+{
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)g));
+}
+
+#else
+
+// SWAR fallback: 8 ctrl bytes per u64 (little-endian byte order)
+
+#define SWAR_LSB 0x0101010101010101ULL
+#define SWAR_LO7 0x7F7F7F7F7F7F7F7FULL
+#define SWAR_MSB 0x8080808080808080ULL
+
+// gather the high bit of each byte into an 8-bit mask
+static inline u32 swar_movemask(u64 x)
+{
+    return (u32)((((x >> 7) & SWAR_LSB) * 0x0102040810204080ULL) >> 56);
+}
+
+// high bit set in every byte equal to b (exact, no false positives)
+static inline u64 swar_eq(u64 w, u8 b)
+{
+    u64 x = w ^ (SWAR_LSB * b);
+    return ~(((x & SWAR_LO7) + SWAR_LO7) | x | SWAR_LO7);
+}
+
+static inline u32 group_match(const u8* g, u8 h2)
+{
+    u64 lo, hi;
+    memcpy(&lo, g, 8);
+    memcpy(&hi, g + 8, 8);
+    return swar_movemask(swar_eq(lo, h2)) | (swar_movemask(swar_eq(hi, h2)) << 8);
+}
+
+static inline u32 group_match_empty(const u8* g)
+{
+    return group_match(g, CTRL_EMPTY);
+}
+
+static inline u32 group_match_free(const u8* g)
+{
+    u64 lo, hi;
+    memcpy(&lo, g, 8);
+    memcpy(&hi, g + 8, 8);
+    return swar_movemask(lo & SWAR_MSB) | (swar_movemask(hi & SWAR_MSB) << 8);
+}
+
+#endif
+
+
+/*
+====================PRIVATE DECLARATIONS====================
+*/
+
+static u64         flat_find(const hashmap_flat* map, const u8* key, u64 hash, b8* found);
+static u64         flat_find_free(const hashmap_flat* map, u64 hash);
+static inline void flat_set_ctrl(hashmap_flat* map, u64 i, u8 c);
+static u64         flat_insert(hashmap_flat* map, u64 hash);
+static void        flat_erase(hashmap_flat* map, u64 i);
+static void        flat_alloc(hashmap_flat* map, u64 capacity);
+static void        flat_resize(hashmap_flat* map, u64 new_capacity);
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+hashmap_flat* hashmap_flat_create(u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                                  compare_fn cmp_fn, const container_ops* key_ops,
+                                  const container_ops* val_ops)
+{
+    CHECK_FATAL(key_size == 0 || val_size == 0, "key/val size can't be 0");
+
+    hashmap_flat* map = malloc(sizeof(hashmap_flat));
+    CHECK_FATAL(!map, "map malloc failed");
+
+    map->key_size = key_size;
+    map->val_size = val_size;
+
+    flat_alloc(map, HASHMAP_INIT_CAPACITY);
+    map->size = 0;
+
+    map->hash_fn = hash_fn ? hash_fn : wyhash;
+    map->cmp_fn  = cmp_fn ? cmp_fn : default_compare;
+
+    map->key_ops = key_ops;
+    map->val_ops = val_ops;
+
+    return map;
+}
+
+
+static void hashmap_flat_destroy_stk(hashmap_flat* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    if (!IS_POD_K(map) || !IS_POD_V(map)) {
+        delete_fn k_del = FLAT_DEL(map->key_ops);
+        delete_fn v_del = FLAT_DEL(map->val_ops);
+        if (k_del || v_del) {
+            for (u64 i = 0; i < map->capacity; i++) {
+                if (!CTRL_FULL(map->ctrl[i])) {
+                    continue;
+                }
+                if (k_del) {
+                    k_del(GET_KEY(map, i));
+                }
+                if (v_del) {
+                    v_del(GET_VAL(map, i));
+                }
+            }
+        }
+    }
+
+    free(map->ctrl);
+    free(map->keys);
+    free(map->vals);
+}
+
+void hashmap_flat_destroy(hashmap_flat* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    hashmap_flat_destroy_stk(map);
+    free(map);
+}
+
+
+// Insert or update — COPY semantics.
+// Ownership: map takes a deep copy of key and val via ops->copy_fn (or memcpy for POD).
+// Returns 1 if key existed (updated), 0 if new key inserted.
+b8 hashmap_flat_put(hashmap_flat* map, const u8* key, const u8* val)
+{
+    CHECK_FATAL(!map || !key || !val, "args null");
+
+    b8  found;
+    u64 hash = FLAT_HASH(map, key);
+    u64 slot = flat_find(map, key, hash, &found);
+
+    copy_fn v_cp = FLAT_COPY(map->val_ops);
+
+    if (found) {
+        delete_fn v_del = FLAT_DEL(map->val_ops);
+        if (v_del) {
+            v_del(GET_VAL(map, slot));
+        }
+        if (v_cp) {
+            v_cp(GET_VAL(map, slot), val);
+        } else {
+            memcpy(GET_VAL(map, slot), val, map->val_size);
+        }
+        return 1;
+    }
+
+    slot = flat_insert(map, hash);
+
+    copy_fn k_cp = FLAT_COPY(map->key_ops);
+    if (k_cp) {
+        k_cp(GET_KEY(map, slot), key);
+    } else {
+        memcpy(GET_KEY(map, slot), key, map->key_size);
+    }
+    if (v_cp) {
+        v_cp(GET_VAL(map, slot), val);
+    } else {
+        memcpy(GET_VAL(map, slot), val, map->val_size);
+    }
+
+    return 0;
+}
+
+
+// Insert or update — MOVE semantics.
+// Ownership: the map takes ownership of *key and *val; both pointers are nulled.
+// Requires move_fn for both key and val.
+b8 hashmap_flat_put_move(hashmap_flat* map, u8** key, u8** val)
+{
+    CHECK_FATAL(!map || !key || !val || !*key || !*val, "args null");
+
+    move_fn k_mv = FLAT_MOVE(map->key_ops);
+    move_fn v_mv = FLAT_MOVE(map->val_ops);
+
+    CHECK_FATAL(!k_mv || !v_mv, "key/val move funcs required");
+
+    b8  found;
+    u64 hash = FLAT_HASH(map, *key);
+    u64 slot = flat_find(map, *key, hash, &found);
+
+    if (found) {
+        delete_fn v_del = FLAT_DEL(map->val_ops);
+        if (v_del) {
+            v_del(GET_VAL(map, slot));
+        }
+        v_mv(GET_VAL(map, slot), val);
+
+        // key already in map — consume the incoming duplicate
+        delete_fn k_del = FLAT_DEL(map->key_ops);
+        if (k_del) {
+            k_del(*key);
+        }
+        free(*key);
+        *key = NULL;
+        return 1;
+    }
+
+    slot = flat_insert(map, hash);
+    k_mv(GET_KEY(map, slot), key);
+    v_mv(GET_VAL(map, slot), val);
+
+    return 0;
+}
+
+
+// Insert or update — key is COPIED, val is MOVED (*val nulled).
+b8 hashmap_flat_put_val_move(hashmap_flat* map, const u8* key, u8** val)
+{
+    CHECK_FATAL(!map || !key || !val || !*val, "args null");
+
+    move_fn v_mv = FLAT_MOVE(map->val_ops);
+
+    CHECK_FATAL(!v_mv, "val move func required");
+
+    b8  found;
+    u64 hash = FLAT_HASH(map, key);
+    u64 slot = flat_find(map, key, hash, &found);
+
+    if (found) {
+        delete_fn v_del = FLAT_DEL(map->val_ops);
+        if (v_del) {
+            v_del(GET_VAL(map, slot));
+        }
+        v_mv(GET_VAL(map, slot), val);
+        return 1;
+    }
+
+    slot = flat_insert(map, hash);
+
+    copy_fn k_cp = FLAT_COPY(map->key_ops);
+    if (k_cp) {
+        k_cp(GET_KEY(map, slot), key);
+    } else {
+        memcpy(GET_KEY(map, slot), key, map->key_size);
+    }
+    v_mv(GET_VAL(map, slot), val);
+
+    return 0;
+}
+
+
+// Insert or update — key is MOVED (*key nulled), val is COPIED.
+b8 hashmap_flat_put_key_move(hashmap_flat* map, u8** key, const u8* val)
+{
+    CHECK_FATAL(!map || !key || !*key || !val, "args null");
+
+    move_fn k_mv = FLAT_MOVE(map->key_ops);
+
+    CHECK_FATAL(!k_mv, "key move func required for hashmap_flat_put_key_move");
+
+    b8  found;
+    u64 hash = FLAT_HASH(map, *key);
+    u64 slot = flat_find(map, *key, hash, &found);
+
+    copy_fn v_cp = FLAT_COPY(map->val_ops);
+
+    if (found) {
+        delete_fn v_del = FLAT_DEL(map->val_ops);
+        if (v_del) {
+            v_del(GET_VAL(map, slot));
+        }
+        if (v_cp) {
+            v_cp(GET_VAL(map, slot), val);
+        } else {
+            memcpy(GET_VAL(map, slot), val, map->val_size);
+        }
+
+        delete_fn k_del = FLAT_DEL(map->key_ops);
+        if (k_del) {
+            k_del(*key);
+        }
+        free(*key);
+        *key = NULL;
+        return 1;
+    }
+
+    slot = flat_insert(map, hash);
+
+    k_mv(GET_KEY(map, slot), key);
+    if (v_cp) {
+        v_cp(GET_VAL(map, slot), val);
+    } else {
+        memcpy(GET_VAL(map, slot), val, map->val_size);
+    }
+
+    return 0;
+}
+
+
+// Get value for key — COPIES into val. Returns 1 if found, 0 if not.
+// Caller owns the copy returned in val.
+b8 hashmap_flat_get(const hashmap_flat* map, const u8* key, u8* val)
+{
+    CHECK_FATAL(!map || !key || !val, "null arg");
+
+    b8  found;
+    u64 slot = flat_find(map, key, FLAT_HASH(map, key), &found);
+
+    if (!found) {
+        return 0;
+    }
+
+    copy_fn v_cp = FLAT_COPY(map->val_ops);
+    if (v_cp) {
+        v_cp(val, GET_VAL(map, slot));
+    } else {
+        memcpy(val, GET_VAL(map, slot), map->val_size);
+    }
+    return 1;
+}
+
+
+// Get pointer to value in-place. Returns NULL if not found.
+// Valid until the next put/del. Do NOT free — the map owns it.
+u8* hashmap_flat_get_ptr(hashmap_flat* map, const u8* key)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    b8  found;
+    u64 slot = flat_find(map, key, FLAT_HASH(map, key), &found);
+
+    return found ? GET_VAL(map, slot) : NULL;
+}
+
+
+// Delete key.
+// If out != NULL, the value is MOVED into it (caller takes ownership).
+// If out == NULL, the value is destroyed via del_fn.
+// Returns 1 if found and deleted, 0 if not found.
+b8 hashmap_flat_del(hashmap_flat* map, const u8* key, u8* out)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    b8  found;
+    u64 slot = flat_find(map, key, FLAT_HASH(map, key), &found);
+
+    if (!found) {
+        return 0;
+    }
+
+    if (out) {
+        memcpy(out, GET_VAL(map, slot), map->val_size);
+    } else {
+        delete_fn v_del = FLAT_DEL(map->val_ops);
+        if (v_del) {
+            v_del(GET_VAL(map, slot));
+        }
+    }
+
+    delete_fn k_del = FLAT_DEL(map->key_ops);
+    if (k_del) {
+        k_del(GET_KEY(map, slot));
+    }
+
+    flat_erase(map, slot);
+    return 1;
+}
+
+
+// Check if key exists.
+b8 hashmap_flat_has(const hashmap_flat* map, const u8* key)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    b8 found;
+    flat_find(map, key, FLAT_HASH(map, key), &found);
+    return found;
+}
+
+
+// Print all key-value pairs.
+void hashmap_flat_print(const hashmap_flat* map, print_fn key_print, print_fn val_print)
+{
+    CHECK_FATAL(!map || !key_print || !val_print, "null arg");
+
+    printf("\t=========\n");
+    printf("\tSize: %lu / Capacity: %lu\n", map->size, map->capacity);
+    printf("\t=========\n");
+
+    for (u64 i = 0; i < map->capacity; i++) {
+        if (!CTRL_FULL(map->ctrl[i])) {
+            continue;
+        }
+        putchar('\t');
+        key_print(GET_KEY(map, i));
+        printf(" => ");
+        val_print(GET_VAL(map, i));
+        putchar('\n');
+    }
+
+    printf("\t=========\n");
+}
+
+
+// Remove all elements, keep capacity. Tombstones are dropped too.
+void hashmap_flat_clear(hashmap_flat* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    if (!IS_POD_K(map) || !IS_POD_V(map)) {
+        delete_fn k_del = FLAT_DEL(map->key_ops);
+        delete_fn v_del = FLAT_DEL(map->val_ops);
+        for (u64 i = 0; i < map->capacity; i++) {
+            if (!CTRL_FULL(map->ctrl[i])) {
+                continue;
+            }
+            if (k_del) {
+                k_del(GET_KEY(map, i));
+            }
+            if (v_del) {
+                v_del(GET_VAL(map, i));
+            }
+        }
+    }
+
+    memset(map->ctrl, CTRL_EMPTY, map->capacity + HASHMAP_FLAT_GROUP);
+    map->size        = 0;
+    map->growth_left = FLAT_MAX_LOAD(map->capacity);
+}
+
+
+// Deep copy src into dest.
+// Ownership: dest gets independently owned copies of all keys and values.
+void hashmap_flat_copy(hashmap_flat* dest, const hashmap_flat* src)
+{
+    CHECK_FATAL(!dest || !src, "null arg");
+
+    hashmap_flat_destroy_stk(dest);
+
+    dest->key_size = src->key_size;
+    dest->val_size = src->val_size;
+    flat_alloc(dest, src->capacity);
+
+    // same capacity and hash_fn — every entry keeps its slot
+    memcpy(dest->ctrl, src->ctrl, src->capacity + HASHMAP_FLAT_GROUP);
+    dest->size        = src->size;
+    dest->growth_left = src->growth_left;
+    dest->hash_fn     = src->hash_fn;
+    dest->cmp_fn      = src->cmp_fn;
+    dest->key_ops     = src->key_ops;
+    dest->val_ops     = src->val_ops;
+
+    copy_fn k_cp = FLAT_COPY(src->key_ops);
+    copy_fn v_cp = FLAT_COPY(src->val_ops);
+
+    for (u64 i = 0; i < src->capacity; i++) {
+        if (!CTRL_FULL(src->ctrl[i])) {
+            continue;
+        }
+
+        if (k_cp) {
+            k_cp(GET_KEY(dest, i), GET_KEY(src, i));
+        } else {
+            memcpy(GET_KEY(dest, i), GET_KEY(src, i), src->key_size);
+        }
+
+        if (v_cp) {
+            v_cp(GET_VAL(dest, i), GET_VAL(src, i));
+        } else {
+            memcpy(GET_VAL(dest, i), GET_VAL(src, i), src->val_size);
+        }
+    }
+}
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+// Probe group by group: triangular steps (16, 32, 48, ...) over a power-of-2
+// table visit every group once. A group holding an empty ctrl byte ends the
+// probe — the key would have been placed there.
+static u64 flat_find(const hashmap_flat* map, const u8* key, u64 hash, b8* found)
+{
+    u64        mask = FLAT_MASK(map);
+    u64        pos  = FLAT_H1(hash) & mask;
+    u8         h2   = FLAT_H2(hash);
+    compare_fn cmp  = map->cmp_fn;
+
+    for (u64 stride = HASHMAP_FLAT_GROUP;; stride += HASHMAP_FLAT_GROUP) {
+        const u8* g = map->ctrl + pos;
+
+        for (u32 m = group_match(g, h2); m; m &= m - 1) {
+            u64 i = (pos + (u64)__builtin_ctz(m)) & mask;
+            if (cmp(GET_KEY(map, i), key, map->key_size) == 0) {
+                *found = 1;
+                return i;
+            }
+        }
+
+        if (group_match_empty(g)) {
+            *found = 0;
+            return 0;
+        }
+
+        pos = (pos + stride) & mask;
+    }
+}
+
+
+// First empty or deleted bucket on the probe path of hash.
+static u64 flat_find_free(const hashmap_flat* map, u64 hash)
+{
+    u64 mask = FLAT_MASK(map);
+    u64 pos  = FLAT_H1(hash) & mask;
+
+    for (u64 stride = HASHMAP_FLAT_GROUP;; stride += HASHMAP_FLAT_GROUP) {
+        u32 m = group_match_free(map->ctrl + pos);
+        if (m) {
+            return (pos + (u64)__builtin_ctz(m)) & mask;
+        }
+        pos = (pos + stride) & mask;
+    }
+}
+
+
+// Write ctrl byte i and its mirror (the first group is cloned after the end)
+static inline void flat_set_ctrl(hashmap_flat* map, u64 i, u8 c)
+{
+    map->ctrl[i] = c;
+    if (i < HASHMAP_FLAT_GROUP) {
+        map->ctrl[map->capacity + i] = c;
+    }
+}
+
+
+// Claim a bucket for a new key (known absent). Grows, or rehashes in place
+// when tombstones ate the budget, before claiming. Caller builds key/val in it.
+static u64 flat_insert(hashmap_flat* map, u64 hash)
+{
+    u64 i = flat_find_free(map, hash);
+
+    // reusing a tombstone costs nothing from the growth budget
+    if (map->growth_left == 0 && map->ctrl[i] != CTRL_DELETED) {
+        // live load <= 25/32: the budget went to tombstones -> same-size rehash
+        if (map->size * 32 <= map->capacity * 25) {
+            flat_resize(map, map->capacity);
+        } else {
+            flat_resize(map, map->capacity * 2);
+        }
+        i = flat_find_free(map, hash);
+    }
+
+    if (map->ctrl[i] == CTRL_EMPTY) {
+        map->growth_left--;
+    }
+    flat_set_ctrl(map, i, FLAT_H2(hash));
+    map->size++;
+    return i;
+}
+
+
+// Free bucket i. A probe can only have walked past i inside a window of 16
+// consecutive non-empty buckets; if no such window covers i it goes straight
+// back to empty, otherwise it must stay a tombstone.
+static void flat_erase(hashmap_flat* map, u64 i)
+{
+    u64 before       = (i - HASHMAP_FLAT_GROUP) & FLAT_MASK(map);
+    u32 empty_before = group_match_empty(map->ctrl + before);
+    u32 empty_after  = group_match_empty(map->ctrl + i);
+
+    // non-empty run ending just before i + run starting at i
+    b8 was_never_full = empty_before && empty_after &&
+                        ((u32)__builtin_clz(empty_before) - 16) + (u32)__builtin_ctz(empty_after) <
+                            HASHMAP_FLAT_GROUP;
+
+    if (was_never_full) {
+        flat_set_ctrl(map, i, CTRL_EMPTY);
+        map->growth_left++;
+    } else {
+        flat_set_ctrl(map, i, CTRL_DELETED);
+    }
+    map->size--;
+}
+
+
+// Fresh, all-empty arrays of the given capacity (power-of-2, >= 16)
+static void flat_alloc(hashmap_flat* map, u64 capacity)
+{
+    map->ctrl = malloc(capacity + HASHMAP_FLAT_GROUP);
+    CHECK_FATAL(!map->ctrl, "ctrl malloc failed");
+    memset(map->ctrl, CTRL_EMPTY, capacity + HASHMAP_FLAT_GROUP);
+
+    map->keys = malloc(capacity * map->key_size);
+    CHECK_FATAL(!map->keys, "keys malloc failed");
+    map->vals = malloc(capacity * map->val_size);
+    CHECK_FATAL(!map->vals, "vals malloc failed");
+
+    map->capacity    = capacity;
+    map->growth_left = FLAT_MAX_LOAD(capacity);
+}
+
+
+// Rehash into new arrays of new_capacity (may equal the old one to purge
+// tombstones). Entries move as raw bytes — no copy/del callbacks.
+static void flat_resize(hashmap_flat* map, u64 new_capacity)
+{
+    u8* old_ctrl = map->ctrl;
+    u8* old_keys = map->keys;
+    u8* old_vals = map->vals;
+    u64 old_cap  = map->capacity;
+
+    flat_alloc(map, new_capacity);
+
+    for (u64 i = 0; i < old_cap; i++) {
+        if (!CTRL_FULL(old_ctrl[i])) {
+            continue;
+        }
+
+        u8* old_key = old_keys + ((u64)map->key_size * i);
+        u64 hash    = FLAT_HASH(map, old_key);
+        u64 slot    = flat_find_free(map, hash);
+
+        flat_set_ctrl(map, slot, FLAT_H2(hash));
+        memcpy(GET_KEY(map, slot), old_key, map->key_size);
+        memcpy(GET_VAL(map, slot), old_vals + ((u64)map->val_size * i), map->val_size);
+    }
+
+    map->growth_left -= map->size;
+
+    free(old_ctrl);
+    free(old_keys);
+    free(old_vals);
+}
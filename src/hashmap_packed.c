@@ -0,0 +1,617 @@
+#include "hashmap_packed.h"
+
+#include <string.h>
+
+
+#define GET_BKT(map, i) ((map)->buckets + ((u64)(map)->stride * (i)))
+#define GET_PSL(map, i) (GET_BKT(map, i))
+#define GET_KEY(map, i) (GET_BKT(map, i) + (map)->key_off)
+#define GET_VAL(map, i) (GET_BKT(map, i) + (map)->val_off)
+
+// capacity is always power-of-2 — use bitmask instead of %
+#define PACKED_MASK(map)       ((map)->capacity - 1)
+#define PACKED_HASH(map, key)  ((map)->hash_fn((key), (map)->key_size))
+#define PACKED_HOME(map, hash) ((hash) & PACKED_MASK(map))
+#define PACKED_NEXT(map, i)    (((i) + 1) & PACKED_MASK(map))
+
+// PSL 0 == empty bucket; stored PSL is (real_psl + 1), starting at 1
+#define BUCKET_EMPTY 0
+
+// keys and vals are aligned to their natural size inside a bucket, capped here
+#define PACKED_MAX_ALIGN 8
+
+#define IS_POD_K(map) (map->key_ops == NULL)
+#define IS_POD_V(map) (map->val_ops == NULL)
+
+
+/*
+====================PRIVATE DECLARATIONS====================
+*/
+
+static inline u32  packed_align_of(u32 size);
+static inline u32  packed_align_up(u32 n, u32 align);
+static void        packed_layout(hashmap_packed* map);
+static u64         packed_lookup(const hashmap_packed* map, const u8* key, u64 hash,
+                                 LOOKUP_RES* res, u8* out_psl);
+static u64         packed_insert_pos(const hashmap_packed* map, u64 idx, u8* out_psl);
+static void        packed_insert(hashmap_packed* map, u8 psl, u64 idx);
+static void        packed_erase(hashmap_packed* map, u64 slot);
+static u8          packed_psl_at(const hashmap_packed* map, u64 slot);
+static inline void packed_copy_key(hashmap_packed* map, u64 slot, const u8* key);
+static inline void packed_copy_val(hashmap_packed* map, u64 slot, const u8* val);
+static inline void packed_del_val(hashmap_packed* map, u64 slot);
+static inline void packed_drop_key(hashmap_packed* map, u8** key);
+static void        packed_destroy_entries(hashmap_packed* map);
+static inline void packed_maybe_resize(hashmap_packed* map);
+static void        packed_resize(hashmap_packed* map, u64 new_capacity);
+
+
+/*
+====================PUBLIC FUNCTIONS====================
+*/
+
+hashmap_packed* hashmap_packed_create(u32 key_size, u32 val_size, custom_hash_fn hash_fn,
+                                      compare_fn cmp_fn, const container_ops* key_ops,
+                                      const container_ops* val_ops)
+{
+    CHECK_FATAL(key_size == 0 || val_size == 0, "key/val size can't be 0");
+
+    hashmap_packed* map = malloc(sizeof(hashmap_packed));
+    CHECK_FATAL(!map, "map malloc failed");
+
+    map->key_size = key_size;
+    map->val_size = val_size;
+    packed_layout(map);
+
+    map->buckets = calloc(HASHMAP_INIT_CAPACITY, map->stride);
+    CHECK_FATAL(!map->buckets, "buckets calloc failed");
+
+    map->size     = 0;
+    map->capacity = HASHMAP_INIT_CAPACITY;
+
+    map->hash_fn = hash_fn ? hash_fn : wyhash;
+    map->cmp_fn  = cmp_fn ? cmp_fn : default_compare;
+
+    map->key_ops = key_ops;
+    map->val_ops = val_ops;
+
+    return map;
+}
+
+
+void hashmap_packed_destroy(hashmap_packed* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    packed_destroy_entries(map);
+    free(map->buckets);
+    free(map);
+}
+
+
+// Insert or update — COPY semantics.
+// Ownership: map takes a deep copy of key and val via ops->copy_fn (or memcpy for POD).
+// Returns 1 if key existed (updated), 0 if new key inserted.
+b8 hashmap_packed_put(hashmap_packed* map, const u8* key, const u8* val)
+{
+    CHECK_FATAL(!map || !key || !val, "args null");
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    u64        slot = packed_lookup(map, key, PACKED_HASH(map, key), &res, &out_psl);
+
+    if (res == FOUND) {
+        packed_del_val(map, slot);
+        packed_copy_val(map, slot, val);
+        return 1;
+    }
+
+    // Open the slot first, then construct key/val directly inside it
+    packed_insert(map, out_psl, slot);
+    packed_copy_key(map, slot, key);
+    packed_copy_val(map, slot, val);
+
+    packed_maybe_resize(map);
+    return 0;
+}
+
+
+// Insert or update — MOVE semantics.
+// Ownership: the map takes ownership of *key and *val; both pointers are nulled.
+// Requires move_fn for both key and val.
+b8 hashmap_packed_put_move(hashmap_packed* map, u8** key, u8** val)
+{
+    CHECK_FATAL(!map || !key || !val || !*key || !*val, "args null");
+
+    move_fn k_mv = PACKED_MOVE(map->key_ops);
+    move_fn v_mv = PACKED_MOVE(map->val_ops);
+
+    CHECK_FATAL(!k_mv || !v_mv, "key/val move funcs required");
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    u64        slot = packed_lookup(map, *key, PACKED_HASH(map, *key), &res, &out_psl);
+
+    if (res == FOUND) {
+        packed_del_val(map, slot);
+        v_mv(GET_VAL(map, slot), val);
+
+        // key already in map — consume the incoming duplicate
+        packed_drop_key(map, key);
+        return 1;
+    }
+
+    packed_insert(map, out_psl, slot);
+    k_mv(GET_KEY(map, slot), key);
+    v_mv(GET_VAL(map, slot), val);
+
+    packed_maybe_resize(map);
+    return 0;
+}
+
+
+// Insert or update — key is COPIED, val is MOVED (*val nulled).
+b8 hashmap_packed_put_val_move(hashmap_packed* map, const u8* key, u8** val)
+{
+    CHECK_FATAL(!map || !key || !val || !*val, "args null");
+
+    move_fn v_mv = PACKED_MOVE(map->val_ops);
+
+    CHECK_FATAL(!v_mv, "val move func required");
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    u64        slot = packed_lookup(map, key, PACKED_HASH(map, key), &res, &out_psl);
+
+    if (res == FOUND) {
+        packed_del_val(map, slot);
+        v_mv(GET_VAL(map, slot), val);
+        return 1;
+    }
+
+    packed_insert(map, out_psl, slot);
+    packed_copy_key(map, slot, key);
+    v_mv(GET_VAL(map, slot), val);
+
+    packed_maybe_resize(map);
+    return 0;
+}
+
+
+// Insert or update — key is MOVED (*key nulled), val is COPIED.
+b8 hashmap_packed_put_key_move(hashmap_packed* map, u8** key, const u8* val)
+{
+    CHECK_FATAL(!map || !key || !*key || !val, "args null");
+
+    move_fn k_mv = PACKED_MOVE(map->key_ops);
+
+    CHECK_FATAL(!k_mv, "key move func required for hashmap_packed_put_key_move");
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    u64        slot = packed_lookup(map, *key, PACKED_HASH(map, *key), &res, &out_psl);
+
+    if (res == FOUND) {
+        packed_del_val(map, slot);
+        packed_copy_val(map, slot, val);
+        packed_drop_key(map, key);
+        return 1;
+    }
+
+    packed_insert(map, out_psl, slot);
+    k_mv(GET_KEY(map, slot), key);
+    packed_copy_val(map, slot, val);
+
+    packed_maybe_resize(map);
+    return 0;
+}
+
+
+// Get value for key — COPIES into val. Returns 1 if found, 0 if not.
+// Caller owns the copy returned in val.
+b8 hashmap_packed_get(const hashmap_packed* map, const u8* key, u8* val)
+{
+    CHECK_FATAL(!map || !key || !val, "null arg");
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    u64        slot = packed_lookup(map, key, PACKED_HASH(map, key), &res, &out_psl);
+
+    if (res != FOUND) {
+        return 0;
+    }
+
+    copy_fn v_cp = PACKED_COPY(map->val_ops);
+    if (v_cp) {
+        v_cp(val, GET_VAL(map, slot));
+    } else {
+        memcpy(val, GET_VAL(map, slot), map->val_size);
+    }
+    return 1;
+}
+
+
+// Get pointer to value in-place. Returns NULL if not found.
+// Valid until the next put/del. Do NOT free — the map owns it.
+u8* hashmap_packed_get_ptr(hashmap_packed* map, const u8* key)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    u64        slot = packed_lookup(map, key, PACKED_HASH(map, key), &res, &out_psl);
+
+    return res == FOUND ? GET_VAL(map, slot) : NULL;
+}
+
+
+// Delete key.
+// If out != NULL, the value is MOVED into it (caller takes ownership).
+// If out == NULL, the value is destroyed via del_fn.
+// Returns 1 if found and deleted, 0 if not found.
+b8 hashmap_packed_del(hashmap_packed* map, const u8* key, u8* out)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    u64        slot = packed_lookup(map, key, PACKED_HASH(map, key), &res, &out_psl);
+
+    if (res != FOUND) {
+        return 0;
+    }
+
+    if (out) {
+        memcpy(out, GET_VAL(map, slot), map->val_size);
+    } else {
+        packed_del_val(map, slot);
+    }
+
+    delete_fn k_del = PACKED_DEL(map->key_ops);
+    if (k_del) {
+        k_del(GET_KEY(map, slot));
+    }
+
+    packed_erase(map, slot);
+    return 1;
+}
+
+
+// Check if key exists.
+b8 hashmap_packed_has(const hashmap_packed* map, const u8* key)
+{
+    CHECK_FATAL(!map || !key, "null arg");
+
+    LOOKUP_RES res;
+    u8         out_psl;
+    packed_lookup(map, key, PACKED_HASH(map, key), &res, &out_psl);
+    return res == FOUND;
+}
+
+
+// Print all key-value pairs.
+void hashmap_packed_print(const hashmap_packed* map, print_fn key_print, print_fn val_print)
+{
+    CHECK_FATAL(!map || !key_print || !val_print, "null arg");
+
+    printf("\t=========\n");
+    printf("\tSize: %lu / Capacity: %lu\n", map->size, map->capacity);
+    printf("\t=========\n");
+
+    for (u64 i = 0; i < map->capacity; i++) {
+        if (*GET_PSL(map, i) == BUCKET_EMPTY) {
+            continue;
+        }
+        putchar('\t');
+        key_print(GET_KEY(map, i));
+        printf(" => ");
+        val_print(GET_VAL(map, i));
+        putchar('\n');
+    }
+
+    printf("\t=========\n");
+}
+
+
+// Remove all elements, keep capacity.
+void hashmap_packed_clear(hashmap_packed* map)
+{
+    CHECK_FATAL(!map, "map is null");
+
+    packed_destroy_entries(map);
+    memset(map->buckets, 0, map->capacity * map->stride);
+    map->size = 0;
+}
+
+
+// Deep copy src into dest.
+// Ownership: dest gets independently owned copies of all keys and values.
+void hashmap_packed_copy(hashmap_packed* dest, const hashmap_packed* src)
+{
+    CHECK_FATAL(!dest || !src, "null arg");
+
+    packed_destroy_entries(dest);
+    free(dest->buckets);
+
+    // same capacity, layout and hash_fn — every entry keeps its slot
+    *dest         = *src;
+    dest->buckets = malloc(src->capacity * src->stride);
+    CHECK_FATAL(!dest->buckets, "copy buckets malloc failed");
+    memcpy(dest->buckets, src->buckets, src->capacity * src->stride);
+
+    copy_fn k_cp = PACKED_COPY(src->key_ops);
+    copy_fn v_cp = PACKED_COPY(src->val_ops);
+    if (!k_cp && !v_cp) {
+        return;
+    }
+
+    for (u64 i = 0; i < src->capacity; i++) {
+        if (*GET_PSL(src, i) == BUCKET_EMPTY) {
+            continue;
+        }
+        if (k_cp) {
+            k_cp(GET_KEY(dest, i), GET_KEY(src, i));
+        }
+        if (v_cp) {
+            v_cp(GET_VAL(dest, i), GET_VAL(src, i));
+        }
+    }
+}
+
+
+/*
+====================PRIVATE FUNCTIONS====================
+*/
+
+// Largest power of 2 dividing size, capped at PACKED_MAX_ALIGN
+static inline u32 packed_align_of(u32 size)
+{
+    u32 a = size & (~size + 1);
+    return a > PACKED_MAX_ALIGN ? PACKED_MAX_ALIGN : a;
+}
+
+static inline u32 packed_align_up(u32 n, u32 align)
+{
+    return (n + (align - 1)) & ~(align - 1);
+}
+
+
+// Bucket layout: psl byte, then key and val each at their own alignment.
+// The stride is rounded up to the larger of the two so that bucket i + 1
+// is aligned like bucket i (malloc'd memory is aligned for both).
+static void packed_layout(hashmap_packed* map)
+{
+    u32 k_align = packed_align_of(map->key_size);
+    u32 v_align = packed_align_of(map->val_size);
+
+    map->key_off = packed_align_up(1, k_align);
+    map->val_off = packed_align_up(map->key_off + map->key_size, v_align);
+    map->stride  = packed_align_up(map->val_off + map->val_size,
+                                   k_align > v_align ? k_align : v_align);
+}
+
+
+static u64 packed_lookup(const hashmap_packed* map, const u8* key, u64 hash,
+                         LOOKUP_RES* res, u8* out_psl)
+{
+    u64        idx = PACKED_HOME(map, hash);
+    u8         psl = 1; // stored PSL=1 means real probe distance 0 (home slot)
+    compare_fn cmp = map->cmp_fn;
+
+    for (u64 i = idx;; i = PACKED_NEXT(map, i)) {
+        const u8* bkt      = GET_BKT(map, i);
+        u8        slot_psl = *bkt;
+
+        if (slot_psl == BUCKET_EMPTY) {
+            *res     = NOT_FOUND;
+            *out_psl = psl;
+            return i;
+        }
+
+        // Robin Hood exit: our key would have displaced this resident
+        if (slot_psl < psl) {
+            *res     = ROBINHOOD_EXIT;
+            *out_psl = psl;
+            return i;
+        }
+
+        // the key sits in the same bucket (and line) as the psl just read
+        if (cmp(bkt + map->key_off, key, map->key_size) == 0) {
+            *res     = FOUND;
+            *out_psl = psl;
+            return i;
+        }
+
+        psl += psl < RH_PSL_MAX; // saturates, see packed_psl_at
+    }
+}
+
+
+// Insertion point for a key that is known to be absent (resize).
+// Keys are unique there, so the probe only compares PSLs — never keys.
+static u64 packed_insert_pos(const hashmap_packed* map, u64 idx, u8* out_psl)
+{
+    u8 psl = 1;
+
+    // empty buckets (psl 0) always stop the probe
+    while (*GET_PSL(map, idx) >= psl) {
+        idx = PACKED_NEXT(map, idx);
+        psl += psl < RH_PSL_MAX;
+    }
+
+    *out_psl = psl;
+    return idx;
+}
+
+
+// Open slot idx for a new entry with the given psl.
+// If the slot is taken, the run [idx, next empty) is shifted one bucket
+// right — whole buckets, so one memmove moves psls, keys and vals together.
+// The caller constructs key/val in place.
+static void packed_insert(hashmap_packed* map, u8 psl, u64 idx)
+{
+    if (*GET_PSL(map, idx) != BUCKET_EMPTY) {
+        u64 end = idx;
+        while (*GET_PSL(map, end) != BUCKET_EMPTY) {
+            end = PACKED_NEXT(map, end);
+        }
+
+        rh_shift_right(map->buckets, map->stride, idx, end, map->capacity);
+
+        // every shifted entry is now one slot further from home
+        for (u64 i = PACKED_NEXT(map, idx);; i = PACKED_NEXT(map, i)) {
+            u8* psl_i = GET_PSL(map, i);
+            *psl_i += *psl_i < RH_PSL_MAX;
+            if (i == end) {
+                break;
+            }
+        }
+    }
+
+    *GET_PSL(map, idx) = psl;
+    map->size++;
+}
+
+
+// Remove the entry at slot (raw bytes — callbacks are the caller's job).
+// Backward-shift deletion, as in hashmap: pull following entries one bucket
+// back while they are away from their home slot (PSL > 1).
+static void packed_erase(hashmap_packed* map, u64 slot)
+{
+    u64 cur = slot;
+    for (;;) {
+        u64 next     = PACKED_NEXT(map, cur);
+        u8  next_psl = *GET_PSL(map, next);
+
+        if (next_psl <= 1) {
+            *GET_PSL(map, cur) = BUCKET_EMPTY;
+            break;
+        }
+
+        memcpy(GET_BKT(map, cur), GET_BKT(map, next), map->stride);
+        *GET_PSL(map, cur) = next_psl < RH_PSL_MAX ? next_psl - 1 : packed_psl_at(map, cur);
+
+        cur = next;
+    }
+
+    map->size--;
+}
+
+
+// Stored psl of the entry at slot, worked out from its hash. Stored psls
+// saturate at RH_PSL_MAX: probes and bumps stop counting there, which keeps
+// every comparison of the Robin Hood order true, but a saturated entry that
+// moves one slot back can't just be decremented.
+static u8 packed_psl_at(const hashmap_packed* map, u64 slot)
+{
+    u64 dist = (slot - PACKED_HOME(map, PACKED_HASH(map, GET_KEY(map, slot)))) & PACKED_MASK(map);
+    return dist + 1 < RH_PSL_MAX ? (u8)(dist + 1) : RH_PSL_MAX;
+}
+
+
+static inline void packed_copy_key(hashmap_packed* map, u64 slot, const u8* key)
+{
+    copy_fn k_cp = PACKED_COPY(map->key_ops);
+    if (k_cp) {
+        k_cp(GET_KEY(map, slot), key);
+    } else {
+        memcpy(GET_KEY(map, slot), key, map->key_size);
+    }
+}
+
+static inline void packed_copy_val(hashmap_packed* map, u64 slot, const u8* val)
+{
+    copy_fn v_cp = PACKED_COPY(map->val_ops);
+    if (v_cp) {
+        v_cp(GET_VAL(map, slot), val);
+    } else {
+        memcpy(GET_VAL(map, slot), val, map->val_size);
+    }
+}
+
+static inline void packed_del_val(hashmap_packed* map, u64 slot)
+{
+    delete_fn v_del = PACKED_DEL(map->val_ops);
+    if (v_del) {
+        v_del(GET_VAL(map, slot));
+    }
+}
+
+// Destroy and free an incoming key that was not stored (duplicate on move)
+static inline void packed_drop_key(hashmap_packed* map, u8** key)
+{
+    delete_fn k_del = PACKED_DEL(map->key_ops);
+    if (k_del) {
+        k_del(*key);
+    }
+    free(*key);
+    *key = NULL;
+}
+
+
+// Run del_fn on every live key and val (the buckets stay allocated)
+static void packed_destroy_entries(hashmap_packed* map)
+{
+    if (IS_POD_K(map) && IS_POD_V(map)) {
+        return;
+    }
+
+    delete_fn k_del = PACKED_DEL(map->key_ops);
+    delete_fn v_del = PACKED_DEL(map->val_ops);
+    if (!k_del && !v_del) {
+        return;
+    }
+
+    for (u64 i = 0; i < map->capacity; i++) {
+        if (*GET_PSL(map, i) == BUCKET_EMPTY) {
+            continue;
+        }
+        if (k_del) {
+            k_del(GET_KEY(map, i));
+        }
+        if (v_del) {
+            v_del(GET_VAL(map, i));
+        }
+    }
+}
+
+
+static inline void packed_maybe_resize(hashmap_packed* map)
+{
+    // integer multiply avoids float — equivalent to load > 0.75
+    if (map->size * 4 >= map->capacity * 3) {
+        packed_resize(map, map->capacity * 2);
+    }
+}
+
+
+// Rehash into a new bucket array of new_capacity (must be power-of-2).
+// Entries move as raw bytes — no copy/del callbacks.
+static void packed_resize(hashmap_packed* map, u64 new_capacity)
+{
+    u8* old_buckets = map->buckets;
+    u64 old_cap     = map->capacity;
+
+    map->buckets = calloc(new_capacity, map->stride);
+    CHECK_FATAL(!map->buckets, "resize buckets calloc failed");
+
+    map->capacity = new_capacity;
+    map->size     = 0;
+
+    for (u64 i = 0; i < old_cap; i++) {
+        const u8* old_bkt = old_buckets + ((u64)map->stride * i);
+        if (*old_bkt == BUCKET_EMPTY) {
+            continue;
+        }
+
+        u64 hash = PACKED_HASH(map, old_bkt + map->key_off);
+
+        u8  out_psl;
+        u64 slot = packed_insert_pos(map, PACKED_HOME(map, hash), &out_psl);
+
+        packed_insert(map, out_psl, slot);
+        memcpy(GET_BKT(map, slot) + 1, old_bkt + 1, map->stride - 1);
+    }
+
+    free(old_buckets);
+}
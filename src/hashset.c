@@ -1,4 +1,6 @@
 #include "hashset.h"
+#include "map_snapshot.h"
+
 #include <string.h>
 
 
@@ -6,30 +8,48 @@
 #define GET_PSL(set, i) ((set)->psls + (i))
 
 // capacity is always power-of-2 — use bitmask instead of %
-#define SET_MASK(set)     ((set)->capacity - 1)
-#define SET_IDX(set, elm) ((set)->hash_fn((elm), (set)->elm_size) & SET_MASK(set))
-#define SET_NEXT(set, i)  (((i) + 1) & SET_MASK(set))
+#define SET_MASK(set)       ((set)->capacity - 1)
+#define SET_HASH(set, elm)  map_seed_mix((set)->hash_fn((elm), (set)->elm_size), (set)->seed)
+#define SET_HOME(set, hash) ((hash) & SET_MASK(set))
+#define SET_NEXT(set, i)    (((i) + 1) & SET_MASK(set))
 
 // PSL 0 == empty bucket; stored PSL is (real_psl + 1), starting at 1
 #define BUCKET_EMPTY 0
 
-// scratch layout: [0 .. elm_size) = stage,  [elm_size .. 2*elm_size) = swap
-// stage: where hashset_insert copies the incoming elm before calling set_insert
-// swap:  where set_insert saves a displaced resident during Robin Hood eviction
-// The two halves are alternated each eviction to avoid aliasing (elm pointer
-// is always in the half that set_insert is NOT currently writing into).
-#define STAGE_ELM(set) ((set)->scratch)
-#define SWAP_ELM(set)  ((set)->scratch + (set)->elm_size)
+// fresh seeds tried by a rehash that keeps overflowing psls (see hashmap.c)
+#define SET_RESEED_TRIES 4
+
+// set algebra: elms hashed and prefetched ahead of probing (as MAP_BATCH)
+#define SET_BATCH 16
+
+// counters are bookkeeping, not set state: const lookups bump them too
+#define SET_COUNT(set, field, n) MAP_STAT_ADD(&((hashset*)(set))->counters, field, n)
 
+// as MAP_CHECK_WRITABLE: a snapshot mapping is PROT_READ until promoted
+#define SET_CHECK_WRITABLE(set) \
+    CHECK_FATAL((set)->read_only, "set is a read-only snapshot, call hashset_promote first")
 
 /*
 ====================PRIVATE DECLARATIONS====================
 */
 
-static u64         set_lookup(const hashset* set, const u8* elm, LOOKUP_RES* res, u8* out_psl);
-static void        set_insert(hashset* set, u8* elm, u8 psl, u64 idx);
+static hashset*    set_create(Arena* arena, u32 elm_size, custom_hash_fn hash_fn, compare_fn cmp_fn,
+                              const container_ops* ops);
+static inline u8*  set_alloc(const hashset* set, u64 size);
+static inline void set_free(const hashset* set, void* ptr);
+static inline void set_drop_snapshot(hashset* set);
+static u64         set_lookup(const hashset* set, const u8* elm, u64 hash, LOOKUP_RES* res, u8* out_psl);
+static u64         set_insert_pos(const hashset* set, u64 idx, u8* out_psl);
+static void        set_insert(hashset* set, u8 psl, u64 idx);
 static void        set_resize(hashset* set, u64 new_capacity);
+static void        set_rehash(hashset* set, u64 new_capacity, u64 seed);
 static inline void set_maybe_resize(hashset* set);
+static inline void set_maybe_shrink(hashset* set);
+static inline void set_same_type(const hashset* a, const hashset* b);
+static u64         set_gather(const hashset* src, u64* pos, const u8** elms);
+static void        set_has_batch(const hashset* probe, const u8** elms, u64 n, u64* hashes, b8* found);
+static void        set_retain(hashset* set, const hashset* other, b8 keep_found);
+static void        set_compact(hashset* set, const u8* drop);
 
 
 /*
@@ -38,20 +58,36 @@ static inline void set_maybe_resize(hashset* set);
 
 hashset* hashset_create(u32 elm_size, custom_hash_fn hash_fn, compare_fn cmp_fn,
                         const container_ops* ops)
+{
+    return set_create(NULL, elm_size, hash_fn, cmp_fn, ops);
+}
+
+
+// Same as hashset_create, but the set struct and its tables come from arena.
+// destroy only runs del_fn on owned elements; arena_clear reclaims the memory.
+hashset* hashset_create_arena(Arena* arena, u32 elm_size, custom_hash_fn hash_fn,
+                              compare_fn cmp_fn, const container_ops* ops)
+{
+    CHECK_FATAL(!arena, "arena is null");
+
+    return set_create(arena, elm_size, hash_fn, cmp_fn, ops);
+}
+
+
+static hashset* set_create(Arena* arena, u32 elm_size, custom_hash_fn hash_fn, compare_fn cmp_fn,
+                           const container_ops* ops)
 {
     CHECK_FATAL(elm_size == 0, "elm_size can't be 0");
 
-    hashset* set = malloc(sizeof(hashset));
+    hashset* set = arena ? ARENA_ALLOC(arena, hashset) : malloc(sizeof(hashset));
     CHECK_FATAL(!set, "set malloc failed");
+    set->arena = arena;
 
-    set->elms = malloc((u64)HASHMAP_INIT_CAPACITY * elm_size);
+    set->elms = set_alloc(set, (u64)HASHMAP_INIT_CAPACITY * elm_size);
     CHECK_FATAL(!set->elms, "elms calloc failed");
-    set->psls = calloc(HASHMAP_INIT_CAPACITY, sizeof(u8));
+    set->psls = set_alloc(set, HASHMAP_INIT_CAPACITY * sizeof(u8));
     CHECK_FATAL(!set->psls, "psls calloc failed");
-
-    // 2 * elm_size: first half = staging, second half = RH swap buffer
-    set->scratch = malloc(2 * (u64)elm_size);
-    CHECK_FATAL(!set->scratch, "scratch malloc failed");
+    memset(set->psls, 0, HASHMAP_INIT_CAPACITY * sizeof(u8));
 
     set->size     = 0;
     set->capacity = HASHMAP_INIT_CAPACITY;
@@ -59,9 +95,21 @@ hashset* hashset_create(u32 elm_size, custom_hash_fn hash_fn, compare_fn cmp_fn,
 
     set->hash_fn = hash_fn ? hash_fn : wyhash;
     set->cmp_fn  = cmp_fn  ? cmp_fn  : default_compare;
+    set->seed    = WC_MAP_SEEDED ? map_seed_random() : 0;
+
+    set->max_load     = MAP_LOAD_PCT(LOAD_FACTOR_GROW);
+    set->min_load     = 0;
+    set->psl_overflow = 0;
+    set->psl_limit    = RH_PSL_LIMIT;
 
     set->ops = ops;
 
+    set->snapshot     = NULL;
+    set->snapshot_len = 0;
+    set->read_only    = 0;
+
+    memset(&set->counters, 0, sizeof(set->counters));
+
     return set;
 }
 
@@ -81,10 +129,10 @@ void hashset_destroy(hashset* set)
         }
     }
 
-    free(set->elms);
-    free(set->psls);
-    free(set->scratch);
-    free(set);
+    set_free(set, set->elms);
+    set_free(set, set->psls);
+    set_drop_snapshot(set);
+    set_free(set, set);
 }
 
 void hashset_destroy_stk(hashset* set)
@@ -102,9 +150,9 @@ void hashset_destroy_stk(hashset* set)
         }
     }
 
-    free(set->elms);
-    free(set->psls);
-    free(set->scratch);
+    set_free(set, set->elms);
+    set_free(set, set->psls);
+    set_drop_snapshot(set);
 }
 
 
@@ -114,25 +162,35 @@ b8 hashset_insert(hashset* set, const u8* elm)
 {
     CHECK_FATAL(!set || !elm, "args null");
 
+    return hashset_insert_with_hash(set, elm, SET_HASH(set, elm));
+}
+
+
+b8 hashset_insert_with_hash(hashset* set, const u8* elm, u64 hash)
+{
+    CHECK_FATAL(!set || !elm, "args null");
+    SET_CHECK_WRITABLE(set);
+
     copy_fn e_cp = SET_COPY(set->ops);
 
     LOOKUP_RES res;
     u8             out_psl;
-    u64            slot = set_lookup(set, elm, &res, &out_psl);
+    u64            slot = set_lookup(set, elm, hash, &res, &out_psl);
 
     if (res == FOUND) {
         return 1;
     }
 
-    // Stage a deep copy into scratch before calling set_insert.
-    // set_insert only does raw memcpy moves between slots — it never calls copy/del.
+    // set_insert only opens the slot (raw byte shifts, no copy/del) —
+    // the deep copy is built directly inside it.
+    set_insert(set, out_psl, slot);
+
     if (e_cp) {
-        e_cp(STAGE_ELM(set), elm);
+        e_cp(GET_ELM(set, slot), elm);
     } else {
-        memcpy(STAGE_ELM(set), elm, set->elm_size);
+        memcpy(GET_ELM(set, slot), elm, set->elm_size);
     }
 
-    set_insert(set, STAGE_ELM(set), out_psl, slot);
     set_maybe_resize(set);
     return 0;
 }
@@ -143,6 +201,7 @@ b8 hashset_insert(hashset* set, const u8* elm)
 b8 hashset_insert_move(hashset* set, u8** elm)
 {
     CHECK_FATAL(!set || !elm || !*elm, "args null");
+    SET_CHECK_WRITABLE(set);
 
     move_fn   e_mv  = SET_MOVE(set->ops);
     delete_fn e_del = SET_DEL(set->ops);
@@ -151,7 +210,7 @@ b8 hashset_insert_move(hashset* set, u8** elm)
 
     LOOKUP_RES res;
     u8             out_psl;
-    u64            slot = set_lookup(set, *elm, &res, &out_psl);
+    u64            slot = set_lookup(set, *elm, SET_HASH(set, *elm), &res, &out_psl);
 
     if (res == FOUND) {
         // Already exists — consume (destroy) the incoming duplicate.
@@ -163,10 +222,10 @@ b8 hashset_insert_move(hashset* set, u8** elm)
         return 1;
     }
 
-    // Stage: move elm into STAGE_ELM — transfers heap resource, nulls *elm.
-    e_mv(STAGE_ELM(set), elm);
+    // move elm into the opened slot — transfers heap resource, nulls *elm.
+    set_insert(set, out_psl, slot);
+    e_mv(GET_ELM(set, slot), elm);
 
-    set_insert(set, STAGE_ELM(set), out_psl, slot);
     set_maybe_resize(set);
     return 0;
 }
@@ -177,9 +236,17 @@ b8 hashset_has(const hashset* set, const u8* elm)
 {
     CHECK_FATAL(!set || !elm, "null arg");
 
+    return hashset_has_with_hash(set, elm, SET_HASH(set, elm));
+}
+
+
+b8 hashset_has_with_hash(const hashset* set, const u8* elm, u64 hash)
+{
+    CHECK_FATAL(!set || !elm, "null arg");
+
     LOOKUP_RES res;
     u8             out_psl;
-    set_lookup(set, elm, &res, &out_psl);
+    set_lookup(set, elm, hash, &res, &out_psl);
     return res == FOUND;
 }
 
@@ -192,9 +259,18 @@ b8 hashset_remove(hashset* set, const u8* elm)
 {
     CHECK_FATAL(!set || !elm, "null arg");
 
+    return hashset_remove_with_hash(set, elm, SET_HASH(set, elm));
+}
+
+
+b8 hashset_remove_with_hash(hashset* set, const u8* elm, u64 hash)
+{
+    CHECK_FATAL(!set || !elm, "null arg");
+    SET_CHECK_WRITABLE(set);
+
     LOOKUP_RES res;
     u8             out_psl;
-    u64            slot = set_lookup(set, elm, &res, &out_psl);
+    u64            slot = set_lookup(set, elm, hash, &res, &out_psl);
 
     if (res != FOUND) {
         return 0;
@@ -225,10 +301,20 @@ b8 hashset_remove(hashset* set, const u8* elm)
     }
 
     set->size--;
+    set_maybe_shrink(set);
     return 1;
 }
 
 
+// Hash of elm as this set computes it — feed it to the *_with_hash calls.
+u64 hashset_hash(const hashset* set, const u8* elm)
+{
+    CHECK_FATAL(!set || !elm, "null arg");
+
+    return SET_HASH(set, elm);
+}
+
+
 // Print all elements.
 void hashset_print(const hashset* set, print_fn print)
 {
@@ -255,6 +341,7 @@ void hashset_print(const hashset* set, print_fn print)
 void hashset_clear(hashset* set)
 {
     CHECK_FATAL(!set, "set is null");
+    SET_CHECK_WRITABLE(set);
 
     delete_fn e_del = SET_DEL(set->ops);
 
@@ -268,7 +355,8 @@ void hashset_clear(hashset* set)
     }
 
     memset(set->psls, 0, set->capacity * sizeof(u8));
-    set->size = 0;
+    set->size         = 0;
+    set->psl_overflow = 0;
 }
 
 
@@ -280,20 +368,26 @@ void hashset_copy(hashset* dest, const hashset* src)
 
     hashset_destroy_stk(dest);
 
-    dest->elms = calloc(src->capacity, src->elm_size);
+    // dest keeps its own storage: its arena if it has one, else the heap
+    dest->elms = set_alloc(dest, src->capacity * src->elm_size);
     CHECK_FATAL(!dest->elms, "copy elms calloc failed");
-    dest->psls = calloc(src->capacity, sizeof(u8));
+    dest->psls = set_alloc(dest, src->capacity * sizeof(u8));
     CHECK_FATAL(!dest->psls, "copy psls calloc failed");
-    dest->scratch = malloc(2 * (u64)src->elm_size);
-    CHECK_FATAL(!dest->scratch, "copy scratch malloc failed");
+    memset(dest->psls, 0, src->capacity * sizeof(u8));
 
     dest->size     = src->size;
     dest->capacity = src->capacity;
     dest->elm_size = src->elm_size;
     dest->hash_fn  = src->hash_fn;
     dest->cmp_fn   = src->cmp_fn;
+    dest->seed     = src->seed; // same slots, same hashes
+    dest->max_load = src->max_load;
+    dest->min_load = src->min_load;
     dest->ops      = src->ops;
 
+    dest->psl_overflow = src->psl_overflow;
+    dest->psl_limit    = src->psl_limit;
+
     copy_fn e_cp = SET_COPY(src->ops);
 
     for (u64 i = 0; i < src->capacity; i++) {
@@ -313,28 +407,564 @@ void hashset_copy(hashset* dest, const hashset* src)
 }
 
 
+// Rehash under the given seed (0 = unseeded). Same capacity.
+void hashset_set_seed(hashset* set, u64 seed)
+{
+    CHECK_FATAL(!set, "set is null");
+
+    if (seed != set->seed) {
+        set_rehash(set, set->capacity, seed);
+    }
+}
+
+
+void hashset_reseed(hashset* set)
+{
+    CHECK_FATAL(!set, "set is null");
+
+    set_rehash(set, set->capacity, map_seed_random());
+}
+
+
+void hashset_set_max_load(hashset* set, double load)
+{
+    CHECK_FATAL(!set, "set is null");
+    CHECK_FATAL(load < LOAD_FACTOR_MIN || load > LOAD_FACTOR_MAX, "max load out of range");
+    CHECK_FATAL(set->min_load * 4 > MAP_LOAD_PCT(load), "max load below 4x min load");
+
+    set->max_load = MAP_LOAD_PCT(load);
+
+    u64 cap = map_capacity_for(set->size, set->capacity, set->max_load);
+    if (cap != set->capacity) {
+        set_resize(set, cap);
+    }
+}
+
+
+
+void hashset_set_min_load(hashset* set, double load)
+{
+    CHECK_FATAL(!set, "set is null");
+    // range-check the double first: MAP_LOAD_PCT of anything past 2.55 doesn't fit a u8
+    CHECK_FATAL(!(load >= 0 && load <= LOAD_FACTOR_MAX / 4), "min load out of range");
+    CHECK_FATAL(MAP_LOAD_PCT(load) * 4 > set->max_load, "min load above max load / 4");
+
+    set->min_load = MAP_LOAD_PCT(load); // checked on the next remove
+}
+
+
+void hashset_shrink_to_fit(hashset* set)
+{
+    CHECK_FATAL(!set, "set is null");
+
+    u64 cap = map_capacity_for(set->size, HASHMAP_INIT_CAPACITY, set->max_load);
+    if (cap < set->capacity) {
+        set_resize(set, cap);
+    }
+}
+
+
+// Copy of the larger set, then the smaller one inserted into it.
+void hashset_union(hashset* out, const hashset* a, const hashset* b)
+{
+    CHECK_FATAL(!out || !a || !b, "null arg");
+    CHECK_FATAL(out == a || out == b, "out must be a separate set");
+    set_same_type(a, b);
+
+    const hashset* small = a->size <= b->size ? a : b;
+    const hashset* large = small == a ? b : a;
+
+    hashset_copy(out, large);
+    hashset_union_with(out, small);
+}
+
+
+// Walk the smaller set, keep what the larger one also has.
+void hashset_intersect(hashset* out, const hashset* a, const hashset* b)
+{
+    CHECK_FATAL(!out || !a || !b, "null arg");
+    CHECK_FATAL(out == a || out == b, "out must be a separate set");
+    set_same_type(a, b);
+    set_same_type(out, a);
+
+    hashset_clear(out);
+
+    const hashset* small = a->size <= b->size ? a : b;
+    const hashset* large = small == a ? b : a;
+
+    const u8* elms[SET_BATCH];
+    u64       hashes[SET_BATCH];
+    b8        found[SET_BATCH];
+    u64       pos = 0;
+    u64       n;
+
+    while ((n = set_gather(small, &pos, elms)) > 0) {
+        set_has_batch(large, elms, n, hashes, found);
+        for (u64 j = 0; j < n; j++) {
+            if (found[j]) {
+                hashset_insert(out, elms[j]);
+            }
+        }
+    }
+}
+
+
+// A smaller b is taken out of a copy of a; otherwise a is walked and
+// every elm b lacks goes into out.
+void hashset_difference(hashset* out, const hashset* a, const hashset* b)
+{
+    CHECK_FATAL(!out || !a || !b, "null arg");
+    CHECK_FATAL(out == a || out == b, "out must be a separate set");
+    set_same_type(a, b);
+    set_same_type(out, a);
+
+    if (b->size < a->size) {
+        hashset_copy(out, a);
+        hashset_difference_with(out, b);
+        return;
+    }
+
+    hashset_clear(out);
+
+    const u8* elms[SET_BATCH];
+    u64       hashes[SET_BATCH];
+    b8        found[SET_BATCH];
+    u64       pos = 0;
+    u64       n;
+
+    while ((n = set_gather(a, &pos, elms)) > 0) {
+        set_has_batch(b, elms, n, hashes, found);
+        for (u64 j = 0; j < n; j++) {
+            if (!found[j]) {
+                hashset_insert(out, elms[j]);
+            }
+        }
+    }
+}
+
+
+void hashset_union_with(hashset* set, const hashset* other)
+{
+    CHECK_FATAL(!set || !other, "null arg");
+    set_same_type(set, other);
+
+    if (set == other) {
+        return;
+    }
+
+    const u8* elms[SET_BATCH];
+    u64       hashes[SET_BATCH];
+    b8        found[SET_BATCH];
+    u64       pos = 0;
+    u64       n;
+
+    while ((n = set_gather(other, &pos, elms)) > 0) {
+        u64 seed = set->seed;
+        set_has_batch(set, elms, n, hashes, found);
+        for (u64 j = 0; j < n; j++) {
+            if (found[j]) {
+                continue;
+            }
+            // an insert can reseed the set after a psl overflow
+            u64 hash = set->seed == seed ? hashes[j] : SET_HASH(set, elms[j]);
+            hashset_insert_with_hash(set, elms[j], hash);
+        }
+    }
+}
+
+
+void hashset_intersect_with(hashset* set, const hashset* other)
+{
+    CHECK_FATAL(!set || !other, "null arg");
+    set_same_type(set, other);
+
+    if (set != other) {
+        set_retain(set, other, 1);
+    }
+}
+
+
+// A smaller other is walked and its elms removed one by one; otherwise
+// set is walked and compacted in one pass.
+void hashset_difference_with(hashset* set, const hashset* other)
+{
+    CHECK_FATAL(!set || !other, "null arg");
+    set_same_type(set, other);
+
+    if (set == other) {
+        hashset_clear(set);
+        return;
+    }
+    if (other->size >= set->size) {
+        set_retain(set, other, 0);
+        return;
+    }
+
+    const u8* elms[SET_BATCH];
+    u64       hashes[SET_BATCH];
+    b8        found[SET_BATCH];
+    u64       pos = 0;
+    u64       n;
+
+    // a remove may shrink the set, but it keeps the seed: hashes stay valid
+    while ((n = set_gather(other, &pos, elms)) > 0) {
+        set_has_batch(set, elms, n, hashes, found);
+        for (u64 j = 0; j < n; j++) {
+            if (found[j]) {
+                hashset_remove_with_hash(set, elms[j], hashes[j]);
+            }
+        }
+    }
+}
+
+
+u64 hashset_intersect_count(const hashset* a, const hashset* b)
+{
+    CHECK_FATAL(!a || !b, "null arg");
+    set_same_type(a, b);
+
+    const hashset* small = a->size <= b->size ? a : b;
+    const hashset* large = small == a ? b : a;
+
+    const u8* elms[SET_BATCH];
+    u64       hashes[SET_BATCH];
+    b8        found[SET_BATCH];
+    u64       pos   = 0;
+    u64       count = 0;
+    u64       n;
+
+    while ((n = set_gather(small, &pos, elms)) > 0) {
+        set_has_batch(large, elms, n, hashes, found);
+        for (u64 j = 0; j < n; j++) {
+            count += found[j];
+        }
+    }
+    return count;
+}
+
+
+genVec* hashset_sorted(const hashset* set, compare_fn cmp_fn)
+{
+    CHECK_FATAL(!set, "set is null");
+
+    copy_fn e_cp = SET_COPY(set->ops);
+    genVec* vec  = genVec_init(set->size, set->elm_size, set->ops);
+
+    u8* dst = vec->data;
+    for (u64 i = 0; (i = map_next_full(set->psls, i, set->capacity)) < set->capacity; i++) {
+        if (e_cp) {
+            e_cp(dst, GET_ELM(set, i));
+        } else {
+            memcpy(dst, GET_ELM(set, i), set->elm_size);
+        }
+        dst += set->elm_size;
+    }
+    vec->size = set->size;
+
+    genVec_sort(vec, cmp_fn);
+    return vec;
+}
+
+
+void hashset_stats(const hashset* set, map_stats* out)
+{
+    CHECK_FATAL(!set || !out, "null arg");
+
+    memset(out, 0, sizeof(*out));
+    out->size     = set->size;
+    out->capacity = set->capacity;
+    out->counters = set->counters;
+    out->bytes    = sizeof(hashset) + (set->capacity * ((u64)set->elm_size + 1));
+
+    map_stats_scan(out, set->psls, set->capacity);
+    map_stats_finish(out);
+}
+
+
+void hashset_stats_reset(hashset* set)
+{
+    CHECK_FATAL(!set, "set is null");
+    memset(&set->counters, 0, sizeof(set->counters));
+}
+
+
+/*
+====================SNAPSHOTS====================
+*/
+
+// Same file layout as hashmap_save, with no vals array.
+b8 hashset_save(const hashset* set, const char* path)
+{
+    CHECK_FATAL(!set || !path, "null arg");
+    CHECK_FATAL(set->ops != NULL, "snapshots need POD elms");
+
+    map_snapshot_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.kind       = MAP_SNAPSHOT_HASHSET;
+    hdr.key_size   = set->elm_size;
+    hdr.size       = set->size;
+    hdr.capacity   = set->capacity;
+    hdr.seed       = set->seed;
+    hdr.hash_check = map_snapshot_hash_check(set->hash_fn, set->elm_size);
+    hdr.max_load   = set->max_load;
+    hdr.min_load   = set->min_load;
+    hdr.lens[0]    = set->capacity;
+    hdr.lens[1]    = set->capacity * set->elm_size;
+
+    const u8* const arrays[MAP_SNAPSHOT_ARRAYS] = {set->psls, set->elms, NULL};
+    return map_snapshot_save(path, &hdr, arrays);
+}
+
+
+hashset* hashset_load_mmap(const char* path, custom_hash_fn hash_fn, compare_fn cmp_fn)
+{
+    CHECK_FATAL(!path, "path is null");
+
+    map_snapshot_header hdr;
+    u8*                 base = map_snapshot_map(path, MAP_SNAPSHOT_HASHSET, &hdr);
+    if (!base) {
+        return NULL;
+    }
+
+    hash_fn = hash_fn ? hash_fn : wyhash;
+    if (hdr.lens[0] != hdr.capacity ||
+        !map_snapshot_len_is(hdr.lens[1], hdr.capacity, hdr.key_size) || hdr.lens[2] != 0 ||
+        map_snapshot_hash_check(hash_fn, hdr.key_size) != hdr.hash_check) {
+        map_snapshot_unmap(base, hdr.file_len);
+        WC_SET_RET(WC_ERR_IO, 1, NULL);
+    }
+
+    hashset* set = malloc(sizeof(hashset));
+    CHECK_FATAL(!set, "set malloc failed");
+    set->arena = NULL;
+
+    set->psls     = base + hdr.offs[0];
+    set->elms     = base + hdr.offs[1];
+    set->size     = hdr.size;
+    set->capacity = hdr.capacity;
+    set->elm_size = hdr.key_size;
+
+    set->hash_fn = hash_fn;
+    set->cmp_fn  = cmp_fn ? cmp_fn : default_compare;
+    set->seed    = hdr.seed;
+
+    set->max_load     = hdr.max_load;
+    set->min_load     = hdr.min_load;
+    set->psl_overflow = 0;
+    set->psl_limit    = RH_PSL_LIMIT;
+
+    set->ops = NULL;
+
+    set->snapshot     = base;
+    set->snapshot_len = hdr.file_len;
+    set->read_only    = 1;
+
+    memset(&set->counters, 0, sizeof(set->counters));
+
+    return set;
+}
+
+
+// Copy-on-write per page, as hashmap_promote
+void hashset_promote(hashset* set)
+{
+    CHECK_FATAL(!set, "set is null");
+
+    if (!set->read_only) {
+        return;
+    }
+    map_snapshot_promote(set->snapshot, set->snapshot_len);
+    set->read_only = 0;
+}
+
+
 /*
 ====================PRIVATE FUNCTIONS====================
 */
 
+// Table storage comes from the set's arena when it has one, else the heap.
+// Arena memory is never handed back piecemeal — set_free skips it.
+static inline u8* set_alloc(const hashset* set, u64 size)
+{
+    return set->arena ? arena_alloc(set->arena, size) : malloc(size);
+}
+
+// Tables still in a snapshot mapping go back with it (set_drop_snapshot)
+static inline void set_free(const hashset* set, void* ptr)
+{
+    if (!set->arena && !map_snapshot_owns(set->snapshot, set->snapshot_len, ptr)) {
+        free(ptr);
+    }
+}
+
+static inline void set_drop_snapshot(hashset* set)
+{
+    map_snapshot_unmap(set->snapshot, set->snapshot_len);
+    set->snapshot     = NULL;
+    set->snapshot_len = 0;
+    set->read_only    = 0;
+}
+
 static inline void set_maybe_resize(hashset* set)
 {
-    // integer multiply avoids float — equivalent to load > 0.75
-    if (set->size * 4 >= set->capacity * 3) {
+    // a psl reached psl_limit: grow past the default load, else
+    // rehash under a new seed (as map_check_overflow)
+    if (set->psl_overflow) {
+        if (map_overflow_grows(set->size, set->capacity)) {
+            set_rehash(set, set->capacity * 2, set->seed);
+        } else {
+            set_rehash(set, set->capacity, map_seed_random());
+        }
+    }
+
+    if (map_load_reached(set->size, set->capacity, set->max_load)) {
         set_resize(set, set->capacity * 2);
     }
 }
 
+// Removes call this, as map_maybe_shrink
+static inline void set_maybe_shrink(hashset* set)
+{
+    if (set->min_load && set->capacity > HASHMAP_INIT_CAPACITY &&
+        !map_load_reached(set->size, set->capacity, set->min_load)) {
+        set_resize(set, map_shrink_capacity(set->size, set->capacity, set->max_load));
+    }
+}
+
+
+/*
+====================SET ALGEBRA====================
+*/
+
+static inline void set_same_type(const hashset* a, const hashset* b)
+{
+    CHECK_FATAL(a->elm_size != b->elm_size, "sets hold different elm sizes");
+}
+
+// Next chunk of up to SET_BATCH elms of src, walking its buckets from *pos.
+// Returns how many were found (0 once src is exhausted).
+static u64 set_gather(const hashset* src, u64* pos, const u8** elms)
+{
+    u64 n = 0;
+    u64 i = *pos;
+
+    while (n < SET_BATCH && (i = map_next_full(src->psls, i, src->capacity)) < src->capacity) {
+        elms[n++] = GET_ELM(src, i);
+        i++;
+    }
+    *pos = i;
+    return n;
+}
+
+// found[j] = probe holds elms[j], hashes[j] = its hash in probe. All n
+// homes are prefetched before the first probe, so the misses overlap.
+static void set_has_batch(const hashset* probe, const u8** elms, u64 n, u64* hashes, b8* found)
+{
+    for (u64 j = 0; j < n; j++) {
+        hashes[j] = SET_HASH(probe, elms[j]);
+        u64 home  = SET_HOME(probe, hashes[j]);
+        __builtin_prefetch(GET_PSL(probe, home));
+        __builtin_prefetch(GET_ELM(probe, home));
+    }
+
+    for (u64 j = 0; j < n; j++) {
+        LOOKUP_RES res;
+        u8         out_psl;
+        set_lookup(probe, elms[j], hashes[j], &res, &out_psl);
+        found[j] = res == FOUND;
+    }
+}
+
+// Keep the elms of set that other has (keep_found) or lacks (!keep_found).
+// Marks first, then drops everything marked in one compaction pass.
+static void set_retain(hashset* set, const hashset* other, b8 keep_found)
+{
+    u8* drop = calloc(set->capacity, sizeof(u8));
+    CHECK_FATAL(!drop, "drop flags calloc failed");
+
+    const u8* elms[SET_BATCH];
+    u64       hashes[SET_BATCH];
+    b8        found[SET_BATCH];
+    u64       pos     = 0;
+    u64       dropped = 0;
+    u64       n;
+
+    while ((n = set_gather(set, &pos, elms)) > 0) {
+        set_has_batch(other, elms, n, hashes, found);
+        for (u64 j = 0; j < n; j++) {
+            if (found[j] != keep_found) {
+                drop[(u64)(elms[j] - set->elms) / set->elm_size] = 1;
+                dropped++;
+            }
+        }
+    }
+
+    if (dropped > 0) {
+        set_compact(set, drop);
+        set_maybe_shrink(set);
+    }
+    free(drop);
+}
+
+// Remove every elm with drop[i] set, in one pass and without rehashing.
+// Starting right after an empty bucket, each run is compacted toward its
+// start: a survivor moves back to its home or to the slot right after the
+// previous survivor, whichever comes later. Order within the run is kept,
+// so the Robin Hood invariant holds.
+static void set_compact(hashset* set, const u8* drop)
+{
+    SET_CHECK_WRITABLE(set);
+
+    delete_fn e_del = SET_DEL(set->ops);
+    u64       mask  = SET_MASK(set);
+    u64       start = rh_run_end(set->psls, 0, mask);
+    u64       w     = (start + 1) & mask; // next free slot of the current run
+
+    for (u64 k = 1; k <= set->capacity; k++) {
+        u64 i   = (start + k) & mask;
+        u8  psl = *GET_PSL(set, i);
+
+        // slots behind i were already rewritten, so this is the original psl
+        if (psl == BUCKET_EMPTY) {
+            w = (i + 1) & mask;
+            continue;
+        }
+
+        if (drop[i]) {
+            if (e_del) {
+                e_del(GET_ELM(set, i));
+            }
+            *GET_PSL(set, i) = BUCKET_EMPTY;
+            set->size--;
+            continue;
+        }
+
+        // home and w both lie at or behind i in this run; take the later one
+        u64 back = (i - w) & mask;
+        u64 to   = back < (u64)(psl - 1) ? w : (i - (psl - 1)) & mask;
+
+        if (to != i) {
+            memcpy(GET_ELM(set, to), GET_ELM(set, i), set->elm_size);
+            *GET_PSL(set, to) = (u8)(psl - ((i - to) & mask));
+            *GET_PSL(set, i)  = BUCKET_EMPTY;
+        }
+        w = (to + 1) & mask;
+    }
+}
+
 
-static u64 set_lookup(const hashset* set, const u8* elm, LOOKUP_RES* res, u8* out_psl)
+static u64 set_lookup(const hashset* set, const u8* elm, u64 hash, LOOKUP_RES* res, u8* out_psl)
 {
-    u64 idx = SET_IDX(set, elm);
+    u64 idx = SET_HOME(set, hash);
     u8  psl = 1; // stored PSL=1 means real probe distance 0 (home slot)
 
+    SET_COUNT(set, lookups, 1);
+
     for (u64 i = idx;; i = SET_NEXT(set, i))
     {
         u8 slot_psl = *GET_PSL(set, i);
         *out_psl    = psl;
+        SET_COUNT(set, probes, 1);
 
         if (slot_psl == BUCKET_EMPTY) {
             *res = NOT_FOUND;
@@ -348,6 +978,7 @@ static u64 set_lookup(const hashset* set, const u8* elm, LOOKUP_RES* res, u8* ou
             return i;
         }
 
+        SET_COUNT(set, compares, 1);
         if (set->cmp_fn(GET_ELM(set, i), elm, set->elm_size) == 0) {
             *res = FOUND;
             return i;
@@ -358,91 +989,114 @@ static u64 set_lookup(const hashset* set, const u8* elm, LOOKUP_RES* res, u8* ou
 }
 
 
-static void set_insert(hashset* set, u8* elm, u8 psl, u64 idx)
+// Insertion point for an elm that is known to be absent (resize).
+// Elms are unique there, so only PSLs are compared — never elms.
+static u64 set_insert_pos(const hashset* set, u64 idx, u8* out_psl)
 {
-    // elm is already owned (either staged copy or moved pointer).
-    // Alternates between the two scratch halves on each Robin Hood eviction
-    // so that elm never aliases the buffer being written into.
-    u8* cur = STAGE_ELM(set);
-    u8* swp = SWAP_ELM(set);
+    u8 psl = 1;
 
-    // elm may already be STAGE_ELM (called from hashset_insert/insert_move);
-    // only copy if it isn't already there.
-    if (elm != cur) {
-        memcpy(cur, elm, set->elm_size);
+    // empty buckets (psl 0) always stop the probe
+    while (*GET_PSL(set, idx) >= psl) {
+        idx = SET_NEXT(set, idx);
+        psl++;
     }
 
-    for (u64 i = idx;; i = SET_NEXT(set, i))
-    {
-        u8 slot_psl = *GET_PSL(set, i);
+    *out_psl = psl;
+    return idx;
+}
 
-        if (slot_psl == BUCKET_EMPTY) {
-            *GET_PSL(set, i) = psl;
-            memcpy(GET_ELM(set, i), cur, set->elm_size);
-            set->size++;
-            return;
-        }
 
-        // Robin Hood: evict the "rich" resident (lower PSL = closer to home).
-        if (slot_psl < psl) {
-            u8 tmp_psl = slot_psl;
+// Open slot idx for a new elm with the given psl (Robin Hood insertion point).
+// An occupied slot has its run shifted one slot right; the caller then
+// constructs the elm in place.
+static void set_insert(hashset* set, u8 psl, u64 idx)
+{
+    if (*GET_PSL(set, idx) != BUCKET_EMPTY) {
+        u64 end = rh_run_end(set->psls, idx, SET_MASK(set));
 
-            // Save displaced resident into swp (disjoint from cur).
-            memcpy(swp, GET_ELM(set, i), set->elm_size);
+        rh_shift_right(set->elms, set->elm_size, idx, end, set->capacity);
+        rh_shift_right(set->psls, sizeof(u8), idx, end, set->capacity);
+        set->psl_overflow |= rh_bump_psls(set->psls, idx, end, SET_MASK(set), set->psl_limit);
+    }
 
-            // Place incoming element into slot.
-            *GET_PSL(set, i) = psl;
-            memcpy(GET_ELM(set, i), cur, set->elm_size);
+    set->psl_overflow |= psl >= set->psl_limit;
+    *GET_PSL(set, idx) = psl;
+    set->size++;
+}
 
-            // The evicted entry is now in swp; swap roles so cur always
-            // points to the element being placed and swp is the free buffer.
-            u8* tmp = cur; cur = swp; swp = tmp;
-            psl = tmp_psl + 1; // +1: evicted entry moves one slot further from home
-            continue;          // skip the unconditional psl++ below
-        }
 
-        psl++;
-    }
+static void set_resize(hashset* set, u64 new_capacity)
+{
+    set_rehash(set, new_capacity, set->seed);
 }
 
 
-static void set_resize(hashset* set, u64 new_capacity)
+// Rebuild the table at new_capacity under seed. A psl overflow throws the
+// new table away and starts over with a fresh seed (and twice the buckets
+// past the default load or after SET_RESEED_TRIES seeds), or under
+// RH_PSL_MAX when the run is elms with equal hash_fn outputs (as map_rehash).
+static void set_rehash(hashset* set, u64 new_capacity, u64 seed)
 {
     if (new_capacity < HASHMAP_INIT_CAPACITY) {
         new_capacity = HASHMAP_INIT_CAPACITY;
     }
 
+    SET_COUNT(set, resizes, 1);
+
     u8* old_elms = set->elms;
     u8* old_psls = set->psls;
     u64 old_cap  = set->capacity;
+    u64 n        = set->size;
+
+    for (u32 tries = 0;; tries++) {
+        set->seed     = seed;
+        set->capacity = new_capacity;
+        set->elms = set_alloc(set, new_capacity * set->elm_size);
+        CHECK_FATAL(!set->elms, "resize elms calloc failed");
+        set->psls = set_alloc(set, new_capacity * sizeof(u8));
+        CHECK_FATAL(!set->psls, "resize psls calloc failed");
+        memset(set->psls, 0, new_capacity * sizeof(u8));
+
+        set->size         = 0;
+        set->psl_overflow = 0;
+
+        for (u64 i = 0; i < old_cap && !set->psl_overflow; i++) {
+            if (old_psls[i] == BUCKET_EMPTY) {
+                continue;
+            }
 
-    set->elms = calloc(new_capacity, set->elm_size);
-    CHECK_FATAL(!set->elms, "resize elms calloc failed");
-    set->psls = calloc(new_capacity, sizeof(u8));
-    CHECK_FATAL(!set->psls, "resize psls calloc failed");
+            u8* old_elm = old_elms + ((u64)set->elm_size * i);
 
-    set->capacity = new_capacity;
-    set->size     = 0;
+            u8  out_psl;
+            u64 slot = set_insert_pos(set, SET_HOME(set, SET_HASH(set, old_elm)), &out_psl);
 
-    for (u64 i = 0; i < old_cap; i++) {
-        if (old_psls[i] == BUCKET_EMPTY) {
-            continue;
+            set_insert(set, out_psl, slot);
+            memcpy(GET_ELM(set, slot), old_elm, set->elm_size);
         }
 
-        u8* old_elm = old_elms + ((u64)set->elm_size * i);
+        if (!set->psl_overflow) {
+            break;
+        }
 
-        // Stage each entry before inserting — set_insert uses SWAP_ELM (second
-        // half of scratch) as its eviction buffer, so old_elm must not alias it.
-        memcpy(STAGE_ELM(set), old_elm, set->elm_size);
+        u64 twins = rh_overflow_twins(set->psls, set->elms, set->elm_size, set->capacity,
+                                      set->psl_limit, set->hash_fn);
+        CHECK_FATAL(twins >= RH_PSL_MAX, "psl overflow: hash_fn maps over 254 elms to one hash");
 
-        LOOKUP_RES res;
-        u8             out_psl;
-        u64            slot = set_lookup(set, STAGE_ELM(set), &res, &out_psl);
-        set_insert(set, STAGE_ELM(set), out_psl, slot);
+        set_free(set, set->elms);
+        set_free(set, set->psls);
+
+        if (set->psl_limit < RH_PSL_MAX && twins * 2 >= RH_PSL_LIMIT) {
+            set->psl_limit = RH_PSL_MAX; // same seed and size, keep the run
+        } else {
+            seed = map_seed_random();
+            if (tries >= SET_RESEED_TRIES || map_overflow_grows(n, new_capacity)) {
+                new_capacity *= 2;
+            }
+        }
     }
 
-    free(old_elms);
-    free(old_psls);
+    // arena sets just leave the old arrays behind until the arena is cleared
+    set_free(set, old_elms);
+    set_free(set, old_psls);
+    set_drop_snapshot(set); // the new tables are on the heap
 }
-
-
@@ -0,0 +1,168 @@
+#include "map_snapshot.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+#define SNAPSHOT_MAGIC  0x31504e534d435757ULL // "WWCMSNP1"
+#define SNAPSHOT_HEADER 4096                  // arrays start on their own page
+#define SNAPSHOT_ALIGN  64
+
+#define ALIGN_UP(x, a) (((x) + (a) - 1) & ~((u64)(a) - 1))
+
+
+/*
+====================PRIVATE====================
+*/
+
+static b8 write_all(FILE* f, const u8* data, u64 len)
+{
+    return len == 0 || fwrite(data, 1, len, f) == len;
+}
+
+static b8 write_zeros(FILE* f, u64 len)
+{
+    static const u8 zeros[SNAPSHOT_ALIGN] = {0};
+    while (len > 0) {
+        u64 n = len < SNAPSHOT_ALIGN ? len : SNAPSHOT_ALIGN;
+        if (!write_all(f, zeros, n)) {
+            return 0;
+        }
+        len -= n;
+    }
+    return 1;
+}
+
+
+/*
+====================PUBLIC====================
+*/
+
+u64 map_snapshot_hash_check(custom_hash_fn hash_fn, u32 key_size)
+{
+    CHECK_FATAL(!hash_fn, "hash_fn is null");
+
+    u8  stack_probe[64] = {0};
+    u8* probe = key_size <= sizeof(stack_probe) ? stack_probe : malloc(key_size);
+    CHECK_FATAL(!probe, "probe malloc failed");
+
+    for (u32 i = 0; i < key_size; i++) {
+        probe[i] = (u8)(0xA5 ^ (i * 31));
+    }
+    u64 h = hash_fn(probe, key_size);
+
+    if (probe != stack_probe) {
+        free(probe);
+    }
+    return h;
+}
+
+
+b8 map_snapshot_save(const char* path, map_snapshot_header* hdr,
+                     const u8* const arrays[MAP_SNAPSHOT_ARRAYS])
+{
+    CHECK_FATAL(!path || !hdr || !arrays, "null arg");
+
+    hdr->magic   = SNAPSHOT_MAGIC;
+    hdr->version = MAP_SNAPSHOT_VERSION;
+
+    u64 off = SNAPSHOT_HEADER;
+    for (u32 i = 0; i < MAP_SNAPSHOT_ARRAYS; i++) {
+        hdr->offs[i] = hdr->lens[i] ? off : 0;
+        off          = ALIGN_UP(off + hdr->lens[i], SNAPSHOT_ALIGN);
+    }
+    hdr->file_len = off;
+
+    u64   tmp_len = strlen(path) + sizeof(".tmp");
+    char* tmp     = malloc(tmp_len);
+    CHECK_FATAL(!tmp, "path malloc failed");
+    snprintf(tmp, tmp_len, "%s.tmp", path);
+
+    FILE* f  = fopen(tmp, "wb");
+    b8    ok = f != NULL;
+
+    u64 pos = sizeof(*hdr);
+    ok      = ok && write_all(f, (const u8*)hdr, sizeof(*hdr));
+    for (u32 i = 0; i < MAP_SNAPSHOT_ARRAYS && ok; i++) {
+        if (hdr->lens[i]) {
+            ok  = write_zeros(f, hdr->offs[i] - pos) && write_all(f, arrays[i], hdr->lens[i]);
+            pos = hdr->offs[i] + hdr->lens[i];
+        }
+    }
+    ok = ok && write_zeros(f, hdr->file_len - pos);
+
+    // data on disk before the rename makes it visible under path
+    ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    if (f && fclose(f) != 0) {
+        ok = 0;
+    }
+    ok = ok && rename(tmp, path) == 0;
+
+    if (!ok) {
+        remove(tmp);
+    }
+    free(tmp);
+
+    WC_SET_RET(WC_ERR_IO, !ok, 0);
+    return 1;
+}
+
+
+u8* map_snapshot_map(const char* path, map_snapshot_kind kind, map_snapshot_header* hdr)
+{
+    CHECK_FATAL(!path || !hdr, "null arg");
+
+    int fd = open(path, O_RDONLY);
+    WC_SET_RET(WC_ERR_IO, fd < 0, NULL);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (u64)st.st_size < SNAPSHOT_HEADER) {
+        close(fd);
+        WC_SET_RET(WC_ERR_IO, 1, NULL);
+    }
+
+    u64 len  = (u64)st.st_size;
+    u8* base = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file open
+    WC_SET_RET(WC_ERR_IO, base == MAP_FAILED, NULL);
+
+    memcpy(hdr, base, sizeof(*hdr));
+
+    b8 bad = hdr->magic != SNAPSHOT_MAGIC || hdr->version != MAP_SNAPSHOT_VERSION ||
+             hdr->kind != (u32)kind || hdr->file_len != len || hdr->capacity == 0 ||
+             (hdr->capacity & (hdr->capacity - 1)) != 0 || hdr->size > hdr->capacity;
+    // loads as hashmap_set_max_load / set_min_load accept them: a max load
+    // of 0 would make every put grow the table
+    bad = bad || hdr->max_load < MAP_LOAD_PCT(LOAD_FACTOR_MIN) ||
+          hdr->max_load > MAP_LOAD_PCT(LOAD_FACTOR_MAX) || hdr->min_load * 4 > hdr->max_load;
+    // written as offs > len - lens so a huge offset can't wrap the sum
+    for (u32 i = 0; i < MAP_SNAPSHOT_ARRAYS && !bad; i++) {
+        bad = hdr->lens[i] && (hdr->offs[i] < SNAPSHOT_HEADER || hdr->lens[i] > len ||
+                               hdr->offs[i] > len - hdr->lens[i]);
+    }
+    if (bad) {
+        munmap(base, len);
+        WC_SET_RET(WC_ERR_IO, 1, NULL);
+    }
+
+    return base;
+}
+
+
+void map_snapshot_promote(u8* base, u64 len)
+{
+    CHECK_FATAL(!base, "mapping is null");
+    CHECK_FATAL(mprotect(base, len, PROT_READ | PROT_WRITE) != 0, "mprotect failed");
+}
+
+
+void map_snapshot_unmap(u8* base, u64 len)
+{
+    if (base) {
+        munmap(base, len);
+    }
+}
@@ -0,0 +1,177 @@
+#include "thread_pool.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+
+struct thread_pool {
+    pthread_t*      workers;
+    u32             n_workers; // threads - 1, the caller is the last one
+    pthread_mutex_t lock;
+    pthread_cond_t  start;     // workers wait here for the next job
+    pthread_cond_t  done;      // the caller waits here for the workers
+    u64             job;       // bumped per job, workers remember the last one they ran
+    u32             running;   // workers not done with the current job
+    b8              stop;
+    b8              busy;
+
+    // current job, written under lock before the workers are woken
+    thread_pool_fn fn;
+    void*          ctx;
+    u64            n_tasks;
+    _Atomic u64    next;       // next unclaimed task
+};
+
+
+/*
+====================PRIVATE====================
+*/
+
+static void pool_claim(thread_pool* pool)
+{
+    u64 t;
+    while ((t = atomic_fetch_add_explicit(&pool->next, 1, memory_order_relaxed)) < pool->n_tasks) {
+        pool->fn(pool->ctx, t);
+    }
+}
+
+static void* pool_worker(void* arg)
+{
+    thread_pool* pool = arg;
+    u64          seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->job == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->job;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool_claim(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+
+/*
+====================PUBLIC====================
+*/
+
+thread_pool* thread_pool_create(u32 n_threads)
+{
+    if (n_threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = cpus > 0 ? (u32)cpus : 1;
+    }
+
+    thread_pool* pool = malloc(sizeof(thread_pool));
+    CHECK_FATAL(!pool, "pool malloc failed");
+
+    pool->n_workers = n_threads - 1;
+    pool->workers   = NULL;
+    pool->job       = 0;
+    pool->running   = 0;
+    pool->stop      = 0;
+    pool->busy      = 0;
+    pool->fn        = NULL;
+    pool->ctx       = NULL;
+    pool->n_tasks   = 0;
+    atomic_init(&pool->next, 0);
+
+    CHECK_FATAL(pthread_mutex_init(&pool->lock, NULL) != 0, "mutex init failed");
+    CHECK_FATAL(pthread_cond_init(&pool->start, NULL) != 0, "cond init failed");
+    CHECK_FATAL(pthread_cond_init(&pool->done, NULL) != 0, "cond init failed");
+
+    if (pool->n_workers > 0) {
+        pool->workers = malloc(sizeof(pthread_t) * pool->n_workers);
+        CHECK_FATAL(!pool->workers, "workers malloc failed");
+    }
+    for (u32 i = 0; i < pool->n_workers; i++) {
+        CHECK_FATAL(pthread_create(&pool->workers[i], NULL, pool_worker, pool) != 0,
+                    "pthread_create failed");
+    }
+
+    return pool;
+}
+
+
+void thread_pool_destroy(thread_pool* pool)
+{
+    CHECK_FATAL(!pool, "pool is null");
+
+    pthread_mutex_lock(&pool->lock);
+    CHECK_FATAL(pool->busy, "pool destroyed while a job runs");
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (u32 i = 0; i < pool->n_workers; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
+
+
+u32 thread_pool_threads(const thread_pool* pool)
+{
+    CHECK_FATAL(!pool, "pool is null");
+
+    return pool->n_workers + 1;
+}
+
+
+void thread_pool_run(thread_pool* pool, u64 n_tasks, thread_pool_fn fn, void* ctx)
+{
+    CHECK_FATAL(!pool, "pool is null");
+    CHECK_FATAL(!fn, "fn is null");
+
+    if (n_tasks == 0) {
+        return;
+    }
+
+    // nothing to share: skip waking the workers
+    if (pool->n_workers == 0 || n_tasks == 1) {
+        for (u64 t = 0; t < n_tasks; t++) {
+            fn(ctx, t);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    CHECK_FATAL(pool->busy, "thread_pool_run called from inside a job");
+    pool->busy    = 1;
+    pool->fn      = fn;
+    pool->ctx     = ctx;
+    pool->n_tasks = n_tasks;
+    atomic_store_explicit(&pool->next, 0, memory_order_relaxed);
+    pool->running = pool->n_workers;
+    pool->job++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    pool_claim(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pool->busy = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -2,6 +2,8 @@
 #include "arena.h"
 #include "wc_errno.h"
 
+#include <string.h>
+
 
 /* ── Basic alloc ─────────────────────────────────────────────────────────── */
 
@@ -194,6 +196,74 @@ static void test_scratch_outer_alloc_survives(void)
 }
 
 
+/* ── Realloc / allocator adapter ─────────────────────────────────────────── */
+
+static void test_realloc_in_place_at_top(void)
+{
+    Arena* a = arena_create(nKB(1));
+    u8*    p = arena_alloc(a, 16);
+    p[0]     = 7;
+
+    u8* q = arena_realloc(a, p, 16, 100);
+    WC_ASSERT_TRUE(q == p);            /* last allocation: extended, not moved */
+    WC_ASSERT_EQ_U64(a->idx, 100);
+    WC_ASSERT_EQ_INT(q[0], 7);
+
+    q = arena_realloc(a, q, 100, 40);  /* shrinking the top gives bytes back */
+    WC_ASSERT_TRUE(q == p);
+    WC_ASSERT_EQ_U64(a->idx, 40);
+
+    arena_release(a);
+}
+
+static void test_realloc_copies_below_top(void)
+{
+    Arena* a = arena_create(nKB(1));
+    u8*    p = arena_alloc(a, 16);
+    memset(p, 9, 16);
+    arena_alloc(a, 8); /* p is no longer the top */
+
+    u8* q = arena_realloc(a, p, 16, 64);
+    WC_ASSERT_TRUE(q != p);
+    WC_ASSERT_EQ_INT(q[15], 9);
+    WC_ASSERT_TRUE(arena_realloc(a, p, 16, 8) == p); /* shrink below top: as is */
+
+    WC_ASSERT_TRUE(arena_realloc(a, NULL, 0, 8) != NULL);
+    arena_release(a);
+}
+
+static void test_realloc_full_returns_null(void)
+{
+    Arena* a = arena_create(64);
+    u8*    p = arena_alloc(a, 32);
+
+    wc_errno = WC_OK;
+    WC_ASSERT_NULL(arena_realloc(a, p, 32, 65));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_FULL);
+    WC_ASSERT_EQ_U64(a->idx, 32); /* untouched */
+
+    arena_release(a);
+}
+
+static void test_allocator_frees_last_only(void)
+{
+    Arena*       a     = arena_create(nKB(1));
+    wc_allocator alloc = arena_allocator(a);
+
+    void* x = wc_alloc(&alloc, 24);
+    void* y = wc_alloc(&alloc, 24);
+    u64   top = a->idx;
+
+    wc_free(&alloc, x, 24); /* not the last: stays until arena_clear */
+    WC_ASSERT_EQ_U64(a->idx, top);
+
+    wc_free(&alloc, y, 24);
+    WC_ASSERT_EQ_U64(a->idx, (u64)((u8*)y - a->base));
+
+    arena_release(a);
+}
+
+
 /* ── Stack-based arena ───────────────────────────────────────────────────── */
 
 static void test_stk_arena(void)
@@ -255,6 +325,12 @@ void arena_suite(void)
     WC_RUN(test_scratch_macro);
     WC_RUN(test_scratch_outer_alloc_survives);
 
+    /* realloc / allocator */
+    WC_RUN(test_realloc_in_place_at_top);
+    WC_RUN(test_realloc_copies_below_top);
+    WC_RUN(test_realloc_full_returns_null);
+    WC_RUN(test_allocator_frees_last_only);
+
     /* stack-based */
     WC_RUN(test_stk_arena);
     WC_RUN(test_used_remaining);
@@ -0,0 +1,228 @@
+#include "wc_test.h"
+#include "bloom.h"
+#include "wc_helpers.h"
+
+
+static u64 key_at(u64 i)
+{
+    return (i + 1) * 0x9E3779B97F4A7C15ULL;
+}
+
+// Fraction of n never-added keys the filter answers maybe for
+static double measured_fp(const bloom* bf, u64 first_absent, u64 n)
+{
+    u64 fp = 0;
+    for (u64 i = 0; i < n; i++) {
+        u64 k = key_at(first_absent + i);
+        fp += bloom_maybe_has(bf, (u8*)&k);
+    }
+    return (double)fp / (double)n;
+}
+
+
+/* ── Basics ──────────────────────────────────────────────────────────────── */
+
+static void test_create_sizing(void)
+{
+    bloom* bf = bloom_create(10000, 0.01, sizeof(u64), NULL);
+
+    WC_ASSERT_EQ_U64(bloom_count(bf), 0);
+    WC_ASSERT_TRUE(bloom_size_bits(bf) >= 10000 * 9); // ~9.6 bits/key at 1%
+    u64 tail = bloom_size_bits(bf) % BLOOM_BLOCK_BITS;
+    WC_ASSERT_EQ_U64(tail, 0);
+    WC_ASSERT_TRUE(bf->k >= 5 && bf->k <= 8);
+
+    bloom_destroy(bf);
+}
+
+static void test_empty_has_nothing(void)
+{
+    bloom* bf = bloom_create(1000, 0.01, sizeof(u64), NULL);
+
+    for (u64 i = 0; i < 1000; i++) {
+        u64 k = key_at(i);
+        WC_ASSERT_FALSE(bloom_maybe_has(bf, (u8*)&k));
+    }
+    WC_ASSERT_TRUE(bloom_fp_estimate(bf) == 0.0);
+
+    bloom_destroy(bf);
+}
+
+static void test_no_false_negatives(void)
+{
+    bloom* bf = bloom_create(50000, 0.01, sizeof(u64), NULL);
+
+    for (u64 i = 0; i < 50000; i++) {
+        u64 k = key_at(i);
+        bloom_add(bf, (u8*)&k);
+    }
+    WC_ASSERT_EQ_U64(bloom_count(bf), 50000);
+
+    for (u64 i = 0; i < 50000; i++) {
+        u64 k = key_at(i);
+        WC_ASSERT_TRUE(bloom_maybe_has(bf, (u8*)&k));
+    }
+
+    bloom_destroy(bf);
+}
+
+// Filled to the expected count, the real rate stays at or below the target
+static void test_fp_rate_within_target(void)
+{
+    const double rates[] = {0.05, 0.01, 0.001};
+
+    for (u32 r = 0; r < 3; r++) {
+        bloom* bf = bloom_create(100000, rates[r], sizeof(u64), NULL);
+        for (u64 i = 0; i < 100000; i++) {
+            u64 k = key_at(i);
+            bloom_add(bf, (u8*)&k);
+        }
+
+        double fp = measured_fp(bf, 1u << 24, 200000);
+        WC_ASSERT_TRUE(fp <= rates[r] * 1.1);
+
+        // the fill-based estimate tracks the measured rate
+        double est = bloom_fp_estimate(bf);
+        WC_ASSERT_TRUE(est <= rates[r] * 1.1);
+
+        bloom_destroy(bf);
+    }
+}
+
+
+/* ── Batch ───────────────────────────────────────────────────────────────── */
+
+static void test_add_many_matches_add(void)
+{
+    const u64 n    = 5000;
+    u64*      keys = malloc(sizeof(u64) * n);
+    for (u64 i = 0; i < n; i++) {
+        keys[i] = key_at(i);
+    }
+
+    bloom* one  = bloom_create(n, 0.01, sizeof(u64), NULL);
+    bloom* many = bloom_create(n, 0.01, sizeof(u64), NULL);
+    for (u64 i = 0; i < n; i++) {
+        bloom_add(one, (u8*)&keys[i]);
+    }
+    bloom_add_many(many, (u8*)keys, n);
+
+    WC_ASSERT_EQ_U64(bloom_count(many), n);
+    WC_ASSERT_EQ_INT(memcmp(one->words, many->words, bloom_size_bits(one) / 8), 0);
+
+    bloom_destroy(one);
+    bloom_destroy(many);
+    free(keys);
+}
+
+static void test_maybe_has_many(void)
+{
+    const u64 n    = 1000;
+    u64*      keys = malloc(sizeof(u64) * n * 2);
+    for (u64 i = 0; i < n * 2; i++) {
+        keys[i] = key_at(i);
+    }
+
+    bloom* bf = bloom_create(n, 0.001, sizeof(u64), NULL);
+    bloom_add_many(bf, (u8*)keys, n); // first half only
+
+    b8* maybe = malloc(n * 2);
+    u64 hits  = bloom_maybe_has_many(bf, (u8*)keys, n * 2, maybe);
+
+    u64 sum = 0;
+    for (u64 i = 0; i < n * 2; i++) {
+        WC_ASSERT_EQ_INT(maybe[i], bloom_maybe_has(bf, (u8*)&keys[i]));
+        if (i < n) {
+            WC_ASSERT_TRUE(maybe[i]);
+        }
+        sum += maybe[i];
+    }
+    WC_ASSERT_EQ_U64(hits, sum);
+    WC_ASSERT_TRUE(hits >= n && hits < n + 20);
+    WC_ASSERT_EQ_U64(bloom_maybe_has_many(bf, (u8*)keys, n, NULL), n);
+
+    free(maybe);
+    bloom_destroy(bf);
+    free(keys);
+}
+
+
+/* ── Merge / clear ───────────────────────────────────────────────────────── */
+
+static void test_merge(void)
+{
+    bloom* a = bloom_create(2000, 0.01, sizeof(u64), NULL);
+    bloom* b = bloom_create(2000, 0.01, sizeof(u64), NULL);
+
+    for (u64 i = 0; i < 1000; i++) {
+        u64 ka = key_at(i);
+        u64 kb = key_at(i + 1000);
+        bloom_add(a, (u8*)&ka);
+        bloom_add(b, (u8*)&kb);
+    }
+
+    bloom_merge(a, b);
+    WC_ASSERT_EQ_U64(bloom_count(a), 2000);
+    for (u64 i = 0; i < 2000; i++) {
+        u64 k = key_at(i);
+        WC_ASSERT_TRUE(bloom_maybe_has(a, (u8*)&k));
+    }
+    WC_ASSERT_TRUE(measured_fp(a, 1u << 24, 20000) < 0.02);
+
+    bloom_merge(a, a); // no-op
+    WC_ASSERT_EQ_U64(bloom_count(a), 2000);
+
+    bloom_destroy(a);
+    bloom_destroy(b);
+}
+
+static void test_clear(void)
+{
+    bloom* bf = bloom_create(100, 0.01, sizeof(u64), NULL);
+
+    for (u64 i = 0; i < 100; i++) {
+        u64 k = key_at(i);
+        bloom_add(bf, (u8*)&k);
+    }
+    bloom_clear(bf);
+
+    WC_ASSERT_EQ_U64(bloom_count(bf), 0);
+    WC_ASSERT_TRUE(measured_fp(bf, 0, 100) == 0.0);
+
+    bloom_destroy(bf);
+}
+
+
+/* ── String keys ─────────────────────────────────────────────────────────── */
+
+static void test_string_keys(void)
+{
+    bloom* bf = bloom_create(100, 0.01, sizeof(String), wyhash_str);
+
+    String a, b;
+    string_create_stk(&a, "apple");
+    string_create_stk(&b, "apple");
+    bloom_add(bf, (u8*)&a);
+
+    // same contents, different buffer: the hash only sees the characters
+    WC_ASSERT_TRUE(bloom_maybe_has(bf, (u8*)&b));
+
+    string_destroy_stk(&a);
+    string_destroy_stk(&b);
+    bloom_destroy(bf);
+}
+
+
+void bloom_suite(void)
+{
+    WC_SUITE("Bloom filter");
+    WC_RUN(test_create_sizing);
+    WC_RUN(test_empty_has_nothing);
+    WC_RUN(test_no_false_negatives);
+    WC_RUN(test_fp_rate_within_target);
+    WC_RUN(test_add_many_matches_add);
+    WC_RUN(test_maybe_has_many);
+    WC_RUN(test_merge);
+    WC_RUN(test_clear);
+    WC_RUN(test_string_keys);
+}
@@ -0,0 +1,290 @@
+#include "wc_test.h"
+#include "gen_vector_par.h"
+#include "wc_helpers.h"
+#include "random.h"
+
+#include <stdatomic.h>
+
+
+#define PAR_N 100000
+
+
+/* ── Thread pool ─────────────────────────────────────────────────────────── */
+
+static void count_task(void* ctx, u64 task)
+{
+    atomic_fetch_add((_Atomic u32*)ctx + task, 1);
+}
+
+static void test_pool_runs_every_task_once(void)
+{
+    thread_pool* pool = thread_pool_create(4);
+    WC_ASSERT_EQ_U64(thread_pool_threads(pool), 4);
+
+    static _Atomic u32 hits[1000];
+    for (int i = 0; i < 1000; i++) {
+        atomic_init(&hits[i], 0);
+    }
+
+    // the same workers take job after job
+    for (int round = 0; round < 3; round++) {
+        thread_pool_run(pool, 1000, count_task, hits);
+    }
+    thread_pool_run(pool, 0, count_task, hits);
+
+    for (int i = 0; i < 1000; i++) {
+        WC_ASSERT_EQ_U64(atomic_load(&hits[i]), 3);
+    }
+    thread_pool_destroy(pool);
+}
+
+static void test_pool_one_thread_runs_inline(void)
+{
+    thread_pool* pool = thread_pool_create(1);
+    WC_ASSERT_EQ_U64(thread_pool_threads(pool), 1);
+
+    static _Atomic u32 hits[8];
+    thread_pool_run(pool, 8, count_task, hits);
+    WC_ASSERT_EQ_U64(atomic_load(&hits[7]), 1);
+    thread_pool_destroy(pool);
+
+    pool = thread_pool_create(0); // one per CPU
+    WC_ASSERT_TRUE(thread_pool_threads(pool) >= 1);
+    thread_pool_destroy(pool);
+}
+
+
+/* ── for_each / map / reduce ─────────────────────────────────────────────── */
+
+static genVec* iota_u32(u64 n)
+{
+    genVec* v = genVec_init(n, sizeof(u32), NULL);
+    u32*    x = (u32*)genVec_emplace_n(v, n);
+    for (u64 i = 0; i < n; i++) {
+        x[i] = (u32)i;
+    }
+    return v;
+}
+
+static void scale_elm(u8* elm, void* ctx)
+{
+    *(u32*)elm *= *(const u32*)ctx;
+}
+
+static void test_for_each(void)
+{
+    thread_pool* pool = thread_pool_create(4);
+    genVec*      v    = iota_u32(PAR_N);
+
+    u32 k = 3;
+    genVec_par_for_each(pool, v, scale_elm, &k);
+    genVec_par_for_each(NULL, v, scale_elm, &k); // same code, calling thread only
+
+    for (u64 i = 0; i < PAR_N; i += 997) {
+        WC_ASSERT_EQ_U64(*(const u32*)genVec_get_ptr(v, i), (u32)(i * 9));
+    }
+    WC_ASSERT_EQ_U64(*(const u32*)genVec_back(v), (u32)((PAR_N - 1) * 9));
+
+    genVec_destroy(v);
+    thread_pool_destroy(pool);
+}
+
+static void u32_to_string(u8* out, const u8* in, void* ctx)
+{
+    (void)ctx;
+    char buf[64];
+    snprintf(buf, sizeof(buf), "element number %u, long enough for the heap", *(const u32*)in);
+    string_create_stk((String*)out, buf);
+}
+
+static void test_map_builds_dest_in_place(void)
+{
+    thread_pool* pool = thread_pool_create(4);
+    genVec*      src  = iota_u32(PAR_N / 4);
+
+    genVec* dest = genVec_init(0, sizeof(String), &wc_str_ops);
+    String  old;
+    string_create_stk(&old, "an old element, cleared before the map");
+    genVec_push(dest, (const u8*)&old);
+    string_destroy_stk(&old);
+
+    genVec_par_map(pool, dest, src, u32_to_string, NULL);
+    WC_ASSERT_EQ_U64(genVec_size(dest), PAR_N / 4);
+    WC_ASSERT_TRUE(string_equals_cstr((const String*)genVec_get_ptr(dest, 0),
+                                      "element number 0, long enough for the heap"));
+    WC_ASSERT_TRUE(string_equals_cstr((const String*)genVec_get_ptr(dest, 12345),
+                                      "element number 12345, long enough for the heap"));
+
+    genVec_clear(src);
+    genVec_par_map(pool, dest, src, u32_to_string, NULL);
+    WC_ASSERT_EQ_U64(genVec_size(dest), 0);
+
+    genVec_destroy(dest);
+    genVec_destroy(src);
+    thread_pool_destroy(pool);
+}
+
+static void sum_fold(u8* acc, const u8* elm, void* ctx)
+{
+    (void)ctx;
+    *(u64*)acc += *(const u32*)elm;
+}
+
+static void sum_combine(u8* acc, const u8* other, void* ctx)
+{
+    (void)ctx;
+    *(u64*)acc += *(const u64*)other;
+}
+
+static void max_fold(u8* acc, const u8* elm, void* ctx)
+{
+    (void)ctx;
+    if (*(const u32*)elm > *(u32*)acc) {
+        *(u32*)acc = *(const u32*)elm;
+    }
+}
+
+static void test_reduce(void)
+{
+    thread_pool* pool = thread_pool_create(4);
+    genVec*      v    = iota_u32(PAR_N);
+
+    // u32 elements into a u64 sum: fold and combine differ
+    u64 sum = 0;
+    genVec_par_reduce(pool, v, (u8*)&sum, sizeof(sum), sum_fold, sum_combine, NULL);
+    WC_ASSERT_EQ_U64(sum, (u64)PAR_N * (PAR_N - 1) / 2);
+
+    sum = 0;
+    genVec_par_reduce(NULL, v, (u8*)&sum, sizeof(sum), sum_fold, sum_combine, NULL);
+    WC_ASSERT_EQ_U64(sum, (u64)PAR_N * (PAR_N - 1) / 2);
+
+    // same type: combine defaults to fold
+    u32 max = 0;
+    genVec_par_reduce(pool, v, (u8*)&max, sizeof(max), max_fold, NULL, NULL);
+    WC_ASSERT_EQ_U64(max, PAR_N - 1);
+
+    genVec_clear(v);
+    sum = 42; // empty vec: acc keeps the identity
+    genVec_par_reduce(pool, v, (u8*)&sum, sizeof(sum), sum_fold, sum_combine, NULL);
+    WC_ASSERT_EQ_U64(sum, 42);
+
+    genVec_destroy(v);
+    thread_pool_destroy(pool);
+}
+
+static void fsum_fold(u8* acc, const u8* elm, void* ctx)
+{
+    (void)ctx;
+    *(float*)acc += *(const float*)elm;
+}
+
+// float addition rounds differently per grouping: the chunks must not
+// follow the thread count
+static void test_reduce_float_same_for_every_pool(void)
+{
+    genVec* v = genVec_init(PAR_N, sizeof(float), NULL);
+    float*  x = (float*)genVec_emplace_n(v, PAR_N);
+    for (u64 i = 0; i < PAR_N; i++) {
+        x[i] = 1.0f / (float)(i + 1);
+    }
+
+    float want = 0.0f;
+    genVec_par_reduce(NULL, v, (u8*)&want, sizeof(want), fsum_fold, NULL, NULL);
+
+    for (u32 threads = 1; threads <= 5; threads++) {
+        thread_pool* pool = thread_pool_create(threads);
+        float        got  = 0.0f;
+        genVec_par_reduce(pool, v, (u8*)&got, sizeof(got), fsum_fold, NULL, NULL);
+        WC_ASSERT_EQ_INT(memcmp(&got, &want, sizeof(float)), 0);
+        thread_pool_destroy(pool);
+    }
+
+    genVec_destroy(v);
+}
+
+/* ── sort ────────────────────────────────────────────────────────────────── */
+
+static int cmp_u64(const u8* a, const u8* b, u64 size)
+{
+    (void)size;
+    u64 x = *(const u64*)a;
+    u64 y = *(const u64*)b;
+    return (x > y) - (x < y);
+}
+
+static void test_sort_matches_serial(void)
+{
+    pcg32_rand_seed(7, 1);
+    genVec* want = genVec_init(PAR_N, sizeof(u64), NULL);
+    for (u64 i = 0; i < PAR_N; i++) {
+        u64 x = pcg32_rand_bounded(5000); // plenty of duplicates
+        genVec_push(want, (const u8*)&x);
+    }
+    genVec got;
+    genVec_init_stk(0, sizeof(u64), NULL, &got);
+
+    // 2, 3 and 4 runs: an odd and an even number of merge rounds, and an
+    // odd run left over in a round
+    for (u32 threads = 1; threads <= 4; threads++) {
+        thread_pool* pool = thread_pool_create(threads);
+        genVec_copy(&got, want);
+        genVec_par_sort(pool, &got, cmp_u64);
+        thread_pool_destroy(pool);
+
+        u64 out_of_order = 0;
+        for (u64 i = 1; i < PAR_N; i++) {
+            out_of_order += cmp_u64(genVec_get_ptr(&got, i - 1), genVec_get_ptr(&got, i), 8) > 0;
+        }
+        WC_ASSERT_EQ_U64(out_of_order, 0);
+    }
+
+    // same multiset as the serial sort
+    genVec_sort(want, cmp_u64);
+    WC_ASSERT_EQ_INT(memcmp(got.data, want->data, PAR_N * sizeof(u64)), 0);
+
+    genVec_destroy_stk(&got);
+    genVec_destroy(want);
+}
+
+static void test_sort_strings_relocates(void)
+{
+    thread_pool* pool = thread_pool_create(3);
+    genVec*      v    = genVec_init(0, sizeof(String), &wc_str_ops);
+
+    pcg32_rand_seed(11, 1);
+    for (u64 i = 0; i < 30000; i++) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%08u is a heap string", pcg32_rand());
+        string_create_stk((String*)genVec_emplace_back(v), buf);
+    }
+
+    genVec_par_sort(pool, v, str_cmp);
+    for (u64 i = 1; i < genVec_size(v); i += 101) {
+        WC_ASSERT_TRUE(string_compare((const String*)genVec_get_ptr(v, i - 1),
+                                      (const String*)genVec_get_ptr(v, i)) <= 0);
+    }
+
+    genVec_destroy(v); // every heap buffer still owned exactly once
+    thread_pool_destroy(pool);
+}
+
+
+/* ── Suite entry points ──────────────────────────────────────────────────── */
+
+void thread_pool_suite(void)
+{
+    WC_SUITE("Thread pool");
+    WC_RUN(test_pool_runs_every_task_once);
+    WC_RUN(test_pool_one_thread_runs_inline);
+}
+
+void gen_vector_par_suite(void)
+{
+    WC_SUITE("genVec parallel algorithms");
+    WC_RUN(test_for_each);
+    WC_RUN(test_map_builds_dest_in_place);
+    WC_RUN(test_reduce);
+    WC_RUN(test_reduce_float_same_for_every_pool);
+    WC_RUN(test_sort_matches_serial);
+    WC_RUN(test_sort_strings_relocates);
+}
@@ -1,4 +1,5 @@
 #include "gen_vector.h"
+#include "arena.h"
 #include "wc_errno.h"
 #include "wc_macros.h"
 #include "wc_helpers.h"
@@ -272,6 +273,300 @@ static void test_reserve_val(void)
 }
 
 
+// Extend / Append / Resize 
+
+static void test_extend_pod(void)
+{
+    int arr[50];
+    for (int i = 0; i < 50; i++) {
+        arr[i] = i * 10;
+    }
+
+    genVec* v = int_vec(0);
+    push_ints(v, 3);
+    genVec_extend(v, (u8*)arr, 50);
+    WC_ASSERT_EQ_U64(genVec_size(v), 53);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 2), 2);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 3), 0);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 52), 490);
+
+    genVec_extend(v, (u8*)arr, 0); // no-op
+    WC_ASSERT_EQ_U64(genVec_size(v), 53);
+
+    // small extends grow geometrically, not one reserve each
+    u64 cap = genVec_capacity(v);
+    genVec_extend(v, (u8*)arr, 1);
+    WC_ASSERT_TRUE(genVec_capacity(v) == cap || genVec_capacity(v) >= cap + (cap / 4));
+
+    genVec_destroy(v);
+}
+
+static void test_extend_strings_copy_and_move(void)
+{
+    String src[3];
+    string_create_stk(&src[0], "one");
+    string_create_stk(&src[1], "a second string, long enough for the heap");
+    string_create_stk(&src[2], "three");
+
+    genVec* v = genVec_init(0, sizeof(String), &wc_str_ops);
+    genVec_extend(v, (u8*)src, 3);
+    WC_ASSERT_TRUE(((String*)genVec_get_ptr(v, 1))->heap != src[1].heap); // deep copy
+
+    // the vec now owns src's bytes: src must not be destroyed again
+    genVec_extend_move(v, (u8*)src, 3);
+    WC_ASSERT_EQ_U64(genVec_size(v), 6);
+    WC_ASSERT_TRUE(((String*)genVec_get_ptr(v, 4))->heap == src[1].heap);
+    WC_ASSERT_TRUE(string_equals_cstr((String*)genVec_get_ptr(v, 4),
+                                      "a second string, long enough for the heap"));
+
+    genVec_destroy(v);
+}
+
+static void test_append_vec(void)
+{
+    genVec* a = int_vec(0);
+    genVec* b = int_vec(0);
+    push_ints(a, 5);
+    push_ints(b, 7);
+
+    genVec_append_vec(a, b);
+    WC_ASSERT_EQ_U64(genVec_size(a), 12);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(a, 5), 0);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(a, 11), 6);
+    WC_ASSERT_EQ_U64(genVec_size(b), 7);
+
+    // onto itself
+    genVec_append_vec(b, b);
+    WC_ASSERT_EQ_U64(genVec_size(b), 14);
+    for (u64 i = 0; i < 14; i++) {
+        int want = (int)(i % 7);
+        WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(b, i), want);
+    }
+
+    genVec_destroy(a);
+    genVec_destroy(b);
+}
+
+static void test_append_vec_strings_self(void)
+{
+    genVec* v = genVec_init(1, sizeof(String), &wc_str_ops);
+    for (int i = 0; i < 4; i++) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "string %d on the heap, long enough", i);
+        VEC_PUSH_CSTR(v, buf);
+    }
+
+    genVec_append_vec(v, v);
+    WC_ASSERT_EQ_U64(genVec_size(v), 8);
+    WC_ASSERT_TRUE(string_equals_cstr((String*)genVec_get_ptr(v, 6),
+                                      "string 2 on the heap, long enough"));
+    WC_ASSERT_TRUE(((String*)genVec_get_ptr(v, 6))->heap != ((String*)genVec_get_ptr(v, 2))->heap);
+
+    genVec_destroy(v);
+}
+
+static void test_resize(void)
+{
+    genVec* v    = int_vec(0);
+    int     fill = 9;
+
+    genVec_resize(v, 37, (u8*)&fill);
+    WC_ASSERT_EQ_U64(genVec_size(v), 37);
+    for (u64 i = 0; i < 37; i++) {
+        WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, i), 9);
+    }
+
+    genVec_resize(v, 10, NULL);
+    WC_ASSERT_EQ_U64(genVec_size(v), 10);
+    WC_ASSERT_TRUE(genVec_capacity(v) >= 37); // kept
+
+    genVec_resize(v, 20, NULL); // zero bytes
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 9), 9);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 10), 0);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 19), 0);
+
+    genVec_resize(v, 0, NULL);
+    WC_ASSERT_TRUE(genVec_empty(v));
+
+    genVec_destroy(v);
+}
+
+static void test_resize_strings(void)
+{
+    genVec* v = genVec_init(0, sizeof(String), &wc_str_ops);
+    String  s;
+    string_create_stk(&s, "a fill string that needs the heap to live");
+
+    genVec_resize(v, 5, (u8*)&s);
+    WC_ASSERT_EQ_U64(genVec_size(v), 5);
+    WC_ASSERT_TRUE(string_equals_cstr((String*)genVec_get_ptr(v, 4),
+                                      "a fill string that needs the heap to live"));
+
+    genVec_resize(v, 2, NULL); // del_fn frees the three dropped
+    WC_ASSERT_EQ_U64(genVec_size(v), 2);
+
+    string_destroy_stk(&s);
+    genVec_destroy(v);
+}
+
+
+// Emplace 
+
+static void test_emplace_back_strings(void)
+{
+    genVec* v = genVec_init(0, sizeof(String), &wc_str_ops);
+
+    for (int i = 0; i < 100; i++) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "emplaced string %d, long enough for the heap", i);
+        string_create_stk((String*)genVec_emplace_back(v), buf);
+    }
+    WC_ASSERT_EQ_U64(genVec_size(v), 100);
+    WC_ASSERT_TRUE(string_equals_cstr((String*)genVec_get_ptr(v, 42),
+                                      "emplaced string 42, long enough for the heap"));
+
+    genVec_destroy(v); // del_fn frees what was built in place
+}
+
+static void test_emplace_n(void)
+{
+    genVec* v = int_vec(0);
+    push_ints(v, 2);
+
+    int* span = (int*)genVec_emplace_n(v, 30);
+    for (int i = 0; i < 30; i++) {
+        span[i] = 100 + i;
+    }
+    WC_ASSERT_EQ_U64(genVec_size(v), 32);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 1), 1);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 2), 100);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 31), 129);
+
+    WC_ASSERT_NULL(genVec_emplace_n(v, 0));
+    WC_ASSERT_EQ_U64(genVec_size(v), 32);
+
+    genVec_destroy(v);
+}
+
+
+// Allocator 
+
+// Heap underneath, counting live blocks and bytes: both back to 0 means
+// every size handed to realloc / free matched what was allocated
+typedef struct {
+    u64 blocks;
+    u64 bytes;
+} alloc_count;
+
+static void* count_alloc(void* ctx, u64 size)
+{
+    alloc_count* c = ctx;
+    c->blocks++;
+    c->bytes += size;
+    return malloc(size);
+}
+
+static void* count_realloc(void* ctx, void* ptr, u64 old_size, u64 new_size)
+{
+    alloc_count* c = ctx;
+    if (!ptr) {
+        return count_alloc(ctx, new_size);
+    }
+    c->bytes += new_size - old_size;
+    return realloc(ptr, new_size);
+}
+
+static void count_free(void* ctx, void* ptr, u64 size)
+{
+    alloc_count* c = ctx;
+    c->blocks--;
+    c->bytes -= size;
+    free(ptr);
+}
+
+static void test_alloc_sizes_balance(void)
+{
+    alloc_count  cnt   = {0};
+    wc_allocator alloc = {count_alloc, count_realloc, count_free, &cnt};
+
+    genVec* v = genVec_init_alloc(2, sizeof(String), &wc_str_ops, &alloc);
+    for (int i = 0; i < 40; i++) {
+        String* s = (String*)genVec_emplace_back(v);
+        string_create_stk(s, "a string long enough for its own heap buffer");
+    }
+    genVec_shrink_to_fit(v);
+    genVec_reset(v);
+    genVec_reserve(v, 10);
+    WC_ASSERT_EQ_U64(cnt.blocks, 2); // struct + data
+
+    // a move keeps the allocator, the shell goes back to it
+    genVec dest;
+    genVec_init_stk(0, sizeof(String), &wc_str_ops, &dest);
+    genVec_move(&dest, &v);
+    WC_ASSERT_TRUE(dest.alloc == &alloc);
+    WC_ASSERT_EQ_U64(cnt.blocks, 1);
+
+    genVec_destroy_stk(&dest);
+    WC_ASSERT_EQ_U64(cnt.blocks, 0);
+    WC_ASSERT_EQ_U64(cnt.bytes, 0);
+}
+
+static void test_arena_vec_grows_in_place(void)
+{
+    Arena*       a     = arena_create(nKB(64));
+    wc_allocator alloc = arena_allocator(a);
+
+    genVec* v    = genVec_init_alloc(4, sizeof(int), NULL, &alloc);
+    u8*     data = v->data;
+    push_ints(v, 5000);
+
+    // always the arena's last block: every grow just moved the top
+    WC_ASSERT_TRUE(v->data == data);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(v, 4999), 4999);
+
+    // a copy is a plain heap vector, it outlives the arena
+    genVec* outer = genVec_init(1, sizeof(genVec), &wc_vec_ops);
+    genVec_push(outer, (const u8*)v);
+    genVec copy;
+    genVec_init_stk(0, sizeof(int), NULL, &copy);
+    genVec_copy(&copy, v);
+    WC_ASSERT_NULL(copy.alloc);
+
+    genVec_destroy(v);
+    WC_ASSERT_EQ_U64(a->idx, 0); // data then struct, both given back
+    memset(a->base, 0xFF, a->size);
+
+    const genVec* inner = (const genVec*)genVec_get_ptr(outer, 0);
+    WC_ASSERT_NULL(inner->alloc);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(inner, 4999), 4999);
+    WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(&copy, 1234), 1234);
+
+    genVec_destroy(outer);
+    genVec_destroy_stk(&copy);
+    arena_release(a);
+}
+
+static void test_stk_arena_vec(void)
+{
+    // stack arena: nothing to release, and the vector never touches the heap
+    Arena a;
+    u8    buf[512];
+    arena_create_arr_stk(&a, buf, sizeof(buf));
+    wc_allocator alloc = arena_allocator(&a);
+
+    genVec v;
+    genVec_init_stk_alloc(8, sizeof(u64), NULL, &alloc, &v);
+    for (u64 i = 0; i < 60; i++) {
+        genVec_push(&v, (const u8*)&i);
+    }
+    WC_ASSERT_TRUE(v.data == buf);
+    WC_ASSERT_EQ_U64(*(const u64*)genVec_back(&v), 59);
+
+    genVec_destroy_stk(&v);
+    WC_ASSERT_EQ_U64(a.idx, 0);
+}
+
+
 // Clear / Reset 
 
 static void test_clear_keeps_capacity(void)
@@ -639,6 +934,108 @@ static void test_vec_foreach_empty(void)
 }
 
 
+// sort / sorted merges 
+
+static int int_cmp(const u8* a, const u8* b, u64 size)
+{
+    (void)size;
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// step, step*2, ... below limit
+static genVec* multiples_vec(int step, int limit)
+{
+    genVec* v = int_vec(0);
+    for (int i = 0; i < limit; i += step) {
+        genVec_push(v, (u8*)&i);
+    }
+    return v;
+}
+
+static void test_sort_ints(void)
+{
+    genVec* v = int_vec(100);
+    for (int i = 0; i < 100; i++) {
+        int x = (i * 37) % 100 - 50;
+        genVec_push(v, (u8*)&x);
+    }
+    genVec_sort(v, int_cmp);
+    for (int i = 0; i < 100; i++) {
+        WC_ASSERT_EQ_INT(VEC_AT(v, int, i), i - 50);
+    }
+    genVec_destroy(v);
+}
+
+static void test_sort_strings(void)
+{
+    genVec*     v     = genVec_init(4, sizeof(String), &wc_str_ops);
+    const char* words[] = {"pear", "apple", "fig", "banana"};
+    for (int i = 0; i < 4; i++) {
+        VEC_PUSH_CSTR(v, words[i]);
+    }
+    genVec_sort(v, str_cmp);
+    WC_ASSERT_TRUE(string_equals_cstr((String*)genVec_get_ptr(v, 0), "apple"));
+    WC_ASSERT_TRUE(string_equals_cstr((String*)genVec_get_ptr(v, 3), "pear"));
+    genVec_destroy(v);
+}
+
+static void test_sorted_set_ops(void)
+{
+    genVec* a   = multiples_vec(2, 100); // 0, 2, ..., 98
+    genVec* b   = multiples_vec(3, 100); // 0, 3, ..., 99
+    genVec* out = int_vec(0);
+
+    genVec_sorted_intersect(out, a, b, int_cmp); // multiples of 6
+    WC_ASSERT_EQ_U64(genVec_size(out), 17);
+    for (u64 i = 0; i < out->size; i++) {
+        WC_ASSERT_EQ_INT(VEC_AT(out, int, i), (int)i * 6);
+    }
+
+    genVec_sorted_union(out, a, b, int_cmp);
+    WC_ASSERT_EQ_U64(genVec_size(out), 50 + 34 - 17);
+    for (u64 i = 1; i < out->size; i++) {
+        WC_ASSERT_TRUE(VEC_AT(out, int, i - 1) < VEC_AT(out, int, i));
+    }
+
+    genVec_sorted_difference(out, a, b, int_cmp); // even, not a multiple of 3
+    WC_ASSERT_EQ_U64(genVec_size(out), 50 - 17);
+    VEC_FOREACH(out, int, x) {
+        WC_ASSERT_TRUE(*x % 2 == 0 && *x % 3 != 0);
+    }
+
+    genVec_sorted_difference(out, b, a, int_cmp);
+    WC_ASSERT_EQ_U64(genVec_size(out), 34 - 17);
+
+    genVec_destroy(a);
+    genVec_destroy(b);
+    genVec_destroy(out);
+}
+
+static void test_sorted_intersect_gallop(void)
+{
+    genVec* big   = multiples_vec(1, 100000);
+    genVec* small = multiples_vec(997, 200000); // half of it past big's end
+    genVec* out   = int_vec(0);
+
+    genVec_sorted_intersect(out, small, big, int_cmp);
+    WC_ASSERT_EQ_U64(genVec_size(out), 101); // 0, 997, ..., 99700
+    WC_ASSERT_EQ_INT(VEC_AT(out, int, 100), 99700);
+
+    genVec_sorted_intersect(out, big, small, int_cmp); // either side may be small
+    WC_ASSERT_EQ_U64(genVec_size(out), 101);
+
+    genVec* none = int_vec(0);
+    genVec_sorted_intersect(out, none, big, int_cmp);
+    WC_ASSERT_EQ_U64(genVec_size(out), 0);
+
+    genVec_destroy(none);
+    genVec_destroy(big);
+    genVec_destroy(small);
+    genVec_destroy(out);
+}
+
+
 
 // Suite entry point 
 
@@ -681,6 +1078,23 @@ extern void gen_vector_suite(void)
     WC_RUN(test_reserve_does_not_shrink);
     WC_RUN(test_reserve_val);
 
+    /* extend / append / resize */
+    WC_RUN(test_extend_pod);
+    WC_RUN(test_extend_strings_copy_and_move);
+    WC_RUN(test_append_vec);
+    WC_RUN(test_append_vec_strings_self);
+    WC_RUN(test_resize);
+    WC_RUN(test_resize_strings);
+
+    /* emplace */
+    WC_RUN(test_emplace_back_strings);
+    WC_RUN(test_emplace_n);
+
+    /* allocator */
+    WC_RUN(test_alloc_sizes_balance);
+    WC_RUN(test_arena_vec_grows_in_place);
+    WC_RUN(test_stk_arena_vec);
+
     /* clear / reset */
     WC_RUN(test_clear_keeps_capacity);
     WC_RUN(test_reset_frees_memory);
@@ -722,4 +1136,9 @@ extern void gen_vector_suite(void)
 
     WC_RUN(test_vec_foreach_mutates);
     WC_RUN(test_vec_foreach_empty);
+
+    WC_RUN(test_sort_ints);
+    WC_RUN(test_sort_strings);
+    WC_RUN(test_sorted_set_ops);
+    WC_RUN(test_sorted_intersect_gallop);
 }
@@ -0,0 +1,290 @@
+#include "wc_test.h"
+#include "hashmap_concurrent.h"
+#include "wc_helpers.h"
+
+#include <pthread.h>
+
+
+/* ── Map constructors ────────────────────────────────────────────────────── */
+
+static hashmap_concurrent* u64_map(u32 shards)
+{
+    return hashmap_concurrent_create(shards, sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+}
+
+static hashmap_concurrent* str_str_map(void)
+{
+    return hashmap_concurrent_create(0, sizeof(String), sizeof(String), wyhash_str, str_cmp,
+                                     &wc_str_ops, &wc_str_ops);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * single thread — same semantics as hashmap
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_put_get_del(void)
+{
+    hashmap_concurrent* m = u64_map(4);
+    WC_ASSERT_EQ_INT(m->optimistic, HASHMAP_CONCURRENT_OPTIMISTIC);
+
+    for (u64 i = 0; i < 5000; i++) {
+        u64 v = i * 3;
+        WC_ASSERT_FALSE(hashmap_concurrent_put(m, (u8*)&i, (u8*)&v));
+    }
+    WC_ASSERT_EQ_U64(hashmap_concurrent_size(m), 5000);
+
+    u64 k = 42, v = 7;
+    WC_ASSERT_TRUE(hashmap_concurrent_put(m, (u8*)&k, (u8*)&v));
+
+    for (u64 i = 0; i < 5000; i++) {
+        u64 out = 0;
+        WC_ASSERT_TRUE(hashmap_concurrent_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_U64(out, i == 42 ? 7 : i * 3);
+    }
+
+    u64 out = 0;
+    WC_ASSERT_TRUE(hashmap_concurrent_del(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_EQ_U64(out, 7);
+    WC_ASSERT_FALSE(hashmap_concurrent_has(m, (u8*)&k));
+    WC_ASSERT_FALSE(hashmap_concurrent_del(m, (u8*)&k, NULL));
+    WC_ASSERT_EQ_U64(hashmap_concurrent_size(m), 4999);
+
+    hashmap_concurrent_clear(m);
+    WC_ASSERT_EQ_U64(hashmap_concurrent_size(m), 0);
+    hashmap_concurrent_destroy(m);
+}
+
+// low 32 bits all 0: unseeded, every key homes in bucket 0 of its shard
+static u64 high_bits_hash(const u8* key, u64 size)
+{
+    (void)size;
+    return *(const u64*)key << 32;
+}
+
+static void test_psl_overflow_rebuilds_shard(void)
+{
+    hashmap_concurrent* m = hashmap_concurrent_create(1, sizeof(u64), sizeof(u64),
+                                                      high_bits_hash, NULL, NULL, NULL);
+    WC_ASSERT_EQ_INT(m->optimistic, HASHMAP_CONCURRENT_OPTIMISTIC);
+    hashmap* shard = atomic_load(&m->shards[0].map);
+    hashmap_reserve(shard, 4000); // no growth rebuilds on the way
+    hashmap_set_seed(shard, 0);
+
+    for (u64 i = 0; i < 3000; i++) {
+        hashmap_concurrent_put(m, (u8*)&i, (u8*)&i);
+    }
+
+    // lock-free mode: the overflow swapped in a reseeded copy
+    // (-DHASHMAP_CONCURRENT_OPTIMISTIC=0: the shard reseeded in place)
+    shard = atomic_load(&m->shards[0].map);
+    WC_ASSERT_TRUE(shard->seed != 0);
+    WC_ASSERT_FALSE(shard->psl_overflow);
+#if HASHMAP_CONCURRENT_OPTIMISTIC
+    WC_ASSERT_NOT_NULL(m->shards[0].retired);
+    WC_ASSERT_TRUE(shard->defer_reseed);
+#endif
+    WC_ASSERT_EQ_U64(hashmap_concurrent_size(m), 3000);
+    for (u64 i = 0; i < 3000; i++) {
+        u64 out = 0;
+        WC_ASSERT_TRUE(hashmap_concurrent_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_U64(out, i);
+    }
+
+    // no reader left: the retired tables can go, the live one stays
+    hashmap_concurrent_reclaim(m);
+    WC_ASSERT_NULL(m->shards[0].retired);
+    WC_ASSERT_EQ_U64(hashmap_concurrent_size(m), 3000);
+    u64 k = 2999, out = 0;
+    WC_ASSERT_TRUE(hashmap_concurrent_get(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_EQ_U64(out, 2999);
+    hashmap_concurrent_destroy(m);
+}
+
+static void test_set_max_load(void)
+{
+    hashmap_concurrent* m = u64_map(4);
+    for (u64 i = 0; i < 2000; i++) {
+        hashmap_concurrent_put(m, (u8*)&i, (u8*)&i);
+    }
+
+    // lowering it rebuilds every shard that is now past the limit
+    hashmap_concurrent_set_max_load(m, 0.3);
+    for (u32 s = 0; s < 4; s++) {
+        hashmap* shard = atomic_load(&m->shards[s].map);
+        WC_ASSERT_EQ_INT(shard->max_load, 30);
+        WC_ASSERT_TRUE(shard->size * 10 < shard->capacity * 3);
+    }
+
+    // and rebuilds by growth carry it over
+    hashmap_concurrent_set_max_load(m, 0.9);
+    for (u64 i = 2000; i < 20000; i++) {
+        hashmap_concurrent_put(m, (u8*)&i, (u8*)&i);
+    }
+    for (u32 s = 0; s < 4; s++) {
+        WC_ASSERT_EQ_INT(atomic_load(&m->shards[s].map)->max_load, 90);
+    }
+    for (u64 i = 0; i < 20000; i++) {
+        u64 out = 0;
+        WC_ASSERT_TRUE(hashmap_concurrent_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_U64(out, i);
+    }
+    hashmap_concurrent_destroy(m);
+}
+
+static void test_single_shard(void)
+{
+    hashmap_concurrent* m = u64_map(1);
+    for (u64 i = 0; i < 300; i++) {
+        hashmap_concurrent_put(m, (u8*)&i, (u8*)&i);
+    }
+    for (u64 i = 0; i < 300; i++) {
+        WC_ASSERT_TRUE(hashmap_concurrent_has(m, (u8*)&i));
+    }
+    hashmap_concurrent_destroy(m);
+}
+
+static void test_owned_strings(void)
+{
+    hashmap_concurrent* m = str_str_map();
+    WC_ASSERT_FALSE(m->optimistic);
+
+    String* k = string_from_cstr("name");
+    String* v = string_from_cstr("a value long enough to live on the heap");
+    hashmap_concurrent_put_move(m, (u8**)&k, (u8**)&v);
+    WC_ASSERT_NULL(k);
+    WC_ASSERT_NULL(v);
+
+    String key;
+    string_create_stk(&key, "name");
+    String* v2 = string_from_cstr("replaced");
+    WC_ASSERT_TRUE(hashmap_concurrent_put_val_move(m, (u8*)&key, (u8**)&v2));
+
+    String out = {0};
+    WC_ASSERT_TRUE(hashmap_concurrent_get(m, (u8*)&key, (u8*)&out));
+    WC_ASSERT_TRUE(string_equals_cstr(&out, "replaced"));
+    string_destroy_stk(&out);
+
+    String sv;
+    string_create_stk(&sv, "copied");
+    String other;
+    string_create_stk(&other, "other");
+    hashmap_concurrent_put(m, (u8*)&other, (u8*)&sv);
+    string_destroy_stk(&sv);
+    string_destroy_stk(&other);
+
+    WC_ASSERT_EQ_U64(hashmap_concurrent_size(m), 2);
+    string_destroy_stk(&key);
+    hashmap_concurrent_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * multi thread
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+#define CM_THREADS 4
+#define CM_PER     20000
+
+typedef struct {
+    hashmap_concurrent* map;
+    u64                 id;
+    u64                 bad; // inconsistent reads seen
+} cm_ctx;
+
+static void* writer_disjoint(void* arg)
+{
+    cm_ctx* c = arg;
+    for (u64 i = 0; i < CM_PER; i++) {
+        u64 k = (c->id * CM_PER) + i;
+        u64 v = k * 2;
+        hashmap_concurrent_put(c->map, (u8*)&k, (u8*)&v);
+    }
+    return NULL;
+}
+
+static void test_parallel_disjoint_writers(void)
+{
+    hashmap_concurrent* m = u64_map(0);
+    pthread_t           th[CM_THREADS];
+    cm_ctx              ctx[CM_THREADS];
+
+    for (u64 t = 0; t < CM_THREADS; t++) {
+        ctx[t] = (cm_ctx){m, t, 0};
+        pthread_create(&th[t], NULL, writer_disjoint, &ctx[t]);
+    }
+    for (u64 t = 0; t < CM_THREADS; t++) {
+        pthread_join(th[t], NULL);
+    }
+
+    WC_ASSERT_EQ_U64(hashmap_concurrent_size(m), (u64)CM_THREADS * CM_PER);
+    for (u64 k = 0; k < (u64)CM_THREADS * CM_PER; k++) {
+        u64 v = 0;
+        WC_ASSERT_TRUE(hashmap_concurrent_get(m, (u8*)&k, (u8*)&v));
+        WC_ASSERT_EQ_U64(v, k * 2);
+    }
+    hashmap_concurrent_destroy(m);
+}
+
+// values are always key * 2 — a reader must never see anything else,
+// even while shards grow and entries shift under it
+static void* reader_checking(void* arg)
+{
+    cm_ctx* c = arg;
+    for (u64 round = 0; round < 4; round++) {
+        for (u64 k = 0; k < CM_PER; k++) {
+            u64 v;
+            if (hashmap_concurrent_get(c->map, (u8*)&k, (u8*)&v) && v != k * 2) {
+                c->bad++;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void* writer_churn(void* arg)
+{
+    cm_ctx* c = arg;
+    for (u64 k = 0; k < CM_PER; k++) {
+        u64 v = k * 2;
+        hashmap_concurrent_put(c->map, (u8*)&k, (u8*)&v);
+        if (k % 3 == 0) {
+            u64 d = k / 2;
+            hashmap_concurrent_del(c->map, (u8*)&d, NULL);
+        }
+    }
+    return NULL;
+}
+
+static void test_readers_see_consistent_values(void)
+{
+    // few shards so readers and the writer collide often
+    hashmap_concurrent* m = u64_map(2);
+    pthread_t           th[CM_THREADS];
+    cm_ctx              ctx[CM_THREADS];
+
+    for (u64 t = 0; t < CM_THREADS; t++) {
+        ctx[t] = (cm_ctx){m, t, 0};
+        pthread_create(&th[t], NULL, t == 0 ? writer_churn : reader_checking, &ctx[t]);
+    }
+    for (u64 t = 0; t < CM_THREADS; t++) {
+        pthread_join(th[t], NULL);
+        WC_ASSERT_EQ_U64(ctx[t].bad, 0);
+    }
+    hashmap_concurrent_destroy(m);
+}
+
+
+void hashmap_concurrent_suite(void)
+{
+    WC_SUITE("HashMap concurrent — single thread");
+    WC_RUN(test_put_get_del);
+    WC_RUN(test_single_shard);
+    WC_RUN(test_psl_overflow_rebuilds_shard);
+    WC_RUN(test_set_max_load);
+    WC_RUN(test_owned_strings);
+
+    WC_SUITE("HashMap concurrent — threads");
+    WC_RUN(test_parallel_disjoint_writers);
+    WC_RUN(test_readers_see_consistent_values);
+}
@@ -0,0 +1,372 @@
+#include "wc_test.h"
+#include "hashmap_flat.h"
+#include "wc_helpers.h"
+
+
+/* ── Map constructors ────────────────────────────────────────────────────── */
+
+static hashmap_flat* int_map(void)
+{
+    return hashmap_flat_create(sizeof(int), sizeof(int), NULL, NULL, NULL, NULL);
+}
+
+static hashmap_flat* int_str_map(void)
+{
+    return hashmap_flat_create(sizeof(int), sizeof(String), NULL, NULL, NULL, &wc_str_ops);
+}
+
+static hashmap_flat* str_str_map(void)
+{
+    return hashmap_flat_create(sizeof(String), sizeof(String), wyhash_str, str_cmp,
+                               &wc_str_ops, &wc_str_ops);
+}
+
+// every key lands in the same h1 and h2 — worst case for group probing
+static u64 const_hash(const u8* key, u64 size)
+{
+    (void)key;
+    (void)size;
+    return 0x2A;
+}
+
+// h1 = 14: in a 16-slot table the probe starts two slots before the end
+static u64 tail_hash(const u8* key, u64 size)
+{
+    (void)key;
+    (void)size;
+    return (14u << 7) | 0x2A;
+}
+
+// 4 distinct h2 values, same start group
+static u64 clump_hash(const u8* key, u64 size)
+{
+    (void)size;
+    return (u64)(*(const int*)key & 3);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * int -> int  (POD)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_put_and_get(void)
+{
+    hashmap_flat* m = int_map();
+    int k = 1, v = 100;
+    WC_ASSERT_FALSE(hashmap_flat_put(m, (u8*)&k, (u8*)&v));
+
+    int out = 0;
+    WC_ASSERT_TRUE(hashmap_flat_get(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_EQ_INT(out, 100);
+    WC_ASSERT_EQ_U64(hashmap_flat_size(m), 1);
+    hashmap_flat_destroy(m);
+}
+
+static void test_put_update(void)
+{
+    hashmap_flat* m = int_map();
+    int k = 1, v1 = 10, v2 = 20;
+    hashmap_flat_put(m, (u8*)&k, (u8*)&v1);
+    WC_ASSERT_TRUE(hashmap_flat_put(m, (u8*)&k, (u8*)&v2));
+
+    int out = 0;
+    hashmap_flat_get(m, (u8*)&k, (u8*)&out);
+    WC_ASSERT_EQ_INT(out, 20);
+    WC_ASSERT_EQ_U64(hashmap_flat_size(m), 1);
+    hashmap_flat_destroy(m);
+}
+
+static void test_missing(void)
+{
+    hashmap_flat* m = int_map();
+    int k = 7, out = -1;
+    WC_ASSERT_FALSE(hashmap_flat_has(m, (u8*)&k));
+    WC_ASSERT_FALSE(hashmap_flat_get(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_NULL(hashmap_flat_get_ptr(m, (u8*)&k));
+    WC_ASSERT_FALSE(hashmap_flat_del(m, (u8*)&k, NULL));
+    WC_ASSERT_EQ_INT(out, -1);
+    hashmap_flat_destroy(m);
+}
+
+static void test_del_copies_out(void)
+{
+    hashmap_flat* m = int_map();
+    int k = 3, v = 33, out = 0;
+    hashmap_flat_put(m, (u8*)&k, (u8*)&v);
+    WC_ASSERT_TRUE(hashmap_flat_del(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_EQ_INT(out, 33);
+    WC_ASSERT_FALSE(hashmap_flat_has(m, (u8*)&k));
+    WC_ASSERT_TRUE(hashmap_flat_empty(m));
+    hashmap_flat_destroy(m);
+}
+
+static void test_resize_preserves_data(void)
+{
+    hashmap_flat* m = int_map();
+    for (int i = 0; i < 10000; i++) {
+        int v = i * 3;
+        hashmap_flat_put(m, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_flat_size(m), 10000);
+    // 7/8 max load
+    WC_ASSERT(hashmap_flat_capacity(m) * 7 >= 10000 * 8);
+
+    for (int i = 0; i < 10000; i++) {
+        int* v = (int*)hashmap_flat_get_ptr(m, (u8*)&i);
+        WC_ASSERT(v && *v == i * 3);
+    }
+    int k = 10000;
+    WC_ASSERT_FALSE(hashmap_flat_has(m, (u8*)&k));
+    hashmap_flat_destroy(m);
+}
+
+static void test_del_half_then_lookup(void)
+{
+    hashmap_flat* m = int_map();
+    for (int i = 0; i < 2000; i++) {
+        hashmap_flat_put(m, (u8*)&i, (u8*)&i);
+    }
+    for (int i = 0; i < 2000; i += 2) {
+        WC_ASSERT_TRUE(hashmap_flat_del(m, (u8*)&i, NULL));
+    }
+    WC_ASSERT_EQ_U64(hashmap_flat_size(m), 1000);
+    for (int i = 0; i < 2000; i++) {
+        int want = i % 2;
+        WC_ASSERT_EQ_INT(hashmap_flat_has(m, (u8*)&i), want);
+    }
+    hashmap_flat_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * probing / tombstones
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_same_hash_spans_groups(void)
+{
+    // 100 keys with one hash: probes must cross many groups and wrap
+    hashmap_flat* m = hashmap_flat_create(sizeof(int), sizeof(int), const_hash, NULL, NULL, NULL);
+    for (int i = 0; i < 100; i++) {
+        hashmap_flat_put(m, (u8*)&i, (u8*)&i);
+    }
+    for (int i = 0; i < 100; i++) {
+        int out = -1;
+        WC_ASSERT_TRUE(hashmap_flat_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i);
+    }
+    // delete from the middle of the chain, later keys stay reachable
+    for (int i = 10; i < 60; i++) {
+        WC_ASSERT_TRUE(hashmap_flat_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 100; i++) {
+        WC_ASSERT_EQ_INT(hashmap_flat_has(m, (u8*)&i), i < 10 || i >= 60);
+    }
+    hashmap_flat_destroy(m);
+}
+
+static void test_delete_reinsert_cycle(void)
+{
+    // churn at a fixed size: tombstones must be recycled or purged,
+    // capacity must not keep growing
+    hashmap_flat* m = hashmap_flat_create(sizeof(int), sizeof(int), clump_hash, NULL, NULL, NULL);
+    for (int i = 0; i < 12; i++) {
+        hashmap_flat_put(m, (u8*)&i, (u8*)&i);
+    }
+    u64 cap = hashmap_flat_capacity(m);
+
+    for (int round = 0; round < 500; round++) {
+        int old = round, new = round + 12;
+        WC_ASSERT_TRUE(hashmap_flat_del(m, (u8*)&old, NULL));
+        WC_ASSERT_FALSE(hashmap_flat_put(m, (u8*)&new, (u8*)&new));
+    }
+    WC_ASSERT_EQ_U64(hashmap_flat_size(m), 12);
+    WC_ASSERT_EQ_U64(hashmap_flat_capacity(m), cap);
+
+    for (int i = 500; i < 512; i++) {
+        int out = -1;
+        WC_ASSERT_TRUE(hashmap_flat_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i);
+    }
+    int gone = 499;
+    WC_ASSERT_FALSE(hashmap_flat_has(m, (u8*)&gone));
+    hashmap_flat_destroy(m);
+}
+
+static void test_wraparound_slots(void)
+{
+    // hashes that start in the last group read the mirrored ctrl bytes
+    hashmap_flat* m = hashmap_flat_create(sizeof(int), sizeof(int), tail_hash, NULL, NULL, NULL);
+    for (int i = 0; i < 14; i++) {
+        hashmap_flat_put(m, (u8*)&i, (u8*)&i);
+    }
+    WC_ASSERT_EQ_U64(hashmap_flat_capacity(m), 16);
+    for (int i = 0; i < 14; i += 3) {
+        WC_ASSERT_TRUE(hashmap_flat_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 14; i++) {
+        int want = i % 3 != 0;
+        WC_ASSERT_EQ_INT(hashmap_flat_has(m, (u8*)&i), want);
+    }
+    hashmap_flat_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * owned keys / values
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_str_str_put_get(void)
+{
+    hashmap_flat* m = str_str_map();
+    for (int i = 0; i < 300; i++) {
+        char kb[32], vb[32];
+        snprintf(kb, sizeof(kb), "key_%d", i);
+        snprintf(vb, sizeof(vb), "val_%d", i);
+        String k, v;
+        string_create_stk(&k, kb);
+        string_create_stk(&v, vb);
+        hashmap_flat_put(m, (u8*)&k, (u8*)&v);
+        string_destroy_stk(&k);
+        string_destroy_stk(&v);
+    }
+
+    for (int i = 0; i < 300; i++) {
+        char kb[32], vb[32];
+        snprintf(kb, sizeof(kb), "key_%d", i);
+        snprintf(vb, sizeof(vb), "val_%d", i);
+        String k;
+        string_create_stk(&k, kb);
+        String* v = (String*)hashmap_flat_get_ptr(m, (u8*)&k);
+        WC_ASSERT(v && string_equals_cstr(v, vb));
+        if (i % 2) {
+            WC_ASSERT_TRUE(hashmap_flat_del(m, (u8*)&k, NULL));
+        }
+        string_destroy_stk(&k);
+    }
+    WC_ASSERT_EQ_U64(hashmap_flat_size(m), 150);
+    hashmap_flat_destroy(m);
+}
+
+static void test_str_put_move(void)
+{
+    hashmap_flat* m = str_str_map();
+    String* k = string_from_cstr("name");
+    String* v = string_from_cstr("Alice");
+    WC_ASSERT_FALSE(hashmap_flat_put_move(m, (u8**)&k, (u8**)&v));
+    WC_ASSERT_NULL(k);
+    WC_ASSERT_NULL(v);
+
+    // duplicate key is consumed, value replaced
+    k = string_from_cstr("name");
+    v = string_from_cstr("Bob");
+    WC_ASSERT_TRUE(hashmap_flat_put_move(m, (u8**)&k, (u8**)&v));
+    WC_ASSERT_NULL(k);
+
+    String key;
+    string_create_stk(&key, "name");
+    String* got = (String*)hashmap_flat_get_ptr(m, (u8*)&key);
+    WC_ASSERT_TRUE(string_equals_cstr(got, "Bob"));
+    string_destroy_stk(&key);
+    hashmap_flat_destroy(m);
+}
+
+static void test_str_val_move_and_update(void)
+{
+    hashmap_flat* m = int_str_map();
+    int     k   = 4;
+    String* src = string_from_cstr("first");
+    hashmap_flat_put_val_move(m, (u8*)&k, (u8**)&src);
+    WC_ASSERT_NULL(src);
+
+    String sv;
+    string_create_stk(&sv, "second");
+    WC_ASSERT_TRUE(hashmap_flat_put(m, (u8*)&k, (u8*)&sv));
+    string_destroy_stk(&sv);
+
+    String out;
+    WC_ASSERT_TRUE(hashmap_flat_del(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_TRUE(string_equals_cstr(&out, "second"));
+    string_destroy_stk(&out);
+    hashmap_flat_destroy(m);
+}
+
+static void test_str_key_move(void)
+{
+    hashmap_flat* m = str_str_map();
+    String* k = string_from_cstr("city");
+    String  v;
+    string_create_stk(&v, "Paris");
+    hashmap_flat_put_key_move(m, (u8**)&k, (u8*)&v);
+    WC_ASSERT_NULL(k);
+    string_destroy_stk(&v);
+
+    String key;
+    string_create_stk(&key, "city");
+    WC_ASSERT_TRUE(hashmap_flat_has(m, (u8*)&key));
+    string_destroy_stk(&key);
+    hashmap_flat_destroy(m);
+}
+
+static void test_clear_then_reuse(void)
+{
+    hashmap_flat* m = int_str_map();
+    for (int i = 0; i < 40; i++) {
+        String* v = string_from_cstr("owned");
+        hashmap_flat_put_val_move(m, (u8*)&i, (u8**)&v);
+    }
+    u64 cap = hashmap_flat_capacity(m);
+    hashmap_flat_clear(m);
+    WC_ASSERT_TRUE(hashmap_flat_empty(m));
+    WC_ASSERT_EQ_U64(hashmap_flat_capacity(m), cap);
+
+    int     k = 5;
+    String* v = string_from_cstr("after_clear");
+    hashmap_flat_put_val_move(m, (u8*)&k, (u8**)&v);
+    WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_flat_get_ptr(m, (u8*)&k), "after_clear"));
+    hashmap_flat_destroy(m);
+}
+
+static void test_copy_is_deep(void)
+{
+    hashmap_flat* src = int_str_map();
+    for (int i = 0; i < 30; i++) {
+        String* v = string_from_cstr("src");
+        hashmap_flat_put_val_move(src, (u8*)&i, (u8**)&v);
+    }
+
+    hashmap_flat* dest = int_map();
+    hashmap_flat_copy(dest, src);
+    WC_ASSERT_EQ_U64(hashmap_flat_size(dest), 30);
+
+    int k = 7;
+    string_append_cstr((String*)hashmap_flat_get_ptr(src, (u8*)&k), "_changed");
+    hashmap_flat_destroy(src);
+
+    WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_flat_get_ptr(dest, (u8*)&k), "src"));
+    hashmap_flat_destroy(dest);
+}
+
+
+void hashmap_flat_suite(void)
+{
+    WC_SUITE("HashMap flat — int->int (POD)");
+    WC_RUN(test_put_and_get);
+    WC_RUN(test_put_update);
+    WC_RUN(test_missing);
+    WC_RUN(test_del_copies_out);
+    WC_RUN(test_resize_preserves_data);
+    WC_RUN(test_del_half_then_lookup);
+
+    WC_SUITE("HashMap flat — probing and tombstones");
+    WC_RUN(test_same_hash_spans_groups);
+    WC_RUN(test_delete_reinsert_cycle);
+    WC_RUN(test_wraparound_slots);
+
+    WC_SUITE("HashMap flat — owned keys/values");
+    WC_RUN(test_str_str_put_get);
+    WC_RUN(test_str_put_move);
+    WC_RUN(test_str_val_move_and_update);
+    WC_RUN(test_str_key_move);
+    WC_RUN(test_clear_then_reuse);
+    WC_RUN(test_copy_is_deep);
+}
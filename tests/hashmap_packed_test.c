@@ -0,0 +1,447 @@
+#include "wc_test.h"
+#include "hashmap_packed.h"
+#include "hashmap.h"
+#include "wc_helpers.h"
+
+#include <stdint.h>
+
+
+/* ── Map constructors ────────────────────────────────────────────────────── */
+
+static hashmap_packed* int_map(void)
+{
+    return hashmap_packed_create(sizeof(int), sizeof(int), NULL, NULL, NULL, NULL);
+}
+
+static hashmap_packed* int_str_map(void)
+{
+    return hashmap_packed_create(sizeof(int), sizeof(String), NULL, NULL, NULL, &wc_str_ops);
+}
+
+static hashmap_packed* str_str_map(void)
+{
+    return hashmap_packed_create(sizeof(String), sizeof(String), wyhash_str, str_cmp,
+                                 &wc_str_ops, &wc_str_ops);
+}
+
+// every key has the same home bucket — one long Robin Hood run
+static u64 const_hash(const u8* key, u64 size)
+{
+    (void)key;
+    (void)size;
+    return 0;
+}
+
+// home bucket 14 in a 16-slot table: runs wrap past the end
+static u64 tail_hash(const u8* key, u64 size)
+{
+    (void)size;
+    return 14 + (u64)(*(const int*)key & 1);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * int -> int  (POD)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_put_and_get(void)
+{
+    hashmap_packed* m = int_map();
+    int k = 1, v = 100;
+    WC_ASSERT_FALSE(hashmap_packed_put(m, (u8*)&k, (u8*)&v));
+
+    int out = 0;
+    WC_ASSERT_TRUE(hashmap_packed_get(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_EQ_INT(out, 100);
+    WC_ASSERT_EQ_U64(hashmap_packed_size(m), 1);
+    hashmap_packed_destroy(m);
+}
+
+static void test_put_update(void)
+{
+    hashmap_packed* m = int_map();
+    int k = 1, v1 = 10, v2 = 20;
+    hashmap_packed_put(m, (u8*)&k, (u8*)&v1);
+    WC_ASSERT_TRUE(hashmap_packed_put(m, (u8*)&k, (u8*)&v2));
+
+    int out = 0;
+    hashmap_packed_get(m, (u8*)&k, (u8*)&out);
+    WC_ASSERT_EQ_INT(out, 20);
+    WC_ASSERT_EQ_U64(hashmap_packed_size(m), 1);
+    hashmap_packed_destroy(m);
+}
+
+static void test_missing(void)
+{
+    hashmap_packed* m = int_map();
+    int k = 7, out = -1;
+    WC_ASSERT_FALSE(hashmap_packed_has(m, (u8*)&k));
+    WC_ASSERT_FALSE(hashmap_packed_get(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_NULL(hashmap_packed_get_ptr(m, (u8*)&k));
+    WC_ASSERT_FALSE(hashmap_packed_del(m, (u8*)&k, NULL));
+    WC_ASSERT_EQ_INT(out, -1);
+    hashmap_packed_destroy(m);
+}
+
+static void test_del_copies_out(void)
+{
+    hashmap_packed* m = int_map();
+    int k = 3, v = 33, out = 0;
+    hashmap_packed_put(m, (u8*)&k, (u8*)&v);
+    WC_ASSERT_TRUE(hashmap_packed_del(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_EQ_INT(out, 33);
+    WC_ASSERT_FALSE(hashmap_packed_has(m, (u8*)&k));
+    WC_ASSERT_TRUE(hashmap_packed_empty(m));
+    hashmap_packed_destroy(m);
+}
+
+static void test_resize_preserves_data(void)
+{
+    hashmap_packed* m = int_map();
+    for (int i = 0; i < 10000; i++) {
+        int v = i * 3;
+        hashmap_packed_put(m, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_packed_size(m), 10000);
+
+    for (int i = 0; i < 10000; i++) {
+        int* v = (int*)hashmap_packed_get_ptr(m, (u8*)&i);
+        WC_ASSERT(v && *v == i * 3);
+    }
+    int k = 10000;
+    WC_ASSERT_FALSE(hashmap_packed_has(m, (u8*)&k));
+    hashmap_packed_destroy(m);
+}
+
+static void test_del_half_then_lookup(void)
+{
+    hashmap_packed* m = int_map();
+    for (int i = 0; i < 2000; i++) {
+        hashmap_packed_put(m, (u8*)&i, (u8*)&i);
+    }
+    for (int i = 0; i < 2000; i += 2) {
+        WC_ASSERT_TRUE(hashmap_packed_del(m, (u8*)&i, NULL));
+    }
+    WC_ASSERT_EQ_U64(hashmap_packed_size(m), 1000);
+    for (int i = 0; i < 2000; i++) {
+        int want = i % 2;
+        WC_ASSERT_EQ_INT(hashmap_packed_has(m, (u8*)&i), want);
+    }
+    hashmap_packed_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * bucket layout
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_layout_aligns_fields(void)
+{
+    hashmap_packed* m = hashmap_packed_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    WC_ASSERT_EQ_U64(m->key_off, 8);
+    WC_ASSERT_EQ_U64(m->val_off, 16);
+    WC_ASSERT_EQ_U64(m->stride, 24);
+    hashmap_packed_destroy(m);
+
+    m = int_map();
+    WC_ASSERT_EQ_U64(m->key_off, 4);
+    WC_ASSERT_EQ_U64(m->val_off, 8);
+    WC_ASSERT_EQ_U64(m->stride, 12);
+    hashmap_packed_destroy(m);
+
+    // odd key size: byte-aligned key, val still 4-aligned, stride keeps it
+    m = hashmap_packed_create(3, sizeof(u32), NULL, NULL, NULL, NULL);
+    WC_ASSERT_EQ_U64(m->key_off, 1);
+    WC_ASSERT_EQ_U64(m->val_off, 4);
+    WC_ASSERT_EQ_U64(m->stride, 8);
+    hashmap_packed_destroy(m);
+}
+
+static void test_odd_sizes_get_ptr_aligned(void)
+{
+    // 3-byte keys, 12-byte vals: every val pointer must stay 4-aligned
+    typedef struct {
+        u32 a, b, c;
+    } val12;
+
+    hashmap_packed* m = hashmap_packed_create(3, sizeof(val12), NULL, NULL, NULL, NULL);
+    for (u32 i = 0; i < 500; i++) {
+        u8    k[3] = {(u8)i, (u8)(i >> 8), 0x5A};
+        val12 v    = {i, i * 2, i * 3};
+        hashmap_packed_put(m, k, (u8*)&v);
+    }
+    for (u32 i = 0; i < 500; i++) {
+        u8     k[3] = {(u8)i, (u8)(i >> 8), 0x5A};
+        val12* v    = (val12*)hashmap_packed_get_ptr(m, k);
+        WC_ASSERT(v != NULL);
+        uintptr_t misalign = (uintptr_t)v % 4;
+        WC_ASSERT_EQ_U64(misalign, 0);
+        WC_ASSERT(v->a == i && v->b == i * 2 && v->c == i * 3);
+    }
+    hashmap_packed_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * Robin Hood runs
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_same_hash_long_run(void)
+{
+    // 100 keys with one home: every insert shifts the run, deletes pull it back
+    hashmap_packed* m = hashmap_packed_create(sizeof(int), sizeof(int), const_hash, NULL, NULL, NULL);
+    for (int i = 0; i < 100; i++) {
+        hashmap_packed_put(m, (u8*)&i, (u8*)&i);
+    }
+    for (int i = 0; i < 100; i++) {
+        int out = -1;
+        WC_ASSERT_TRUE(hashmap_packed_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i);
+    }
+    for (int i = 10; i < 60; i++) {
+        WC_ASSERT_TRUE(hashmap_packed_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 100; i++) {
+        WC_ASSERT_EQ_INT(hashmap_packed_has(m, (u8*)&i), i < 10 || i >= 60);
+    }
+    hashmap_packed_destroy(m);
+}
+
+static void test_same_hash_past_psl_max(void)
+{
+    // 300 keys with one home: psls saturate at 255 instead of wrapping to empty
+    hashmap_packed* m = hashmap_packed_create(sizeof(int), sizeof(int), const_hash, NULL, NULL, NULL);
+    for (int i = 0; i < 300; i++) {
+        int v = i * 2;
+        hashmap_packed_put(m, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_packed_size(m), 300);
+    for (int i = 0; i < 300; i++) {
+        int out = -1;
+        WC_ASSERT_TRUE(hashmap_packed_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i * 2);
+    }
+    int missing = 1000;
+    WC_ASSERT_FALSE(hashmap_packed_has(m, (u8*)&missing));
+
+    // deletes near the front pull saturated entries back past the limit
+    for (int i = 0; i < 100; i += 2) {
+        WC_ASSERT_TRUE(hashmap_packed_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 300; i++) {
+        b8 kept = i >= 100 || (i & 1);
+        WC_ASSERT_EQ_INT(hashmap_packed_has(m, (u8*)&i), kept);
+    }
+    for (int i = 0; i < 100; i += 2) {
+        hashmap_packed_put(m, (u8*)&i, (u8*)&i);
+    }
+    for (int i = 0; i < 300; i++) {
+        WC_ASSERT_TRUE(hashmap_packed_has(m, (u8*)&i));
+    }
+    hashmap_packed_destroy(m);
+}
+
+static void test_wraparound_slots(void)
+{
+    // two homes at the very end of the table; shifts and deletes wrap to 0
+    hashmap_packed* m = hashmap_packed_create(sizeof(int), sizeof(int), tail_hash, NULL, NULL, NULL);
+    for (int i = 0; i < 11; i++) {
+        int v = i * 7;
+        hashmap_packed_put(m, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_packed_capacity(m), 16);
+    for (int i = 0; i < 11; i += 3) {
+        WC_ASSERT_TRUE(hashmap_packed_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 11; i++) {
+        int* v = (int*)hashmap_packed_get_ptr(m, (u8*)&i);
+        if (i % 3 == 0) {
+            WC_ASSERT_NULL(v);
+        } else {
+            WC_ASSERT(v && *v == i * 7);
+        }
+    }
+    hashmap_packed_destroy(m);
+}
+
+static void test_matches_hashmap(void)
+{
+    // same op stream into both layouts, same answers
+    hashmap_packed* p = int_map();
+    hashmap*        h = hashmap_create(sizeof(int), sizeof(int), NULL, NULL, NULL, NULL);
+
+    u64 s = 12345;
+    for (int op = 0; op < 20000; op++) {
+        s     = (s * 6364136223846793005ULL) + 1442695040888963407ULL;
+        int k = (int)((s >> 33) % 3000);
+        int v = op;
+        if ((s >> 20) % 3 == 0) {
+            WC_ASSERT_EQ_INT(hashmap_packed_del(p, (u8*)&k, NULL), hashmap_del(h, (u8*)&k, NULL));
+        } else {
+            WC_ASSERT_EQ_INT(hashmap_packed_put(p, (u8*)&k, (u8*)&v),
+                             hashmap_put(h, (u8*)&k, (u8*)&v));
+        }
+    }
+    WC_ASSERT_EQ_U64(hashmap_packed_size(p), hashmap_size(h));
+    for (int k = 0; k < 3000; k++) {
+        int* pv = (int*)hashmap_packed_get_ptr(p, (u8*)&k);
+        int* hv = (int*)hashmap_get_ptr(h, (u8*)&k);
+        WC_ASSERT((pv == NULL) == (hv == NULL));
+        WC_ASSERT(!pv || *pv == *hv);
+    }
+    hashmap_packed_destroy(p);
+    hashmap_destroy(h);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * owned keys / values
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_str_str_put_get(void)
+{
+    hashmap_packed* m = str_str_map();
+    for (int i = 0; i < 300; i++) {
+        char kb[32], vb[64];
+        snprintf(kb, sizeof(kb), "key_%d", i);
+        snprintf(vb, sizeof(vb), "a value long enough for the heap %d", i);
+        String k, v;
+        string_create_stk(&k, kb);
+        string_create_stk(&v, vb);
+        hashmap_packed_put(m, (u8*)&k, (u8*)&v);
+        string_destroy_stk(&k);
+        string_destroy_stk(&v);
+    }
+
+    for (int i = 0; i < 300; i++) {
+        char kb[32], vb[64];
+        snprintf(kb, sizeof(kb), "key_%d", i);
+        snprintf(vb, sizeof(vb), "a value long enough for the heap %d", i);
+        String k;
+        string_create_stk(&k, kb);
+        String* v = (String*)hashmap_packed_get_ptr(m, (u8*)&k);
+        WC_ASSERT(v && string_equals_cstr(v, vb));
+        if (i % 2) {
+            WC_ASSERT_TRUE(hashmap_packed_del(m, (u8*)&k, NULL));
+        }
+        string_destroy_stk(&k);
+    }
+    WC_ASSERT_EQ_U64(hashmap_packed_size(m), 150);
+    hashmap_packed_destroy(m);
+}
+
+static void test_str_put_move(void)
+{
+    hashmap_packed* m = str_str_map();
+    String* k = string_from_cstr("name");
+    String* v = string_from_cstr("Alice");
+    WC_ASSERT_FALSE(hashmap_packed_put_move(m, (u8**)&k, (u8**)&v));
+    WC_ASSERT_NULL(k);
+    WC_ASSERT_NULL(v);
+
+    // duplicate key is consumed, value replaced
+    k = string_from_cstr("name");
+    v = string_from_cstr("Bob");
+    WC_ASSERT_TRUE(hashmap_packed_put_move(m, (u8**)&k, (u8**)&v));
+    WC_ASSERT_NULL(k);
+
+    String key;
+    string_create_stk(&key, "name");
+    String* got = (String*)hashmap_packed_get_ptr(m, (u8*)&key);
+    WC_ASSERT_TRUE(string_equals_cstr(got, "Bob"));
+    string_destroy_stk(&key);
+    hashmap_packed_destroy(m);
+}
+
+static void test_str_val_move_and_key_move(void)
+{
+    hashmap_packed* m = str_str_map();
+
+    String  k;
+    String* v = string_from_cstr("first");
+    string_create_stk(&k, "city");
+    hashmap_packed_put_val_move(m, (u8*)&k, (u8**)&v);
+    WC_ASSERT_NULL(v);
+
+    String* k2 = string_from_cstr("city");
+    String  v2;
+    string_create_stk(&v2, "Paris");
+    WC_ASSERT_TRUE(hashmap_packed_put_key_move(m, (u8**)&k2, (u8*)&v2));
+    WC_ASSERT_NULL(k2);
+    string_destroy_stk(&v2);
+
+    String out;
+    WC_ASSERT_TRUE(hashmap_packed_del(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_TRUE(string_equals_cstr(&out, "Paris"));
+    string_destroy_stk(&out);
+    string_destroy_stk(&k);
+    hashmap_packed_destroy(m);
+}
+
+static void test_clear_then_reuse(void)
+{
+    hashmap_packed* m = int_str_map();
+    for (int i = 0; i < 40; i++) {
+        String* v = string_from_cstr("owned");
+        hashmap_packed_put_val_move(m, (u8*)&i, (u8**)&v);
+    }
+    u64 cap = hashmap_packed_capacity(m);
+    hashmap_packed_clear(m);
+    WC_ASSERT_TRUE(hashmap_packed_empty(m));
+    WC_ASSERT_EQ_U64(hashmap_packed_capacity(m), cap);
+
+    int     k = 5;
+    String* v = string_from_cstr("after_clear");
+    hashmap_packed_put_val_move(m, (u8*)&k, (u8**)&v);
+    WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_packed_get_ptr(m, (u8*)&k), "after_clear"));
+    hashmap_packed_destroy(m);
+}
+
+static void test_copy_is_deep(void)
+{
+    hashmap_packed* src = int_str_map();
+    for (int i = 0; i < 30; i++) {
+        String* v = string_from_cstr("src");
+        hashmap_packed_put_val_move(src, (u8*)&i, (u8**)&v);
+    }
+
+    hashmap_packed* dest = int_map();
+    hashmap_packed_copy(dest, src);
+    WC_ASSERT_EQ_U64(hashmap_packed_size(dest), 30);
+
+    int k = 7;
+    string_append_cstr((String*)hashmap_packed_get_ptr(src, (u8*)&k), "_changed");
+    hashmap_packed_destroy(src);
+
+    WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_packed_get_ptr(dest, (u8*)&k), "src"));
+    hashmap_packed_destroy(dest);
+}
+
+
+void hashmap_packed_suite(void)
+{
+    WC_SUITE("HashMap packed — int->int (POD)");
+    WC_RUN(test_put_and_get);
+    WC_RUN(test_put_update);
+    WC_RUN(test_missing);
+    WC_RUN(test_del_copies_out);
+    WC_RUN(test_resize_preserves_data);
+    WC_RUN(test_del_half_then_lookup);
+
+    WC_SUITE("HashMap packed — bucket layout");
+    WC_RUN(test_layout_aligns_fields);
+    WC_RUN(test_odd_sizes_get_ptr_aligned);
+
+    WC_SUITE("HashMap packed — Robin Hood runs");
+    WC_RUN(test_same_hash_long_run);
+    WC_RUN(test_same_hash_past_psl_max);
+    WC_RUN(test_wraparound_slots);
+    WC_RUN(test_matches_hashmap);
+
+    WC_SUITE("HashMap packed — owned keys/values");
+    WC_RUN(test_str_str_put_get);
+    WC_RUN(test_str_put_move);
+    WC_RUN(test_str_val_move_and_key_move);
+    WC_RUN(test_clear_then_reuse);
+    WC_RUN(test_copy_is_deep);
+}
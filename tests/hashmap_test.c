@@ -2,6 +2,11 @@
 #include "hashmap.h"
 #include "wc_helpers.h"
 #include "wc_macros.h"
+#include "wc_errno.h"
+#include "hashset.h"
+#include "map_snapshot.h"
+
+#include <unistd.h>
 
 
 /* ── Map constructors ────────────────────────────────────────────────────── */
@@ -24,277 +29,2289 @@ static hashmap* str_str_map(void)
 
 
 /* ════════════════════════════════════════════════════════════════════════════
- * int -> int  (POD, no copy/move/del)
+ * int -> int  (POD, no copy/move/del)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_put_and_get(void)
+{
+    hashmap* m = int_map();
+    int k = 1, v = 100;
+    hashmap_put(m, (u8*)&k, (u8*)&v);
+
+    int out = 0;
+    WC_ASSERT_TRUE(hashmap_get(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_EQ_INT(out, 100);
+    hashmap_destroy(m);
+}
+
+static void test_put_update(void)
+{
+    hashmap* m = int_map();
+    int k = 1, v1 = 10, v2 = 20;
+    hashmap_put(m, (u8*)&k, (u8*)&v1);
+    b8 was_update = hashmap_put(m, (u8*)&k, (u8*)&v2);
+    WC_ASSERT_TRUE(was_update);
+
+    int out = 0;
+    hashmap_get(m, (u8*)&k, (u8*)&out);
+    WC_ASSERT_EQ_INT(out, 20);
+    WC_ASSERT_EQ_U64(hashmap_size(m), 1);
+    hashmap_destroy(m);
+}
+
+static void test_has(void)
+{
+    hashmap* m = int_map();
+    int k = 5, v = 0;
+    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&k));
+    hashmap_put(m, (u8*)&k, (u8*)&v);
+    WC_ASSERT_TRUE(hashmap_has(m, (u8*)&k));
+    hashmap_destroy(m);
+}
+
+static void test_del(void)
+{
+    hashmap* m = int_map();
+    int k = 3, v = 42;
+    hashmap_put(m, (u8*)&k, (u8*)&v);
+    WC_ASSERT_TRUE(hashmap_del(m, (u8*)&k, NULL));
+    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&k));
+    WC_ASSERT_EQ_U64(hashmap_size(m), 0);
+    hashmap_destroy(m);
+}
+
+static void test_del_copies_out(void)
+{
+    hashmap* m = int_map();
+    int k = 7, v = 99, out = 0;
+    hashmap_put(m, (u8*)&k, (u8*)&v);
+    hashmap_del(m, (u8*)&k, (u8*)&out);
+    WC_ASSERT_EQ_INT(out, 99);
+    hashmap_destroy(m);
+}
+
+static void test_del_missing_returns_false(void)
+{
+    hashmap* m = int_map();
+    int k = 404;
+    WC_ASSERT_FALSE(hashmap_del(m, (u8*)&k, NULL));
+    hashmap_destroy(m);
+}
+
+static void test_del_on_empty_map(void)
+{
+    hashmap* m = int_map();
+    int k = 1;
+    WC_ASSERT_FALSE(hashmap_del(m, (u8*)&k, NULL));
+    WC_ASSERT_EQ_U64(hashmap_size(m), 0);
+    hashmap_destroy(m);
+}
+
+static void test_get_ptr(void)
+{
+    hashmap* m = int_map();
+    int k = 2, v = 55;
+    hashmap_put(m, (u8*)&k, (u8*)&v);
+    int* ptr = (int*)hashmap_get_ptr(m, (u8*)&k);
+    WC_ASSERT_NOT_NULL(ptr);
+    WC_ASSERT_EQ_INT(*ptr, 55);
+
+    // Mutate through ptr — must be visible via get
+    *ptr = 66;
+    int out = 0;
+    hashmap_get(m, (u8*)&k, (u8*)&out);
+    WC_ASSERT_EQ_INT(out, 66);
+    hashmap_destroy(m);
+}
+
+static void test_get_ptr_missing_returns_null(void)
+{
+    hashmap* m = int_map();
+    int k = 999;
+    WC_ASSERT_NULL(hashmap_get_ptr(m, (u8*)&k));
+    hashmap_destroy(m);
+}
+
+static void test_get_missing_returns_false(void)
+{
+    hashmap* m = int_map();
+    int k = 999, out = 0;
+    WC_ASSERT_FALSE(hashmap_get(m, (u8*)&k, (u8*)&out));
+    hashmap_destroy(m);
+}
+
+static void test_size_tracks_inserts(void)
+{
+    hashmap* m = int_map();
+    WC_ASSERT_EQ_U64(hashmap_size(m), 0);
+    WC_ASSERT_TRUE(hashmap_empty(m));
+
+    for (int i = 0; i < 10; i++) {
+        int v = i * 10;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 10);
+    WC_ASSERT_FALSE(hashmap_empty(m));
+    hashmap_destroy(m);
+}
+
+static void test_resize_preserves_data(void)
+{
+    hashmap* m = int_map();
+    for (int i = 0; i < 50; i++) {
+        int v = i * 2;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 50);
+    for (int i = 0; i < 50; i++) {
+        int out = 0;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i * 2);
+    }
+    hashmap_destroy(m);
+}
+
+// Robin Hood + backward-shift delete doesn't shrink — no LOAD_FACTOR_SHRINK.
+// Verify correctness after heavy deletion instead.
+static void test_del_correctness_after_many_deletes(void)
+{
+    hashmap* m = int_map();
+    for (int i = 0; i < 50; i++) {
+        int v = i;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    for (int i = 0; i < 48; i++) {
+        hashmap_del(m, (u8*)&i, NULL);
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 2);
+
+    for (int i = 48; i < 50; i++) {
+        int out = 0;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i);
+    }
+    hashmap_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * delete correctness  (backward-shift, no tombstones)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_del_reinsert(void)
+{
+    // Delete a key then reinsert it — must succeed and be findable
+    hashmap* m = int_map();
+    int k = 42, v1 = 1, v2 = 2;
+    hashmap_put(m, (u8*)&k, (u8*)&v1);
+    hashmap_del(m, (u8*)&k, NULL);
+    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&k));
+
+    hashmap_put(m, (u8*)&k, (u8*)&v2);
+    int out = 0;
+    WC_ASSERT_TRUE(hashmap_get(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_EQ_INT(out, 2);
+    WC_ASSERT_EQ_U64(hashmap_size(m), 1);
+    hashmap_destroy(m);
+}
+
+static void test_del_mid_chain(void)
+{
+    // Insert keys that will chain during probing, delete one mid-chain,
+    // then verify all remaining keys are still reachable.
+    // Backward-shift delete keeps the Robin Hood invariant intact.
+    hashmap* m = int_map();
+    for (int i = 0; i < 20; i++) {
+        int v = i * 10;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+
+    int mid = 5;
+    hashmap_del(m, (u8*)&mid, NULL);
+
+    for (int i = 0; i < 20; i++) {
+        if (i == mid) {
+            continue;
+        }
+        int out = 0;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i * 10);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_delete_reinsert_cycle(void)
+{
+    // Repeated delete+reinsert must not corrupt or leak
+    hashmap* m = int_map();
+    int k = 7;
+    for (int cycle = 0; cycle < 20; cycle++) {
+        int v = cycle;
+        hashmap_put(m, (u8*)&k, (u8*)&v);
+        int out = 0;
+        hashmap_get(m, (u8*)&k, (u8*)&out);
+        WC_ASSERT_EQ_INT(out, cycle);
+        hashmap_del(m, (u8*)&k, NULL);
+        WC_ASSERT_EQ_U64(hashmap_size(m), 0);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_del_first_in_chain(void)
+{
+    // Deleting the head of a probe chain must leave the rest reachable
+    hashmap* m = int_map();
+    for (int i = 0; i < 15; i++) {
+        int v = i;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    int head = 0;
+    hashmap_del(m, (u8*)&head, NULL);
+    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&head));
+
+    for (int i = 1; i < 15; i++) {
+        int out = 0;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_del_all_then_reinsert(void)
+{
+    // Delete every key then reinsert — map must be fully functional
+    hashmap* m = int_map();
+    for (int i = 0; i < 20; i++) {
+        int v = i;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    for (int i = 0; i < 20; i++) {
+        hashmap_del(m, (u8*)&i, NULL);
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 0);
+    WC_ASSERT_TRUE(hashmap_empty(m));
+
+    for (int i = 0; i < 20; i++) {
+        int v = i * 3;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 20);
+    for (int i = 0; i < 20; i++) {
+        int out = 0;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i * 3);
+    }
+    hashmap_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * insert shifting  (Robin Hood run shift, in-place construction)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+// Weak hash: only 4 distinct home buckets, forces long shared runs
+static u64 clump_hash(const u8* key, u64 size)
+{
+    (void)size;
+    return (u64)(*(const int*)key & 3);
+}
+
+// Every key hashes to the last bucket, so runs wrap around index 0
+static u64 tail_hash(const u8* key, u64 size)
+{
+    (void)key;
+    (void)size;
+    return (u64)-1;
+}
+
+typedef struct {
+    u64 a;
+    u64 b;
+} key16;
+
+static void test_insert_shift_long_runs(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), clump_hash, NULL, NULL, NULL);
+    for (int i = 0; i < 40; i++) {
+        int v = i * 7;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 40);
+
+    for (int i = 0; i < 40; i++) {
+        int out = -1;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i * 7);
+    }
+    for (int i = 0; i < 40; i += 3) {
+        WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 40; i++) {
+        int want = i % 3 != 0;
+        WC_ASSERT_EQ_INT(hashmap_has(m, (u8*)&i), want);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_insert_shift_wraps_around(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), tail_hash, NULL, NULL, NULL);
+    hashmap_set_seed(m, 0); // raw tail_hash placement
+    for (int i = 0; i < 10; i++) {
+        int v = i + 100;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 16);
+
+    for (int i = 0; i < 10; i++) {
+        int out = -1;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i + 100);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_insert_shift_owned_vals(void)
+{
+    // shifted String vals are moved as raw bytes — no double free / leak
+    hashmap* m = hashmap_create(sizeof(int), sizeof(String), clump_hash, NULL, NULL, &wc_str_ops);
+    for (int i = 0; i < 30; i++) {
+        char buf[40];
+        snprintf(buf, sizeof(buf), "value number %d, long enough for heap", i);
+        MAP_PUT_INT_STR(m, i, buf);
+    }
+    for (int i = 0; i < 30; i++) {
+        char buf[40];
+        snprintf(buf, sizeof(buf), "value number %d, long enough for heap", i);
+        String* v = (String*)hashmap_get_ptr(m, (u8*)&i);
+        WC_ASSERT_NOT_NULL(v);
+        WC_ASSERT(v && string_equals_cstr(v, buf));
+    }
+    hashmap_destroy(m);
+}
+
+static void test_insert_16b_keys(void)
+{
+    hashmap* m = hashmap_create(sizeof(key16), sizeof(u64), NULL, NULL, NULL, NULL);
+    for (u64 i = 0; i < 1000; i++) {
+        key16 k = {i, ~i};
+        u64   v = i * 3;
+        hashmap_put(m, (u8*)&k, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 1000);
+    for (u64 i = 0; i < 1000; i++) {
+        key16 k   = {i, ~i};
+        u64   out = 0;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&k, (u8*)&out));
+        WC_ASSERT_EQ_U64(out, i * 3);
+    }
+    hashmap_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * hash cache  (low hash bits stored per bucket)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static u64 hash_calls = 0;
+
+static u64 counting_hash(const u8* key, u64 size)
+{
+    hash_calls++;
+    return wyhash(key, size);
+}
+
+static void test_hash_cache_int_map(void)
+{
+    hashmap* m = int_map();
+    hashmap_set_hash_cache(m, 1);
+    WC_ASSERT_NOT_NULL(m->hashes);
+
+    for (int i = 0; i < 500; i++) {
+        int v = -i;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    for (int i = 0; i < 500; i += 2) {
+        WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 500; i++) {
+        int out  = 0;
+        int want = i % 2;
+        WC_ASSERT_EQ_INT(hashmap_get(m, (u8*)&i, (u8*)&out), want);
+        if (i % 2) {
+            WC_ASSERT_EQ_INT(out, -i);
+        }
+    }
+    hashmap_destroy(m);
+}
+
+static void test_hash_cache_resize_skips_hash_fn(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), counting_hash, NULL, NULL, NULL);
+    hashmap_set_hash_cache(m, 1);
+
+    hash_calls = 0;
+    for (int i = 0; i < 1000; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    // one hash per put — resizes reuse the cached bits
+    WC_ASSERT_EQ_U64(hash_calls, 1000);
+    WC_ASSERT(hashmap_capacity(m) > 1000);
+
+    for (int i = 0; i < 1000; i++) {
+        WC_ASSERT_TRUE(hashmap_has(m, (u8*)&i));
+    }
+    hashmap_destroy(m);
+}
+
+static void test_hash_cache_clumped_keys(void)
+{
+    // same home bucket for many keys — fingerprints must still match exactly
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), clump_hash, NULL, NULL, NULL);
+    hashmap_set_hash_cache(m, 1);
+    for (int i = 0; i < 40; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    for (int i = 0; i < 40; i++) {
+        int out = -1;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_hash_cache_enable_on_full_map(void)
+{
+    hashmap* m = str_str_map();
+    for (int i = 0; i < 100; i++) {
+        char k[32];
+        snprintf(k, sizeof(k), "key_%d", i);
+        MAP_PUT_STR_STR(m, k, "v");
+    }
+
+    hashmap_set_hash_cache(m, 1);
+    for (int i = 100; i < 200; i++) {
+        char k[32];
+        snprintf(k, sizeof(k), "key_%d", i);
+        MAP_PUT_STR_STR(m, k, "v");
+    }
+    for (int i = 0; i < 200; i++) {
+        char k[32];
+        snprintf(k, sizeof(k), "key_%d", i);
+        String key;
+        string_create_stk(&key, k);
+        WC_ASSERT_TRUE(hashmap_has(m, (u8*)&key));
+        string_destroy_stk(&key);
+    }
+
+    hashmap_set_hash_cache(m, 0);
+    WC_ASSERT_NULL(m->hashes);
+    String key;
+    string_create_stk(&key, "key_150");
+    WC_ASSERT_TRUE(hashmap_has(m, (u8*)&key));
+    string_destroy_stk(&key);
+    hashmap_destroy(m);
+}
+
+static void test_hash_cache_copy(void)
+{
+    hashmap* src = int_map();
+    hashmap_set_hash_cache(src, 1);
+    for (int i = 0; i < 50; i++) {
+        hashmap_put(src, (u8*)&i, (u8*)&i);
+    }
+
+    hashmap* dest = int_map();
+    hashmap_copy(dest, src);
+    WC_ASSERT_NOT_NULL(dest->hashes);
+    for (int i = 0; i < 50; i++) {
+        WC_ASSERT_TRUE(hashmap_has(dest, (u8*)&i));
+    }
+    hashmap_destroy(src);
+    hashmap_destroy(dest);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * precomputed hash
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_with_hash_has_then_put(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), counting_hash, NULL, NULL, NULL);
+    hashmap_set_hash_cache(m, 1); // keep resizes out of the count
+
+    hash_calls = 0;
+    for (int i = 0; i < 100; i++) {
+        u64 h = hashmap_hash(m, (u8*)&i);
+        if (!hashmap_has_with_hash(m, (u8*)&i, h)) {
+            int v = i * 2;
+            WC_ASSERT_FALSE(hashmap_put_with_hash(m, (u8*)&i, (u8*)&v, h));
+        }
+    }
+    WC_ASSERT_EQ_U64(hash_calls, 100);
+    WC_ASSERT_EQ_U64(hashmap_size(m), 100);
+
+    for (int i = 0; i < 100; i++) {
+        int out = -1;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, i * 2);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_with_hash_get_then_del(void)
+{
+    hashmap* m = str_str_map();
+    MAP_PUT_STR_STR(m, "session", "token-value");
+
+    String k;
+    string_create_stk(&k, "session");
+    u64 h = hashmap_hash(m, (u8*)&k);
+
+    String* p = (String*)hashmap_get_ptr_with_hash(m, (u8*)&k, h);
+    WC_ASSERT_TRUE(string_equals_cstr(p, "token-value"));
+
+    String out = {0};
+    WC_ASSERT_TRUE(hashmap_get_with_hash(m, (u8*)&k, (u8*)&out, h));
+    string_destroy_stk(&out);
+
+    WC_ASSERT_TRUE(hashmap_del_with_hash(m, (u8*)&k, NULL, h));
+    WC_ASSERT_FALSE(hashmap_has_with_hash(m, (u8*)&k, h));
+    WC_ASSERT_TRUE(hashmap_empty(m));
+    string_destroy_stk(&k);
+    hashmap_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * batch get / has / put
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_put_many_then_get_many(void)
+{
+    // 1000 is not a multiple of the batch chunk — covers the short tail chunk
+    enum { N = 1000 };
+    int keys[N], vals[N];
+    for (int i = 0; i < N; i++) {
+        keys[i] = i;
+        vals[i] = i * 7;
+    }
+
+    hashmap* m = int_map();
+    WC_ASSERT_EQ_U64(hashmap_put_many(m, (u8*)keys, (u8*)vals, N), N);
+    WC_ASSERT_EQ_U64(hashmap_size(m), N);
+
+    // every other query misses
+    int q[N], out[N];
+    b8  found[N];
+    for (int i = 0; i < N; i++) {
+        q[i]   = (i % 2) ? i : N + i;
+        out[i] = -1;
+    }
+    WC_ASSERT_EQ_U64(hashmap_get_many(m, (u8*)q, N, (u8*)out, found), N / 2);
+    for (int i = 0; i < N; i++) {
+        int odd = i % 2;
+        WC_ASSERT_EQ_INT(found[i], odd);
+        WC_ASSERT_EQ_INT(out[i], odd ? i * 7 : -1);
+    }
+
+    WC_ASSERT_EQ_U64(hashmap_has_many(m, (u8*)q, N, NULL), N / 2);
+    hashmap_destroy(m);
+}
+
+static void test_put_many_updates_and_repeats(void)
+{
+    hashmap* m = int_map();
+    int k0 = 1, v0 = 100;
+    hashmap_put(m, (u8*)&k0, (u8*)&v0);
+
+    // key 1 already present, key 2 repeated inside the batch — last one wins
+    int keys[4] = {1, 2, 3, 2};
+    int vals[4] = {10, 20, 30, 40};
+    WC_ASSERT_EQ_U64(hashmap_put_many(m, (u8*)keys, (u8*)vals, 4), 2);
+    WC_ASSERT_EQ_U64(hashmap_size(m), 3);
+    WC_ASSERT_EQ_INT(MAP_GET(m, int, k0), 10);
+    int k2 = 2;
+    WC_ASSERT_EQ_INT(MAP_GET(m, int, k2), 40);
+
+    WC_ASSERT_EQ_U64(hashmap_get_many(m, (u8*)keys, 0, (u8*)vals, NULL), 0);
+    hashmap_destroy(m);
+}
+
+static void test_get_many_copies_owned_vals(void)
+{
+    hashmap* m = int_str_map();
+    for (int i = 0; i < 40; i++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "val_%d", i);
+        MAP_PUT_INT_STR(m, i, buf);
+    }
+
+    int    keys[3] = {5, 99, 39};
+    String out[3]  = {0};
+    b8     found[3];
+    WC_ASSERT_EQ_U64(hashmap_get_many(m, (u8*)keys, 3, (u8*)out, found), 2);
+    WC_ASSERT_TRUE(found[0] && !found[1] && found[2]);
+    WC_ASSERT_TRUE(string_equals_cstr(&out[0], "val_5"));
+    WC_ASSERT_TRUE(string_equals_cstr(&out[2], "val_39"));
+
+    // copies are ours — the map's values stay intact
+    string_destroy_stk(&out[0]);
+    string_destroy_stk(&out[2]);
+    WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_get_ptr(m, (u8*)&keys[0]), "val_5"));
+    hashmap_destroy(m);
+}
+
+static void test_put_many_move_owned(void)
+{
+    enum { N = 50 };
+    hashmap* m = str_str_map();
+    MAP_PUT_STR_STR(m, "key_3", "old");
+
+    String* keys = malloc(sizeof(String) * N);
+    String* vals = malloc(sizeof(String) * N);
+    for (int i = 0; i < N; i++) {
+        char kb[32], vb[64];
+        snprintf(kb, sizeof(kb), "key_%d", i);
+        snprintf(vb, sizeof(vb), "a much longer heap value string %d", i);
+        string_create_stk(&keys[i], kb);
+        string_create_stk(&vals[i], vb);
+    }
+
+    // key_3 existed: its old value and the duplicate key are destroyed
+    WC_ASSERT_EQ_U64(hashmap_put_many_move(m, (u8*)keys, (u8*)vals, N), N - 1);
+    free(keys); // element bytes belong to the map now
+    free(vals);
+
+    WC_ASSERT_EQ_U64(hashmap_size(m), N);
+    String k;
+    string_create_stk(&k, "key_3");
+    WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_get_ptr(m, (u8*)&k),
+                                      "a much longer heap value string 3"));
+    string_destroy_stk(&k);
+    hashmap_destroy(m);
+}
+
+static void test_batch_with_hash_cache(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), clump_hash, NULL, NULL, NULL);
+    hashmap_set_hash_cache(m, 1);
+
+    int keys[64], vals[64];
+    for (int i = 0; i < 64; i++) {
+        keys[i] = i;
+        vals[i] = -i;
+    }
+    hashmap_put_many(m, (u8*)keys, (u8*)vals, 64);
+
+    int out[64];
+    WC_ASSERT_EQ_U64(hashmap_get_many(m, (u8*)keys, 64, (u8*)out, NULL), 64);
+    for (int i = 0; i < 64; i++) {
+        WC_ASSERT_EQ_INT(out[i], -i);
+    }
+    hashmap_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * incremental resize  (old and new table coexist while the old one drains)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static hashmap* incr_int_map(custom_hash_fn hash_fn)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), hash_fn, NULL, NULL, NULL);
+    hashmap_set_incremental(m, 1);
+    return m;
+}
+
+// Put keys from *next on until a resize of an old table with at least
+// min_old entries is in flight (small tables drain within one step)
+static void fill_until_resizing(hashmap* m, int* next, u64 min_old)
+{
+    while (!m->old || m->old->size < min_old) {
+        int v = *next * 10;
+        hashmap_put(m, (u8*)next, (u8*)&v);
+        (*next)++;
+    }
+}
+
+static void test_incremental_put_get_del(void)
+{
+    hashmap* m = incr_int_map(NULL);
+    b8       seen_resize = 0;
+
+    for (int i = 0; i < 5000; i++) {
+        int v = i * 10;
+        WC_ASSERT_FALSE(hashmap_put(m, (u8*)&i, (u8*)&v));
+        seen_resize |= (m->old != NULL);
+
+        // old and new table entries are both visible to every read
+        int probe = i / 2, out = -1;
+        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&probe, (u8*)&out));
+        WC_ASSERT_EQ_INT(out, probe * 10);
+    }
+    WC_ASSERT_TRUE(seen_resize);
+    WC_ASSERT_EQ_U64(hashmap_size(m), 5000);
+
+    for (int i = 0; i < 5000; i += 3) {
+        WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 5000; i++) {
+        int want = i % 3 != 0;
+        WC_ASSERT_EQ_INT(hashmap_has(m, (u8*)&i), want);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_incremental_no_full_rehash(void)
+{
+    hashmap* m = incr_int_map(counting_hash);
+    int      next = 0;
+
+    // the put that crosses the threshold only swaps tables
+    fill_until_resizing(m, &next, 1000);
+
+    // each later put rehashes its own key plus a few old buckets — a small
+    // constant, never the 1000+ entries of the old table
+    while (m->old) {
+        hash_calls = 0;
+        int v = 0;
+        hashmap_put(m, (u8*)&next, (u8*)&v);
+        next++;
+        WC_ASSERT(hash_calls <= 16);
+    }
+
+    for (int i = 0; i < next; i++) {
+        WC_ASSERT_TRUE(hashmap_has(m, (u8*)&i));
+    }
+    hashmap_destroy(m);
+}
+
+static void test_incremental_update_and_del_in_old_table(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(String), NULL, NULL, NULL, &wc_str_ops);
+    hashmap_set_incremental(m, 1);
+
+    int next = 0;
+    while (!m->old || m->old->size < 1000) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "a value long enough for the heap %d", next);
+        MAP_PUT_INT_STR(m, next, buf);
+        next++;
+    }
+
+    // key 0 is still in the old table: the update must free the old String
+    MAP_PUT_INT_STR(m, 0, "replaced");
+    int k = 0;
+    WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_get_ptr(m, (u8*)&k), "replaced"));
+
+    String out = {0};
+    k = 1;
+    WC_ASSERT_TRUE(hashmap_del(m, (u8*)&k, (u8*)&out));
+    WC_ASSERT_TRUE(string_equals_cstr(&out, "a value long enough for the heap 1"));
+    string_destroy_stk(&out);
+    WC_ASSERT_EQ_U64(hashmap_size(m), (u64)next - 1);
+
+    // destroy with the old table still holding owned values
+    WC_ASSERT_NOT_NULL(m->old);
+    hashmap_destroy(m);
+}
+
+static void test_incremental_wrapped_runs(void)
+{
+    // every key homes in the last bucket, so runs wrap around index 0
+    hashmap* m = incr_int_map(tail_hash);
+    hashmap_set_seed(m, 0);
+    for (int i = 0; i < 60; i++) {
+        int v = i * 10;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+        for (int j = 0; j <= i; j += 7) {
+            int out = -1;
+            WC_ASSERT_TRUE(hashmap_get(m, (u8*)&j, (u8*)&out));
+            WC_ASSERT_EQ_INT(out, j * 10);
+        }
+    }
+    for (int i = 0; i < 60; i += 2) {
+        WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 60; i++) {
+        int want = i % 2;
+        WC_ASSERT_EQ_INT(hashmap_has(m, (u8*)&i), want);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_incremental_hash_cache_clumped(void)
+{
+    hashmap* m = incr_int_map(clump_hash);
+    hashmap_set_hash_cache(m, 1);
+
+    int next = 0;
+    fill_until_resizing(m, &next, 50);
+    WC_ASSERT_NOT_NULL(m->old->hashes);
+
+    int keys[8] = {0, 1, 2, 3, 5, 8, 9, 10};
+    int out[8];
+    b8  found[8];
+    WC_ASSERT_EQ_U64(hashmap_get_many(m, (u8*)keys, 8, (u8*)out, found), 8);
+    for (int i = 0; i < 8; i++) {
+        WC_ASSERT_EQ_INT(out[i], keys[i] * 10);
+    }
+    WC_ASSERT_EQ_U64(hashmap_has_many(m, (u8*)keys, 8, NULL), 8);
+
+    hashmap_set_hash_cache(m, 0);
+    WC_ASSERT_NULL(m->hashes);
+    for (int i = 0; i < next; i++) {
+        WC_ASSERT_TRUE(hashmap_has(m, (u8*)&i));
+    }
+    hashmap_destroy(m);
+}
+
+static void test_incremental_copy_clear_foreach(void)
+{
+    hashmap* m    = incr_int_map(NULL);
+    int      next = 0;
+    fill_until_resizing(m, &next, 300);
+
+    u64 visited = 0;
+    MAP_FOREACH_KEY(m, int, k) {
+        WC_ASSERT(*k >= 0 && *k < next);
+        visited++;
+    }
+    WC_ASSERT_EQ_U64(visited, (u64)next);
+
+    // copy of a map mid-resize is a single table holding everything
+    hashmap* dest = int_map();
+    hashmap_copy(dest, m);
+    WC_ASSERT_NULL(dest->old);
+    WC_ASSERT_EQ_U64(hashmap_size(dest), (u64)next);
+    for (int i = 0; i < next; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(dest, int, i), i * 10);
+    }
+
+    hashmap_clear(m);
+    WC_ASSERT_NULL(m->old);
+    WC_ASSERT_TRUE(hashmap_empty(m));
+    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&next));
+
+    hashmap_destroy(dest);
+    hashmap_destroy(m);
+}
+
+static void test_incremental_matches_plain(void)
+{
+    // random put/del/get mix, checked op by op against a plain map
+    hashmap* inc   = incr_int_map(NULL);
+    hashmap* plain = int_map();
+    u64      rng   = 12345;
+
+    for (int op = 0; op < 60000; op++) {
+        rng    = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+        int k  = (int)((rng >> 33) % 8000);
+        int v  = op;
+        u32 pick = (u32)(rng >> 20) % 10;
+
+        if (pick < 6) {
+            WC_ASSERT_EQ_INT(hashmap_put(inc, (u8*)&k, (u8*)&v), hashmap_put(plain, (u8*)&k, (u8*)&v));
+        } else if (pick < 8) {
+            WC_ASSERT_EQ_INT(hashmap_del(inc, (u8*)&k, NULL), hashmap_del(plain, (u8*)&k, NULL));
+        } else {
+            int a = -1, b = -1;
+            WC_ASSERT_EQ_INT(hashmap_get(inc, (u8*)&k, (u8*)&a), hashmap_get(plain, (u8*)&k, (u8*)&b));
+            WC_ASSERT_EQ_INT(a, b);
+        }
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(inc), hashmap_size(plain));
+    hashmap_destroy(inc);
+    hashmap_destroy(plain);
+}
+
+static void test_incremental_disable_finishes(void)
+{
+    hashmap* m    = incr_int_map(NULL);
+    int      next = 0;
+    fill_until_resizing(m, &next, 300);
+
+    hashmap_set_incremental(m, 0);
+    WC_ASSERT_NULL(m->old);
+    WC_ASSERT_EQ_U64(hashmap_size(m), (u64)next);
+    for (int i = 0; i < next; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i * 10);
+    }
+    hashmap_destroy(m);
+}
+
+// a reserve that fits the new table still drains the old one
+static void test_incremental_reserve_finishes(void)
+{
+    hashmap* m    = incr_int_map(NULL);
+    int      next = 0;
+    fill_until_resizing(m, &next, 300);
+
+    u64 cap = hashmap_capacity(m);
+    hashmap_reserve(m, (u64)next + 1);
+    WC_ASSERT_NULL(m->old);
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), cap);
+    for (int i = 0; i < next; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i * 10);
+    }
+
+    // and one that grows takes both tables into the bigger one
+    fill_until_resizing(m, &next, 300);
+    hashmap_reserve(m, hashmap_capacity(m) * 4);
+    WC_ASSERT_NULL(m->old);
+    WC_ASSERT_EQ_U64(hashmap_size(m), (u64)next);
+    for (int i = 0; i < next; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i * 10);
+    }
+    hashmap_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * reserve / bulk build from genVecs
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_reserve_avoids_resize(void)
+{
+    hashmap* m = int_map();
+    hashmap_reserve(m, 1000);
+    u64 cap = hashmap_capacity(m);
+    WC_ASSERT_EQ_U64(cap, 2048);
+
+    for (int i = 0; i < 1000; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), cap);
+
+    // never shrinks, and a satisfied reserve is a no-op
+    hashmap_reserve(m, 10);
+    hashmap_reserve(m, 1000);
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), cap);
+    for (int i = 0; i < 1000; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_reserve_keeps_hash_cache(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), counting_hash, NULL, NULL, NULL);
+    hashmap_set_hash_cache(m, 1);
+    for (int i = 0; i < 10; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+
+    hash_calls = 0;
+    hashmap_reserve(m, 5000);
+    WC_ASSERT_EQ_U64(hash_calls, 0); // cached bits place the 10 entries
+    WC_ASSERT_NOT_NULL(m->hashes);
+    for (int i = 0; i < 10; i++) {
+        WC_ASSERT_TRUE(hashmap_has(m, (u8*)&i));
+    }
+    hashmap_destroy(m);
+}
+
+static void test_from_vecs_pod(void)
+{
+    for (int sort = 0; sort < 2; sort++) {
+        genVec* keys = genVec_init(3000, sizeof(int), NULL);
+        genVec* vals = genVec_init(3000, sizeof(int), NULL);
+        for (int i = 0; i < 3000; i++) {
+            int v = i * 3;
+            genVec_push(keys, (u8*)&i);
+            genVec_push(vals, (u8*)&v);
+        }
+
+        hashmap* m = hashmap_from_vecs(keys, vals, NULL, NULL, (b8)sort);
+        WC_ASSERT_EQ_U64(hashmap_size(m), 3000);
+        WC_ASSERT_EQ_U64(hashmap_capacity(m), 4096); // sized once
+        WC_ASSERT_EQ_U64(genVec_size(keys), 0);
+        WC_ASSERT_EQ_U64(genVec_size(vals), 0);
+        for (int i = 0; i < 3000; i++) {
+            WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i * 3);
+        }
+
+        genVec_destroy(keys);
+        genVec_destroy(vals);
+        hashmap_destroy(m);
+    }
+}
+
+static void test_from_vecs_owned_with_repeats(void)
+{
+    for (int sort = 0; sort < 2; sort++) {
+        genVec* keys = genVec_init(8, sizeof(String), &wc_str_ops);
+        genVec* vals = genVec_init(8, sizeof(String), &wc_str_ops);
+        for (int i = 0; i < 200; i++) {
+            char kb[32], vb[64];
+            snprintf(kb, sizeof(kb), "key_%d", i % 150); // keys 0..49 appear twice
+            snprintf(vb, sizeof(vb), "a heap allocated value number %d", i);
+            String* k = string_from_cstr(kb);
+            String* v = string_from_cstr(vb);
+            genVec_push_move(keys, (u8**)&k);
+            genVec_push_move(vals, (u8**)&v);
+        }
+
+        hashmap* m = hashmap_from_vecs(keys, vals, wyhash_str, str_cmp, (b8)sort);
+        WC_ASSERT_EQ_U64(hashmap_size(m), 150);
+        WC_ASSERT(m->key_ops == &wc_str_ops && m->val_ops == &wc_str_ops);
+
+        String k;
+        string_create_stk(&k, "key_7");
+        WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_get_ptr(m, (u8*)&k),
+                                          "a heap allocated value number 157"));
+        string_destroy_stk(&k);
+        string_create_stk(&k, "key_120");
+        WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_get_ptr(m, (u8*)&k),
+                                          "a heap allocated value number 120"));
+        string_destroy_stk(&k);
+
+        genVec_destroy(keys); // empty — nothing double freed
+        genVec_destroy(vals);
+        hashmap_destroy(m);
+    }
+}
+
+static void test_from_vecs_sorted_clumped(void)
+{
+    genVec* keys = genVec_init(64, sizeof(int), NULL);
+    genVec* vals = genVec_init(64, sizeof(int), NULL);
+    for (int i = 63; i >= 0; i--) {
+        int v = -i;
+        genVec_push(keys, (u8*)&i);
+        genVec_push(vals, (u8*)&v);
+    }
+
+    hashmap* m = hashmap_from_vecs(keys, vals, clump_hash, NULL, 1);
+    WC_ASSERT_EQ_U64(hashmap_size(m), 64);
+    for (int i = 0; i < 64; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), -i);
+    }
+
+    genVec_destroy(keys);
+    genVec_destroy(vals);
+    hashmap_destroy(m);
+}
+
+static void test_from_vecs_empty(void)
+{
+    genVec*  keys = genVec_init(0, sizeof(int), NULL);
+    genVec*  vals = genVec_init(0, sizeof(int), NULL);
+    hashmap* m    = hashmap_from_vecs(keys, vals, NULL, NULL, 1);
+    WC_ASSERT_TRUE(hashmap_empty(m));
+    genVec_destroy(keys);
+    genVec_destroy(vals);
+    hashmap_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * arena-backed storage
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_arena_map_pod(void)
+{
+    Arena*   a = arena_create(nKB(256));
+    hashmap* m = hashmap_create_arena(a, sizeof(int), sizeof(int), NULL, NULL, NULL, NULL);
+    hashmap_set_hash_cache(m, 1);
+
+    for (int i = 0; i < 2000; i++) {
+        int v = i * 2;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    for (int i = 0; i < 2000; i += 4) {
+        WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
+    }
+    for (int i = 0; i < 2000; i++) {
+        int out  = -1;
+        int want = i % 4 != 0;
+        WC_ASSERT_EQ_INT(hashmap_get(m, (u8*)&i, (u8*)&out), want);
+        if (i % 4) {
+            WC_ASSERT_EQ_INT(out, i * 2);
+        }
+    }
+
+    // struct and tables all live in the arena
+    WC_ASSERT((u8*)m >= a->base && (u8*)m < a->base + a->size);
+    WC_ASSERT(m->keys >= a->base && m->keys < a->base + a->size);
+
+    hashmap_destroy(m); // no-op for POD
+    arena_clear(a);
+    WC_ASSERT_EQ_U64(arena_used(a), 0);
+    arena_release(a);
+}
+
+static void test_arena_map_reserve_then_fill(void)
+{
+    Arena*   a = arena_create(nKB(64));
+    hashmap* m = hashmap_create_arena(a, sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+
+    // one table of the final size — no abandoned arrays from doubling
+    hashmap_reserve(m, 1000);
+    u64 used = arena_used(a);
+    for (u64 i = 0; i < 1000; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    WC_ASSERT_EQ_U64(arena_used(a), used);
+
+    hashmap_destroy(m);
+    arena_release(a);
+}
+
+static void test_arena_map_owned_and_incremental(void)
+{
+    Arena*   a = arena_create(nMB(1));
+    hashmap* m = hashmap_create_arena(a, sizeof(int), sizeof(String), NULL, NULL, NULL, &wc_str_ops);
+    hashmap_set_incremental(m, 1);
+
+    for (int i = 0; i < 1500; i++) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "a value long enough for the heap %d", i);
+        MAP_PUT_INT_STR(m, i, buf);
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 1500);
+
+    // an arena dest for a copy, then a clear of the source
+    hashmap* dest = hashmap_create_arena(a, sizeof(int), sizeof(String), NULL, NULL, NULL, &wc_str_ops);
+    hashmap_copy(dest, m);
+    hashmap_clear(m);
+    int k = 1499;
+    WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_get_ptr(dest, (u8*)&k),
+                                      "a value long enough for the heap 1499"));
+
+    // destroy still frees the Strings' heap buffers
+    hashmap_destroy(dest);
+    hashmap_destroy(m);
+    arena_release(a);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * snapshots (save / load_mmap / promote)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+#define SNAP_PATH "/tmp/wc_hashmap_test.snap"
+
+static hashmap* u64_map_filled(u64 n)
+{
+    hashmap* m = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    for (u64 i = 0; i < n; i++) {
+        u64 v = i * 3;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    return m;
+}
+
+static b8 file_bytes_equal(const char* path, const u8* want, u64 len)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return 0;
+    }
+    u8* got = malloc(len + 1);
+    u64 n   = fread(got, 1, len + 1, f);
+    fclose(f);
+    b8 eq = n == len && memcmp(got, want, len) == 0;
+    free(got);
+    return eq;
+}
+
+static void test_snapshot_round_trip(void)
+{
+    hashmap* m = u64_map_filled(5000);
+    WC_ASSERT_TRUE(hashmap_save(m, SNAP_PATH));
+
+    hashmap* s = hashmap_load_mmap(SNAP_PATH, NULL, NULL);
+    WC_ASSERT_NOT_NULL(s);
+    WC_ASSERT_TRUE(s->read_only);
+    WC_ASSERT_EQ_U64(hashmap_size(s), 5000);
+    WC_ASSERT_EQ_U64(hashmap_capacity(s), hashmap_capacity(m));
+    WC_ASSERT_EQ_U64(s->seed, m->seed);
+
+    for (u64 i = 0; i < 5000; i++) {
+        u64 v = 0;
+        WC_ASSERT_TRUE(hashmap_get(s, (u8*)&i, (u8*)&v));
+        WC_ASSERT_EQ_U64(v, i * 3);
+    }
+    u64 miss = 5000;
+    WC_ASSERT_FALSE(hashmap_has(s, (u8*)&miss));
+
+    // iteration and copies work on the read-only tables
+    u64          seen = 0;
+    hashmap_iter it   = hashmap_iter_begin(s);
+    while (hashmap_iter_next(&it)) {
+        WC_ASSERT_EQ_U64(*(u64*)it.val, *(u64*)it.key * 3);
+        seen++;
+    }
+    WC_ASSERT_EQ_U64(seen, 5000);
+
+    hashmap* c = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    hashmap_copy(c, s);
+    WC_ASSERT_FALSE(c->read_only);
+    hashmap_put(c, (u8*)&miss, (u8*)&miss);
+    WC_ASSERT_EQ_U64(hashmap_size(c), 5001);
+
+    hashmap_destroy(c);
+    hashmap_destroy(s);
+    hashmap_destroy(m);
+    remove(SNAP_PATH);
+}
+
+static void test_snapshot_save_finishes_incremental(void)
+{
+    hashmap* m = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    hashmap_set_incremental(m, 1);
+    for (u64 i = 0; i < 3000; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    WC_ASSERT_TRUE(hashmap_save(m, SNAP_PATH));
+    WC_ASSERT_NULL(m->old);
+
+    hashmap* s = hashmap_load_mmap(SNAP_PATH, NULL, NULL);
+    WC_ASSERT_NOT_NULL(s);
+    WC_ASSERT_FALSE(s->incremental);
+    for (u64 i = 0; i < 3000; i++) {
+        WC_ASSERT_EQ_U64(*(u64*)hashmap_get_ptr(s, (u8*)&i), i);
+    }
+
+    hashmap_destroy(s);
+    hashmap_destroy(m);
+    remove(SNAP_PATH);
+}
+
+static void test_snapshot_bad_files(void)
+{
+    wc_errno = WC_OK;
+    WC_ASSERT_NULL(hashmap_load_mmap("/tmp/wc_no_such_snapshot", NULL, NULL));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_IO);
+
+    // not a snapshot at all
+    FILE* f = fopen(SNAP_PATH, "wb");
+    for (int i = 0; i < 5000; i++) {
+        fputc(i, f);
+    }
+    fclose(f);
+    wc_errno = WC_OK;
+    WC_ASSERT_NULL(hashmap_load_mmap(SNAP_PATH, NULL, NULL));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_IO);
+
+    // a set snapshot is not a map snapshot
+    hashset* set = hashset_create(sizeof(u64), NULL, NULL, NULL);
+    u64      x   = 7;
+    hashset_insert(set, (u8*)&x);
+    WC_ASSERT_TRUE(hashset_save(set, SNAP_PATH));
+    wc_errno = WC_OK;
+    WC_ASSERT_NULL(hashmap_load_mmap(SNAP_PATH, NULL, NULL));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_IO);
+    hashset_destroy(set);
+
+    // truncated
+    hashmap* m = u64_map_filled(100);
+    WC_ASSERT_TRUE(hashmap_save(m, SNAP_PATH));
+    WC_ASSERT_EQ_INT(truncate(SNAP_PATH, 5000), 0);
+    wc_errno = WC_OK;
+    WC_ASSERT_NULL(hashmap_load_mmap(SNAP_PATH, NULL, NULL));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_IO);
+
+    // unwritable path
+    wc_errno = WC_OK;
+    WC_ASSERT_FALSE(hashmap_save(m, "/tmp/wc_no_such_dir/x.snap"));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_IO);
+
+    hashmap_destroy(m);
+    remove(SNAP_PATH);
+}
+
+static u64 snap_other_hash(const u8* key, u64 size)
+{
+    return wyhash(key, size) ^ 1;
+}
+
+static void snap_read_header(map_snapshot_header* hdr)
+{
+    FILE* f = fopen(SNAP_PATH, "rb");
+    WC_ASSERT_EQ_U64(fread(hdr, sizeof(*hdr), 1, f), 1);
+    fclose(f);
+}
+
+static void snap_write_header(const map_snapshot_header* hdr)
+{
+    FILE* f = fopen(SNAP_PATH, "r+b");
+    WC_ASSERT_EQ_U64(fwrite(hdr, sizeof(*hdr), 1, f), 1);
+    fclose(f);
+}
+
+// valid files with a bad header or the wrong hash_fn are errors, not aborts
+static void test_snapshot_bad_headers(void)
+{
+    hashmap* m = u64_map_filled(100);
+    WC_ASSERT_TRUE(hashmap_save(m, SNAP_PATH));
+
+    wc_errno = WC_OK;
+    WC_ASSERT_NULL(hashmap_load_mmap(SNAP_PATH, snap_other_hash, NULL));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_IO);
+
+    map_snapshot_header good;
+    snap_read_header(&good);
+
+    map_snapshot_header hdr = good;
+    hdr.max_load = 0; // every put would grow
+    snap_write_header(&hdr);
+    wc_errno = WC_OK;
+    WC_ASSERT_NULL(hashmap_load_mmap(SNAP_PATH, NULL, NULL));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_IO);
+
+    hdr          = good;
+    hdr.min_load = hdr.max_load; // above max / 4
+    snap_write_header(&hdr);
+    WC_ASSERT_NULL(hashmap_load_mmap(SNAP_PATH, NULL, NULL));
+
+    hdr         = good;
+    hdr.offs[1] = UINT64_MAX - 8; // offs + lens wraps
+    snap_write_header(&hdr);
+    WC_ASSERT_NULL(hashmap_load_mmap(SNAP_PATH, NULL, NULL));
+
+    hdr          = good;
+    hdr.key_size = 1u << 31; // capacity * key_size wraps
+    hdr.capacity = 1ULL << 34;
+    hdr.lens[0]  = hdr.capacity;
+    snap_write_header(&hdr);
+    WC_ASSERT_NULL(hashmap_load_mmap(SNAP_PATH, NULL, NULL));
+
+    // the untouched header still loads
+    snap_write_header(&good);
+    hashmap* s = hashmap_load_mmap(SNAP_PATH, NULL, NULL);
+    WC_ASSERT_NOT_NULL(s);
+    WC_ASSERT_EQ_U64(hashmap_size(s), 100);
+
+    hashmap_destroy(s);
+    hashmap_destroy(m);
+    remove(SNAP_PATH);
+}
+
+static void test_snapshot_promote_then_mutate(void)
+{
+    hashmap* m = u64_map_filled(2000);
+    WC_ASSERT_TRUE(hashmap_save(m, SNAP_PATH));
+
+    FILE* f   = fopen(SNAP_PATH, "rb");
+    fseek(f, 0, SEEK_END);
+    u64 len   = (u64)ftell(f);
+    u8* bytes = malloc(len);
+    fseek(f, 0, SEEK_SET);
+    WC_ASSERT_EQ_U64(fread(bytes, 1, len, f), len);
+    fclose(f);
+
+    hashmap* s = hashmap_load_mmap(SNAP_PATH, NULL, NULL);
+    hashmap_promote(s);
+    WC_ASSERT_FALSE(s->read_only);
+    hashmap_promote(s); // no-op
+
+    // in place: update, delete, insert without a resize
+    u64 k = 10, v = 99;
+    WC_ASSERT_TRUE(hashmap_put(s, (u8*)&k, (u8*)&v));
+    k = 11;
+    WC_ASSERT_TRUE(hashmap_del(s, (u8*)&k, NULL));
+    k = 100000;
+    WC_ASSERT_FALSE(hashmap_put(s, (u8*)&k, (u8*)&v));
+    WC_ASSERT_NOT_NULL(s->snapshot);
+    WC_ASSERT_EQ_U64(hashmap_size(s), 2000);
+
+    // the file under the mapping never changes
+    WC_ASSERT_TRUE(file_bytes_equal(SNAP_PATH, bytes, len));
+
+    // growing moves the tables to the heap and drops the mapping
+    for (u64 i = 2000; i < 10000; i++) {
+        hashmap_put(s, (u8*)&i, (u8*)&i);
+    }
+    WC_ASSERT_NULL(s->snapshot);
+    WC_ASSERT_EQ_U64(hashmap_size(s), 10000);
+    k = 10;
+    WC_ASSERT_EQ_U64(*(u64*)hashmap_get_ptr(s, (u8*)&k), 99);
+    k = 11;
+    WC_ASSERT_FALSE(hashmap_has(s, (u8*)&k));
+    k = 5000;
+    WC_ASSERT_EQ_U64(*(u64*)hashmap_get_ptr(s, (u8*)&k), 5000);
+
+    WC_ASSERT_TRUE(file_bytes_equal(SNAP_PATH, bytes, len));
+
+    free(bytes);
+    hashmap_destroy(s);
+    hashmap_destroy(m);
+    remove(SNAP_PATH);
+}
+
+// a reseed of an unpromoted map rebuilds on the heap, leaving it writable
+static void test_snapshot_reseed_leaves_mapping(void)
+{
+    hashmap* m = u64_map_filled(500);
+    WC_ASSERT_TRUE(hashmap_save(m, SNAP_PATH));
+
+    hashmap* s = hashmap_load_mmap(SNAP_PATH, NULL, NULL);
+    hashmap_reseed(s);
+    WC_ASSERT_NULL(s->snapshot);
+    WC_ASSERT_FALSE(s->read_only);
+
+    u64 k = 700;
+    hashmap_put(s, (u8*)&k, (u8*)&k);
+    for (u64 i = 0; i < 500; i++) {
+        WC_ASSERT_EQ_U64(*(u64*)hashmap_get_ptr(s, (u8*)&i), i * 3);
+    }
+
+    hashmap_destroy(s);
+    hashmap_destroy(m);
+    remove(SNAP_PATH);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * iteration / keys / values
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_iter_visits_every_entry_once(void)
+{
+    hashmap* m = int_map();
+    for (int i = 0; i < 1000; i++) {
+        int v = i * 2;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+    // deletes leave holes of all widths for the word-wide skip
+    for (int i = 0; i < 1000; i += 3) {
+        hashmap_del(m, (u8*)&i, NULL);
+    }
+
+    u8  seen[1000] = {0};
+    u64 count      = 0;
+
+    hashmap_iter it = hashmap_iter_begin(m);
+    while (hashmap_iter_next(&it)) {
+        int k = *(int*)it.key;
+        WC_ASSERT_EQ_INT(*(int*)it.val, k * 2);
+        WC_ASSERT_EQ_INT(seen[k], 0);
+        seen[k] = 1;
+        count++;
+    }
+    WC_ASSERT_EQ_U64(count, hashmap_size(m));
+    WC_ASSERT_NULL(it.key);
+    WC_ASSERT_FALSE(hashmap_iter_next(&it)); // stays finished
+
+    for (int i = 0; i < 1000; i++) {
+        int want = i % 3 != 0;
+        WC_ASSERT_EQ_INT(seen[i], want);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_iter_empty_and_last_bucket(void)
+{
+    hashmap* m = int_map();
+    hashmap_iter it = hashmap_iter_begin(m);
+    WC_ASSERT_FALSE(hashmap_iter_next(&it));
+
+    // a lone entry in the very last bucket is past every full word
+    for (int i = 0;; i++) {
+        if ((hashmap_hash(m, (u8*)&i) & (hashmap_capacity(m) - 1)) == hashmap_capacity(m) - 1) {
+            hashmap_put(m, (u8*)&i, (u8*)&i);
+            break;
+        }
+    }
+    it = hashmap_iter_begin(m);
+    WC_ASSERT_TRUE(hashmap_iter_next(&it));
+    WC_ASSERT_FALSE(hashmap_iter_next(&it));
+    hashmap_destroy(m);
+}
+
+static void test_iter_pause_and_resume(void)
+{
+    hashmap* m = int_map();
+    for (int i = 0; i < 300; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+
+    // walk 100, save the cursor, walk on, then resume from the copy
+    hashmap_iter it = hashmap_iter_begin(m);
+    for (int n = 0; n < 100; n++) {
+        WC_ASSERT_TRUE(hashmap_iter_next(&it));
+    }
+    hashmap_iter saved = it;
+
+    int after_a = 0, after_b = 0;
+    while (hashmap_iter_next(&it)) {
+        after_a++;
+    }
+    while (hashmap_iter_next(&saved)) {
+        after_b++;
+    }
+    WC_ASSERT_EQ_INT(after_a, 200);
+    WC_ASSERT_EQ_INT(after_b, 200);
+    hashmap_destroy(m);
+}
+
+static void test_iter_modify_vals_in_place(void)
+{
+    hashmap* m = int_map();
+    for (int i = 0; i < 50; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    MAP_FOREACH_VAL(m, int, v) {
+        *v += 1000;
+    }
+    for (int i = 0; i < 50; i++) {
+        int out = 0;
+        hashmap_get(m, (u8*)&i, (u8*)&out);
+        WC_ASSERT_EQ_INT(out, i + 1000);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_iter_during_incremental_resize(void)
+{
+    hashmap* m    = incr_int_map(NULL);
+    int      next = 0;
+    fill_until_resizing(m, &next, 300);
+
+    // entries are split across both tables — each is visited exactly once
+    int keys = 0;
+    u64 sum  = 0;
+    MAP_FOREACH_KEY(m, int, k) {
+        keys++;
+        sum += (u64)*k;
+    }
+    WC_ASSERT_EQ_INT(keys, next);
+    WC_ASSERT_EQ_U64(sum, (u64)next * (u64)(next - 1) / 2);
+    hashmap_destroy(m);
+}
+
+static void test_keys_values_pod(void)
+{
+    hashmap* m = int_map();
+    for (int i = 0; i < 500; i++) {
+        int v = -i;
+        hashmap_put(m, (u8*)&i, (u8*)&v);
+    }
+
+    genVec* keys = hashmap_keys(m);
+    genVec* vals = hashmap_values(m);
+    WC_ASSERT_EQ_U64(keys->size, 500);
+    WC_ASSERT_EQ_U64(vals->size, 500);
+    WC_ASSERT_EQ_U64(keys->capacity, 500); // sized once, no growth
+
+    for (u64 i = 0; i < keys->size; i++) {
+        int k = *(int*)genVec_get_ptr(keys, i);
+        WC_ASSERT_EQ_INT(*(int*)genVec_get_ptr(vals, i), -k);
+    }
+    genVec_destroy(keys);
+    genVec_destroy(vals);
+
+    hashmap_clear(m);
+    keys = hashmap_keys(m);
+    WC_ASSERT_EQ_U64(keys->size, 0);
+    genVec_destroy(keys);
+    hashmap_destroy(m);
+}
+
+static void test_keys_values_deep_copy(void)
+{
+    hashmap* m = str_str_map();
+    MAP_PUT_STR_STR(m, "alpha", "a value long enough for the heap 1");
+    MAP_PUT_STR_STR(m, "beta", "a value long enough for the heap 2");
+
+    genVec* keys = hashmap_keys(m);
+    genVec* vals = hashmap_values(m);
+    WC_ASSERT(keys->ops == &wc_str_ops && vals->ops == &wc_str_ops);
+
+    // the vecs own independent copies: they outlive the map
+    hashmap_destroy(m);
+
+    for (u64 i = 0; i < keys->size; i++) {
+        String* k = (String*)genVec_get_ptr(keys, i);
+        String* v = (String*)genVec_get_ptr(vals, i);
+        b8      a = string_equals_cstr(k, "alpha");
+        WC_ASSERT(a || string_equals_cstr(k, "beta"));
+        WC_ASSERT_TRUE(string_equals_cstr(v, a ? "a value long enough for the heap 1"
+                                               : "a value long enough for the heap 2"));
+    }
+    genVec_destroy(keys);
+    genVec_destroy(vals);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * entry API
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_entry_word_count(void)
+{
+    const char* text[] = {"the", "cat", "sat", "on", "the", "mat", "the", "end", "cat"};
+
+    hashmap* m = hashmap_create(sizeof(String), sizeof(int), wyhash_str, str_cmp, &wc_str_ops, NULL);
+    u64 new_words = 0;
+    for (u64 i = 0; i < sizeof(text) / sizeof(text[0]); i++) {
+        String w;
+        string_create_stk(&w, text[i]);
+        b8   inserted = 0;
+        int* count    = (int*)hashmap_entry(m, (u8*)&w, &inserted);
+        if (inserted) {
+            WC_ASSERT_EQ_INT(*count, 0); // fresh slots start zeroed
+            new_words++;
+        }
+        (*count)++;
+        string_destroy_stk(&w);
+    }
+    WC_ASSERT_EQ_U64(new_words, 6);
+    WC_ASSERT_EQ_U64(hashmap_size(m), 6);
+
+    String the;
+    string_create_stk(&the, "the");
+    WC_ASSERT_EQ_INT(*(int*)hashmap_get_ptr(m, (u8*)&the), 3);
+    string_destroy_stk(&the);
+    hashmap_destroy(m);
+}
+
+static void test_entry_one_hash_per_call(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), counting_hash, NULL, NULL, NULL);
+    hashmap_reserve(m, 100);
+
+    hash_calls = 0;
+    for (int i = 0; i < 1000; i++) {
+        int k = i % 100;
+        (*MAP_ENTRY(m, int, k))++;
+    }
+    WC_ASSERT_EQ_U64(hash_calls, 1000);
+
+    for (int k = 0; k < 100; k++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, k), 10);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_entry_pointer_survives_growth(void)
+{
+    // the insert that reaches 0.75 grows first, so its slot is already final
+    hashmap* m = int_map();
+    int      i = 0;
+    for (; (u64)(i + 1) * 4 < hashmap_capacity(m) * 3; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    u64 cap = hashmap_capacity(m);
+
+    b8   inserted = 0;
+    int* slot     = (int*)hashmap_entry(m, (u8*)&i, &inserted);
+    WC_ASSERT_TRUE(inserted);
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), cap * 2);
+    *slot = 4242;
+
+    WC_ASSERT_EQ_INT(MAP_GET(m, int, i), 4242);
+    for (int k = 0; k < i; k++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, k), k);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_entry_matches_put_growth(void)
+{
+    // same keys through put and through entry: same capacity at every step
+    hashmap* a = int_map();
+    hashmap* b = int_map();
+    for (int i = 0; i < 3000; i++) {
+        hashmap_put(a, (u8*)&i, (u8*)&i);
+        *(int*)hashmap_entry(b, (u8*)&i, NULL) = i;
+        WC_ASSERT_EQ_U64(hashmap_capacity(a), hashmap_capacity(b));
+    }
+    for (int i = 0; i < 3000; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(b, int, i), i);
+    }
+    hashmap_destroy(a);
+    hashmap_destroy(b);
+}
+
+static void test_entry_move_key(void)
+{
+    hashmap* m = hashmap_create(sizeof(String), sizeof(int), wyhash_str, str_cmp, &wc_str_ops, NULL);
+
+    String* k = string_from_cstr("a key long enough to live on the heap");
+    b8      inserted = 0;
+    *(int*)hashmap_entry_move(m, (u8**)&k, &inserted) = 1;
+    WC_ASSERT_TRUE(inserted);
+    WC_ASSERT_NULL(k);
+
+    // duplicate: incoming key consumed, existing slot returned
+    k        = string_from_cstr("a key long enough to live on the heap");
+    int* val = (int*)hashmap_entry_move(m, (u8**)&k, &inserted);
+    WC_ASSERT_FALSE(inserted);
+    WC_ASSERT_NULL(k);
+    WC_ASSERT_EQ_INT(*val, 1);
+    WC_ASSERT_EQ_U64(hashmap_size(m), 1);
+    hashmap_destroy(m);
+}
+
+static void test_entry_owned_value_and_hash_cache(void)
+{
+    hashmap* m = int_str_map();
+    hashmap_set_hash_cache(m, 1);
+    for (int i = 0; i < 200; i++) {
+        b8      inserted = 0;
+        String* v        = (String*)hashmap_entry(m, (u8*)&i, &inserted);
+        WC_ASSERT_TRUE(inserted);
+        string_create_stk(v, "constructed in place, long enough for the heap");
+    }
+    int     k = 123;
+    String* v = (String*)hashmap_entry(m, (u8*)&k, NULL);
+    string_append_cstr(v, "!");
+    WC_ASSERT_TRUE(string_equals_cstr((String*)hashmap_get_ptr(m, (u8*)&k),
+                                      "constructed in place, long enough for the heap!"));
+    hashmap_destroy(m);
+}
+
+static void test_entry_incremental(void)
+{
+    hashmap* m = incr_int_map(NULL);
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 4000; i++) {
+            (*MAP_ENTRY(m, int, i))++;
+        }
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 4000);
+    for (int i = 0; i < 4000; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), 3);
+    }
+    hashmap_destroy(m);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * hashmap_stats  (table shape always, counters with WC_MAP_STATS)
  * ════════════════════════════════════════════════════════════════════════════ */
 
-static void test_put_and_get(void)
+static u64 psl_hist_sum(const map_stats* st)
 {
-    hashmap* m = int_map();
-    int k = 1, v = 100;
-    hashmap_put(m, (u8*)&k, (u8*)&v);
-
-    int out = 0;
-    WC_ASSERT_TRUE(hashmap_get(m, (u8*)&k, (u8*)&out));
-    WC_ASSERT_EQ_INT(out, 100);
-    hashmap_destroy(m);
+    u64 sum = 0;
+    for (u32 d = 0; d < MAP_STATS_PSL_SLOTS; d++) {
+        sum += st->psl_hist[d];
+    }
+    return sum;
 }
 
-static void test_put_update(void)
+static void test_stats_empty_map(void)
 {
-    hashmap* m = int_map();
-    int k = 1, v1 = 10, v2 = 20;
-    hashmap_put(m, (u8*)&k, (u8*)&v1);
-    b8 was_update = hashmap_put(m, (u8*)&k, (u8*)&v2);
-    WC_ASSERT_TRUE(was_update);
-
-    int out = 0;
-    hashmap_get(m, (u8*)&k, (u8*)&out);
-    WC_ASSERT_EQ_INT(out, 20);
-    WC_ASSERT_EQ_U64(hashmap_size(m), 1);
+    hashmap*  m = int_map();
+    map_stats st;
+    hashmap_stats(m, &st);
+
+    WC_ASSERT_EQ_U64(st.size, 0);
+    WC_ASSERT_EQ_U64(st.capacity, hashmap_capacity(m));
+    WC_ASSERT_EQ_U64(st.max_psl, 0);
+    WC_ASSERT_EQ_U64(psl_hist_sum(&st), 0);
+    WC_ASSERT_TRUE(st.load_factor == 0.0 && st.mean_psl == 0.0);
+    WC_ASSERT_TRUE(st.bytes >= st.capacity * (sizeof(int) * 2 + 1));
     hashmap_destroy(m);
 }
 
-static void test_has(void)
+static void test_stats_good_hash(void)
 {
     hashmap* m = int_map();
-    int k = 5, v = 0;
-    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&k));
-    hashmap_put(m, (u8*)&k, (u8*)&v);
-    WC_ASSERT_TRUE(hashmap_has(m, (u8*)&k));
+    for (int i = 0; i < 5000; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    map_stats st;
+    hashmap_stats(m, &st);
+
+    WC_ASSERT_EQ_U64(st.size, 5000);
+    WC_ASSERT_EQ_U64(psl_hist_sum(&st), 5000);
+    WC_ASSERT_TRUE(st.load_factor > 0.25 && st.load_factor < 0.75);
+    WC_ASSERT_TRUE(st.mean_psl < 2.0);
+    WC_ASSERT_TRUE(st.max_psl < MAP_STATS_PSL_SLOTS - 1);
+    WC_ASSERT_TRUE(st.psl_hist[0] > st.psl_hist[2]);
     hashmap_destroy(m);
 }
 
-static void test_del(void)
+static void test_stats_weak_hash_shows_tail(void)
 {
-    hashmap* m = int_map();
-    int k = 3, v = 42;
-    hashmap_put(m, (u8*)&k, (u8*)&v);
-    WC_ASSERT_TRUE(hashmap_del(m, (u8*)&k, NULL));
-    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&k));
-    WC_ASSERT_EQ_U64(hashmap_size(m), 0);
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), clump_hash, NULL, NULL, NULL);
+    hashmap_set_seed(m, 0); // a seed would scatter the 4 homes, not merge the runs
+    for (int i = 0; i < 80; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    map_stats st;
+    hashmap_stats(m, &st);
+
+    // 4 home buckets for 80 keys: one long run, most entries far from home
+    WC_ASSERT_EQ_U64(psl_hist_sum(&st), 80);
+    WC_ASSERT_TRUE(st.max_psl >= 70);
+    WC_ASSERT_TRUE(st.mean_psl > 20.0);
+    WC_ASSERT_TRUE(st.psl_hist[MAP_STATS_PSL_SLOTS - 1] > 40);
     hashmap_destroy(m);
 }
 
-static void test_del_copies_out(void)
+static void test_stats_hash_cache_bytes(void)
 {
     hashmap* m = int_map();
-    int k = 7, v = 99, out = 0;
-    hashmap_put(m, (u8*)&k, (u8*)&v);
-    hashmap_del(m, (u8*)&k, (u8*)&out);
-    WC_ASSERT_EQ_INT(out, 99);
+    map_stats plain, cached;
+    hashmap_stats(m, &plain);
+    hashmap_set_hash_cache(m, 1);
+    hashmap_stats(m, &cached);
+
+    WC_ASSERT_EQ_U64(cached.bytes - plain.bytes, hashmap_capacity(m) * sizeof(u32));
     hashmap_destroy(m);
 }
 
-static void test_del_missing_returns_false(void)
+static void test_stats_incremental_both_tables(void)
 {
-    hashmap* m = int_map();
-    int k = 404;
-    WC_ASSERT_FALSE(hashmap_del(m, (u8*)&k, NULL));
+    hashmap* m    = incr_int_map(NULL);
+    int      next = 0;
+    fill_until_resizing(m, &next, 64);
+
+    map_stats st;
+    hashmap_stats(m, &st);
+    WC_ASSERT_EQ_U64(st.size, hashmap_size(m));
+    WC_ASSERT_EQ_U64(psl_hist_sum(&st), hashmap_size(m));
     hashmap_destroy(m);
 }
 
-static void test_del_on_empty_map(void)
+static void test_stats_counters(void)
 {
     hashmap* m = int_map();
-    int k = 1;
-    WC_ASSERT_FALSE(hashmap_del(m, (u8*)&k, NULL));
-    WC_ASSERT_EQ_U64(hashmap_size(m), 0);
+    for (int i = 0; i < 100; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    map_stats st;
+    hashmap_stats(m, &st);
+
+#if WC_MAP_STATS
+    WC_ASSERT_EQ_U64(st.counters.lookups, 100);
+    WC_ASSERT_TRUE(st.counters.resizes >= 3); // grew from 16 several times
+
+    hashmap_stats_reset(m);
+    for (int i = 0; i < 10; i++) {
+        WC_ASSERT_TRUE(hashmap_has(m, (u8*)&i));
+    }
+    int miss = -1;
+    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&miss));
+    hashmap_stats(m, &st);
+
+    WC_ASSERT_EQ_U64(st.counters.lookups, 11);
+    WC_ASSERT_TRUE(st.counters.compares >= 10);
+    WC_ASSERT_TRUE(st.counters.probes >= st.counters.lookups);
+    WC_ASSERT_EQ_U64(st.counters.resizes, 0);
+#else
+    WC_ASSERT_EQ_U64(st.counters.lookups, 0);
+    WC_ASSERT_EQ_U64(st.counters.probes, 0);
+    WC_ASSERT_EQ_U64(st.counters.compares, 0);
+    WC_ASSERT_EQ_U64(st.counters.resizes, 0);
+#endif
     hashmap_destroy(m);
 }
 
-static void test_get_ptr(void)
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * seeding  (per-map seed, reseed on psl overflow)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+// Distinct 64-bit hashes whose low 32 bits are all 0: unseeded, every key
+// homes in bucket 0 — what keys crafted against a known seed look like
+static u64 high_bits_hash(const u8* key, u64 size)
 {
-    hashmap* m = int_map();
-    int k = 2, v = 55;
-    hashmap_put(m, (u8*)&k, (u8*)&v);
-    int* ptr = (int*)hashmap_get_ptr(m, (u8*)&k);
-    WC_ASSERT_NOT_NULL(ptr);
-    WC_ASSERT_EQ_INT(*ptr, 55);
+    (void)size;
+    return (u64)(u32)*(const int*)key << 32;
+}
 
-    // Mutate through ptr — must be visible via get
-    *ptr = 66;
-    int out = 0;
-    hashmap_get(m, (u8*)&k, (u8*)&out);
-    WC_ASSERT_EQ_INT(out, 66);
-    hashmap_destroy(m);
+static u64 max_psl_of(const hashmap* m)
+{
+    map_stats st;
+    hashmap_stats(m, &st);
+    return st.max_psl;
 }
 
-static void test_get_ptr_missing_returns_null(void)
+static void test_seed_per_map(void)
 {
-    hashmap* m = int_map();
-    int k = 999;
-    WC_ASSERT_NULL(hashmap_get_ptr(m, (u8*)&k));
-    hashmap_destroy(m);
+    hashmap* a = int_map();
+    hashmap* b = int_map();
+#if WC_MAP_SEEDED
+    WC_ASSERT_TRUE(a->seed != 0 && b->seed != 0);
+    WC_ASSERT_TRUE(a->seed != b->seed);
+#endif
+    hashmap_set_seed(a, 0);
+    int k = 12345;
+    WC_ASSERT_EQ_U64(hashmap_hash(a, (u8*)&k), wyhash((u8*)&k, sizeof(int)));
+    hashmap_destroy(a);
+    hashmap_destroy(b);
 }
 
-static void test_get_missing_returns_false(void)
+static void test_set_seed_keeps_entries(void)
 {
-    hashmap* m = int_map();
-    int k = 999, out = 0;
-    WC_ASSERT_FALSE(hashmap_get(m, (u8*)&k, (u8*)&out));
+    hashmap* m = int_str_map();
+    hashmap_set_hash_cache(m, 1);
+    for (int i = 0; i < 2000; i++) {
+        MAP_PUT_INT_STR(m, i, "seeded");
+    }
+    int k  = 7;
+    u64 h0 = hashmap_hash(m, (u8*)&k);
+
+    hashmap_reseed(m);
+    WC_ASSERT_TRUE(hashmap_hash(m, (u8*)&k) != h0);
+    hashmap_set_seed(m, 99);
+    WC_ASSERT_EQ_U64(m->seed, 99);
+
+    WC_ASSERT_EQ_U64(hashmap_size(m), 2000);
+    for (int i = 0; i < 2000; i++) {
+        String* v = (String*)hashmap_get_ptr(m, (u8*)&i);
+        WC_ASSERT_NOT_NULL(v);
+        WC_ASSERT_EQ_INT(string_equals_cstr(v, "seeded"), 1);
+    }
     hashmap_destroy(m);
 }
 
-static void test_size_tracks_inserts(void)
+static void test_psl_overflow_reseeds(void)
 {
-    hashmap* m = int_map();
-    WC_ASSERT_EQ_U64(hashmap_size(m), 0);
-    WC_ASSERT_TRUE(hashmap_empty(m));
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), high_bits_hash, NULL, NULL, NULL);
+    hashmap_set_seed(m, 0);
 
-    for (int i = 0; i < 10; i++) {
-        int v = i * 10;
+    for (int i = 0; i < 2000; i++) {
+        int v = i * 2;
         hashmap_put(m, (u8*)&i, (u8*)&v);
+        WC_ASSERT_TRUE(max_psl_of(m) < RH_PSL_LIMIT);
+    }
+
+    // the flood tripped the limit once and the map went seeded
+    WC_ASSERT_TRUE(m->seed != 0);
+    WC_ASSERT_FALSE(m->psl_overflow);
+    WC_ASSERT_TRUE(max_psl_of(m) < 16);
+    for (int i = 0; i < 2000; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i * 2);
     }
-    WC_ASSERT_EQ_U64(hashmap_size(m), 10);
-    WC_ASSERT_FALSE(hashmap_empty(m));
     hashmap_destroy(m);
 }
 
-static void test_resize_preserves_data(void)
+static u64 const_hash(const u8* key, u64 size)
 {
-    hashmap* m = int_map();
-    for (int i = 0; i < 50; i++) {
-        int v = i * 2;
+    (void)key;
+    (void)size;
+    return 42;
+}
+
+// equal hash_fn outputs collide under every seed: the map keeps the long
+// run instead of reseeding forever
+static void test_psl_overflow_equal_hashes(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), const_hash, NULL, NULL, NULL);
+    for (int i = 0; i < 200; i++) {
+        int v = i * 3;
         hashmap_put(m, (u8*)&i, (u8*)&v);
     }
-    WC_ASSERT_EQ_U64(hashmap_size(m), 50);
-    for (int i = 0; i < 50; i++) {
-        int out = 0;
-        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
-        WC_ASSERT_EQ_INT(out, i * 2);
+
+    WC_ASSERT_EQ_U64(hashmap_size(m), 200);
+    WC_ASSERT_EQ_U64(m->psl_limit, RH_PSL_MAX);
+    WC_ASSERT_FALSE(m->psl_overflow);
+    WC_ASSERT_EQ_U64(max_psl_of(m), 199); // one run of 200 keys
+    for (int i = 0; i < 200; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i * 3);
+    }
+
+    // the limit survives growth and dels
+    for (int i = 0; i < 200; i += 2) {
+        WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
+    }
+    hashmap_reserve(m, 1000);
+    for (int i = 0; i < 200; i++) {
+        int want = i % 2 != 0;
+        WC_ASSERT_EQ_INT(hashmap_has(m, (u8*)&i), want);
     }
     hashmap_destroy(m);
 }
 
-// Robin Hood + backward-shift delete doesn't shrink — no LOAD_FACTOR_SHRINK.
-// Verify correctness after heavy deletion instead.
-static void test_del_correctness_after_many_deletes(void)
+static void test_psl_overflow_incremental(void)
 {
-    hashmap* m = int_map();
-    for (int i = 0; i < 50; i++) {
-        int v = i;
-        hashmap_put(m, (u8*)&i, (u8*)&v);
+    hashmap* m = incr_int_map(high_bits_hash);
+    hashmap_set_hash_cache(m, 1);
+    hashmap_set_seed(m, 0);
+
+    for (int i = 0; i < 3000; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+        if (i % 3 == 0) {
+            WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
+        }
     }
-    for (int i = 0; i < 48; i++) {
-        hashmap_del(m, (u8*)&i, NULL);
+    WC_ASSERT_TRUE(m->seed != 0);
+    WC_ASSERT_EQ_U64(hashmap_size(m), 2000);
+    for (int i = 0; i < 3000; i++) {
+        int want = i % 3 != 0;
+        WC_ASSERT_EQ_INT(hashmap_has(m, (u8*)&i), want);
     }
-    WC_ASSERT_EQ_U64(hashmap_size(m), 2);
+    hashmap_destroy(m);
+}
 
-    for (int i = 48; i < 50; i++) {
-        int out = 0;
-        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
-        WC_ASSERT_EQ_INT(out, i);
+static void test_psl_overflow_entry_and_batch(void)
+{
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), high_bits_hash, NULL, NULL, NULL);
+    hashmap_set_seed(m, 0);
+
+    // the slot handed back must survive the reseed its own insert triggers
+    for (int i = 0; i < 500; i++) {
+        *MAP_ENTRY(m, int, i) = i + 1;
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i + 1);
     }
+    WC_ASSERT_TRUE(m->seed != 0);
+
+    // and batch puts rehash keys whose precomputed hash went stale
+    hashmap* b = hashmap_create(sizeof(int), sizeof(int), high_bits_hash, NULL, NULL, NULL);
+    hashmap_set_seed(b, 0);
+    int keys[600], vals[600];
+    for (int i = 0; i < 600; i++) {
+        keys[i] = i;
+        vals[i] = -i;
+    }
+    WC_ASSERT_EQ_U64(hashmap_put_many(b, (u8*)keys, (u8*)vals, 600), 600);
+    WC_ASSERT_EQ_U64(hashmap_size(b), 600);
+    for (int i = 0; i < 600; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(b, int, i), -i);
+    }
+
     hashmap_destroy(m);
+    hashmap_destroy(b);
 }
 
 
 /* ════════════════════════════════════════════════════════════════════════════
- * delete correctness  (backward-shift, no tombstones)
+ * Load factor
  * ════════════════════════════════════════════════════════════════════════════ */
 
-static void test_del_reinsert(void)
+// Unseeded, consecutive keys home 2/5 of a bucket apart, so a 256-bucket
+// table builds one run whose psls hit the limit past the default load.
+// Bit 8 sends odd keys to the upper half once the table has 512 buckets.
+static u64 dense_hash(const u8* key, u64 size)
+{
+    (void)size;
+    u64 k = (u64)(u32)*(const int*)key;
+    return ((k * 2) / 5) | ((k & 1) << 8);
+}
+
+static void test_max_load_default(void)
 {
-    // Delete a key then reinsert it — must succeed and be findable
     hashmap* m = int_map();
-    int k = 42, v1 = 1, v2 = 2;
-    hashmap_put(m, (u8*)&k, (u8*)&v1);
-    hashmap_del(m, (u8*)&k, NULL);
-    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&k));
+    WC_ASSERT_EQ_INT(m->max_load, 75);
 
-    hashmap_put(m, (u8*)&k, (u8*)&v2);
-    int out = 0;
-    WC_ASSERT_TRUE(hashmap_get(m, (u8*)&k, (u8*)&out));
-    WC_ASSERT_EQ_INT(out, 2);
-    WC_ASSERT_EQ_U64(hashmap_size(m), 1);
+    for (int i = 0; i < 11; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 16);
+    int k = 11;
+    hashmap_put(m, (u8*)&k, (u8*)&k); // 12 / 16 = 0.75
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 32);
     hashmap_destroy(m);
 }
 
-static void test_del_mid_chain(void)
+static void test_max_load_high_packs_tighter(void)
+{
+    hashmap* lo = int_map();
+    hashmap* hi = int_map();
+    hashmap_set_max_load(hi, 0.9);
+
+    for (int i = 0; i < 900; i++) {
+        int v = -i;
+        hashmap_put(lo, (u8*)&i, (u8*)&v);
+        hashmap_put(hi, (u8*)&i, (u8*)&v);
+    }
+    WC_ASSERT_EQ_U64(hashmap_capacity(lo), 2048);
+    WC_ASSERT_EQ_U64(hashmap_capacity(hi), 1024); // 900 / 1024 = 0.88
+    WC_ASSERT_TRUE(max_psl_of(hi) < RH_PSL_LIMIT);
+    for (int i = 0; i < 900; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(hi, int, i), -i);
+    }
+
+    hashmap_destroy(lo);
+    hashmap_destroy(hi);
+}
+
+static void test_max_load_reserve_and_lower(void)
 {
-    // Insert keys that will chain during probing, delete one mid-chain,
-    // then verify all remaining keys are still reachable.
-    // Backward-shift delete keeps the Robin Hood invariant intact.
     hashmap* m = int_map();
-    for (int i = 0; i < 20; i++) {
-        int v = i * 10;
-        hashmap_put(m, (u8*)&i, (u8*)&v);
+    hashmap_set_max_load(m, 0.9);
+    hashmap_reserve(m, 900);
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 1024);
+
+    for (int i = 0; i < 700; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
     }
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 1024);
 
-    int mid = 5;
-    hashmap_del(m, (u8*)&mid, NULL);
+    // 700 / 1024 is past 0.5: grows on the spot
+    hashmap_set_max_load(m, 0.5);
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 2048);
+    for (int i = 0; i < 700; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i);
+    }
 
-    for (int i = 0; i < 20; i++) {
-        if (i == mid) {
-            continue;
+    // copies keep the load factor
+    hashmap* c = int_map();
+    hashmap_copy(c, m);
+    WC_ASSERT_EQ_INT(c->max_load, 50);
+
+    hashmap_destroy(c);
+    hashmap_destroy(m);
+}
+
+static void test_max_load_incremental_and_entry(void)
+{
+    hashmap* m = incr_int_map(NULL);
+    hashmap_set_max_load(m, 0.95);
+
+    for (int i = 0; i < 5000; i++) {
+        (*MAP_ENTRY(m, int, i)) += i;
+        if (i % 4 == 0) {
+            WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
         }
-        int out = 0;
-        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
-        WC_ASSERT_EQ_INT(out, i * 10);
+    }
+    WC_ASSERT_EQ_U64(hashmap_size(m), 3750);
+    WC_ASSERT_TRUE(max_psl_of(m) < RH_PSL_LIMIT);
+    for (int i = 0; i < 5000; i++) {
+        int want = i % 4 != 0;
+        WC_ASSERT_EQ_INT(hashmap_has(m, (u8*)&i), want);
     }
     hashmap_destroy(m);
 }
 
-static void test_delete_reinsert_cycle(void)
+static void test_psl_overflow_dense_grows(void)
 {
-    // Repeated delete+reinsert must not corrupt or leak
-    hashmap* m = int_map();
-    int k = 7;
-    for (int cycle = 0; cycle < 20; cycle++) {
-        int v = cycle;
-        hashmap_put(m, (u8*)&k, (u8*)&v);
-        int out = 0;
-        hashmap_get(m, (u8*)&k, (u8*)&out);
-        WC_ASSERT_EQ_INT(out, cycle);
-        hashmap_del(m, (u8*)&k, NULL);
-        WC_ASSERT_EQ_U64(hashmap_size(m), 0);
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), dense_hash, NULL, NULL, NULL);
+    hashmap_set_seed(m, 0);
+    hashmap_set_max_load(m, 0.95);
+    hashmap_reserve(m, 200);
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 256);
+
+    int k0 = 0;
+    u64 h0 = hashmap_hash(m, (u8*)&k0);
+    for (int i = 0; i < 240; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+
+    // the run overflowed at ~0.83 load: the table doubled and kept its seed,
+    // so precomputed hashes still work
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 512);
+    WC_ASSERT_EQ_U64(m->seed, 0);
+    WC_ASSERT_TRUE(max_psl_of(m) < 64);
+    WC_ASSERT_TRUE(hashmap_has_with_hash(m, (u8*)&k0, h0));
+    for (int i = 0; i < 240; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), i);
     }
     hashmap_destroy(m);
 }
 
-static void test_del_first_in_chain(void)
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * Shrinking
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_shrink_to_fit(void)
 {
-    // Deleting the head of a probe chain must leave the rest reachable
     hashmap* m = int_map();
-    for (int i = 0; i < 15; i++) {
-        int v = i;
-        hashmap_put(m, (u8*)&i, (u8*)&v);
+    for (int i = 0; i < 10000; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    for (int i = 100; i < 10000; i++) {
+        hashmap_del(m, (u8*)&i, NULL);
+    }
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 16384); // dels alone never shrink
+
+    u64 seed = m->seed;
+    hashmap_shrink_to_fit(m);
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 256); // 100 / 128 would be past 0.75
+    WC_ASSERT_EQ_U64(m->seed, seed);
+    for (int i = 0; i < 10000; i++) {
+        WC_ASSERT_EQ_INT(hashmap_has(m, (u8*)&i), i < 100);
     }
-    int head = 0;
-    hashmap_del(m, (u8*)&head, NULL);
-    WC_ASSERT_FALSE(hashmap_has(m, (u8*)&head));
 
-    for (int i = 1; i < 15; i++) {
-        int out = 0;
-        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
-        WC_ASSERT_EQ_INT(out, i);
+    hashmap_shrink_to_fit(m); // already tight: no-op
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 256);
+
+    hashmap_clear(m);
+    hashmap_shrink_to_fit(m);
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), HASHMAP_INIT_CAPACITY);
+    hashmap_destroy(m);
+}
+
+static void test_shrink_to_fit_incremental(void)
+{
+    hashmap* m    = incr_int_map(NULL);
+    int      next = 0;
+    fill_until_resizing(m, &next, 1000);
+
+    for (int i = 0; i < next; i += 2) {
+        WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
+    }
+    hashmap_shrink_to_fit(m);
+    WC_ASSERT_NULL(m->old);
+    WC_ASSERT_FALSE(map_load_reached(m->size, m->capacity, m->max_load));
+    WC_ASSERT_TRUE(map_load_reached(m->size, m->capacity / 2, m->max_load));
+    for (int i = 0; i < next; i++) {
+        int want = i % 2 == 1;
+        WC_ASSERT_EQ_INT(hashmap_has(m, (u8*)&i), want);
     }
     hashmap_destroy(m);
 }
 
-static void test_del_all_then_reinsert(void)
+static void test_auto_shrink(void)
 {
-    // Delete every key then reinsert — map must be fully functional
     hashmap* m = int_map();
-    for (int i = 0; i < 20; i++) {
-        int v = i;
+    hashmap_set_min_load(m, 0.1);
+    for (int i = 0; i < 10000; i++) {
+        int v = -i;
         hashmap_put(m, (u8*)&i, (u8*)&v);
     }
-    for (int i = 0; i < 20; i++) {
-        hashmap_del(m, (u8*)&i, NULL);
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 16384);
+
+    u64 shrinks = 0, cap = hashmap_capacity(m);
+    for (int i = 9999; i >= 0; i--) {
+        WC_ASSERT_TRUE(hashmap_del(m, (u8*)&i, NULL));
+        if (hashmap_capacity(m) != cap) {
+            WC_ASSERT_TRUE(hashmap_capacity(m) < cap);
+            cap = hashmap_capacity(m);
+            shrinks++;
+        }
+        // never left below 10% full, except at the smallest table
+        WC_ASSERT_TRUE(cap == HASHMAP_INIT_CAPACITY || m->size * 10 >= cap);
     }
-    WC_ASSERT_EQ_U64(hashmap_size(m), 0);
-    WC_ASSERT_TRUE(hashmap_empty(m));
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), HASHMAP_INIT_CAPACITY);
+    // just under 0.1 full, one halving reaches 0.2 (small tables may take two)
+    WC_ASSERT_TRUE(shrinks >= 8 && shrinks <= 10);
 
-    for (int i = 0; i < 20; i++) {
-        int v = i * 3;
+    // refill: a shrunk map grows back normally
+    for (int i = 0; i < 2000; i++) {
+        int v = -i;
         hashmap_put(m, (u8*)&i, (u8*)&v);
     }
-    WC_ASSERT_EQ_U64(hashmap_size(m), 20);
-    for (int i = 0; i < 20; i++) {
-        int out = 0;
-        WC_ASSERT_TRUE(hashmap_get(m, (u8*)&i, (u8*)&out));
-        WC_ASSERT_EQ_INT(out, i * 3);
+    for (int i = 0; i < 2000; i++) {
+        WC_ASSERT_EQ_INT(MAP_GET(m, int, i), -i);
+    }
+    hashmap_destroy(m);
+}
+
+static void test_auto_shrink_hysteresis(void)
+{
+    hashmap* m = int_map();
+    hashmap_set_min_load(m, 0.1);
+    for (int i = 0; i < 1700; i++) {
+        hashmap_put(m, (u8*)&i, (u8*)&i);
+    }
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 4096);
+
+    // 409 / 4096 < 0.1: shrink to where it is at most 0.375 full
+    for (int i = 409; i < 1700; i++) {
+        hashmap_del(m, (u8*)&i, NULL);
+    }
+    WC_ASSERT_EQ_U64(hashmap_capacity(m), 2048);
+
+    // bouncing around the shrink point neither grows nor shrinks again
+    for (int round = 0; round < 50; round++) {
+        for (int i = 409; i < 700; i++) {
+            hashmap_put(m, (u8*)&i, (u8*)&i);
+        }
+        for (int i = 409; i < 700; i++) {
+            hashmap_del(m, (u8*)&i, NULL);
+        }
+        WC_ASSERT_EQ_U64(hashmap_capacity(m), 2048);
     }
     hashmap_destroy(m);
 }
@@ -857,6 +2874,109 @@ void hashmap_suite(void)
     WC_RUN(test_del_first_in_chain);
     WC_RUN(test_del_all_then_reinsert);
 
+    WC_SUITE("HashMap — insert shifting");
+    WC_RUN(test_insert_shift_long_runs);
+    WC_RUN(test_insert_shift_wraps_around);
+    WC_RUN(test_insert_shift_owned_vals);
+    WC_RUN(test_insert_16b_keys);
+
+    WC_SUITE("HashMap — hash cache");
+    WC_RUN(test_hash_cache_int_map);
+    WC_RUN(test_hash_cache_resize_skips_hash_fn);
+    WC_RUN(test_hash_cache_clumped_keys);
+    WC_RUN(test_hash_cache_enable_on_full_map);
+    WC_RUN(test_hash_cache_copy);
+
+    WC_SUITE("HashMap — precomputed hash");
+    WC_RUN(test_with_hash_has_then_put);
+    WC_RUN(test_with_hash_get_then_del);
+
+    WC_SUITE("HashMap — batch get/has/put");
+    WC_RUN(test_put_many_then_get_many);
+    WC_RUN(test_put_many_updates_and_repeats);
+    WC_RUN(test_get_many_copies_owned_vals);
+    WC_RUN(test_put_many_move_owned);
+    WC_RUN(test_batch_with_hash_cache);
+
+    WC_SUITE("HashMap — incremental resize");
+    WC_RUN(test_incremental_put_get_del);
+    WC_RUN(test_incremental_no_full_rehash);
+    WC_RUN(test_incremental_update_and_del_in_old_table);
+    WC_RUN(test_incremental_wrapped_runs);
+    WC_RUN(test_incremental_hash_cache_clumped);
+    WC_RUN(test_incremental_copy_clear_foreach);
+    WC_RUN(test_incremental_matches_plain);
+    WC_RUN(test_incremental_disable_finishes);
+    WC_RUN(test_incremental_reserve_finishes);
+
+    WC_SUITE("HashMap — reserve / from_vecs");
+    WC_RUN(test_reserve_avoids_resize);
+    WC_RUN(test_reserve_keeps_hash_cache);
+    WC_RUN(test_from_vecs_pod);
+    WC_RUN(test_from_vecs_owned_with_repeats);
+    WC_RUN(test_from_vecs_sorted_clumped);
+    WC_RUN(test_from_vecs_empty);
+
+    WC_SUITE("HashMap — arena storage");
+    WC_RUN(test_arena_map_pod);
+    WC_RUN(test_arena_map_reserve_then_fill);
+    WC_RUN(test_arena_map_owned_and_incremental);
+
+    WC_SUITE("HashMap — snapshots");
+    WC_RUN(test_snapshot_round_trip);
+    WC_RUN(test_snapshot_save_finishes_incremental);
+    WC_RUN(test_snapshot_bad_files);
+    WC_RUN(test_snapshot_bad_headers);
+    WC_RUN(test_snapshot_promote_then_mutate);
+    WC_RUN(test_snapshot_reseed_leaves_mapping);
+
+    WC_SUITE("HashMap — iteration / keys / values");
+    WC_RUN(test_iter_visits_every_entry_once);
+    WC_RUN(test_iter_empty_and_last_bucket);
+    WC_RUN(test_iter_pause_and_resume);
+    WC_RUN(test_iter_modify_vals_in_place);
+    WC_RUN(test_iter_during_incremental_resize);
+    WC_RUN(test_keys_values_pod);
+    WC_RUN(test_keys_values_deep_copy);
+
+    WC_SUITE("HashMap — entry API");
+    WC_RUN(test_entry_word_count);
+    WC_RUN(test_entry_one_hash_per_call);
+    WC_RUN(test_entry_pointer_survives_growth);
+    WC_RUN(test_entry_matches_put_growth);
+    WC_RUN(test_entry_move_key);
+    WC_RUN(test_entry_owned_value_and_hash_cache);
+    WC_RUN(test_entry_incremental);
+
+    WC_SUITE("HashMap — stats");
+    WC_RUN(test_stats_empty_map);
+    WC_RUN(test_stats_good_hash);
+    WC_RUN(test_stats_weak_hash_shows_tail);
+    WC_RUN(test_stats_hash_cache_bytes);
+    WC_RUN(test_stats_incremental_both_tables);
+    WC_RUN(test_stats_counters);
+
+    WC_SUITE("HashMap — seeding");
+    WC_RUN(test_seed_per_map);
+    WC_RUN(test_set_seed_keeps_entries);
+    WC_RUN(test_psl_overflow_reseeds);
+    WC_RUN(test_psl_overflow_equal_hashes);
+    WC_RUN(test_psl_overflow_incremental);
+    WC_RUN(test_psl_overflow_entry_and_batch);
+
+    WC_SUITE("HashMap — load factor");
+    WC_RUN(test_max_load_default);
+    WC_RUN(test_max_load_high_packs_tighter);
+    WC_RUN(test_max_load_reserve_and_lower);
+    WC_RUN(test_max_load_incremental_and_entry);
+    WC_RUN(test_psl_overflow_dense_grows);
+
+    WC_SUITE("HashMap — shrink");
+    WC_RUN(test_shrink_to_fit);
+    WC_RUN(test_shrink_to_fit_incremental);
+    WC_RUN(test_auto_shrink);
+    WC_RUN(test_auto_shrink_hysteresis);
+
     WC_SUITE("HashMap — clear");
     WC_RUN(test_clear_empties_map);
     WC_RUN(test_clear_then_reuse);
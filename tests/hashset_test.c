@@ -1,7 +1,9 @@
 #include "wc_macros.h"
 #include "wc_test.h"
 #include "hashset.h"
+#include "hashmap.h"
 #include "wc_helpers.h"
+#include "wc_errno.h"
 
 
 /* ── Set constructors ────────────────────────────────────────────────────── */
@@ -241,6 +243,539 @@ static void test_remove_all_then_reinsert(void)
 }
 
 
+/* ════════════════════════════════════════════════════════════════════════════
+ * insert shifting  (Robin Hood run shift, in-place construction)
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+// Weak hash: only 4 distinct home buckets, forces long shared runs
+static u64 clump_hash(const u8* elm, u64 size)
+{
+    (void)size;
+    return (u64)(*(const int*)elm & 3);
+}
+
+static void test_insert_shift_long_runs(void)
+{
+    hashset* s = hashset_create(sizeof(int), clump_hash, NULL, NULL);
+    for (int i = 0; i < 40; i++) {
+        hashset_insert(s, (u8*)&i);
+    }
+    WC_ASSERT_EQ_U64(hashset_size(s), 40);
+
+    for (int i = 0; i < 40; i += 4) {
+        WC_ASSERT_TRUE(hashset_remove(s, (u8*)&i));
+    }
+    for (int i = 0; i < 40; i++) {
+        int want = i % 4 != 0;
+        WC_ASSERT_EQ_INT(hashset_has(s, (u8*)&i), want);
+    }
+    hashset_destroy(s);
+}
+
+static void test_insert_shift_owned_elms(void)
+{
+    hashset* s = hashset_create(sizeof(String), wyhash_str, str_cmp, &wc_str_ops);
+    for (int i = 0; i < 50; i++) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "element %d with a heap sized payload", i);
+        SET_INSERT_CSTR(s, buf);
+    }
+    for (int i = 0; i < 50; i++) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "element %d with a heap sized payload", i);
+        String probe;
+        string_create_stk(&probe, buf);
+        WC_ASSERT_TRUE(hashset_has(s, (u8*)&probe));
+        string_destroy_stk(&probe);
+    }
+    hashset_destroy(s);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * precomputed hash
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static u64 hash_calls = 0;
+
+static u64 counting_str_hash(const u8* elm, u64 size)
+{
+    hash_calls++;
+    return wyhash_str(elm, size);
+}
+
+static void test_with_hash_single_hash_per_key(void)
+{
+    hashset* s = hashset_create(sizeof(String), counting_str_hash, str_cmp, &wc_str_ops);
+
+    String e;
+    string_create_stk(&e, "a fairly long key that is expensive to hash");
+
+    hash_calls = 0;
+    u64 h      = hashset_hash(s, (u8*)&e);
+    WC_ASSERT_FALSE(hashset_has_with_hash(s, (u8*)&e, h));
+    WC_ASSERT_FALSE(hashset_insert_with_hash(s, (u8*)&e, h));
+    WC_ASSERT_TRUE(hashset_has_with_hash(s, (u8*)&e, h));
+    WC_ASSERT_TRUE(hashset_remove_with_hash(s, (u8*)&e, h));
+    WC_ASSERT_EQ_U64(hash_calls, 1);
+
+    WC_ASSERT_FALSE(hashset_has(s, (u8*)&e));
+    string_destroy_stk(&e);
+    hashset_destroy(s);
+}
+
+static void test_with_hash_matches_plain_calls(void)
+{
+    hashset* s = int_set();
+    for (int i = 0; i < 200; i++) {
+        hashset_insert_with_hash(s, (u8*)&i, hashset_hash(s, (u8*)&i));
+    }
+    // survives resizes — stored entries are rehashed with hash_fn
+    for (int i = 0; i < 200; i++) {
+        WC_ASSERT_TRUE(hashset_has(s, (u8*)&i));
+    }
+    for (int i = 0; i < 200; i += 2) {
+        WC_ASSERT_TRUE(hashset_remove(s, (u8*)&i));
+    }
+    for (int i = 0; i < 200; i++) {
+        int want = i % 2;
+        WC_ASSERT_EQ_INT(hashset_has_with_hash(s, (u8*)&i, hashset_hash(s, (u8*)&i)), want);
+    }
+    hashset_destroy(s);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * arena-backed storage
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_arena_set_pod(void)
+{
+    Arena*   a = arena_create(nKB(64));
+    hashset* s = hashset_create_arena(a, sizeof(int), NULL, NULL, NULL);
+    WC_ASSERT(arena_used(a) > 0);
+
+    for (int i = 0; i < 1000; i++) {
+        WC_ASSERT_FALSE(hashset_insert(s, (u8*)&i));
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        WC_ASSERT_TRUE(hashset_remove(s, (u8*)&i));
+    }
+    for (int i = 0; i < 1000; i++) {
+        int want = i % 2;
+        WC_ASSERT_EQ_INT(hashset_has(s, (u8*)&i), want);
+    }
+
+    // copy into a heap set, then throw the arena set away wholesale
+    hashset* h = int_set();
+    hashset_copy(h, s);
+    hashset_destroy(s); // frees nothing
+    arena_clear(a);
+    WC_ASSERT_EQ_U64(hashset_size(h), 500);
+    WC_ASSERT_TRUE(hashset_has(h, (u8*)&(int){999}));
+
+    hashset_destroy(h);
+    arena_release(a);
+}
+
+static void test_arena_set_owned_strings(void)
+{
+    Arena*   a = arena_create(nKB(64));
+    hashset* s = hashset_create_arena(a, sizeof(String), wyhash_str, str_cmp, &wc_str_ops);
+    for (int i = 0; i < 100; i++) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "a string long enough for the heap %d", i);
+        String* e = string_from_cstr(buf);
+        hashset_insert_move(s, (u8**)&e);
+    }
+    WC_ASSERT_EQ_U64(hashset_size(s), 100);
+
+    // the Strings' own buffers are heap — destroy still frees those
+    hashset_destroy(s);
+    arena_release(a);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * hashset_stats
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_stats_shape(void)
+{
+    hashset* good = int_set();
+    hashset* weak = hashset_create(sizeof(int), clump_hash, NULL, NULL);
+    hashset_set_seed(weak, 0); // raw clump_hash placement
+    for (int i = 0; i < 80; i++) {
+        hashset_insert(good, (u8*)&i);
+        hashset_insert(weak, (u8*)&i);
+    }
+
+    map_stats g, w;
+    hashset_stats(good, &g);
+    hashset_stats(weak, &w);
+
+    u64 g_sum = 0, w_sum = 0;
+    for (u32 d = 0; d < MAP_STATS_PSL_SLOTS; d++) {
+        g_sum += g.psl_hist[d];
+        w_sum += w.psl_hist[d];
+    }
+    WC_ASSERT_EQ_U64(g_sum, 80);
+    WC_ASSERT_EQ_U64(w_sum, 80);
+    WC_ASSERT_EQ_U64(g.size, 80);
+    WC_ASSERT_TRUE(g.load_factor == (double)g.size / (double)g.capacity);
+    WC_ASSERT_TRUE(g.bytes >= g.capacity * (sizeof(int) + 1));
+
+    // a clumping hash is obvious from the psls alone
+    WC_ASSERT_TRUE(g.mean_psl < 4.0);
+    WC_ASSERT_TRUE(w.mean_psl > 20.0);
+    WC_ASSERT_TRUE(w.max_psl >= 70);
+
+    hashset_destroy(good);
+    hashset_destroy(weak);
+}
+
+// low 32 bits all 0: unseeded, every elm homes in bucket 0
+static u64 high_bits_hash(const u8* elm, u64 size)
+{
+    (void)size;
+    return (u64)(u32)*(const int*)elm << 32;
+}
+
+static void test_psl_overflow_reseeds(void)
+{
+    hashset* s = hashset_create(sizeof(int), high_bits_hash, NULL, NULL);
+    hashset_set_seed(s, 0);
+
+    for (int i = 0; i < 1000; i++) {
+        WC_ASSERT_FALSE(hashset_insert(s, (u8*)&i));
+    }
+    WC_ASSERT_TRUE(s->seed != 0);
+
+    map_stats st;
+    hashset_stats(s, &st);
+    WC_ASSERT_TRUE(st.max_psl < 16);
+    for (int i = 0; i < 1000; i++) {
+        WC_ASSERT_TRUE(hashset_has(s, (u8*)&i));
+    }
+
+    hashset_reseed(s);
+    WC_ASSERT_EQ_U64(hashset_size(s), 1000);
+    for (int i = 0; i < 1000; i++) {
+        WC_ASSERT_TRUE(hashset_has(s, (u8*)&i));
+    }
+    hashset_destroy(s);
+}
+
+static u64 const_hash(const u8* elm, u64 size)
+{
+    (void)elm;
+    (void)size;
+    return 42;
+}
+
+// no seed splits equal hashes: the set keeps the run (as hashmap)
+static void test_psl_overflow_equal_hashes(void)
+{
+    hashset* s = hashset_create(sizeof(int), const_hash, NULL, NULL);
+    for (int i = 0; i < 200; i++) {
+        WC_ASSERT_FALSE(hashset_insert(s, (u8*)&i));
+    }
+
+    WC_ASSERT_EQ_U64(hashset_size(s), 200);
+    WC_ASSERT_EQ_U64(s->psl_limit, RH_PSL_MAX);
+    WC_ASSERT_FALSE(s->psl_overflow);
+    for (int i = 0; i < 200; i++) {
+        WC_ASSERT_TRUE(hashset_has(s, (u8*)&i));
+    }
+    int missing = 500;
+    WC_ASSERT_FALSE(hashset_has(s, (u8*)&missing));
+    hashset_destroy(s);
+}
+
+// Consecutive elms home 2/5 of a bucket apart (see the hashmap test)
+static u64 dense_hash(const u8* elm, u64 size)
+{
+    (void)size;
+    u64 k = (u64)(u32)*(const int*)elm;
+    return ((k * 2) / 5) | ((k & 1) << 8);
+}
+
+static void test_max_load(void)
+{
+    hashset* s = int_set();
+    hashset_set_max_load(s, 0.9);
+    for (int i = 0; i < 900; i++) {
+        hashset_insert(s, (u8*)&i);
+    }
+    WC_ASSERT_EQ_U64(hashset_capacity(s), 1024);
+
+    hashset_set_max_load(s, 0.5);
+    WC_ASSERT_EQ_U64(hashset_capacity(s), 2048);
+    for (int i = 0; i < 900; i++) {
+        WC_ASSERT_TRUE(hashset_has(s, (u8*)&i));
+    }
+    hashset_destroy(s);
+}
+
+static void test_psl_overflow_dense_grows(void)
+{
+    hashset* s = hashset_create(sizeof(int), dense_hash, NULL, NULL);
+    hashset_set_seed(s, 0);
+    hashset_set_max_load(s, 0.95);
+    for (int i = 0; i < 240; i++) {
+        hashset_insert(s, (u8*)&i);
+    }
+
+    // grew to 256 at 0.95, overflowed at ~0.83 and doubled, same seed
+    WC_ASSERT_EQ_U64(hashset_capacity(s), 512);
+    WC_ASSERT_EQ_U64(s->seed, 0);
+    for (int i = 0; i < 240; i++) {
+        WC_ASSERT_TRUE(hashset_has(s, (u8*)&i));
+    }
+    hashset_destroy(s);
+}
+
+static void test_shrink(void)
+{
+    hashset* s = int_set();
+    for (int i = 0; i < 5000; i++) {
+        hashset_insert(s, (u8*)&i);
+    }
+    for (int i = 50; i < 5000; i++) {
+        hashset_remove(s, (u8*)&i);
+    }
+    WC_ASSERT_EQ_U64(hashset_capacity(s), 8192);
+    hashset_shrink_to_fit(s);
+    WC_ASSERT_EQ_U64(hashset_capacity(s), 128);
+
+    // automatic: removes keep it at least 10% full above the smallest table
+    hashset_set_min_load(s, 0.1);
+    for (int i = 50; i < 5000; i++) {
+        hashset_insert(s, (u8*)&i);
+    }
+    for (int i = 0; i < 4990; i++) {
+        hashset_remove(s, (u8*)&i);
+        WC_ASSERT_TRUE(s->size * 10 >= s->capacity);
+    }
+    WC_ASSERT_EQ_U64(hashset_capacity(s), 32);
+    for (int i = 0; i < 5000; i++) {
+        WC_ASSERT_EQ_INT(hashset_has(s, (u8*)&i), i >= 4990);
+    }
+    hashset_destroy(s);
+}
+
+/* ── set algebra ─────────────────────────────────────────────────────────── */
+
+static hashset* range_set(int from, int to)
+{
+    hashset* s = int_set();
+    for (int i = from; i < to; i++) {
+        hashset_insert(s, (u8*)&i);
+    }
+    return s;
+}
+
+// elms in [from, to) are present, nothing else in [lo, hi) is
+static void assert_exactly(const hashset* s, int from, int to, int lo, int hi)
+{
+    WC_ASSERT_EQ_U64(hashset_size(s), (u64)(to - from));
+    for (int i = lo; i < hi; i++) {
+        WC_ASSERT_EQ_INT(hashset_has(s, (u8*)&i), i >= from && i < to);
+    }
+}
+
+static void test_union_intersect_difference(void)
+{
+    hashset* a   = range_set(0, 1000);
+    hashset* b   = range_set(500, 2500);
+    hashset* out = int_set();
+
+    hashset_union(out, a, b);
+    assert_exactly(out, 0, 2500, -10, 2510);
+
+    hashset_intersect(out, a, b);
+    assert_exactly(out, 500, 1000, -10, 2510);
+    WC_ASSERT_EQ_U64(hashset_intersect_count(a, b), 500);
+    WC_ASSERT_EQ_U64(hashset_intersect_count(b, a), 500);
+
+    hashset_difference(out, a, b); // walks a
+    assert_exactly(out, 0, 500, -10, 2510);
+
+    hashset_difference(out, b, a); // copy of b, then a taken out
+    assert_exactly(out, 1000, 2500, -10, 2510);
+
+    // inputs untouched
+    assert_exactly(a, 0, 1000, -10, 2510);
+    assert_exactly(b, 500, 2500, -10, 2510);
+
+    hashset_destroy(a);
+    hashset_destroy(b);
+    hashset_destroy(out);
+}
+
+static void test_in_place_ops(void)
+{
+    hashset* s     = range_set(0, 3000);
+    hashset* evens = int_set();
+    for (int i = 0; i < 6000; i += 2) {
+        hashset_insert(evens, (u8*)&i);
+    }
+
+    hashset_intersect_with(s, evens); // compaction drops every odd elm
+    WC_ASSERT_EQ_U64(hashset_size(s), 1500);
+    for (int i = 0; i < 6000; i++) {
+        int want = i < 3000 && i % 2 == 0;
+        WC_ASSERT_EQ_INT(hashset_has(s, (u8*)&i), want);
+    }
+
+    hashset_union_with(s, evens);
+    WC_ASSERT_EQ_U64(hashset_size(s), 3000);
+
+    hashset* small = range_set(0, 100);
+    hashset_difference_with(s, small); // walks small, removes one by one
+    WC_ASSERT_EQ_U64(hashset_size(s), 2950);
+
+    hashset_difference_with(small, evens); // walks small, compacts it
+    WC_ASSERT_EQ_U64(hashset_size(small), 50);
+    for (int i = 0; i < 100; i++) {
+        int want = i % 2 == 1;
+        WC_ASSERT_EQ_INT(hashset_has(small, (u8*)&i), want);
+    }
+
+    // a set with itself
+    hashset_union_with(small, small);
+    hashset_intersect_with(small, small);
+    WC_ASSERT_EQ_U64(hashset_size(small), 50);
+    hashset_difference_with(small, small);
+    WC_ASSERT_TRUE(hashset_empty(small));
+
+    hashset_destroy(s);
+    hashset_destroy(evens);
+    hashset_destroy(small);
+}
+
+// Unseeded, every elm homes in the last 8 buckets: one long run that wraps
+static u64 tail_wrap_hash(const u8* elm, u64 size)
+{
+    (void)size;
+    return ~(u64)(*(const int*)elm % 8);
+}
+
+static void test_compact_wrapped_runs(void)
+{
+    hashset* s = hashset_create(sizeof(int), tail_wrap_hash, NULL, NULL);
+    hashset_set_seed(s, 0);
+    for (int i = 0; i < 60; i++) {
+        hashset_insert(s, (u8*)&i);
+    }
+    WC_ASSERT_EQ_U64(hashset_capacity(s), 128);
+
+    hashset* keep = int_set();
+    for (int i = 0; i < 60; i += 3) {
+        hashset_insert(keep, (u8*)&i);
+    }
+    hashset_intersect_with(s, keep);
+    WC_ASSERT_EQ_U64(hashset_size(s), 20);
+
+    // the compacted run is still a valid Robin Hood run: every psl matches
+    // the distance from home, and every elm is found
+    for (u64 i = 0; i < s->capacity; i++) {
+        if (s->psls[i]) {
+            u64 home = tail_wrap_hash(s->elms + (i * sizeof(int)), sizeof(int)) & (s->capacity - 1);
+            WC_ASSERT_EQ_U64(s->psls[i], ((i - home) & (s->capacity - 1)) + 1);
+        }
+    }
+    for (int i = 0; i < 60; i++) {
+        int want = i % 3 == 0;
+        WC_ASSERT_EQ_INT(hashset_has(s, (u8*)&i), want);
+    }
+
+    hashset_destroy(s);
+    hashset_destroy(keep);
+}
+
+static void test_set_ops_owned_strings(void)
+{
+    hashset* a = str_set();
+    hashset* b = str_set();
+    char     buf[16];
+    for (int i = 0; i < 200; i++) {
+        snprintf(buf, sizeof(buf), "id_%d", i);
+        SET_INSERT_CSTR(a, buf);
+        snprintf(buf, sizeof(buf), "id_%d", i + 100);
+        SET_INSERT_CSTR(b, buf);
+    }
+
+    hashset* out = str_set();
+    hashset_intersect(out, a, b);
+    WC_ASSERT_EQ_U64(hashset_size(out), 100);
+    hashset_union(out, a, b);
+    WC_ASSERT_EQ_U64(hashset_size(out), 300);
+    hashset_difference(out, a, b);
+    WC_ASSERT_EQ_U64(hashset_size(out), 100);
+
+    hashset_intersect_with(a, b); // dropped Strings are destroyed
+    WC_ASSERT_EQ_U64(hashset_size(a), 100);
+    String probe;
+    string_create_stk(&probe, "id_150");
+    WC_ASSERT_TRUE(hashset_has(a, (u8*)&probe));
+    string_destroy_stk(&probe);
+
+    hashset_destroy(a);
+    hashset_destroy(b);
+    hashset_destroy(out);
+}
+
+static int int_cmp(const u8* a, const u8* b, u64 size)
+{
+    (void)size;
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static void test_sorted_export(void)
+{
+    hashset* s = int_set();
+    for (int i = 0; i < 500; i++) {
+        int x = (i * 7919) % 500 - 250;
+        hashset_insert(s, (u8*)&x);
+    }
+    genVec* v = hashset_sorted(s, int_cmp);
+    WC_ASSERT_EQ_U64(genVec_size(v), 500);
+    for (int i = 0; i < 500; i++) {
+        WC_ASSERT_EQ_INT(VEC_AT(v, int, i), i - 250);
+    }
+    genVec_destroy(v);
+    hashset_destroy(s);
+}
+
+static void test_stats_counters(void)
+{
+    hashset* s = int_set();
+    for (int i = 0; i < 20; i++) {
+        hashset_insert(s, (u8*)&i);
+    }
+    hashset_stats_reset(s);
+    for (int i = 0; i < 5; i++) {
+        WC_ASSERT_TRUE(hashset_has(s, (u8*)&i));
+    }
+
+    map_stats st;
+    hashset_stats(s, &st);
+#if WC_MAP_STATS
+    WC_ASSERT_EQ_U64(st.counters.lookups, 5);
+    WC_ASSERT_TRUE(st.counters.compares >= 5);
+    WC_ASSERT_TRUE(st.counters.probes >= 5);
+#else
+    WC_ASSERT_EQ_U64(st.counters.lookups, 0);
+    WC_ASSERT_EQ_U64(st.counters.probes, 0);
+    WC_ASSERT_EQ_U64(st.counters.compares, 0);
+#endif
+    WC_ASSERT_EQ_U64(st.counters.resizes, 0);
+    hashset_destroy(s);
+}
+
+
 /* ════════════════════════════════════════════════════════════════════════════
  * hashset_clear
  * ════════════════════════════════════════════════════════════════════════════ */
@@ -649,6 +1184,96 @@ static void test_clear_empty_set_noop(void)
 }
 
 
+/* ── snapshots ───────────────────────────────────────────────────────────── */
+
+#define SET_SNAP_PATH "/tmp/wc_hashset_test.snap"
+
+static void test_snapshot_round_trip(void)
+{
+    hashset* s = int_set();
+    for (int i = 0; i < 3000; i += 2) {
+        hashset_insert(s, (u8*)&i);
+    }
+    WC_ASSERT_TRUE(hashset_save(s, SET_SNAP_PATH));
+
+    hashset* l = hashset_load_mmap(SET_SNAP_PATH, NULL, NULL);
+    WC_ASSERT_NOT_NULL(l);
+    WC_ASSERT_TRUE(l->read_only);
+    WC_ASSERT_EQ_U64(hashset_size(l), 1500);
+    for (int i = 0; i < 3000; i++) {
+        int want = i % 2 == 0;
+        WC_ASSERT_EQ_INT(hashset_has(l, (u8*)&i), want);
+    }
+    WC_ASSERT_EQ_U64(hashset_intersect_count(l, s), 1500);
+
+    // another hash_fn would look in the wrong buckets
+    wc_errno = WC_OK;
+    WC_ASSERT_NULL(hashset_load_mmap(SET_SNAP_PATH, const_hash, NULL));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_IO);
+
+    // a map snapshot is not a set snapshot
+    hashmap* m = hashmap_create(sizeof(int), sizeof(int), NULL, NULL, NULL, NULL);
+    WC_ASSERT_TRUE(hashmap_save(m, SET_SNAP_PATH));
+    wc_errno = WC_OK;
+    WC_ASSERT_NULL(hashset_load_mmap(SET_SNAP_PATH, NULL, NULL));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_IO);
+
+    hashmap_destroy(m);
+    hashset_destroy(l);
+    hashset_destroy(s);
+    remove(SET_SNAP_PATH);
+}
+
+static void test_snapshot_promote_then_mutate(void)
+{
+    hashset* s = int_set();
+    for (int i = 0; i < 1000; i++) {
+        hashset_insert(s, (u8*)&i);
+    }
+    WC_ASSERT_TRUE(hashset_save(s, SET_SNAP_PATH));
+
+    hashset* l = hashset_load_mmap(SET_SNAP_PATH, NULL, NULL);
+    hashset_promote(l);
+    WC_ASSERT_FALSE(l->read_only);
+
+    int x = 5;
+    WC_ASSERT_TRUE(hashset_remove(l, (u8*)&x));
+    x = 5000;
+    WC_ASSERT_FALSE(hashset_insert(l, (u8*)&x));
+
+    // in-place removals compact inside the mapping
+    hashset* odd = int_set();
+    for (int i = 1; i < 1000; i += 2) {
+        hashset_insert(odd, (u8*)&i);
+    }
+    hashset_difference_with(l, odd);
+    WC_ASSERT_EQ_U64(hashset_size(l), 501); // the evens and 5000
+
+    // the file still holds the saved set
+    hashset* again = hashset_load_mmap(SET_SNAP_PATH, NULL, NULL);
+    WC_ASSERT_EQ_U64(hashset_size(again), 1000);
+    x = 5;
+    WC_ASSERT_TRUE(hashset_has(again, (u8*)&x));
+    hashset_destroy(again);
+
+    // growing moves to the heap
+    for (int i = 10000; i < 20000; i++) {
+        hashset_insert(l, (u8*)&i);
+    }
+    WC_ASSERT_NULL(l->snapshot);
+    WC_ASSERT_EQ_U64(hashset_size(l), 10501);
+    x = 5000;
+    WC_ASSERT_TRUE(hashset_has(l, (u8*)&x));
+    x = 4;
+    WC_ASSERT_TRUE(hashset_has(l, (u8*)&x));
+
+    hashset_destroy(odd);
+    hashset_destroy(l);
+    hashset_destroy(s);
+    remove(SET_SNAP_PATH);
+}
+
+
 /* ── SET_FOREACH macro ───────────────────────────────────────────────────── */
 
 static void test_set_foreach_visits_all(void)
@@ -724,6 +1349,38 @@ void hashset_suite(void)
     WC_RUN(test_remove_first_in_chain);
     WC_RUN(test_remove_all_then_reinsert);
 
+    WC_SUITE("HashSet — insert shifting");
+    WC_RUN(test_insert_shift_long_runs);
+    WC_RUN(test_insert_shift_owned_elms);
+
+    WC_SUITE("HashSet — precomputed hash");
+    WC_RUN(test_with_hash_single_hash_per_key);
+    WC_RUN(test_with_hash_matches_plain_calls);
+
+    WC_SUITE("HashSet — arena storage");
+    WC_RUN(test_arena_set_pod);
+    WC_RUN(test_arena_set_owned_strings);
+
+    WC_SUITE("HashSet — snapshots");
+    WC_RUN(test_snapshot_round_trip);
+    WC_RUN(test_snapshot_promote_then_mutate);
+
+    WC_SUITE("HashSet — stats");
+    WC_RUN(test_stats_shape);
+    WC_RUN(test_stats_counters);
+    WC_RUN(test_psl_overflow_reseeds);
+    WC_RUN(test_psl_overflow_equal_hashes);
+    WC_RUN(test_max_load);
+    WC_RUN(test_psl_overflow_dense_grows);
+    WC_RUN(test_shrink);
+
+    WC_SUITE("HashSet — set algebra");
+    WC_RUN(test_union_intersect_difference);
+    WC_RUN(test_in_place_ops);
+    WC_RUN(test_compact_wrapped_runs);
+    WC_RUN(test_set_ops_owned_strings);
+    WC_RUN(test_sorted_export);
+
     WC_SUITE("HashSet — clear");
     WC_RUN(test_clear_empties_set);
     WC_RUN(test_clear_then_reuse);
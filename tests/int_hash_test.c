@@ -0,0 +1,265 @@
+#include "wc_test.h"
+#include "int_hash_generic.h"
+
+
+INSTANTIATE_INT_SET(u64, "%lu")
+INSTANTIATE_INT_SET(int, "%d")
+INSTANTIATE_INT_MAP(u32, u64)
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * IntSet
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_set_insert_has_remove(void)
+{
+    IntSet_u64* s = intset_create_u64();
+
+    WC_ASSERT_FALSE(intset_has_u64(s, 42));
+    WC_ASSERT_FALSE(intset_insert_u64(s, 42));
+    WC_ASSERT_TRUE(intset_insert_u64(s, 42)); // already existed
+    WC_ASSERT_TRUE(intset_has_u64(s, 42));
+    WC_ASSERT_EQ_U64(s->size, 1);
+
+    WC_ASSERT_TRUE(intset_remove_u64(s, 42));
+    WC_ASSERT_FALSE(intset_remove_u64(s, 42));
+    WC_ASSERT_FALSE(intset_has_u64(s, 42));
+    WC_ASSERT_EQ_U64(s->size, 0);
+
+    intset_destroy_u64(s);
+}
+
+// 0 is the empty-slot sentinel, so it lives outside the table
+static void test_set_zero_key(void)
+{
+    IntSet_u64* s = intset_create_u64();
+
+    WC_ASSERT_FALSE(intset_has_u64(s, 0));
+    WC_ASSERT_FALSE(intset_insert_u64(s, 0));
+    WC_ASSERT_TRUE(intset_insert_u64(s, 0));
+    WC_ASSERT_TRUE(intset_has_u64(s, 0));
+    WC_ASSERT_EQ_U64(s->size, 1);
+
+    intset_insert_u64(s, 7);
+    WC_ASSERT_EQ_U64(s->size, 2);
+
+    WC_ASSERT_TRUE(intset_remove_u64(s, 0));
+    WC_ASSERT_FALSE(intset_has_u64(s, 0));
+    WC_ASSERT_TRUE(intset_has_u64(s, 7));
+    WC_ASSERT_EQ_U64(s->size, 1);
+
+    intset_destroy_u64(s);
+}
+
+static void test_set_grow_and_remove_half(void)
+{
+    IntSet_u64* s = intset_create_u64();
+    const u64   n = 20000;
+
+    for (u64 i = 0; i < n; i++) {
+        intset_insert_u64(s, i * 3);
+    }
+    WC_ASSERT_EQ_U64(s->size, n);
+    WC_ASSERT_TRUE(s->capacity >= n);
+
+    // remove the odd entries: backward shift has to keep every run reachable
+    for (u64 i = 1; i < n; i += 2) {
+        WC_ASSERT_TRUE(intset_remove_u64(s, i * 3));
+    }
+    WC_ASSERT_EQ_U64(s->size, n / 2);
+
+    for (u64 i = 0; i < n; i++) {
+        int want = (i % 2) == 0;
+        WC_ASSERT_EQ_INT(intset_has_u64(s, i * 3), want);
+        WC_ASSERT_FALSE(intset_has_u64(s, (i * 3) + 1));
+    }
+
+    intset_destroy_u64(s);
+}
+
+// Strided keys land in one bucket under identity hashing; the mix spreads them
+static void test_set_strided_keys(void)
+{
+    IntSet_u64* s = intset_create_u64();
+
+    for (u64 i = 1; i <= 4096; i++) {
+        intset_insert_u64(s, i << 32);
+    }
+    for (u64 i = 1; i <= 4096; i++) {
+        WC_ASSERT_TRUE(intset_has_u64(s, i << 32));
+    }
+    WC_ASSERT_EQ_U64(s->size, 4096);
+
+    intset_destroy_u64(s);
+}
+
+static void test_set_signed_keys(void)
+{
+    IntSet_int* s = intset_create_int();
+
+    for (int i = -500; i <= 500; i++) {
+        intset_insert_int(s, i);
+    }
+    WC_ASSERT_EQ_U64(s->size, 1001);
+    for (int i = -500; i <= 500; i++) {
+        WC_ASSERT_TRUE(intset_has_int(s, i));
+    }
+    WC_ASSERT_FALSE(intset_has_int(s, -501));
+    WC_ASSERT_FALSE(intset_has_int(s, 501));
+
+    intset_destroy_int(s);
+}
+
+static void test_set_reserve_and_clear(void)
+{
+    IntSet_u64* s = intset_create_u64();
+
+    intset_reserve_u64(s, 1000);
+    u64 cap = s->capacity;
+    WC_ASSERT_TRUE(cap >= 1024);
+
+    for (u64 i = 0; i < 1000; i++) {
+        intset_insert_u64(s, i);
+    }
+    WC_ASSERT_EQ_U64(s->capacity, cap); // no growth after reserve
+
+    intset_clear_u64(s);
+    WC_ASSERT_EQ_U64(s->size, 0);
+    WC_ASSERT_EQ_U64(s->capacity, cap);
+    WC_ASSERT_FALSE(intset_has_u64(s, 0));
+    WC_ASSERT_FALSE(intset_has_u64(s, 999));
+
+    intset_insert_u64(s, 5);
+    WC_ASSERT_TRUE(intset_has_u64(s, 5));
+
+    intset_destroy_u64(s);
+}
+
+// Random inserts/removes checked against a plain presence array
+static void test_set_matches_reference(void)
+{
+    IntSet_u64* s = intset_create_u64();
+    b8          ref[512] = {0};
+    u64         size     = 0;
+    u64         r        = 0x243F6A8885A308D3ULL;
+
+    for (u32 i = 0; i < 50000; i++) {
+        r     = (r * 6364136223846793005ULL) + 1442695040888963407ULL;
+        u64 k = (r >> 33) % 512;
+        if ((r >> 20) & 1) {
+            WC_ASSERT_EQ_INT(intset_insert_u64(s, k), ref[k]);
+            size += !ref[k];
+            ref[k] = 1;
+        } else {
+            WC_ASSERT_EQ_INT(intset_remove_u64(s, k), ref[k]);
+            size -= ref[k];
+            ref[k] = 0;
+        }
+    }
+
+    WC_ASSERT_EQ_U64(s->size, size);
+    for (u64 k = 0; k < 512; k++) {
+        WC_ASSERT_EQ_INT(intset_has_u64(s, k), ref[k]);
+    }
+
+    intset_destroy_u64(s);
+}
+
+
+/* ════════════════════════════════════════════════════════════════════════════
+ * IntMap
+ * ════════════════════════════════════════════════════════════════════════════ */
+
+static void test_map_put_get_update(void)
+{
+    IntMap_u32_u64* m = intmap_create_u32_u64();
+    u64             v = 0;
+
+    WC_ASSERT_FALSE(intmap_get_u32_u64(m, 1, &v));
+    WC_ASSERT_FALSE(intmap_put_u32_u64(m, 1, 100));
+    WC_ASSERT_TRUE(intmap_get_u32_u64(m, 1, &v));
+    WC_ASSERT_EQ_U64(v, 100);
+
+    WC_ASSERT_TRUE(intmap_put_u32_u64(m, 1, 200)); // update
+    WC_ASSERT_TRUE(intmap_get_u32_u64(m, 1, &v));
+    WC_ASSERT_EQ_U64(v, 200);
+    WC_ASSERT_EQ_U64(m->size, 1);
+
+    *intmap_get_ptr_u32_u64(m, 1) += 5;
+    WC_ASSERT_TRUE(intmap_get_u32_u64(m, 1, &v));
+    WC_ASSERT_EQ_U64(v, 205);
+    WC_ASSERT_NULL(intmap_get_ptr_u32_u64(m, 2));
+
+    intmap_destroy_u32_u64(m);
+}
+
+static void test_map_zero_key(void)
+{
+    IntMap_u32_u64* m = intmap_create_u32_u64();
+    u64             v = 0;
+
+    WC_ASSERT_FALSE(intmap_has_u32_u64(m, 0));
+    WC_ASSERT_FALSE(intmap_put_u32_u64(m, 0, 11));
+    WC_ASSERT_TRUE(intmap_put_u32_u64(m, 0, 12));
+    WC_ASSERT_TRUE(intmap_get_u32_u64(m, 0, &v));
+    WC_ASSERT_EQ_U64(v, 12);
+    WC_ASSERT_EQ_U64(m->size, 1);
+
+    WC_ASSERT_TRUE(intmap_del_u32_u64(m, 0, &v));
+    WC_ASSERT_EQ_U64(v, 12);
+    WC_ASSERT_FALSE(intmap_del_u32_u64(m, 0, NULL));
+    WC_ASSERT_EQ_U64(m->size, 0);
+
+    intmap_destroy_u32_u64(m);
+}
+
+static void test_map_grow_and_del(void)
+{
+    IntMap_u32_u64* m = intmap_create_u32_u64();
+    const u32       n = 50000;
+
+    for (u32 i = 1; i <= n; i++) {
+        intmap_put_u32_u64(m, i, (u64)i * 10);
+    }
+    WC_ASSERT_EQ_U64(m->size, n);
+
+    u64 out = 0;
+    for (u32 i = 1; i <= n; i += 3) {
+        WC_ASSERT_TRUE(intmap_del_u32_u64(m, i, &out));
+        WC_ASSERT_EQ_U64(out, (u64)i * 10);
+    }
+
+    for (u32 i = 1; i <= n; i++) {
+        u64 v    = 0;
+        b8  hit  = intmap_get_u32_u64(m, i, &v);
+        b8  want = (i - 1) % 3 != 0;
+        WC_ASSERT_EQ_INT(hit, want);
+        if (hit) {
+            WC_ASSERT_EQ_U64(v, (u64)i * 10); // vals moved with their keys
+        }
+    }
+
+    intmap_clear_u32_u64(m);
+    WC_ASSERT_EQ_U64(m->size, 0);
+    WC_ASSERT_FALSE(intmap_has_u32_u64(m, 2));
+
+    intmap_destroy_u32_u64(m);
+}
+
+
+void int_hash_suite(void)
+{
+    WC_SUITE("IntSet (macro-generated)");
+    WC_RUN(test_set_insert_has_remove);
+    WC_RUN(test_set_zero_key);
+    WC_RUN(test_set_grow_and_remove_half);
+    WC_RUN(test_set_strided_keys);
+    WC_RUN(test_set_signed_keys);
+    WC_RUN(test_set_reserve_and_clear);
+    WC_RUN(test_set_matches_reference);
+
+    WC_SUITE("IntMap (macro-generated)");
+    WC_RUN(test_map_put_get_update);
+    WC_RUN(test_map_zero_key);
+    WC_RUN(test_map_grow_and_del);
+}
@@ -8,13 +8,31 @@
  */
 #include "wc_test.h"
 #include "gen_vector.h"
+#include "gen_vector_par.h"
+#include "vec_generic.h"
 #include "hashmap.h"
+#include "hashmap_flat.h"
+#include "hashmap_packed.h"
+#include "hashmap_concurrent.h"
+#include "hashset.h"
+#include "int_hash_generic.h"
+#include "bloom.h"
+#include "random.h"
+#include "arena.h"
 #include "String.h"
 #include "wc_helpers.h"
+#include "wc_macros.h"
 
 #include <time.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+
+
+VEC_INSTANTIATE(int)
+VEC_INSTANTIATE(float)
+VEC_INSTANTIATE(String)
 
 
 // ─── Timing helpers ──────────────────────────────────────────────────────────
@@ -487,102 +505,2018 @@ static void bench_map_clear_cx(void)
 
 
 // ═══════════════════════════════════════════════════════════════════════════════
-// SUITE 8: pop (single-element, copy + del path)
+// SUITE 7b: hashmap_put ingest (16B key -> 8B val, high load)
+//
+// Robin Hood insert shifts the displaced run one slot right and constructs the
+// new entry in place. Per put that moves (K + V) bytes per displaced entry
+// plus one (K + V) write, where the old stage/swap scheme moved 2 * (K + V)
+// per eviction on top of staging the incoming pair through scratch.
 // ═══════════════════════════════════════════════════════════════════════════════
 
-#define POP_N 500000
+#define INGEST_CAP (1u << 18)
+#define INGEST_N   ((INGEST_CAP / 4) * 3 - 1) // stops one short of the grow threshold
 
-static void bench_pop_pod(void)
+typedef struct {
+    u64 lo;
+    u64 hi;
+} bench_key16;
+
+static void bench_map_put_16b_ingest(void)
 {
-    genVec* v = genVec_init(POP_N, sizeof(int), NULL);
-    int val   = 1;
-    for (int i = 0; i < POP_N; i++) genVec_push(v, (u8*)&val);
+    hashmap* map = hashmap_create(sizeof(bench_key16), sizeof(u64), NULL, NULL, NULL, NULL);
 
-    int out = 0;
-    u64 t0  = ns_now();
-    for (int i = 0; i < POP_N; i++) genVec_pop(v, (u8*)&out);
+    // capacity reaches INGEST_CAP well before INGEST_CAP / 2 entries,
+    // so [half, INGEST_N) runs at load 0.50 -> 0.75 with no resize
+    u64 half  = INGEST_CAP / 2;
+    u64 t_mid = 0;
+
+    u64 t0 = ns_now();
+    for (u64 i = 0; i < INGEST_N; i++) {
+        if (i == half) {
+            t_mid = ns_now();
+        }
+        bench_key16 k = {i * 0x9E3779B97F4A7C15ULL, i};
+        hashmap_put(map, (u8*)&k, (u8*)&i);
+    }
     u64 t1 = ns_now();
 
-    WC_ASSERT_EQ_U64(v->size, 0);
-    bench("pop POD (int)", POP_N, t0, t1);
-    genVec_destroy(v);
+    WC_ASSERT_EQ_U64(map->size, INGEST_N);
+    WC_ASSERT_EQ_U64(map->capacity, INGEST_CAP);
+    bench("hashmap_put 16B->8B (all, with resizes)", INGEST_N, t0, t1);
+    bench("hashmap_put 16B->8B (load 0.50 -> 0.75)", INGEST_N - half, t_mid, t1);
+    hashmap_destroy(map);
 }
 
-static void bench_pop_cx(void)
+static void bench_map_put_16b_churn(void)
 {
-    genVec* v = genVec_init(POP_N, sizeof(String), &wc_str_ops);
-    for (int i = 0; i < POP_N; i++) {
-        String s;
-        string_create_stk(&s, "pop");
-        genVec_push(v, (u8*)&s);
-        string_destroy_stk(&s);
+    // steady state at 0.75 load: delete one key, insert a fresh one
+    hashmap* map = hashmap_create(sizeof(bench_key16), sizeof(u64), NULL, NULL, NULL, NULL);
+    for (u64 i = 0; i < INGEST_N; i++) {
+        bench_key16 k = {i * 0x9E3779B97F4A7C15ULL, i};
+        hashmap_put(map, (u8*)&k, (u8*)&i);
     }
 
     u64 t0 = ns_now();
-    for (int i = 0; i < POP_N; i++) genVec_pop(v, NULL);
+    for (u64 i = INGEST_N; i < 2 * (u64)INGEST_N; i++) {
+        u64         old = i - INGEST_N;
+        bench_key16 dk  = {old * 0x9E3779B97F4A7C15ULL, old};
+        bench_key16 k   = {i * 0x9E3779B97F4A7C15ULL, i};
+        hashmap_del(map, (u8*)&dk, NULL);
+        hashmap_put(map, (u8*)&k, (u8*)&i);
+    }
     u64 t1 = ns_now();
 
-    WC_ASSERT_EQ_U64(v->size, 0);
-    bench("pop CX (String, del)", POP_N, t0, t1);
-    genVec_destroy(v);
+    WC_ASSERT_EQ_U64(map->size, INGEST_N);
+    bench("hashmap del+put 16B->8B (load 0.75)", INGEST_N, t0, t1);
+    hashmap_destroy(map);
 }
 
 
 // ═══════════════════════════════════════════════════════════════════════════════
-// Suites
+// SUITE 7c: hash cache (String keys — expensive hash + compare)
 // ═══════════════════════════════════════════════════════════════════════════════
 
-void suite_push(void)
+#define HCACHE_N 200000
+
+static void bench_map_str_hash_cache(b8 cached)
 {
-    WC_SUITE("push  (1M ops)");
-    WC_RUN(bench_push_pod);
-    WC_RUN(bench_push_cx);
+    hashmap* map = hashmap_create(sizeof(String), sizeof(int), wyhash_str, str_cmp,
+                                  &wc_str_ops, NULL);
+    hashmap_set_hash_cache(map, cached);
+
+    String* keys = malloc(sizeof(String) * HCACHE_N);
+    for (int i = 0; i < HCACHE_N; i++) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "some/longer/path/segment/key_%d", i);
+        string_create_stk(&keys[i], buf);
+    }
+
+    u64 t0 = ns_now();
+    for (int i = 0; i < HCACHE_N; i++) {
+        hashmap_put(map, (u8*)&keys[i], (u8*)&i);
+    }
+    u64 t1 = ns_now();
+
+    int hits = 0;
+    for (int i = 0; i < HCACHE_N; i++) {
+        hits += hashmap_has(map, (u8*)&keys[i]);
+    }
+    u64 t2 = ns_now();
+
+    WC_ASSERT_EQ_INT(hits, HCACHE_N);
+    bench(cached ? "put String key (hash cache on)" : "put String key (hash cache off)",
+          HCACHE_N, t0, t1);
+    bench(cached ? "has String key (hash cache on)" : "has String key (hash cache off)",
+          HCACHE_N, t1, t2);
+
+    for (int i = 0; i < HCACHE_N; i++) {
+        string_destroy_stk(&keys[i]);
+    }
+    free(keys);
+    hashmap_destroy(map);
 }
 
-void suite_clear_destroy(void)
+static void bench_map_str_cache_off(void) { bench_map_str_hash_cache(0); }
+static void bench_map_str_cache_on(void)  { bench_map_str_hash_cache(1); }
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7d: hashmap vs hashmap_flat lookups (u64 -> u64, 1M entries)
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Both maps hold the same keys; queries come in scattered order so every
+// lookup is a cache miss on the table. hit_pct of the queries are present.
+
+#define LOOKUP_N (1u << 20)
+
+static u64 lookup_key(u64 i)
 {
-    WC_SUITE("clear / destroy  (bulk del loop — biggest POD win)");
-    WC_RUN(bench_clear_pod);
-    WC_RUN(bench_clear_cx);
-    WC_RUN(bench_destroy_pod);
-    WC_RUN(bench_destroy_cx);
+    return (i + 1) * 0x9E3779B97F4A7C15ULL;
 }
 
-void suite_copy(void)
+static u64* lookup_queries(u32 hit_pct)
 {
-    WC_SUITE("genVec_copy  (bulk memcpy vs per-element copy_fn)");
-    WC_RUN(bench_vec_copy_pod);
-    WC_RUN(bench_vec_copy_cx);
+    u64* q = malloc(sizeof(u64) * LOOKUP_N);
+    u64  s = 0x243F6A8885A308D3ULL;
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        s       = (s * 6364136223846793005ULL) + 1442695040888963407ULL;
+        u64 idx = (s >> 20) & (LOOKUP_N - 1);
+        q[i]    = ((s >> 50) % 100 < hit_pct) ? lookup_key(idx) : lookup_key(idx + LOOKUP_N);
+    }
+    return q;
 }
 
-void suite_init_val(void)
+static void bench_lookup_rh_vs_flat(u32 hit_pct, const char* rh_label, const char* flat_label)
 {
-    WC_SUITE("init_val  (broadcast fill)");
-    WC_RUN(bench_init_val_pod);
-    WC_RUN(bench_init_val_cx);
+    hashmap*      rh   = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    hashmap_flat* flat = hashmap_flat_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hashmap_put(rh, (u8*)&k, (u8*)&i);
+        hashmap_flat_put(flat, (u8*)&k, (u8*)&i);
+    }
+    u64* q = lookup_queries(hit_pct);
+
+    u64 rh_hits = 0, rh_sum = 0;
+    u64 t0 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 v;
+        if (hashmap_get(rh, (u8*)&q[i], (u8*)&v)) {
+            rh_hits++;
+            rh_sum += v;
+        }
+    }
+    u64 t1 = ns_now();
+
+    u64 flat_hits = 0, flat_sum = 0;
+    u64 t2 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 v;
+        if (hashmap_flat_get(flat, (u8*)&q[i], (u8*)&v)) {
+            flat_hits++;
+            flat_sum += v;
+        }
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_EQ_U64(rh_hits, flat_hits);
+    WC_ASSERT_EQ_U64(rh_sum, flat_sum);
+    bench(rh_label, LOOKUP_N, t0, t1);
+    bench(flat_label, LOOKUP_N, t2, t3);
+
+    free(q);
+    hashmap_destroy(rh);
+    hashmap_flat_destroy(flat);
 }
 
-void suite_remove_range(void)
+static void bench_lookup_hit(void)
 {
-    WC_SUITE("remove_range  (bulk del loop)");
-    WC_RUN(bench_remove_range_pod);
-    WC_RUN(bench_remove_range_cx);
+    bench_lookup_rh_vs_flat(100, "get hit    hashmap", "get hit    hashmap_flat");
 }
 
-void suite_map_put_get(void)
+static void bench_lookup_miss(void)
 {
-    WC_SUITE("hashmap put / get  (hot path)");
-    WC_RUN(bench_map_put_pod);
-    WC_RUN(bench_map_put_cx);
-    WC_RUN(bench_map_get_pod);
-    WC_RUN(bench_map_get_cx);
+    bench_lookup_rh_vs_flat(0, "get miss   hashmap", "get miss   hashmap_flat");
 }
 
-void suite_map_clear(void)
+static void bench_lookup_mixed(void)
 {
-    WC_SUITE("hashmap_clear  (bulk del loop)");
-    WC_RUN(bench_map_clear_pod);
-    WC_RUN(bench_map_clear_cx);
+    bench_lookup_rh_vs_flat(50, "get 50/50  hashmap", "get 50/50  hashmap_flat");
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7e: batched get / put (prefetch ahead of probing)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+static void bench_map_get_batched(u32 hit_pct, const char* one_label, const char* many_label)
+{
+    hashmap* map = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hashmap_put(map, (u8*)&k, (u8*)&i);
+    }
+    u64* q   = lookup_queries(hit_pct);
+    u64* out = malloc(sizeof(u64) * LOOKUP_N);
+
+    u64 one_hits = 0;
+    u64 t0       = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        one_hits += hashmap_get(map, (u8*)&q[i], (u8*)&out[i]);
+    }
+    u64 t1 = ns_now();
+
+    u64 many_hits = hashmap_get_many(map, (u8*)q, LOOKUP_N, (u8*)out, NULL);
+    u64 t2        = ns_now();
+
+    WC_ASSERT_EQ_U64(one_hits, many_hits);
+    bench(one_label, LOOKUP_N, t0, t1);
+    bench(many_label, LOOKUP_N, t1, t2);
+
+    free(q);
+    free(out);
+    hashmap_destroy(map);
+}
+
+static void bench_map_get_many_hit(void)
+{
+    bench_map_get_batched(100, "get hit    one at a time", "get hit    hashmap_get_many");
+}
+
+static void bench_map_get_many_mixed(void)
+{
+    bench_map_get_batched(50, "get 50/50  one at a time", "get 50/50  hashmap_get_many");
+}
+
+static void bench_map_put_many(void)
+{
+    u64* keys = malloc(sizeof(u64) * LOOKUP_N);
+    u64* vals = malloc(sizeof(u64) * LOOKUP_N);
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        keys[i] = lookup_key(i);
+        vals[i] = i;
+    }
+
+    hashmap* one  = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    hashmap* many = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+
+    u64 t0 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        hashmap_put(one, (u8*)&keys[i], (u8*)&vals[i]);
+    }
+    u64 t1 = ns_now();
+    hashmap_put_many(many, (u8*)keys, (u8*)vals, LOOKUP_N);
+    u64 t2 = ns_now();
+
+    WC_ASSERT_EQ_U64(hashmap_size(one), hashmap_size(many));
+    bench("put        one at a time", LOOKUP_N, t0, t1);
+    bench("put        hashmap_put_many", LOOKUP_N, t1, t2);
+
+    free(keys);
+    free(vals);
+    hashmap_destroy(one);
+    hashmap_destroy(many);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7f: precomputed hash (has-then-put on long String keys)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define PREHASH_N 200000
+
+static void bench_map_has_then_put(b8 prehash)
+{
+    hashmap* map = hashmap_create(sizeof(String), sizeof(int), wyhash_str, str_cmp,
+                                  &wc_str_ops, NULL);
+
+    String* keys = malloc(sizeof(String) * PREHASH_N);
+    for (int i = 0; i < PREHASH_N; i++) {
+        char buf[96];
+        snprintf(buf, sizeof(buf), "/var/lib/service/cache/objects/by-name/entry_%08d.bin", i / 2);
+        string_create_stk(&keys[i], buf); // every key shows up twice
+    }
+
+    u64 t0 = ns_now();
+    for (int i = 0; i < PREHASH_N; i++) {
+        if (prehash) {
+            u64 h = hashmap_hash(map, (u8*)&keys[i]);
+            if (!hashmap_has_with_hash(map, (u8*)&keys[i], h)) {
+                hashmap_put_with_hash(map, (u8*)&keys[i], (u8*)&i, h);
+            }
+        } else if (!hashmap_has(map, (u8*)&keys[i])) {
+            hashmap_put(map, (u8*)&keys[i], (u8*)&i);
+        }
+    }
+    u64 t1 = ns_now();
+
+    WC_ASSERT_EQ_U64(hashmap_size(map), PREHASH_N / 2);
+    bench(prehash ? "has-then-put  hashmap_hash + *_with_hash" : "has-then-put  hashing twice",
+          PREHASH_N, t0, t1);
+
+    for (int i = 0; i < PREHASH_N; i++) {
+        string_destroy_stk(&keys[i]);
+    }
+    free(keys);
+    hashmap_destroy(map);
+}
+
+static void bench_map_has_then_put_rehash(void) { bench_map_has_then_put(0); }
+static void bench_map_has_then_put_prehash(void) { bench_map_has_then_put(1); }
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7g: hashmap_concurrent throughput, 1..N threads (90% get / 10% put)
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Every thread runs CONC_OPS operations on keys drawn from CONC_KEYS.
+// Reported ns/op is wall time / total ops across all threads, so it drops as
+// threads are added if the map scales. The baseline is one hashmap behind a
+// single pthread rwlock.
+
+#define CONC_KEYS (1u << 18)
+#define CONC_OPS  400000
+
+typedef struct {
+    hashmap_concurrent* cmap;
+    hashmap*            map;
+    pthread_rwlock_t*   lock;
+    u64                 seed;
+    u64                 hits;
+} conc_ctx;
+
+static void* conc_worker(void* arg)
+{
+    conc_ctx* c = arg;
+    u64       s = c->seed;
+    for (u64 i = 0; i < CONC_OPS; i++) {
+        s       = (s * 6364136223846793005ULL) + 1442695040888963407ULL;
+        u64 k   = lookup_key((s >> 24) & (CONC_KEYS - 1));
+        b8  put = ((s >> 56) % 10) == 0;
+
+        if (c->cmap) {
+            if (put) {
+                hashmap_concurrent_put(c->cmap, (u8*)&k, (u8*)&i);
+            } else {
+                u64 v;
+                c->hits += hashmap_concurrent_get(c->cmap, (u8*)&k, (u8*)&v);
+            }
+        } else if (put) {
+            pthread_rwlock_wrlock(c->lock);
+            hashmap_put(c->map, (u8*)&k, (u8*)&i);
+            pthread_rwlock_unlock(c->lock);
+        } else {
+            u64 v;
+            pthread_rwlock_rdlock(c->lock);
+            c->hits += hashmap_get(c->map, (u8*)&k, (u8*)&v);
+            pthread_rwlock_unlock(c->lock);
+        }
+    }
+    return NULL;
+}
+
+static void bench_conc_run(u32 threads, b8 sharded)
+{
+    hashmap_concurrent* cmap = NULL;
+    hashmap*            map  = NULL;
+    pthread_rwlock_t    lock;
+    pthread_rwlock_init(&lock, NULL);
+
+    if (sharded) {
+        cmap = hashmap_concurrent_create(0, sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    } else {
+        map = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    }
+    for (u64 i = 0; i < CONC_KEYS; i += 2) { // half the keys present
+        u64 k = lookup_key(i);
+        if (sharded) {
+            hashmap_concurrent_put(cmap, (u8*)&k, (u8*)&i);
+        } else {
+            hashmap_put(map, (u8*)&k, (u8*)&i);
+        }
+    }
+
+    pthread_t* th  = malloc(sizeof(pthread_t) * threads);
+    conc_ctx*  ctx = malloc(sizeof(conc_ctx) * threads);
+
+    u64 t0 = ns_now();
+    for (u32 t = 0; t < threads; t++) {
+        ctx[t] = (conc_ctx){cmap, map, &lock, 0x9E3779B97F4A7C15ULL * (t + 1), 0};
+        pthread_create(&th[t], NULL, conc_worker, &ctx[t]);
+    }
+    for (u32 t = 0; t < threads; t++) {
+        pthread_join(th[t], NULL);
+    }
+    u64 t1 = ns_now();
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s  %2u thread%s",
+             sharded ? "hashmap_concurrent " : "hashmap + one rwlock", threads,
+             threads == 1 ? "" : "s");
+    bench(label, (u64)CONC_OPS * threads, t0, t1);
+
+    free(th);
+    free(ctx);
+    if (sharded) {
+        hashmap_concurrent_destroy(cmap);
+    } else {
+        hashmap_destroy(map);
+    }
+    pthread_rwlock_destroy(&lock);
+}
+
+static void bench_conc_scaling(void)
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    u32  max  = (ncpu > 0) ? (u32)ncpu : 1;
+
+    for (u32 t = 1; t <= max; t *= 2) {
+        bench_conc_run(t, 0);
+        bench_conc_run(t, 1);
+    }
+    if ((max & (max - 1)) != 0) { // finish on the real core count
+        bench_conc_run(max, 0);
+        bench_conc_run(max, 1);
+    }
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7h: put tail latency, full resize vs incremental resize
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Times every single put while a map grows from empty to LAT_N entries and
+// reports percentiles. A full resize shows up as a handful of very slow puts
+// (max); incremental resize trades them for slightly slower puts while a
+// resize is draining. First-touch page faults of the new table then land on
+// single puts too, which is most of what is left in its p999.
+
+#define LAT_N (1u << 22)
+
+static int cmp_u32(const void* a, const void* b)
+{
+    u32 x = *(const u32*)a;
+    u32 y = *(const u32*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_put_latency(b8 incremental)
+{
+    hashmap* map = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    hashmap_set_incremental(map, incremental);
+
+    u32* lat = malloc(sizeof(u32) * LAT_N);
+    WC_ASSERT_NOT_NULL(lat);
+
+    u64 t0 = ns_now();
+    for (u64 i = 0; i < LAT_N; i++) {
+        u64 k = lookup_key(i);
+        u64 a = ns_now();
+        hashmap_put(map, (u8*)&k, (u8*)&i);
+        u64 b = ns_now();
+        lat[i] = (u32)((b - a) > UINT32_MAX ? UINT32_MAX : (b - a));
+    }
+    u64 t1 = ns_now();
+
+    WC_ASSERT_EQ_U64(hashmap_size(map), LAT_N);
+    bench(incremental ? "put  incremental resize" : "put  full resize", LAT_N, t0, t1);
+
+    qsort(lat, LAT_N, sizeof(u32), cmp_u32);
+    printf("  %-44s p50 %llu  p99 %llu  p999 %llu  max %llu ns\n", "",
+           (unsigned long long)lat[LAT_N / 2],
+           (unsigned long long)lat[(u64)LAT_N * 99 / 100],
+           (unsigned long long)lat[(u64)LAT_N * 999 / 1000],
+           (unsigned long long)lat[LAT_N - 1]);
+
+    free(lat);
+    hashmap_destroy(map);
+}
+
+static void bench_put_latency_full(void) { bench_put_latency(0); }
+static void bench_put_latency_incremental(void) { bench_put_latency(1); }
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7i: building a map from N known entries
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// put loop (one rehash per doubling) vs reserve + put loop vs hashmap_from_vecs
+// with and without the home-bucket sort. The vecs are filled outside the timing.
+
+#define BUILD_N (1u << 21)
+
+static void build_vecs(genVec** keys, genVec** vals)
+{
+    *keys = genVec_init(BUILD_N, sizeof(u64), NULL);
+    *vals = genVec_init(BUILD_N, sizeof(u64), NULL);
+    for (u64 i = 0; i < BUILD_N; i++) {
+        u64 k = lookup_key(i);
+        genVec_push(*keys, (u8*)&k);
+        genVec_push(*vals, (u8*)&i);
+    }
+}
+
+static void bench_build_put(b8 reserve)
+{
+    genVec *keys, *vals;
+    build_vecs(&keys, &vals);
+
+    u64      t0  = ns_now();
+    hashmap* map = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    if (reserve) {
+        hashmap_reserve(map, BUILD_N);
+    }
+    for (u64 i = 0; i < BUILD_N; i++) {
+        hashmap_put(map, genVec_get_ptr(keys, i), genVec_get_ptr(vals, i));
+    }
+    u64 t1 = ns_now();
+
+    WC_ASSERT_EQ_U64(hashmap_size(map), BUILD_N);
+    bench(reserve ? "build  reserve + put loop" : "build  put loop (grows)", BUILD_N, t0, t1);
+    genVec_destroy(keys);
+    genVec_destroy(vals);
+    hashmap_destroy(map);
+}
+
+static void bench_build_from_vecs(b8 sort)
+{
+    genVec *keys, *vals;
+    build_vecs(&keys, &vals);
+
+    u64      t0  = ns_now();
+    hashmap* map = hashmap_from_vecs(keys, vals, NULL, NULL, sort);
+    u64      t1  = ns_now();
+
+    WC_ASSERT_EQ_U64(hashmap_size(map), BUILD_N);
+    bench(sort ? "build  hashmap_from_vecs (sorted)" : "build  hashmap_from_vecs", BUILD_N, t0, t1);
+    genVec_destroy(keys);
+    genVec_destroy(vals);
+    hashmap_destroy(map);
+}
+
+static void bench_build_put_grow(void) { bench_build_put(0); }
+static void bench_build_put_reserve(void) { bench_build_put(1); }
+static void bench_build_from_vecs_plain(void) { bench_build_from_vecs(0); }
+static void bench_build_from_vecs_sorted(void) { bench_build_from_vecs(1); }
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7j: bucket layout — hashmap (psls | keys | vals) vs hashmap_packed
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Same entries in both maps, queries in scattered order so each lookup misses
+// cache on the table. hashmap touches up to three arrays per probe, packed
+// one [psl|key|val] bucket. Swept over key / val sizes (bytes).
+
+#define LAYOUT_N (1u << 19)
+
+// key i of key_size bytes: lookup_key(i) spread over every 8-byte word
+static void layout_key(u8* out, u32 key_size, u64 i)
+{
+    for (u32 off = 0; off < key_size; off += 8) {
+        u64 w = lookup_key(i) ^ (off * 0xD6E8FEB86659FD93ULL);
+        memcpy(out + off, &w, key_size - off < 8 ? key_size - off : 8);
+    }
+}
+
+static u64 layout_get_soa(const hashmap* m, const u8* keys, u32 ks, const u32* q, u8* out, u64* sum)
+{
+    u64 hits = 0;
+    for (u64 i = 0; i < LAYOUT_N; i++) {
+        if (hashmap_get(m, keys + ((u64)q[i] * ks), out)) {
+            u64 v;
+            memcpy(&v, out, sizeof(v));
+            hits++;
+            *sum += v;
+        }
+    }
+    return hits;
+}
+
+static u64 layout_get_aos(const hashmap_packed* m, const u8* keys, u32 ks, const u32* q, u8* out,
+                          u64* sum)
+{
+    u64 hits = 0;
+    for (u64 i = 0; i < LAYOUT_N; i++) {
+        if (hashmap_packed_get(m, keys + ((u64)q[i] * ks), out)) {
+            u64 v;
+            memcpy(&v, out, sizeof(v));
+            hits++;
+            *sum += v;
+        }
+    }
+    return hits;
+}
+
+// key_size, val_size >= 8 (the value carries the entry index)
+static void bench_layout(u32 key_size, u32 val_size)
+{
+    hashmap*        soa = hashmap_create(key_size, val_size, NULL, NULL, NULL, NULL);
+    hashmap_packed* aos = hashmap_packed_create(key_size, val_size, NULL, NULL, NULL, NULL);
+
+    // keys [0, N) are inserted, keys [N, 2N) are the misses
+    u8* keys = malloc((u64)LAYOUT_N * 2 * key_size);
+    u8* val  = calloc(1, val_size);
+    for (u64 i = 0; i < (u64)LAYOUT_N * 2; i++) {
+        layout_key(keys + (i * key_size), key_size, i);
+    }
+    for (u64 i = 0; i < LAYOUT_N; i++) {
+        memcpy(val, &i, sizeof(i));
+        hashmap_put(soa, keys + (i * key_size), val);
+        hashmap_packed_put(aos, keys + (i * key_size), val);
+    }
+
+    u32* hit_q  = malloc(sizeof(u32) * LAYOUT_N);
+    u32* miss_q = malloc(sizeof(u32) * LAYOUT_N);
+    u64  s      = 0x243F6A8885A308D3ULL;
+    for (u64 i = 0; i < LAYOUT_N; i++) {
+        s         = (s * 6364136223846793005ULL) + 1442695040888963407ULL;
+        hit_q[i]  = (u32)((s >> 20) & (LAYOUT_N - 1));
+        miss_q[i] = hit_q[i] + LAYOUT_N;
+    }
+
+    char label[64];
+    u64  soa_sum = 0, aos_sum = 0, t0, t1;
+
+    t0 = ns_now();
+    u64 soa_hits = layout_get_soa(soa, keys, key_size, hit_q, val, &soa_sum);
+    t1 = ns_now();
+    snprintf(label, sizeof(label), "hit   k%-3u v%-3u hashmap", key_size, val_size);
+    bench(label, LAYOUT_N, t0, t1);
+
+    t0 = ns_now();
+    u64 aos_hits = layout_get_aos(aos, keys, key_size, hit_q, val, &aos_sum);
+    t1 = ns_now();
+    snprintf(label, sizeof(label), "hit   k%-3u v%-3u hashmap_packed", key_size, val_size);
+    bench(label, LAYOUT_N, t0, t1);
+
+    WC_ASSERT_EQ_U64(soa_hits, LAYOUT_N);
+    WC_ASSERT_EQ_U64(aos_hits, LAYOUT_N);
+    WC_ASSERT_EQ_U64(soa_sum, aos_sum);
+
+    t0 = ns_now();
+    soa_hits = layout_get_soa(soa, keys, key_size, miss_q, val, &soa_sum);
+    t1 = ns_now();
+    snprintf(label, sizeof(label), "miss  k%-3u v%-3u hashmap", key_size, val_size);
+    bench(label, LAYOUT_N, t0, t1);
+
+    t0 = ns_now();
+    aos_hits = layout_get_aos(aos, keys, key_size, miss_q, val, &aos_sum);
+    t1 = ns_now();
+    snprintf(label, sizeof(label), "miss  k%-3u v%-3u hashmap_packed", key_size, val_size);
+    bench(label, LAYOUT_N, t0, t1);
+
+    WC_ASSERT_EQ_U64(soa_hits + aos_hits, 0);
+
+    free(hit_q);
+    free(miss_q);
+    free(keys);
+    free(val);
+    hashmap_destroy(soa);
+    hashmap_packed_destroy(aos);
+}
+
+static void bench_layout_8_8(void) { bench_layout(8, 8); }
+static void bench_layout_16_16(void) { bench_layout(16, 16); }
+static void bench_layout_8_24(void) { bench_layout(8, 24); }
+static void bench_layout_32_32(void) { bench_layout(32, 32); }
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7k: walking every entry — byte-per-bucket scan vs hashmap_iter
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// 1M entries in 2M buckets, then keep_pct of them kept. The scan is the loop
+// MAP_FOREACH used to expand to; the iterator tests 8 psls per load.
+
+static void bench_iterate(u32 keep_pct, const char* scan_label, const char* iter_label)
+{
+    hashmap* map = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hashmap_put(map, (u8*)&k, (u8*)&i);
+    }
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        if (i % 100 >= keep_pct) {
+            u64 k = lookup_key(i);
+            hashmap_del(map, (u8*)&k, NULL);
+        }
+    }
+
+    const u64 reps = 20;
+    u64       scan_sum = 0, iter_sum = 0;
+
+    u64 t0 = ns_now();
+    for (u64 r = 0; r < reps; r++) {
+        for (u64 i = 0; i < map->capacity; i++) {
+            if (map->psls[i]) {
+                scan_sum += *(u64*)(map->vals + (i * map->val_size));
+            }
+        }
+    }
+    u64 t1 = ns_now();
+
+    u64 t2 = ns_now();
+    for (u64 r = 0; r < reps; r++) {
+        hashmap_iter it = hashmap_iter_begin(map);
+        while (hashmap_iter_next(&it)) {
+            iter_sum += *(u64*)it.val;
+        }
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_EQ_U64(scan_sum, iter_sum);
+    bench(scan_label, reps * map->size, t0, t1);
+    bench(iter_label, reps * map->size, t2, t3);
+
+    hashmap_destroy(map);
+}
+
+static void bench_iterate_dense(void)
+{
+    bench_iterate(100, "walk 50% full  byte scan", "walk 50% full  hashmap_iter");
+}
+
+static void bench_iterate_sparse(void)
+{
+    bench_iterate(5, "walk 2.5% full byte scan", "walk 2.5% full hashmap_iter");
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7l: upsert — word count over 2M String tokens
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// get_ptr, then put(key, 1) on a miss: two probes (and two hashes) per new
+// word. hashmap_entry: one probe per token, the key is copied only on insert.
+// Few words: almost every token is a hit. Many words: ~40% are new.
+
+#define WC_TOKENS (1u << 21)
+
+static String* wc_words(u64 n_words)
+{
+    String* words = malloc(sizeof(String) * n_words);
+    for (u64 i = 0; i < n_words; i++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "word_%llu", (unsigned long long)lookup_key(i) % 1000000007ULL);
+        string_create_stk(&words[i], buf);
+    }
+    return words;
+}
+
+static u32* wc_tokens(u64 n_words)
+{
+    u32* t = malloc(sizeof(u32) * WC_TOKENS);
+    u64  s = 0x9E3779B97F4A7C15ULL;
+    for (u64 i = 0; i < WC_TOKENS; i++) {
+        s    = (s * 6364136223846793005ULL) + 1442695040888963407ULL;
+        t[i] = (u32)((s >> 33) % n_words);
+    }
+    return t;
+}
+
+static void bench_word_count(u64 n_words, b8 entry, const char* label)
+{
+    String*  words  = wc_words(n_words);
+    u32*     tokens = wc_tokens(n_words);
+    hashmap* map    = hashmap_create(sizeof(String), sizeof(u64), wyhash_str, str_cmp, &wc_str_ops, NULL);
+
+    u64 t0 = ns_now();
+    if (entry) {
+        for (u64 i = 0; i < WC_TOKENS; i++) {
+            (*(u64*)hashmap_entry(map, (u8*)&words[tokens[i]], NULL))++;
+        }
+    } else {
+        for (u64 i = 0; i < WC_TOKENS; i++) {
+            u64* c = (u64*)hashmap_get_ptr(map, (u8*)&words[tokens[i]]);
+            if (c) {
+                (*c)++;
+            } else {
+                u64 one = 1;
+                hashmap_put(map, (u8*)&words[tokens[i]], (u8*)&one);
+            }
+        }
+    }
+    u64 t1 = ns_now();
+
+    u64 total = 0;
+    MAP_FOREACH_VAL(map, u64, c) {
+        total += *c;
+    }
+    WC_ASSERT_EQ_U64(total, WC_TOKENS);
+    bench(label, WC_TOKENS, t0, t1);
+
+    hashmap_destroy(map);
+    for (u64 i = 0; i < n_words; i++) {
+        string_destroy_stk(&words[i]);
+    }
+    free(words);
+    free(tokens);
+}
+
+static void bench_word_count_few(void)
+{
+    bench_word_count(20000, 0, "20k words  get_ptr + put");
+    bench_word_count(20000, 1, "20k words  hashmap_entry");
+}
+
+static void bench_word_count_many(void)
+{
+    bench_word_count(1000000, 0, "1M words   get_ptr + put");
+    bench_word_count(1000000, 1, "1M words   hashmap_entry");
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7m: seeded vs unseeded hashing (u64 -> u64, 1M entries)
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Same keys, same query order; the only difference is the per-map seed mix
+// (one extra multiply per hash). seed 0 is what -DWC_MAP_SEEDED=0 builds get.
+
+static void bench_seed_put_get(b8 seeded, const char* put_label, const char* get_label)
+{
+    hashmap* map = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    if (!seeded) {
+        hashmap_set_seed(map, 0);
+    }
+
+    u64 t0 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hashmap_put(map, (u8*)&k, (u8*)&i);
+    }
+    u64 t1 = ns_now();
+
+    u64* q    = lookup_queries(50);
+    u64  hits = 0;
+    u64  t2   = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        hits += hashmap_has(map, (u8*)&q[i]);
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_EQ_U64(map->size, LOOKUP_N);
+    WC_ASSERT_TRUE(hits > 0 && hits < LOOKUP_N);
+    bench(put_label, LOOKUP_N, t0, t1);
+    bench(get_label, LOOKUP_N, t2, t3);
+
+    free(q);
+    hashmap_destroy(map);
+}
+
+static void bench_seed_unseeded(void)
+{
+    bench_seed_put_get(0, "put        seed 0", "has 50/50  seed 0");
+}
+
+static void bench_seed_seeded(void)
+{
+    bench_seed_put_get(1, "put        seeded", "has 50/50  seeded");
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7n: max load 0.75 vs 0.9 (u64 -> u64, 900k entries)
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// 900k entries: 2M buckets at 0.75 (0.43 full), 1M buckets at 0.9 (0.86
+// full). Half the memory against longer runs — misses feel it most.
+
+#define LOAD_N 900000u
+
+static void bench_load_factor(double load, const char* hit_label, const char* miss_label)
+{
+    hashmap* map = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    hashmap_set_max_load(map, load);
+    for (u64 i = 0; i < LOAD_N; i++) {
+        u64 k = lookup_key(i);
+        hashmap_put(map, (u8*)&k, (u8*)&i);
+    }
+
+    u64 sum = 0;
+    u64 t0  = ns_now();
+    for (u64 i = 0; i < LOAD_N; i++) {
+        u64 k = lookup_key((i * 7919) % LOAD_N);
+        sum += *(u64*)hashmap_get_ptr(map, (u8*)&k);
+    }
+    u64 t1 = ns_now();
+
+    u64 misses = 0;
+    u64 t2     = ns_now();
+    for (u64 i = 0; i < LOAD_N; i++) {
+        u64 k = lookup_key(LOAD_N + ((i * 7919) % LOAD_N));
+        misses += !hashmap_has(map, (u8*)&k);
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_EQ_U64(sum, (u64)LOAD_N * (LOAD_N - 1) / 2);
+    WC_ASSERT_EQ_U64(misses, LOAD_N);
+    bench(hit_label, LOAD_N, t0, t1);
+    bench(miss_label, LOAD_N, t2, t3);
+
+    hashmap_destroy(map);
+}
+
+static void bench_load_075(void)
+{
+    bench_load_factor(0.75, "get hit    max load 0.75 (2M buckets)", "get miss   max load 0.75");
+}
+
+static void bench_load_090(void)
+{
+    bench_load_factor(0.9, "get hit    max load 0.90 (1M buckets)", "get miss   max load 0.90");
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7o: hashset intersection (u64 ids)
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Naive: walk the smaller set, hashset_has + hashset_insert per elm, one
+// cache miss at a time. hashset_intersect hashes and prefetches 16 elms
+// before probing any. Sorted: the same ids as pre-sorted genVecs, merged
+// (or galloped when one side is much smaller). ns per elm of the smaller set.
+
+static int u64_cmp(const u8* a, const u8* b, u64 size)
+{
+    (void)size;
+    u64 x = *(const u64*)a, y = *(const u64*)b;
+    return (x > y) - (x < y);
+}
+
+// ids lookup_key(first .. first + n), as a set and as a sorted vec
+static hashset* id_set(u64 first, u64 n, genVec** sorted)
+{
+    hashset* s = hashset_create(sizeof(u64), NULL, NULL, NULL);
+    for (u64 i = first; i < first + n; i++) {
+        u64 k = lookup_key(i);
+        hashset_insert(s, (u8*)&k);
+    }
+    *sorted = hashset_sorted(s, u64_cmp);
+    return s;
+}
+
+static void bench_intersect(u64 n_small, u64 n_large, const char* naive_label,
+                            const char* batch_label, const char* sorted_label)
+{
+    genVec*  vs;
+    genVec*  vl;
+    hashset* small = id_set(n_large - (n_small / 2), n_small, &vs); // half of it overlaps
+    hashset* large = id_set(0, n_large, &vl);
+
+    hashset* out = hashset_create(sizeof(u64), NULL, NULL, NULL);
+    u64      t0  = ns_now();
+    SET_FOREACH(small, u64, k) {
+        if (hashset_has(large, (const u8*)k)) {
+            hashset_insert(out, (const u8*)k);
+        }
+    }
+    u64 t1    = ns_now();
+    u64 naive = hashset_size(out);
+
+    u64 t2 = ns_now();
+    hashset_intersect(out, small, large);
+    u64 t3 = ns_now();
+
+    genVec* merged = genVec_init(0, sizeof(u64), NULL);
+    u64     t4     = ns_now();
+    genVec_sorted_intersect(merged, vs, vl, u64_cmp);
+    u64 t5 = ns_now();
+
+    WC_ASSERT_EQ_U64(naive, n_small / 2);
+    WC_ASSERT_EQ_U64(hashset_size(out), n_small / 2);
+    WC_ASSERT_EQ_U64(genVec_size(merged), n_small / 2);
+    bench(naive_label, n_small, t0, t1);
+    bench(batch_label, n_small, t2, t3);
+    bench(sorted_label, n_small, t4, t5);
+
+    genVec_destroy(merged);
+    genVec_destroy(vs);
+    genVec_destroy(vl);
+    hashset_destroy(out);
+    hashset_destroy(small);
+    hashset_destroy(large);
+}
+
+static void bench_intersect_even(void)
+{
+    bench_intersect(1u << 20, 1u << 20, "1M & 1M    has + insert", "1M & 1M    hashset_intersect",
+                    "1M & 1M    sorted merge");
+}
+
+static void bench_intersect_lopsided(void)
+{
+    bench_intersect(1u << 14, 1u << 21, "16k & 2M   has + insert", "16k & 2M   hashset_intersect",
+                    "16k & 2M   sorted gallop");
+}
+
+static void bench_intersect_count(void)
+{
+    genVec*  vs;
+    genVec*  vl;
+    hashset* a = id_set(1u << 19, 1u << 20, &vs);
+    hashset* b = id_set(0, 1u << 21, &vl);
+
+    u64 naive = 0;
+    u64 t0    = ns_now();
+    SET_FOREACH(a, u64, k) {
+        naive += hashset_has(b, (const u8*)k);
+    }
+    u64 t1 = ns_now();
+
+    u64 t2      = ns_now();
+    u64 batched = hashset_intersect_count(a, b);
+    u64 t3      = ns_now();
+
+    WC_ASSERT_EQ_U64(naive, 1u << 20);
+    WC_ASSERT_EQ_U64(batched, naive);
+    bench("count 1M in 2M   hashset_has loop", 1u << 20, t0, t1);
+    bench("count 1M in 2M   intersect_count", 1u << 20, t2, t3);
+
+    genVec_destroy(vs);
+    genVec_destroy(vl);
+    hashset_destroy(a);
+    hashset_destroy(b);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7p: IntSet_u64 / IntMap_u64_u64 vs hashset / hashmap (u64 keys, 1M)
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Same keys, same scattered 50/50 queries. The generic tables call hash_fn
+// and cmp_fn through pointers and memcmp the keys; the instantiated ones
+// inline an integer mix and compare with ==.
+
+INSTANTIATE_INT_SET(u64, "%lu")
+INSTANTIATE_INT_MAP(u64, u64)
+
+static void bench_int_set_generic(void)
+{
+    hashset* s = hashset_create(sizeof(u64), NULL, NULL, NULL);
+
+    u64 t0 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hashset_insert(s, (u8*)&k);
+    }
+    u64 t1 = ns_now();
+
+    u64* q    = lookup_queries(50);
+    u64  hits = 0;
+    u64  t2   = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        hits += hashset_has(s, (u8*)&q[i]);
+    }
+    u64 t3 = ns_now();
+
+    u64 t4 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hashset_remove(s, (u8*)&k);
+    }
+    u64 t5 = ns_now();
+
+    WC_ASSERT_TRUE(hits > 0 && hits < LOOKUP_N);
+    WC_ASSERT_EQ_U64(s->size, 0);
+    bench("insert     hashset (u64)", LOOKUP_N, t0, t1);
+    bench("has 50/50  hashset (u64)", LOOKUP_N, t2, t3);
+    bench("remove     hashset (u64)", LOOKUP_N, t4, t5);
+
+    free(q);
+    hashset_destroy(s);
+}
+
+static void bench_int_set_specialized(void)
+{
+    IntSet_u64* s = intset_create_u64();
+
+    u64 t0 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        intset_insert_u64(s, lookup_key(i));
+    }
+    u64 t1 = ns_now();
+
+    u64* q    = lookup_queries(50);
+    u64  hits = 0;
+    u64  t2   = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        hits += intset_has_u64(s, q[i]);
+    }
+    u64 t3 = ns_now();
+
+    u64 t4 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        intset_remove_u64(s, lookup_key(i));
+    }
+    u64 t5 = ns_now();
+
+    WC_ASSERT_TRUE(hits > 0 && hits < LOOKUP_N);
+    WC_ASSERT_EQ_U64(s->size, 0);
+    bench("insert     IntSet_u64", LOOKUP_N, t0, t1);
+    bench("has 50/50  IntSet_u64", LOOKUP_N, t2, t3);
+    bench("remove     IntSet_u64", LOOKUP_N, t4, t5);
+
+    free(q);
+    intset_destroy_u64(s);
+}
+
+static void bench_int_map_generic(void)
+{
+    hashmap* map = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+
+    u64 t0 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hashmap_put(map, (u8*)&k, (u8*)&i);
+    }
+    u64 t1 = ns_now();
+
+    u64* q   = lookup_queries(50);
+    u64  sum = 0;
+    u64  t2  = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 v;
+        if (hashmap_get(map, (u8*)&q[i], (u8*)&v)) {
+            sum += v;
+        }
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_TRUE(sum > 0);
+    bench("put        hashmap (u64 -> u64)", LOOKUP_N, t0, t1);
+    bench("get 50/50  hashmap (u64 -> u64)", LOOKUP_N, t2, t3);
+
+    free(q);
+    hashmap_destroy(map);
+}
+
+static void bench_int_map_specialized(void)
+{
+    IntMap_u64_u64* map = intmap_create_u64_u64();
+
+    u64 t0 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        intmap_put_u64_u64(map, lookup_key(i), i);
+    }
+    u64 t1 = ns_now();
+
+    u64* q   = lookup_queries(50);
+    u64  sum = 0;
+    u64  t2  = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 v;
+        if (intmap_get_u64_u64(map, q[i], &v)) {
+            sum += v;
+        }
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_TRUE(sum > 0);
+    bench("put        IntMap_u64_u64", LOOKUP_N, t0, t1);
+    bench("get 50/50  IntMap_u64_u64", LOOKUP_N, t2, t3);
+
+    free(q);
+    intmap_destroy_u64_u64(map);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7q: bloom filter in front of hashset_has (u64 keys, 1M, 90% misses)
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// The filter answers a definite miss from one cache line; only its maybes
+// (hits plus ~1% false positives) go on to probe the set.
+
+static void bench_bloom_front(void)
+{
+    hashset* s  = hashset_create(sizeof(u64), NULL, NULL, NULL);
+    bloom*   bf = bloom_create(LOOKUP_N, 0.01, sizeof(u64), NULL);
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hashset_insert(s, (u8*)&k);
+        bloom_add(bf, (u8*)&k);
+    }
+    u64* q = lookup_queries(10);
+
+    u64 plain = 0;
+    u64 t0    = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        plain += hashset_has(s, (u8*)&q[i]);
+    }
+    u64 t1 = ns_now();
+
+    u64 filtered = 0;
+    u64 t2       = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        filtered += bloom_maybe_has(bf, (u8*)&q[i]) && hashset_has(s, (u8*)&q[i]);
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_EQ_U64(filtered, plain);
+    bench("has 10/90  hashset", LOOKUP_N, t0, t1);
+    bench("has 10/90  bloom, then hashset", LOOKUP_N, t2, t3);
+
+    free(q);
+    bloom_destroy(bf);
+    hashset_destroy(s);
+}
+
+static void bench_bloom_ops(void)
+{
+    u64* keys = malloc(sizeof(u64) * LOOKUP_N);
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        keys[i] = lookup_key(i);
+    }
+    u64* q = lookup_queries(10);
+
+    bloom* bf = bloom_create(LOOKUP_N, 0.01, sizeof(u64), NULL);
+    u64    t0 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        bloom_add(bf, (u8*)&keys[i]);
+    }
+    u64 t1 = ns_now();
+
+    bloom* bf2 = bloom_create(LOOKUP_N, 0.01, sizeof(u64), NULL);
+    u64    t2  = ns_now();
+    bloom_add_many(bf2, (u8*)keys, LOOKUP_N);
+    u64 t3 = ns_now();
+
+    u64 t4    = ns_now();
+    u64 maybe = 0;
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        maybe += bloom_maybe_has(bf, (u8*)&q[i]);
+    }
+    u64 t5 = ns_now();
+
+    u64 t6         = ns_now();
+    u64 maybe_many = bloom_maybe_has_many(bf, (u8*)q, LOOKUP_N, NULL);
+    u64 t7         = ns_now();
+
+    WC_ASSERT_EQ_U64(maybe_many, maybe);
+    bench("bloom_add", LOOKUP_N, t0, t1);
+    bench("bloom_add_many", LOOKUP_N, t2, t3);
+    bench("bloom_maybe_has       10/90", LOOKUP_N, t4, t5);
+    bench("bloom_maybe_has_many  10/90", LOOKUP_N, t6, t7);
+
+    bloom_destroy(bf);
+    bloom_destroy(bf2);
+    free(q);
+    free(keys);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7r: snapshot load vs rebuild (u64 -> u64, 1M)
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Rebuild = putting every entry again. load_mmap only maps the file: its
+// cost moves to the first lookups, which fault the pages in (from the page
+// cache here, the file was just written).
+
+#define SNAP_BENCH_PATH "/tmp/wc_speed_test.snap"
+
+static void bench_snapshot_load(void)
+{
+    hashmap* m  = hashmap_create(sizeof(u64), sizeof(u64), NULL, NULL, NULL, NULL);
+    u64      t0 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hashmap_put(m, (u8*)&k, (u8*)&i);
+    }
+    u64 t1 = ns_now();
+
+    u64 t2 = ns_now();
+    WC_ASSERT_TRUE(hashmap_save(m, SNAP_BENCH_PATH));
+    u64 t3 = ns_now();
+
+    u64      t4 = ns_now();
+    hashmap* s  = hashmap_load_mmap(SNAP_BENCH_PATH, NULL, NULL);
+    u64      t5 = ns_now();
+    WC_ASSERT_NOT_NULL(s);
+
+    u64 hits = 0;
+    u64 t6   = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hits += hashmap_has(s, (u8*)&k);
+    }
+    u64 t7 = ns_now();
+
+    u64 t8 = ns_now();
+    for (u64 i = 0; i < LOOKUP_N; i++) {
+        u64 k = lookup_key(i);
+        hits += hashmap_has(s, (u8*)&k);
+    }
+    u64 t9 = ns_now();
+
+    WC_ASSERT_EQ_U64(hits, 2 * LOOKUP_N);
+    bench("rebuild (put every entry)", LOOKUP_N, t0, t1);
+    bench("hashmap_save", LOOKUP_N, t2, t3);
+    bench("hashmap_load_mmap", LOOKUP_N, t4, t5);
+    bench("has after load, first pass (faults)", LOOKUP_N, t6, t7);
+    bench("has after load, second pass", LOOKUP_N, t8, t9);
+
+    hashmap_destroy(s);
+    hashmap_destroy(m);
+    remove(SNAP_BENCH_PATH);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7s: typed vector (VEC_INSTANTIATE) vs genVec
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Same work through genVec's runtime data_size memcpy and through the typed
+// vector, where sizeof(T) is a constant. Both start empty and grow.
+
+static void bench_typed_push_int(void)
+{
+    genVec* g  = genVec_init(0, sizeof(int), NULL);
+    u64     t0 = ns_now();
+    for (int i = 0; i < PUSH_N; i++) {
+        genVec_push(g, (u8*)&i);
+    }
+    u64 t1 = ns_now();
+
+    Vec_int* v  = vec_int_create(0, NULL);
+    u64      t2 = ns_now();
+    for (int i = 0; i < PUSH_N; i++) {
+        vec_int_push(v, i);
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_EQ_U64(v->size, g->size);
+    WC_ASSERT_EQ_INT(memcmp(v->data, g->data, sizeof(int) * PUSH_N), 0);
+    bench("push int    genVec", PUSH_N, t0, t1);
+    bench("push int    Vec_int", PUSH_N, t2, t3);
+
+    vec_int_destroy(v);
+    genVec_destroy(g);
+}
+
+static void bench_typed_sum_float(void)
+{
+    Vec_float* v = vec_float_create(PUSH_N, NULL);
+    for (int i = 0; i < PUSH_N; i++) {
+        vec_float_push(v, (float)(i & 1023));
+    }
+    genVec* g = vec_float_as_genVec(v); // the same data both ways
+
+    // whole numbers summed in a double stay exact in any order
+    double sum_g = 0;
+    u64    t0    = ns_now();
+    for (u64 i = 0; i < g->size; i++) {
+        float f;
+        genVec_get(g, i, (u8*)&f);
+        sum_g += f;
+    }
+    u64 t1 = ns_now();
+
+    double sum_v = 0;
+    u64    t2    = ns_now();
+    for (u64 i = 0; i < v->size; i++) {
+        sum_v += vec_float_get(v, i);
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_TRUE(sum_g == sum_v);
+    bench("get+sum float  genVec_get", PUSH_N, t0, t1);
+    bench("get+sum float  vec_float_get", PUSH_N, t2, t3);
+
+    vec_float_destroy(v);
+}
+
+static void bench_typed_push_string(void)
+{
+    String s;
+    string_create_stk(&s, "hello");
+
+    genVec* g  = genVec_init(0, sizeof(String), &wc_str_ops);
+    u64     t0 = ns_now();
+    for (int i = 0; i < PUSH_N; i++) {
+        genVec_push(g, (u8*)&s);
+    }
+    u64 t1 = ns_now();
+
+    Vec_String* v  = vec_String_create(0, &wc_str_ops);
+    u64         t2 = ns_now();
+    for (int i = 0; i < PUSH_N; i++) {
+        vec_String_push(v, s);
+    }
+    u64 t3 = ns_now();
+
+    WC_ASSERT_EQ_U64(v->size, g->size);
+    bench("push String genVec (copy)", PUSH_N, t0, t1);
+    bench("push String Vec_String (copy)", PUSH_N, t2, t3);
+
+    vec_String_destroy(v);
+    genVec_destroy(g);
+    string_destroy_stk(&s);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7t: bulk append (extend / append_vec / resize) vs push loops
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Both sides start from an empty vec: the push loop pays a capacity check,
+// an IS_POD branch and a one-element memcpy per element, the bulk call
+// reserves once and copies in one go.
+
+static void bench_extend_int(void)
+{
+    int* arr = malloc(sizeof(int) * PUSH_N);
+    for (int i = 0; i < PUSH_N; i++) {
+        arr[i] = i;
+    }
+
+    genVec* a  = genVec_init(0, sizeof(int), NULL);
+    u64     t0 = ns_now();
+    for (int i = 0; i < PUSH_N; i++) {
+        genVec_push(a, (u8*)&arr[i]);
+    }
+    u64 t1 = ns_now();
+
+    genVec* b  = genVec_init(0, sizeof(int), NULL);
+    u64     t2 = ns_now();
+    genVec_extend(b, (u8*)arr, PUSH_N);
+    u64 t3 = ns_now();
+
+    genVec* c  = genVec_init(0, sizeof(int), NULL);
+    u64     t4 = ns_now();
+    genVec_append_vec(c, b);
+    u64 t5 = ns_now();
+
+    genVec* d    = genVec_init(0, sizeof(int), NULL);
+    int     fill = 7;
+    u64     t6   = ns_now();
+    genVec_resize(d, PUSH_N, (u8*)&fill);
+    u64 t7 = ns_now();
+
+    WC_ASSERT_EQ_INT(memcmp(a->data, b->data, sizeof(int) * PUSH_N), 0);
+    WC_ASSERT_EQ_INT(memcmp(b->data, c->data, sizeof(int) * PUSH_N), 0);
+    WC_ASSERT_EQ_U64(d->size, PUSH_N);
+    bench("int    push loop", PUSH_N, t0, t1);
+    bench("int    genVec_extend", PUSH_N, t2, t3);
+    bench("int    genVec_append_vec", PUSH_N, t4, t5);
+    bench("int    genVec_resize (fill)", PUSH_N, t6, t7);
+
+    genVec_destroy(a);
+    genVec_destroy(b);
+    genVec_destroy(c);
+    genVec_destroy(d);
+    free(arr);
+}
+
+static void bench_extend_string(void)
+{
+    String* arr = malloc(sizeof(String) * PUSH_N);
+    for (int i = 0; i < PUSH_N; i++) {
+        string_create_stk(&arr[i], "hello");
+    }
+
+    genVec* a  = genVec_init(0, sizeof(String), &wc_str_ops);
+    u64     t0 = ns_now();
+    for (int i = 0; i < PUSH_N; i++) {
+        genVec_push(a, (u8*)&arr[i]);
+    }
+    u64 t1 = ns_now();
+
+    genVec* b  = genVec_init(0, sizeof(String), &wc_str_ops);
+    u64     t2 = ns_now();
+    genVec_extend(b, (u8*)arr, PUSH_N);
+    u64 t3 = ns_now();
+
+    // the vec takes the elements, arr is left to free
+    genVec* c  = genVec_init(0, sizeof(String), &wc_str_ops);
+    u64     t4 = ns_now();
+    genVec_extend_move(c, (u8*)arr, PUSH_N);
+    u64 t5 = ns_now();
+
+    WC_ASSERT_EQ_U64(b->size, a->size);
+    WC_ASSERT_EQ_U64(c->size, a->size);
+    bench("String push loop (copy)", PUSH_N, t0, t1);
+    bench("String genVec_extend (copy)", PUSH_N, t2, t3);
+    bench("String genVec_extend_move", PUSH_N, t4, t5);
+
+    genVec_destroy(a);
+    genVec_destroy(b);
+    genVec_destroy(c);
+    free(arr);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7u: building a vec of heap Strings: push / push_move / emplace
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// push copies a stack String (a temporary heap buffer per element),
+// push_move needs a heap shell per element (an extra malloc + free),
+// emplace builds the String in its slot (only the String's own malloc).
+// Each vec is filled once untimed and cleared, so the timed pass runs on
+// warm memory instead of paying the page faults of a fresh 40 MB buffer.
+
+#define EMPLACE_STR "a string too long for the SSO buffer"
+
+typedef enum { FILL_PUSH, FILL_PUSH_MOVE, FILL_EMPLACE, FILL_EMPLACE_N } emplace_fill;
+
+static void emplace_fill_vec(genVec* v, emplace_fill how)
+{
+    String* span = how == FILL_EMPLACE_N ? (String*)genVec_emplace_n(v, PUSH_N) : NULL;
+
+    for (int i = 0; i < PUSH_N; i++) {
+        switch (how) {
+            case FILL_PUSH: {
+                String s;
+                string_create_stk(&s, EMPLACE_STR);
+                genVec_push(v, (u8*)&s);
+                string_destroy_stk(&s);
+            } break;
+            case FILL_PUSH_MOVE: {
+                String* s = string_from_cstr(EMPLACE_STR);
+                genVec_push_move(v, (u8**)&s);
+            } break;
+            case FILL_EMPLACE:
+                string_create_stk((String*)genVec_emplace_back(v), EMPLACE_STR);
+                break;
+            case FILL_EMPLACE_N:
+                string_create_stk(&span[i], EMPLACE_STR);
+                break;
+        }
+    }
+}
+
+static void bench_emplace_strings(void)
+{
+    static const char* labels[] = {"String push (copy)", "String push_move (heap shell)",
+                                   "String emplace_back", "String emplace_n"};
+
+    for (emplace_fill how = FILL_PUSH; how <= FILL_EMPLACE_N; how++) {
+        genVec* v = genVec_init(0, sizeof(String), &wc_str_ops);
+        emplace_fill_vec(v, how);
+        genVec_clear(v);
+
+        u64 t0 = ns_now();
+        emplace_fill_vec(v, how);
+        u64 t1 = ns_now();
+
+        WC_ASSERT_EQ_U64(v->size, PUSH_N);
+        WC_ASSERT_TRUE(string_equals_cstr((String*)genVec_back(v), EMPLACE_STR));
+        bench(labels[how], PUSH_N, t0, t1);
+        genVec_destroy(v);
+    }
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7v: per-frame scratch vectors: heap vs arena allocator
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// Each frame builds a few small vectors from empty and throws them away.
+// On the heap that is a malloc + several reallocs + a free per vector.
+// From an arena every grow of the vector being filled is a bump of the
+// arena top, and the frame ends with one arena_clear. Filling the vectors
+// round-robin shows the other case: only the last block grows in place,
+// the rest copy into fresh arena space.
+
+#define FRAME_N    20000
+#define FRAME_VECS 8
+#define FRAME_ELMS 100
+
+typedef enum { FRAME_HEAP, FRAME_ARENA, FRAME_ARENA_RR } frame_mode;
+
+static u64 frame_run(frame_mode mode, Arena* a, const wc_allocator* alloc)
+{
+    u64 sum = 0;
+
+    for (int f = 0; f < FRAME_N; f++) {
+        genVec v[FRAME_VECS];
+        for (int j = 0; j < FRAME_VECS; j++) {
+            genVec_init_stk_alloc(0, sizeof(int), NULL, mode == FRAME_HEAP ? NULL : alloc, &v[j]);
+        }
+
+        if (mode == FRAME_ARENA_RR) {
+            for (int i = 0; i < FRAME_ELMS; i++) {
+                for (int j = 0; j < FRAME_VECS; j++) {
+                    int x = f + i + j;
+                    genVec_push(&v[j], (u8*)&x);
+                }
+            }
+        } else {
+            for (int j = 0; j < FRAME_VECS; j++) {
+                for (int i = 0; i < FRAME_ELMS; i++) {
+                    int x = f + i + j;
+                    genVec_push(&v[j], (u8*)&x);
+                }
+            }
+        }
+
+        for (int j = 0; j < FRAME_VECS; j++) {
+            sum += (u64)*(const int*)genVec_back(&v[j]);
+        }
+
+        if (mode == FRAME_HEAP) {
+            for (int j = 0; j < FRAME_VECS; j++) {
+                genVec_destroy_stk(&v[j]);
+            }
+        } else {
+            arena_clear(a);
+        }
+    }
+    return sum;
+}
+
+static void bench_frame_vecs(void)
+{
+    static const char* labels[] = {"frame of 8 vecs, heap", "frame of 8 vecs, arena",
+                                   "frame of 8 vecs, arena round-robin"};
+
+    Arena*       a     = arena_create(nKB(64));
+    wc_allocator alloc = arena_allocator(a);
+    u64          want  = 0;
+
+    for (frame_mode mode = FRAME_HEAP; mode <= FRAME_ARENA_RR; mode++) {
+        u64 t0  = ns_now();
+        u64 sum = frame_run(mode, a, &alloc);
+        u64 t1  = ns_now();
+
+        if (mode == FRAME_HEAP) {
+            want = sum;
+        }
+        WC_ASSERT_EQ_U64(sum, want);
+        bench(labels[mode], FRAME_N, t0, t1);
+    }
+
+    arena_release(a);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 7w: parallel genVec algorithms, scaling from 1 thread to every CPU
+// ═══════════════════════════════════════════════════════════════════════════════
+//
+// 10M u64 elements. Each row is one pool size (1, 2, 4, ... and the CPU
+// count); the 1-thread pool runs the same chunked code on the calling
+// thread, so it is the baseline the other rows scale from. for_each and
+// map are memory bound and stop scaling once the memory bus is full;
+// reduce only reads, sort is compare bound and scales furthest.
+
+#define PAR_BENCH_N 10000000
+
+static void par_bench_scale(u8* elm, void* ctx)
+{
+    (void)ctx;
+    *(u64*)elm = (*(u64*)elm * 3) + 1;
+}
+
+static void par_bench_to_double(u8* out, const u8* in, void* ctx)
+{
+    (void)ctx;
+    *(double*)out = (double)*(const u64*)in * 0.5;
+}
+
+static void par_bench_sum(u8* acc, const u8* elm, void* ctx)
+{
+    (void)ctx;
+    *(u64*)acc += *(const u64*)elm;
+}
+
+static int par_bench_cmp(const u8* a, const u8* b, u64 size)
+{
+    (void)size;
+    u64 x = *(const u64*)a;
+    u64 y = *(const u64*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_par_scaling(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    u32  max  = cpus > 0 ? (u32)cpus : 1;
+
+    genVec* v    = genVec_init(PAR_BENCH_N, sizeof(u64), NULL);
+    genVec* keys = genVec_init(PAR_BENCH_N, sizeof(u64), NULL);
+    genVec* dbl  = genVec_init(PAR_BENCH_N, sizeof(double), NULL);
+    u64*    k    = (u64*)genVec_emplace_n(keys, PAR_BENCH_N);
+    pcg32_rand_seed(42, 1);
+    for (u64 i = 0; i < PAR_BENCH_N; i++) {
+        k[i] = ((u64)pcg32_rand() << 32) | pcg32_rand();
+    }
+    genVec_copy(v, keys);
+
+    u64  want = 0;
+    char label[64];
+
+    for (u32 threads = 1;; threads = threads * 2 < max ? threads * 2 : max) {
+        thread_pool* pool = thread_pool_create(threads);
+
+        u64 t0 = ns_now();
+        genVec_par_for_each(pool, v, par_bench_scale, NULL);
+        u64 t1 = ns_now();
+        snprintf(label, sizeof(label), "for_each, %u thread(s)", threads);
+        bench(label, PAR_BENCH_N, t0, t1);
+
+        t0 = ns_now();
+        genVec_par_map(pool, dbl, v, par_bench_to_double, NULL);
+        t1 = ns_now();
+        snprintf(label, sizeof(label), "map u64 -> double, %u thread(s)", threads);
+        bench(label, PAR_BENCH_N, t0, t1);
+
+        u64 sum = 0;
+        t0      = ns_now();
+        genVec_par_reduce(pool, keys, (u8*)&sum, sizeof(sum), par_bench_sum, NULL, NULL);
+        t1 = ns_now();
+        if (threads == 1) {
+            want = sum;
+        }
+        WC_ASSERT_EQ_U64(sum, want);
+        snprintf(label, sizeof(label), "reduce sum, %u thread(s)", threads);
+        bench(label, PAR_BENCH_N, t0, t1);
+
+        genVec_copy(v, keys);
+        t0 = ns_now();
+        genVec_par_sort(pool, v, par_bench_cmp);
+        t1 = ns_now();
+        WC_ASSERT_TRUE(*(const u64*)genVec_get_ptr(v, 0) <= *(const u64*)genVec_back(v));
+        snprintf(label, sizeof(label), "sort, %u thread(s)", threads);
+        bench(label, PAR_BENCH_N, t0, t1);
+
+        thread_pool_destroy(pool);
+        if (threads == max) {
+            break;
+        }
+    }
+
+    genVec_copy(v, keys);
+    u64 t0 = ns_now();
+    genVec_sort(v, par_bench_cmp);
+    u64 t1 = ns_now();
+    bench("genVec_sort (qsort), serial", PAR_BENCH_N, t0, t1);
+
+    genVec_destroy(dbl);
+    genVec_destroy(keys);
+    genVec_destroy(v);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SUITE 8: pop (single-element, copy + del path)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define POP_N 500000
+
+static void bench_pop_pod(void)
+{
+    genVec* v = genVec_init(POP_N, sizeof(int), NULL);
+    int val   = 1;
+    for (int i = 0; i < POP_N; i++) genVec_push(v, (u8*)&val);
+
+    int out = 0;
+    u64 t0  = ns_now();
+    for (int i = 0; i < POP_N; i++) genVec_pop(v, (u8*)&out);
+    u64 t1 = ns_now();
+
+    WC_ASSERT_EQ_U64(v->size, 0);
+    bench("pop POD (int)", POP_N, t0, t1);
+    genVec_destroy(v);
+}
+
+static void bench_pop_cx(void)
+{
+    genVec* v = genVec_init(POP_N, sizeof(String), &wc_str_ops);
+    for (int i = 0; i < POP_N; i++) {
+        String s;
+        string_create_stk(&s, "pop");
+        genVec_push(v, (u8*)&s);
+        string_destroy_stk(&s);
+    }
+
+    u64 t0 = ns_now();
+    for (int i = 0; i < POP_N; i++) genVec_pop(v, NULL);
+    u64 t1 = ns_now();
+
+    WC_ASSERT_EQ_U64(v->size, 0);
+    bench("pop CX (String, del)", POP_N, t0, t1);
+    genVec_destroy(v);
+}
+
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// Suites
+// ═══════════════════════════════════════════════════════════════════════════════
+
+void suite_push(void)
+{
+    WC_SUITE("push  (1M ops)");
+    WC_RUN(bench_push_pod);
+    WC_RUN(bench_push_cx);
+}
+
+void suite_clear_destroy(void)
+{
+    WC_SUITE("clear / destroy  (bulk del loop — biggest POD win)");
+    WC_RUN(bench_clear_pod);
+    WC_RUN(bench_clear_cx);
+    WC_RUN(bench_destroy_pod);
+    WC_RUN(bench_destroy_cx);
+}
+
+void suite_copy(void)
+{
+    WC_SUITE("genVec_copy  (bulk memcpy vs per-element copy_fn)");
+    WC_RUN(bench_vec_copy_pod);
+    WC_RUN(bench_vec_copy_cx);
+}
+
+void suite_init_val(void)
+{
+    WC_SUITE("init_val  (broadcast fill)");
+    WC_RUN(bench_init_val_pod);
+    WC_RUN(bench_init_val_cx);
+}
+
+void suite_remove_range(void)
+{
+    WC_SUITE("remove_range  (bulk del loop)");
+    WC_RUN(bench_remove_range_pod);
+    WC_RUN(bench_remove_range_cx);
+}
+
+void suite_map_put_get(void)
+{
+    WC_SUITE("hashmap put / get  (hot path)");
+    WC_RUN(bench_map_put_pod);
+    WC_RUN(bench_map_put_cx);
+    WC_RUN(bench_map_get_pod);
+    WC_RUN(bench_map_get_cx);
+}
+
+void suite_map_clear(void)
+{
+    WC_SUITE("hashmap_clear  (bulk del loop)");
+    WC_RUN(bench_map_clear_pod);
+    WC_RUN(bench_map_clear_cx);
+}
+
+void suite_map_ingest(void)
+{
+    WC_SUITE("hashmap put ingest  (16B key -> 8B val, high load)");
+    WC_RUN(bench_map_put_16b_ingest);
+    WC_RUN(bench_map_put_16b_churn);
+}
+
+void suite_map_hash_cache(void)
+{
+    WC_SUITE("hashmap hash cache  (String keys, 200k)");
+    WC_RUN(bench_map_str_cache_off);
+    WC_RUN(bench_map_str_cache_on);
+}
+
+void suite_map_vs_flat(void)
+{
+    WC_SUITE("hashmap vs hashmap_flat lookup  (u64 -> u64, 1M)");
+    WC_RUN(bench_lookup_hit);
+    WC_RUN(bench_lookup_miss);
+    WC_RUN(bench_lookup_mixed);
+}
+
+void suite_map_batch(void)
+{
+    WC_SUITE("hashmap batched get / put  (u64 -> u64, 1M)");
+    WC_RUN(bench_map_get_many_hit);
+    WC_RUN(bench_map_get_many_mixed);
+    WC_RUN(bench_map_put_many);
+}
+
+void suite_map_prehash(void)
+{
+    WC_SUITE("hashmap precomputed hash  (String keys, 200k)");
+    WC_RUN(bench_map_has_then_put_rehash);
+    WC_RUN(bench_map_has_then_put_prehash);
+}
+
+void suite_map_concurrent(void)
+{
+    WC_SUITE("hashmap_concurrent throughput  (90% get / 10% put)");
+    WC_RUN(bench_conc_scaling);
+}
+
+void suite_map_put_latency(void)
+{
+    WC_SUITE("hashmap put latency  (4M puts from empty, u64 keys)");
+    WC_RUN(bench_put_latency_full);
+    WC_RUN(bench_put_latency_incremental);
+}
+
+void suite_map_build(void)
+{
+    WC_SUITE("hashmap bulk build  (2M u64 entries)");
+    WC_RUN(bench_build_put_grow);
+    WC_RUN(bench_build_put_reserve);
+    WC_RUN(bench_build_from_vecs_plain);
+    WC_RUN(bench_build_from_vecs_sorted);
+}
+
+void suite_map_layout(void)
+{
+    WC_SUITE("hashmap vs hashmap_packed lookup  (512k entries, key/val bytes)");
+    WC_RUN(bench_layout_8_8);
+    WC_RUN(bench_layout_16_16);
+    WC_RUN(bench_layout_8_24);
+    WC_RUN(bench_layout_32_32);
+}
+
+void suite_map_iterate(void)
+{
+    WC_SUITE("hashmap iterate  (2M buckets, ns per entry visited)");
+    WC_RUN(bench_iterate_dense);
+    WC_RUN(bench_iterate_sparse);
+}
+
+void suite_map_upsert(void)
+{
+    WC_SUITE("hashmap upsert  (word count, 2M String tokens)");
+    WC_RUN(bench_word_count_few);
+    WC_RUN(bench_word_count_many);
+}
+
+void suite_map_seed(void)
+{
+    WC_SUITE("hashmap seeding  (1M u64 keys, per-map seed vs seed 0)");
+    WC_RUN(bench_seed_unseeded);
+    WC_RUN(bench_seed_seeded);
+}
+
+void suite_map_load(void)
+{
+    WC_SUITE("hashmap max load  (900k u64 keys, 0.75 vs 0.9)");
+    WC_RUN(bench_load_075);
+    WC_RUN(bench_load_090);
+}
+
+void suite_set_algebra(void)
+{
+    WC_SUITE("hashset intersection  (u64 ids, ns per elm of the smaller set)");
+    WC_RUN(bench_intersect_even);
+    WC_RUN(bench_intersect_lopsided);
+    WC_RUN(bench_intersect_count);
+}
+
+void suite_int_hash(void)
+{
+    WC_SUITE("integer specializations  (1M u64 keys, generic vs instantiated)");
+    WC_RUN(bench_int_set_generic);
+    WC_RUN(bench_int_set_specialized);
+    WC_RUN(bench_int_map_generic);
+    WC_RUN(bench_int_map_specialized);
+}
+
+void suite_bloom(void)
+{
+    WC_SUITE("bloom filter  (1M u64 keys, 1% fp, 90% of queries miss)");
+    WC_RUN(bench_bloom_front);
+    WC_RUN(bench_bloom_ops);
+}
+
+void suite_map_snapshot(void)
+{
+    WC_SUITE("hashmap snapshot  (1M u64 -> u64, load_mmap vs rebuild)");
+    WC_RUN(bench_snapshot_load);
+}
+
+void suite_vec_typed(void)
+{
+    WC_SUITE("typed vector  (1M elements, VEC_INSTANTIATE vs genVec)");
+    WC_RUN(bench_typed_push_int);
+    WC_RUN(bench_typed_sum_float);
+    WC_RUN(bench_typed_push_string);
+}
+
+void suite_vec_bulk(void)
+{
+    WC_SUITE("genVec bulk append  (1M elements, extend / append / resize vs push)");
+    WC_RUN(bench_extend_int);
+    WC_RUN(bench_extend_string);
+}
+
+void suite_vec_emplace(void)
+{
+    WC_SUITE("genVec emplace  (1M heap Strings, push vs push_move vs emplace)");
+    WC_RUN(bench_emplace_strings);
+}
+
+void suite_vec_arena(void)
+{
+    WC_SUITE("per-frame vectors  (20k frames of 8 x 100 ints, heap vs arena)");
+    WC_RUN(bench_frame_vecs);
+}
+
+void suite_vec_par(void)
+{
+    WC_SUITE("parallel genVec  (10M u64, for_each / map / reduce / sort, 1..N threads)");
+    WC_RUN(bench_par_scaling);
 }
 
 void suite_pop(void)
@@ -605,6 +2539,28 @@ extern int speed_suite(void)
     suite_init_val();
     suite_map_put_get();
     suite_map_clear();
+    suite_map_ingest();
+    suite_map_hash_cache();
+    suite_map_vs_flat();
+    suite_map_batch();
+    suite_map_prehash();
+    suite_map_concurrent();
+    suite_map_put_latency();
+    suite_map_build();
+    suite_map_layout();
+    suite_map_iterate();
+    suite_map_upsert();
+    suite_map_seed();
+    suite_map_load();
+    suite_set_algebra();
+    suite_int_hash();
+    suite_bloom();
+    suite_map_snapshot();
+    suite_vec_typed();
+    suite_vec_bulk();
+    suite_vec_emplace();
+    suite_vec_arena();
+    suite_vec_par();
 
     return WC_REPORT();
 }
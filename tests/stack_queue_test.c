@@ -2,6 +2,7 @@
 #include "Stack.h"
 #include "Queue.h"
 #include "wc_errno.h"
+#include "arena.h"
 
 
 /* ═══════════════════════════════════════════════════════════════════════════
@@ -170,6 +171,36 @@ static void test_queue_reset(void)
     queue_destroy(q);
 }
 
+static void test_stack_queue_arena(void)
+{
+    Arena*       a     = arena_create(nKB(16));
+    wc_allocator alloc = arena_allocator(a);
+
+    Stack* stk = stack_create_alloc(2, sizeof(int), NULL, &alloc);
+    for (int i = 0; i < 100; i++) stack_push(stk, (u8*)&i);
+    int top = 0;
+    stack_peek(stk, (u8*)&top);
+    WC_ASSERT_EQ_INT(top, 99);
+    stack_destroy(stk);
+    WC_ASSERT_EQ_U64(a->idx, 0);
+
+    // grows and compacts through the same allocator
+    Queue* q = queue_create_alloc(4, sizeof(int), NULL, &alloc);
+    for (int i = 0; i < 200; i++) enqueue(q, (u8*)&i);
+    for (int i = 0; i < 190; i++) {
+        int out = 0;
+        dequeue(q, (u8*)&out);
+        WC_ASSERT_EQ_INT(out, i);
+    }
+    WC_ASSERT_EQ_U64(queue_size(q), 10);
+    WC_ASSERT_EQ_INT(*(const int*)queue_peek_ptr(q), 190);
+    WC_ASSERT_TRUE(q->arr->alloc == &alloc);
+    WC_ASSERT_TRUE((u8*)q >= a->base && (u8*)q < a->base + a->size);
+    queue_destroy(q);
+
+    arena_release(a);
+}
+
 
 /* ── Suite entry points ──────────────────────────────────────────────────── */
 
@@ -194,4 +225,5 @@ void queue_suite(void)
     WC_RUN(test_queue_circular_wrap);
     WC_RUN(test_queue_growth);
     WC_RUN(test_queue_reset);
+    WC_RUN(test_stack_queue_arena);
 }
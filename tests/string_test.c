@@ -1,5 +1,6 @@
 #include "wc_test.h"
 #include "String.h"
+#include "arena.h"
 
 
 // TODO: test SSO
@@ -530,6 +531,38 @@ static void test_sso_promotes_at_overflow(void)
 }
 
 
+static void test_alloc_arena_buffer(void)
+{
+    Arena*       a     = arena_create(nKB(4));
+    wc_allocator alloc = arena_allocator(a);
+
+    String s;
+    string_create_stk_alloc(&s, "short", &alloc);
+    WC_ASSERT_TRUE(string_sso(&s));
+    WC_ASSERT_EQ_U64(a->idx, 0); // SSO takes nothing
+
+    for (int i = 0; i < 20; i++) {
+        string_append_cstr(&s, "0123456789");
+    }
+    WC_ASSERT_FALSE(string_sso(&s));
+    WC_ASSERT_TRUE((u8*)s.heap == a->base); // promoted into the arena, then grown in place
+    WC_ASSERT_EQ_U64(string_len(&s), 205);
+
+    // the copy goes to dest's allocator, the heap here
+    String* d = string_from_cstr("");
+    string_copy(d, &s);
+    WC_ASSERT_NULL(d->alloc);
+    WC_ASSERT_TRUE(string_equals(d, &s));
+
+    string_destroy_stk(&s);
+    WC_ASSERT_EQ_U64(a->idx, 0);
+    WC_ASSERT_EQ_U64(string_len(d), 205);
+
+    string_destroy(d);
+    arena_release(a);
+}
+
+
 
 // Suite entry point
 
@@ -603,6 +636,8 @@ void string_suite(void)
 
     WC_RUN(test_sso_stays_sso_up_to_limit);
     WC_RUN(test_sso_promotes_at_overflow);
+
+    WC_RUN(test_alloc_arena_buffer);
 }
 
 
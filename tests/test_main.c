@@ -6,12 +6,20 @@
 void string_suite(void);
 void arena_suite(void);
 void gen_vector_suite(void);
+void vec_generic_suite(void);
+void thread_pool_suite(void);
+void gen_vector_par_suite(void);
 void hashmap_suite(void);
+void hashmap_flat_suite(void);
+void hashmap_packed_suite(void);
+void hashmap_concurrent_suite(void);
 void hashset_suite(void);
+void int_hash_suite(void);
 void stack_suite(void);
 void queue_suite(void);
 void matrix_suite(void);
 void bit_vector_suite(void);
+void bloom_suite(void);
 void fast_math_suite(void);
 void complex_suite(void);
 
@@ -27,12 +35,28 @@ int main(void)
 
     gen_vector_suite();
 
+    vec_generic_suite();
+
+    thread_pool_suite();
+
+    gen_vector_par_suite();
+
     bit_vector_suite();
 
+    bloom_suite();
+
     hashmap_suite();
 
+    hashmap_flat_suite();
+
+    hashmap_packed_suite();
+
+    hashmap_concurrent_suite();
+
     hashset_suite();
 
+    int_hash_suite();
+
     stack_suite();
 
     queue_suite();
@@ -0,0 +1,190 @@
+#include "wc_test.h"
+#include "vec_generic.h"
+#include "wc_helpers.h"
+
+
+VEC_INSTANTIATE(int)
+VEC_INSTANTIATE(float)
+VEC_INSTANTIATE(String)
+
+
+static int cmp_int(const u8* a, const u8* b, u64 size)
+{
+    (void)size;
+    return *(const int*)a - *(const int*)b;
+}
+
+
+/* ── POD ─────────────────────────────────────────────────────────────────── */
+
+static void test_push_at_pop(void)
+{
+    Vec_int* v = vec_int_create(0, NULL);
+    WC_ASSERT_NULL(v->data);
+    WC_ASSERT_EQ_U64(v->data_size, sizeof(int));
+
+    for (int i = 0; i < 1000; i++) {
+        vec_int_push(v, i * 2);
+    }
+    WC_ASSERT_EQ_U64(v->size, 1000);
+    WC_ASSERT_TRUE(v->capacity >= 1000);
+    WC_ASSERT_EQ_INT(*vec_int_at(v, 10), 20);
+    WC_ASSERT_EQ_INT(vec_int_get(v, 999), 1998);
+
+    vec_int_set(v, 0, -1);
+    WC_ASSERT_EQ_INT(v->data[0], -1);
+
+    int out = 0;
+    WC_ASSERT_TRUE(vec_int_pop(v, &out));
+    WC_ASSERT_EQ_INT(out, 1998);
+    WC_ASSERT_TRUE(vec_int_pop(v, NULL));
+    WC_ASSERT_EQ_U64(v->size, 998);
+
+    vec_int_destroy(v);
+}
+
+static void test_pop_empty_sets_errno(void)
+{
+    Vec_float v;
+    vec_float_init_stk(&v, 4, NULL);
+
+    wc_errno = WC_OK;
+    WC_ASSERT_FALSE(vec_float_pop(&v, NULL));
+    WC_ASSERT_EQ_INT(wc_errno, WC_ERR_EMPTY);
+
+    vec_float_push(&v, 1.5f);
+    float f = 0;
+    WC_ASSERT_TRUE(vec_float_pop(&v, &f));
+    WC_ASSERT_TRUE(f == 1.5f);
+
+    vec_float_destroy_stk(&v);
+}
+
+static void test_push_arr_and_reserve(void)
+{
+    int arr[100];
+    for (int i = 0; i < 100; i++) {
+        arr[i] = i;
+    }
+
+    Vec_int* v = vec_int_create(2, NULL);
+    vec_int_push(v, -5);
+    vec_int_push_arr(v, arr, 100);
+    WC_ASSERT_EQ_U64(v->size, 101);
+    WC_ASSERT_EQ_INT(v->data[0], -5);
+    WC_ASSERT_EQ_INT(v->data[100], 99);
+
+    vec_int_reserve(v, 500);
+    WC_ASSERT_EQ_U64(v->capacity, 500);
+    vec_int_reserve(v, 10); // never shrinks
+    WC_ASSERT_EQ_U64(v->capacity, 500);
+
+    vec_int_clear(v);
+    WC_ASSERT_EQ_U64(v->size, 0);
+    vec_int_push_arr(v, arr, 0);
+    WC_ASSERT_EQ_U64(v->size, 0);
+
+    vec_int_destroy(v);
+}
+
+
+/* ── genVec interop ──────────────────────────────────────────────────────── */
+
+static void test_as_genvec(void)
+{
+    Vec_int* v = vec_int_create(0, NULL);
+    for (int i = 10; i > 0; i--) {
+        vec_int_push(v, i);
+    }
+
+    genVec* g = vec_int_as_genVec(v);
+    genVec_sort(g, cmp_int);
+    for (int i = 0; i < 10; i++) {
+        WC_ASSERT_EQ_INT(v->data[i], i + 1);
+    }
+
+    // genVec_push grows the same buffer the typed calls see
+    int x = 42;
+    genVec_push(g, (u8*)&x);
+    WC_ASSERT_EQ_U64(v->size, 11);
+    WC_ASSERT_EQ_INT(vec_int_get(v, 10), 42);
+
+    // and back again
+    genVec* plain = genVec_init(0, sizeof(int), NULL);
+    Vec_int* tv   = vec_int_from_genVec(plain);
+    vec_int_push(tv, 7);
+    WC_ASSERT_EQ_INT(*(const int*)genVec_get_ptr(plain, 0), 7);
+    genVec_destroy(plain);
+
+    genVec_destroy(g); // frees a typed vec just the same
+}
+
+
+/* ── owned elements (String) ─────────────────────────────────────────────── */
+
+static void test_string_copy_semantics(void)
+{
+    Vec_String* v = vec_String_create(0, &wc_str_ops);
+
+    String s;
+    string_create_stk(&s, "a string long enough to live on the heap");
+    vec_String_push(v, s);
+    vec_String_push(v, s);
+
+    // deep copies: the source can go
+    string_destroy_stk(&s);
+    WC_ASSERT_TRUE(string_equals_cstr(vec_String_at(v, 0),
+                                      "a string long enough to live on the heap"));
+    WC_ASSERT_TRUE(vec_String_at(v, 0)->heap != vec_String_at(v, 1)->heap);
+
+    String t;
+    string_create_stk(&t, "short");
+    vec_String_set(v, 1, t); // frees the old heap string
+    string_destroy_stk(&t);
+    WC_ASSERT_TRUE(string_equals_cstr(vec_String_at(v, 1), "short"));
+
+    vec_String_destroy(v);
+}
+
+static void test_string_move_and_pop(void)
+{
+    Vec_String* v = vec_String_create(1, &wc_str_ops);
+
+    for (int i = 0; i < 50; i++) {
+        String s;
+        char   buf[64];
+        snprintf(buf, sizeof(buf), "moved string number %d, on the heap", i);
+        string_create_stk(&s, buf);
+        vec_String_push_move(v, &s);
+        WC_ASSERT_NULL(s.heap);
+    }
+    WC_ASSERT_EQ_U64(v->size, 50);
+
+    // built in place
+    string_create_stk(vec_String_emplace_back(v), "emplaced, and on the heap as well");
+    WC_ASSERT_EQ_U64(v->size, 51);
+    WC_ASSERT_TRUE(vec_String_pop(v, NULL));
+
+    // pop hands ownership over, no copy
+    String out;
+    WC_ASSERT_TRUE(vec_String_pop(v, &out));
+    WC_ASSERT_TRUE(string_equals_cstr(&out, "moved string number 49, on the heap"));
+    string_destroy_stk(&out);
+
+    WC_ASSERT_TRUE(vec_String_pop(v, NULL)); // del_fn frees it
+
+    // genVec_destroy runs del_fn on the rest
+    genVec_destroy(vec_String_as_genVec(v));
+}
+
+
+void vec_generic_suite(void)
+{
+    WC_SUITE("Typed vector (VEC_INSTANTIATE)");
+    WC_RUN(test_push_at_pop);
+    WC_RUN(test_pop_empty_sets_errno);
+    WC_RUN(test_push_arr_and_reserve);
+    WC_RUN(test_as_genvec);
+    WC_RUN(test_string_copy_semantics);
+    WC_RUN(test_string_move_and_pop);
+}
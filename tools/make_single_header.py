@@ -36,6 +36,7 @@ from pathlib import Path
 COMPONENTS = [
     "common",
     "wc_errno",
+    "wc_allocator",
     "fast_math",
     "gen_vector",
     "String",
@@ -44,8 +45,12 @@ COMPONENTS = [
     "Stack",
     "Queue",
     "map_setup",
+    "map_snapshot",
     "random",
     "hashmap",
+    "hashmap_flat",
+    "hashmap_packed",
+    "hashmap_concurrent",
     "hashset",
     "matrix",
     "matrix_generic",
@@ -63,17 +68,22 @@ DEPENDENCIES: dict[str, list[str]] = {
     "common":           [],
     "wc_errno":         [],
     "wc_macros":        [],
+    "wc_allocator":     ["common"],
     "fast_math":        ["common"],
-    "gen_vector":       ["common", "wc_errno"],
-    "String":           ["common", "wc_errno"],
-    "arena":            ["common", "wc_errno"],
+    "gen_vector":       ["common", "wc_errno", "wc_allocator"],
+    "String":           ["common", "wc_errno", "wc_allocator"],
+    "arena":            ["common", "wc_errno", "wc_allocator"],
     "bit_vector":       ["gen_vector"],
     "Stack":            ["gen_vector"],
     "Queue":            ["gen_vector"],
     "map_setup":        ["String"],
+    "map_snapshot":     ["map_setup", "wc_errno"],
     "random":           ["fast_math"],
-    "hashmap":          ["map_setup"],
-    "hashset":          ["map_setup"],
+    "hashmap":          ["map_setup", "map_snapshot", "gen_vector", "arena"],
+    "hashmap_flat":     ["map_setup"],
+    "hashmap_packed":   ["map_setup"],
+    "hashmap_concurrent": ["hashmap"],
+    "hashset":          ["map_setup", "map_snapshot", "gen_vector", "arena"],
     "matrix":           ["arena"],
     "matrix_generic":   ["arena"],
     "wc_helpers":       ["String"],